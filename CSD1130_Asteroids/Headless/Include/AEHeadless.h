@@ -0,0 +1,16 @@
+/******************************************************************************/
+/*!
+\file		AEHeadless.h
+\brief		This file is included before every source of the headless Linux
+			build. AEExport.h defines AE_API as __declspec(dllexport), which
+			only the Microsoft compilers know, the functions of AEHeadless.cpp
+			are linked in directly.
+ */
+/******************************************************************************/
+
+#ifndef CSD1130_AE_HEADLESS_H_
+#define CSD1130_AE_HEADLESS_H_
+
+#define __declspec(x)
+
+#endif // CSD1130_AE_HEADLESS_H_
@@ -0,0 +1,74 @@
+/******************************************************************************/
+/*!
+\file		windows.h
+\brief		This file stands in for the Win32 header in the headless Linux
+			build. AEEngine.h includes <windows.h>, the Alpha Engine headers only
+			need the handle types of AESystem.h, the virtual key codes of
+			AEInput.h and the MessageBox() of the asserts. The key codes have
+			their Win32 values.
+ */
+/******************************************************************************/
+
+#ifndef CSD1130_HEADLESS_WINDOWS_H_
+#define CSD1130_HEADLESS_WINDOWS_H_
+
+#include <stdint.h>
+#include <stdio.h>
+
+// ---------------------------------------------------------------------------
+// types
+
+typedef void *			HINSTANCE;
+typedef void *			HWND;
+typedef unsigned int	UINT;
+typedef unsigned long	DWORD;
+typedef char *			LPSTR;
+typedef uintptr_t		WPARAM;
+typedef intptr_t		LPARAM;
+typedef intptr_t		LRESULT;
+
+#define CALLBACK
+#define WINAPI
+#define UNREFERENCED_PARAMETER(x)	(void)(x)
+
+// ---------------------------------------------------------------------------
+// message box, there is no window: the message goes to the console
+
+#define MB_OK					0x00000000
+
+inline int MessageBox(HWND, const char * text, const char * caption, UINT)
+{
+	fprintf(stderr, "%s: %s\n", caption, text);
+	return 0;
+}
+
+// ---------------------------------------------------------------------------
+// virtual key codes
+
+#define VK_LBUTTON				0x01
+#define VK_RBUTTON				0x02
+#define VK_MBUTTON				0x04
+#define VK_BACK					0x08
+#define VK_TAB					0x09
+#define VK_RETURN				0x0D
+#define VK_SHIFT				0x10
+#define VK_CONTROL				0x11
+#define VK_MENU					0x12
+#define VK_PAUSE				0x13
+#define VK_CAPITAL				0x14
+#define VK_ESCAPE				0x1B
+#define VK_SPACE				0x20
+#define VK_PRIOR				0x21
+#define VK_NEXT					0x22
+#define VK_END					0x23
+#define VK_HOME					0x24
+#define VK_LEFT					0x25
+#define VK_UP					0x26
+#define VK_RIGHT				0x27
+#define VK_DOWN					0x28
+#define VK_INSERT				0x2D
+#define VK_DELETE				0x2E
+
+// ---------------------------------------------------------------------------
+
+#endif // CSD1130_HEADLESS_WINDOWS_H_
@@ -0,0 +1,112 @@
+/******************************************************************************/
+/*!
+\file		AEHeadless.cpp
+\brief		This file contains the definition of the Alpha Engine functions the
+			simulation links against, for the headless Linux build where
+			Alpha_Engine.dll does not exist. There is no window: the graphics
+			functions do nothing and no key is ever pressed. The vector and
+			matrix functions compute the same results as the engine, the vector
+			math benchmark compares them with Math2D.h.
+ */
+/******************************************************************************/
+
+#include "AEEngine.h"
+#include "Math2D.h"
+
+// ---------------------------------------------------------------------------
+// graphics
+
+void AEGfxSetRenderMode(AEGfxRenderMode)
+{
+}
+
+void AEGfxSetBlendMode(AEGfxBlendMode)
+{
+}
+
+void AEGfxSetTransform(f32 [3][3])
+{
+}
+
+void AEGfxSetTransparency(f32)
+{
+}
+
+void AEGfxTextureSet(AEGfxTexture *, f32, f32)
+{
+}
+
+void AEGfxMeshStart()
+{
+}
+
+void AEGfxTriAdd(f32, f32, u32, f32, f32,
+				 f32, f32, u32, f32, f32,
+				 f32, f32, u32, f32, f32)
+{
+}
+
+// no mesh is ever built, the headless game state does not draw
+AEGfxVertexList * AEGfxMeshEnd()
+{
+	return 0;
+}
+
+void AEGfxMeshDraw(AEGfxVertexList *, AEGfxMeshDrawMode)
+{
+}
+
+void AEGfxMeshFree(AEGfxVertexList *)
+{
+}
+
+// ---------------------------------------------------------------------------
+// input
+
+u8 AEInputCheckCurr(u8)
+{
+	return 0;
+}
+
+u8 AEInputCheckTriggered(u8)
+{
+	return 0;
+}
+
+// ---------------------------------------------------------------------------
+// vector and matrix
+
+void AEVec2Add(AEVec2 * pResult, AEVec2 * pVec0, AEVec2 * pVec1)
+{
+	*pResult = Vec2Add(*pVec0, *pVec1);
+}
+
+void AEVec2Sub(AEVec2 * pResult, AEVec2 * pVec0, AEVec2 * pVec1)
+{
+	*pResult = Vec2Sub(*pVec0, *pVec1);
+}
+
+void AEVec2Scale(AEVec2 * pResult, AEVec2 * pVec0, f32 s)
+{
+	*pResult = Vec2Scale(*pVec0, s);
+}
+
+void AEMtx33Concat(AEMtx33 * pResult, AEMtx33 * pMtx0, AEMtx33 * pMtx1)
+{
+	*pResult = Mtx33Concat(*pMtx0, *pMtx1);
+}
+
+void AEMtx33Trans(AEMtx33 * pResult, f32 x, f32 y)
+{
+	*pResult = Mtx33TRSCosSin(Vec2Make(1.0f, 1.0f), 1.0f, 0.0f, Vec2Make(x, y));
+}
+
+void AEMtx33Scale(AEMtx33 * pResult, f32 x, f32 y)
+{
+	*pResult = Mtx33TRSCosSin(Vec2Make(x, y), 1.0f, 0.0f, Vec2Make(0.0f, 0.0f));
+}
+
+void AEMtx33Rot(AEMtx33 * pResult, f32 angle)
+{
+	*pResult = Mtx33TRS(Vec2Make(1.0f, 1.0f), angle, Vec2Make(0.0f, 0.0f));
+}
@@ -0,0 +1,37 @@
+/******************************************************************************/
+/*!
+\file		BenchmarkMain.cpp
+\brief		This file contains the entry point of the headless benchmark
+			executable built on Linux. The arguments are the same as the ones
+			that follow "-bench" on the command line of the game, e.g.
+			"asteroids_bench suite baseline=BenchmarkBaseline.csv".
+ */
+/******************************************************************************/
+
+#include "Main.h"
+#include "Benchmark.h"
+
+#include <string>
+
+// ---------------------------------------------------------------------------
+// Globals, defined by Main.cpp in the game
+
+float	g_dt;
+double	g_appTime;
+
+/******************************************************************************/
+/*!
+	Join the arguments back into the string BenchmarkRun() parses and run it.
+*/
+/******************************************************************************/
+int main(int argc, char * argv[])
+{
+	std::string args;
+	for (int i = 1; i < argc; i++)
+	{
+		args += ' ';
+		args += argv[i];
+	}
+
+	return BenchmarkRun(args.c_str());
+}
@@ -0,0 +1,30 @@
+/******************************************************************************/
+/*!
+\file		LoadGenMain.cpp
+\brief		This file contains the entry point of the load generator built
+			on Linux. The arguments are the same as the ones that follow
+			"-loadgen" on the command line of the game, e.g.
+			"asteroids_loadgen bots=1000 seconds=30 threads=4".
+ */
+/******************************************************************************/
+
+#include "LoadGen.h"
+
+#include <string>
+
+/******************************************************************************/
+/*!
+	Join the arguments back into the string LoadGenRun() parses and run it.
+*/
+/******************************************************************************/
+int main(int argc, char * argv[])
+{
+	std::string args;
+	for (int i = 1; i < argc; i++)
+	{
+		args += ' ';
+		args += argv[i];
+	}
+
+	return LoadGenRun(args.c_str());
+}
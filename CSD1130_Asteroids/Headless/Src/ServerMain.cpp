@@ -0,0 +1,37 @@
+/******************************************************************************/
+/*!
+\file		ServerMain.cpp
+\brief		This file contains the entry point of the headless server
+			executable built on Linux. The arguments are the same as the ones
+			that follow "-server" on the command line of the game, e.g.
+			"asteroids_server port=7777 asteroids=500".
+ */
+/******************************************************************************/
+
+#include "Main.h"
+#include "Server.h"
+
+#include <string>
+
+// ---------------------------------------------------------------------------
+// Globals, defined by Main.cpp in the game
+
+float	g_dt;
+double	g_appTime;
+
+/******************************************************************************/
+/*!
+	Join the arguments back into the string ServerRun() parses and run it.
+*/
+/******************************************************************************/
+int main(int argc, char * argv[])
+{
+	std::string args;
+	for (int i = 1; i < argc; i++)
+	{
+		args += ' ';
+		args += argv[i];
+	}
+
+	return ServerRun(args.c_str());
+}
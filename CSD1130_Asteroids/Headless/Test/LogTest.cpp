@@ -0,0 +1,131 @@
+/******************************************************************************/
+/*!
+\file		LogTest.cpp
+\brief		This file contains the flood test of the structured log. Several
+			threads write 800k numbered records as fast as they can into a
+			file, then the file is read back: every record is either a line
+			or counted as dropped, the lines of a thread are in the order it
+			wrote them with every field intact, and the drops the log reports
+			add up to LogDropped(). Returns 1 at the first difference.
+ */
+/******************************************************************************/
+
+#include "Log.h"
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// settings
+
+const unsigned int	TEST_THREADS		= 4;		// threads writing at once
+const unsigned int	TEST_RECORDS		= 800000;	// records of all the threads together
+
+/******************************************************************************/
+/*!
+	Body of a writing thread: its share of the records, numbered.
+*/
+/******************************************************************************/
+static void testFlood(unsigned int writer)
+{
+	for (unsigned int n = 0; n < TEST_RECORDS / TEST_THREADS; n++)
+		LogWrite(LOG_INFO, "flood", { LogInt("writer", writer), LogInt("n", n), LogFloat("half", n * 0.5),
+			LogText("text", "a \"quoted\" value") });
+}
+
+/******************************************************************************/
+/*!
+	Value of "key=" in a line, returns false if it is not there.
+*/
+/******************************************************************************/
+static bool testField(const char * line, const char * key, long long& value)
+{
+	const char * pAt = strstr(line, key);
+	return pAt && sscanf(pAt + strlen(key), "%lld", &value) == 1;
+}
+
+/******************************************************************************/
+/*!
+	Flood the log, then check the file named by the first argument. Returns
+	the process exit code.
+*/
+/******************************************************************************/
+int main(int argc, char * argv[])
+{
+	const char * path = argc > 1 ? argv[1] : "log_test.log";
+	remove(path);
+
+	if (!LogStart(path))
+	{
+		printf("log: cannot open %s\n", path);
+		return 1;
+	}
+
+	std::vector<std::thread> threads;
+	for (unsigned int t = 0; t < TEST_THREADS; t++)
+		threads.emplace_back(testFlood, t);
+	for (std::thread& thread : threads)
+		thread.join();
+
+	uint64_t dropped = LogDropped();
+	LogStop();
+
+	FILE * pFile = fopen(path, "r");
+	if (pFile == 0)
+	{
+		printf("log: cannot read %s\n", path);
+		return 1;
+	}
+
+	std::vector<long long>	last(TEST_THREADS, -1);
+	unsigned long long		lines = 0, reported = 0, summary = 0;
+	char					line[512];
+	int						result = 0;
+
+	while (result == 0 && fgets(line, sizeof(line), pFile))
+	{
+		long long writer, n, count;
+
+		if (strstr(line, "event=log.dropped") && testField(line, " count=", count))
+			reported += (unsigned long long)count;
+		else if (sscanf(line, "log: %lld record(s) dropped", &count) == 1)
+			summary = (unsigned long long)count;
+		else if (!strstr(line, " level=info ") || !strstr(line, " event=flood ")
+			  || !testField(line, " writer=", writer) || !testField(line, " n=", n)
+			  || writer < 0 || writer >= (long long)TEST_THREADS
+			  || !strstr(line, " text=\"a \\\"quoted\\\" value\"\n"))
+		{
+			printf("log: broken line: %s", line);
+			result = 1;
+		}
+		else if (n <= last[writer])
+		{
+			printf("log: writer %lld wrote record %lld after %lld\n", writer, n, last[writer]);
+			result = 1;
+		}
+		else
+		{
+			last[writer] = n;
+			++lines;
+		}
+	}
+	fclose(pFile);
+	remove(path);
+
+	if (result != 0)
+		return result;
+
+	if (lines + dropped != TEST_RECORDS || reported != dropped || summary != dropped)
+	{
+		printf("log: %llu lines and %llu dropped for %u records, %llu reported, %llu in the summary\n",
+			lines, (unsigned long long)dropped, TEST_RECORDS, reported, summary);
+		return 1;
+	}
+
+	printf("log: %u records from %u threads, %llu written, %llu dropped, ok\n",
+		TEST_RECORDS, TEST_THREADS, lines, (unsigned long long)dropped);
+	return 0;
+}
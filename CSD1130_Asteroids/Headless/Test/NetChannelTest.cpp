@@ -0,0 +1,204 @@
+/******************************************************************************/
+/*!
+\file		NetChannelTest.cpp
+\brief		This file contains the ordering test of the reliable channel. A
+			sender and a receiver talk over a simulated link that loses,
+			duplicates, delays and reorders the packets both ways. Every
+			message carries its number and bytes derived from it, the receiver
+			must hand out every message exactly once, in the order it was
+			queued, with its payload intact. Returns 1 at the first
+			difference.
+ */
+/******************************************************************************/
+
+#include "NetChannel.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// settings
+
+const unsigned int	TEST_MESSAGES		= 100000;	// messages queued
+const unsigned int	TEST_FRAMES_MAX		= 2000000;	// frames before the test gives up
+const double		TEST_FRAME			= 1.0 / 60.0;	// seconds between two packets each way
+const double		TEST_LOSS			= 0.2;		// packets lost, both ways
+const double		TEST_DUPLICATE		= 0.05;		// packets delivered twice
+const double		TEST_DELAY_MIN		= 0.03;		// seconds on the link
+const double		TEST_DELAY_MAX		= 0.15;		// the spread reorders the packets
+const double		TEST_RESEND			= 0.2;		// seconds before a message is written again
+const size_t		TEST_BUDGET			= 120;		// bytes of messages per packet
+const uint32_t		TEST_SEED			= 1130;
+
+// ---------------------------------------------------------------------------
+
+// one packet on the link
+struct TestPacket
+{
+	double					arrival;
+	uint32_t				sequence;		// data packet: its sequence, ack packet: the last one received
+	uint32_t				bits;			// ack packet: the ones before it
+	std::vector<uint8_t>	data;			// data packet: the message section
+};
+
+// ---------------------------------------------------------------------------
+// Static variables
+
+static std::mt19937							sRandom(TEST_SEED);
+static std::uniform_real_distribution<double>	sUnit(0.0, 1.0);
+
+/******************************************************************************/
+/*!
+	The payload of message number n: the number, then bytes derived from it,
+	4 to NET_MESSAGE_PAYLOAD_MAX bytes long.
+*/
+/******************************************************************************/
+static size_t testPayload(uint32_t n, uint8_t * pPayload)
+{
+	size_t size = 4 + n % (NET_MESSAGE_PAYLOAD_MAX - 3);
+	memcpy(pPayload, &n, 4);
+	for (size_t i = 4; i < size; i++)
+		pPayload[i] = (uint8_t)(n * 31 + i);
+	return size;
+}
+
+/******************************************************************************/
+/*!
+	Put a packet on the link: lost, delivered once or twice, after a random
+	delay. lossy is false for the drain at the end.
+*/
+/******************************************************************************/
+static void testSend(std::vector<TestPacket>& link, const TestPacket& packet, double now, bool lossy)
+{
+	if (lossy && sUnit(sRandom) < TEST_LOSS)
+		return;
+
+	unsigned int copies = lossy && sUnit(sRandom) < TEST_DUPLICATE ? 2 : 1;
+	for (unsigned int c = 0; c < copies; c++)
+	{
+		link.push_back(packet);
+		link.back().arrival = now + TEST_DELAY_MIN + sUnit(sRandom) * (TEST_DELAY_MAX - TEST_DELAY_MIN);
+	}
+}
+
+/******************************************************************************/
+/*!
+	Take the packets that arrived by now off the link, in arrival order.
+*/
+/******************************************************************************/
+static void testArrived(std::vector<TestPacket>& link, double now, std::vector<TestPacket>& arrived)
+{
+	arrived.clear();
+	for (size_t i = 0; i < link.size();)
+	{
+		if (link[i].arrival <= now)
+		{
+			arrived.push_back(std::move(link[i]));
+			link[i] = std::move(link.back());
+			link.pop_back();
+		}
+		else
+			i++;
+	}
+
+	std::sort(arrived.begin(), arrived.end(), [](const TestPacket& a, const TestPacket& b)
+	{
+		return a.arrival < b.arrival;
+	});
+}
+
+/******************************************************************************/
+/*!
+	Run the link until every message is delivered, returns the process exit
+	code.
+*/
+/******************************************************************************/
+int main()
+{
+	static NetChannelSender		sender;
+	static NetChannelReceiver	receiver;
+	NetChannelInit(sender);
+	NetChannelInit(receiver);
+
+	std::vector<TestPacket>		toReceiver, toSender, arrived;
+	std::vector<NetMessage>		delivered;
+	uint32_t					queued = 0, expected = 0, sequence = 0;
+	uint8_t						payload[NET_MESSAGE_PAYLOAD_MAX];
+	unsigned int				frame = 0;
+
+	for (; frame < TEST_FRAMES_MAX && expected < TEST_MESSAGES; frame++)
+	{
+		double	now		= frame * TEST_FRAME;
+		bool	lossy	= queued < TEST_MESSAGES;
+
+		// the sender queues a burst while the queue takes it, then writes a packet
+		unsigned int burst = (unsigned int)(sRandom() % 12);
+		for (unsigned int b = 0; b < burst && queued < TEST_MESSAGES; b++)
+		{
+			size_t size = testPayload(queued, payload);
+			if (!NetChannelQueue(sender, (uint8_t)(queued & 0xFF), payload, size))
+				break;
+			++queued;
+		}
+
+		TestPacket packet = {};
+		packet.sequence = sequence;
+		NetChannelWrite(sender, sequence++, now, TEST_RESEND, TEST_BUDGET, packet.data);
+		testSend(toReceiver, packet, now, lossy);
+
+		// the receiver reads what arrived and checks the order
+		testArrived(toReceiver, now, arrived);
+		for (const TestPacket& in : arrived)
+		{
+			const uint8_t * pCursor = in.data.data();
+			delivered.clear();
+			if (!NetChannelRead(receiver, pCursor, in.data.data() + in.data.size(), delivered))
+			{
+				printf("netchannel: frame %u: packet %u cut short\n", frame, in.sequence);
+				return 1;
+			}
+			NetChannelReceivePacket(receiver, in.sequence);
+
+			for (const NetMessage& message : delivered)
+			{
+				size_t size = testPayload(expected, payload);
+				if (message.type != (uint8_t)(expected & 0xFF) || message.size != size
+				 || memcmp(message.payload, payload, size) != 0)
+				{
+					uint32_t got = 0;
+					memcpy(&got, message.payload, 4);
+					printf("netchannel: frame %u: message %u handed out, expected %u\n", frame, got, expected);
+					return 1;
+				}
+				++expected;
+			}
+		}
+
+		// the receiver acknowledges back every frame
+		if (receiver.anyPacket)
+		{
+			TestPacket ack = {};
+			ack.sequence	= receiver.lastSequence;
+			ack.bits		= receiver.ackBits;
+			testSend(toSender, ack, now, lossy);
+		}
+
+		testArrived(toSender, now, arrived);
+		for (const TestPacket& in : arrived)
+			NetChannelAck(sender, in.sequence, in.bits);
+	}
+
+	if (expected != TEST_MESSAGES)
+	{
+		printf("netchannel: %u of %u messages delivered after %u frames\n", expected, TEST_MESSAGES, frame);
+		return 1;
+	}
+
+	printf("netchannel: %u messages in order over %u frames, %llu resent, %llu duplicates, %llu held back, ok\n",
+		TEST_MESSAGES, frame, (unsigned long long)sender.stats.resent, (unsigned long long)receiver.duplicates,
+		(unsigned long long)receiver.heldBack);
+	return 0;
+}
@@ -0,0 +1,195 @@
+/******************************************************************************/
+/*!
+\file		ScoreboardTest.cpp
+\brief		This file contains the test of the scoreboard against a std::map
+			of the same scores. It runs random joins, leaves, score events and
+			replaced scores, checks every score it looks up and compares the
+			leaderboard with the map sorted in full at every publish. A client
+			follows the leaderboard through the deltas, from bases it holds
+			and from bases too old to be kept, and must end up with the same
+			one. Returns 1 at the first difference.
+ */
+/******************************************************************************/
+
+#include "Scoreboard.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <random>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// settings
+
+const unsigned int	TEST_OPERATIONS		= 300000;	// random operations
+const unsigned int	TEST_PLAYERS		= 2000;		// player ids drawn from 0 to this
+const unsigned int	TEST_TOP_COUNT		= 16;		// players on the leaderboard
+const unsigned int	TEST_PUBLISH_EVERY	= 37;		// operations between two publishes
+const uint32_t		TEST_SEED			= 1130;
+
+// ---------------------------------------------------------------------------
+// Static variables
+
+static std::map<uint32_t, int32_t>	sReference;	// the scores the scoreboard must hold
+
+/******************************************************************************/
+/*!
+	The leaderboard of the reference: best score first, ties to the lowest
+	player id, at most the top count.
+*/
+/******************************************************************************/
+static void testReferenceTop(std::vector<ScoreboardEntry>& top)
+{
+	top.clear();
+	for (const auto& score : sReference)
+		top.push_back({ score.first, score.second });
+
+	std::sort(top.begin(), top.end(), [](const ScoreboardEntry& a, const ScoreboardEntry& b)
+	{
+		return a.score != b.score ? a.score > b.score : a.player < b.player;
+	});
+	if (top.size() > TEST_TOP_COUNT)
+		top.resize(TEST_TOP_COUNT);
+}
+
+/******************************************************************************/
+/*!
+	true if two leaderboards hold the same players with the same scores in
+	the same order.
+*/
+/******************************************************************************/
+static bool testSameTop(const std::vector<ScoreboardEntry>& a, const std::vector<ScoreboardEntry>& b)
+{
+	if (a.size() != b.size())
+		return false;
+
+	for (size_t i = 0; i < a.size(); i++)
+		if (a[i].player != b[i].player || a[i].score != b[i].score)
+			return false;
+
+	return true;
+}
+
+/******************************************************************************/
+/*!
+	Run the random operations on both, returns the process exit code.
+*/
+/******************************************************************************/
+int main()
+{
+	std::mt19937							random(TEST_SEED);
+	std::uniform_int_distribution<uint32_t>	player(0, TEST_PLAYERS - 1);
+	std::uniform_int_distribution<int32_t>	points(-300, 1000);
+	std::uniform_int_distribution<int>		operation(0, 99);
+	std::vector<ScoreboardEntry>			top, expected;
+	std::vector<ScoreboardEntry>			board;			// the leaderboard of the client
+	uint32_t								boardVersion = 0;
+	std::vector<uint8_t>					delta;
+	unsigned int							publishes = 0, applied = 0;
+	unsigned int							offline = 0;	// publishes the client still misses
+
+	ScoreboardInit(TEST_TOP_COUNT);
+
+	for (unsigned int i = 0; i < TEST_OPERATIONS; i++)
+	{
+		uint32_t	id		= player(random);
+		int			pick	= operation(random);
+
+		if (pick < 15)
+		{
+			ScoreboardJoin(id);
+			sReference.emplace(id, 0);
+		}
+		else if (pick < 25)
+		{
+			ScoreboardLeave(id);
+			sReference.erase(id);
+		}
+		else if (pick < 85)
+		{
+			int32_t add = points(random);
+			ScoreboardAdd(id, add);
+			auto it = sReference.find(id);
+			if (it != sReference.end())
+				it->second += add;
+		}
+		else if (pick < 90)
+		{
+			int32_t set = points(random) * 10;
+			ScoreboardSet(id, set);
+			auto it = sReference.find(id);
+			if (it != sReference.end())
+				it->second = set;
+		}
+
+		// every operation: the score of the player it touched
+		int32_t	score	= 0;
+		bool	found	= ScoreboardFind(id, score);
+		auto	it		= sReference.find(id);
+		if (found != (it != sReference.end()) || (found && score != it->second))
+		{
+			printf("scoreboard: operation %u, player %u: found %d score %d, expected %d %d\n",
+				i, id, (int)found, (int)score, (int)(it != sReference.end()), it != sReference.end() ? (int)it->second : 0);
+			return 1;
+		}
+
+		if (ScoreboardPlayerCount() != sReference.size())
+		{
+			printf("scoreboard: operation %u: %u players, expected %zu\n", i, ScoreboardPlayerCount(), sReference.size());
+			return 1;
+		}
+
+		if (i % TEST_PUBLISH_EVERY != 0)
+			continue;
+
+		// every publish: the leaderboard, then the client catches up through a delta
+		ScoreboardPublish();
+		++publishes;
+		ScoreboardTop(top);
+		testReferenceTop(expected);
+		if (!testSameTop(top, expected))
+		{
+			printf("scoreboard: operation %u: leaderboard differs from the reference\n", i);
+			return 1;
+		}
+
+		// the client misses one delta in four, the next one comes from the same base,
+		// and now and then more than the history keeps, the next one is the whole leaderboard
+		if (offline == 0 && random() % 512 == 0)
+			offline = SCOREBOARD_HISTORY + 16;
+		if (offline > 0)
+		{
+			--offline;
+			continue;
+		}
+		if (random() % 4 == 0)
+			continue;
+
+		// the server sends nothing to a client that holds the latest version
+		if (boardVersion == ScoreboardVersion())
+			continue;
+
+		delta.clear();
+		ScoreboardWriteDelta(boardVersion, delta);
+		if (!ScoreboardApplyDelta(delta.data(), delta.data() + delta.size(), board, boardVersion))
+		{
+			printf("scoreboard: operation %u: the delta from version %u was refused\n", i, boardVersion);
+			return 1;
+		}
+		++applied;
+
+		if (boardVersion != ScoreboardVersion() || !testSameTop(board, expected))
+		{
+			printf("scoreboard: operation %u: the client holds version %u, not the latest %u\n",
+				i, boardVersion, ScoreboardVersion());
+			return 1;
+		}
+	}
+
+	ScoreboardFree();
+
+	printf("scoreboard: %u operations, %u publishes, %u deltas applied, %zu players left, ok\n",
+		TEST_OPERATIONS, publishes, applied, sReference.size());
+	return 0;
+}
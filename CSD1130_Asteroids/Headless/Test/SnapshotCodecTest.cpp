@@ -0,0 +1,201 @@
+/******************************************************************************/
+/*!
+\file		SnapshotCodecTest.cpp
+\brief		This file contains the round trip test of the snapshot codecs.
+			Random slices, some like the asteroids of a match and some with
+			any id, owner, score and time, go through every codec and back:
+			SNAPSHOT_CODEC_RAW must give them back as they were, the others
+			within half a SNAPSHOT_QUANTUM and half an angle step, with the
+			id, the owner, the score and the bits of the time exact. An
+			encoder given too little room must say so without writing past
+			it, and a decoder given a slice cut short must not read past it.
+			Returns 1 at the first difference.
+ */
+/******************************************************************************/
+
+#include "SnapshotCodec.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// settings
+
+const unsigned int	TEST_SLICES			= 4000;		// slices per codec
+const unsigned int	TEST_SLICE_MAX		= 200;		// asteroids in a slice at most
+const size_t		TEST_GUARD			= 64;		// bytes past the room given to the encoder, must stay untouched
+const uint8_t		TEST_GUARD_BYTE		= 0xA5;
+const uint32_t		TEST_SEED			= 1130;
+
+// ---------------------------------------------------------------------------
+// Static variables
+
+static std::mt19937							sRandom(TEST_SEED);
+
+/******************************************************************************/
+/*!
+	A random float between low and high.
+*/
+/******************************************************************************/
+static float testRange(float low, float high)
+{
+	return std::uniform_real_distribution<float>(low, high)(sRandom);
+}
+
+/******************************************************************************/
+/*!
+	A random slice of count asteroids. A match slice has growing ids, few
+	owners and the values of the game, a wild one anything the fields hold
+	within the range the codecs quantize.
+*/
+/******************************************************************************/
+static void testSlice(std::vector<AsteroidData>& slice, size_t count, bool wild)
+{
+	slice.resize(count);
+
+	uint32_t	id		= sRandom() % 5000;
+	uint8_t		owner	= (uint8_t)(sRandom() % 4);
+	float		time	= testRange(0.0f, 600.0f);
+	for (AsteroidData& data : slice)
+	{
+		float angle		= testRange(-3.14159265f, 3.14159265f);
+		data.direction	= { cosf(angle), sinf(angle) };
+
+		if (wild)
+		{
+			uint32_t timeBits = sRandom();
+			data.owner		= (uint8_t)sRandom();
+			data.id			= sRandom();
+			data.position	= { testRange(-1.0e6f, 1.0e6f), testRange(-1.0e6f, 1.0e6f) };
+			data.scale		= { testRange(-1.0e4f, 1.0e4f), testRange(-1.0e4f, 1.0e4f) };
+			data.velocity	= { testRange(-1.0e5f, 1.0e5f), testRange(-1.0e5f, 1.0e5f) };
+			data.scoreCount	= (int)sRandom();
+			memcpy(&data.time, &timeBits, sizeof(data.time));
+			continue;
+		}
+
+		id				+= 1 + (sRandom() % 8 == 0 ? sRandom() % 40 : 0);
+		owner			= sRandom() % 16 == 0 ? (uint8_t)(sRandom() % 4) : owner;
+		time			+= sRandom() % 4 == 0 ? testRange(0.0f, 0.5f) : 0.0f;
+		data.owner		= owner;
+		data.id			= id;
+		data.position	= { testRange(-800.0f, 800.0f), testRange(-450.0f, 450.0f) };
+		float size		= testRange(10.0f, 60.0f);
+		data.scale		= { size, size };
+		data.velocity	= { testRange(-100.0f, 100.0f), testRange(-100.0f, 100.0f) };
+		data.scoreCount	= (int)(sRandom() % 3) * 100;
+		data.time		= time;
+	}
+}
+
+/******************************************************************************/
+/*!
+	true if the decoded asteroid b stands for a under the codec.
+*/
+/******************************************************************************/
+static bool testSame(SNAPSHOT_CODEC codec, const AsteroidData& a, const AsteroidData& b)
+{
+	if (a.owner != b.owner || a.id != b.id || a.scoreCount != b.scoreCount || memcmp(&a.time, &b.time, sizeof(a.time)) != 0)
+		return false;
+
+	const float	pA[] = { a.position.x, a.position.y, a.scale.x, a.scale.y, a.velocity.x, a.velocity.y };
+	const float	pB[] = { b.position.x, b.position.y, b.scale.x, b.scale.y, b.velocity.x, b.velocity.y };
+
+	if (codec == SNAPSHOT_CODEC_RAW)
+		return memcmp(pA, pB, sizeof(pA)) == 0 && a.direction.x == b.direction.x && a.direction.y == b.direction.y;
+
+	// half a quantum, and the float steps of the value itself
+	for (size_t i = 0; i < sizeof(pA) / sizeof(pA[0]); i++)
+		if (fabsf(pA[i] - pB[i]) > SNAPSHOT_QUANTUM * 0.5f + fabsf(pA[i]) * 1.0e-6f)
+			return false;
+
+	double angle = fabs(atan2((double)a.direction.y, (double)a.direction.x) - atan2((double)b.direction.y, (double)b.direction.x));
+	angle = angle > 3.14159265358979 ? 2.0 * 3.14159265358979 - angle : angle;
+	return angle <= 3.14159265358979 / SNAPSHOT_ANGLE_STEPS + 1.0e-5;
+}
+
+/******************************************************************************/
+/*!
+	Round trip the slices through every codec, returns the process exit
+	code.
+*/
+/******************************************************************************/
+int main()
+{
+	std::vector<AsteroidData>	slice, decoded;
+	std::vector<uint8_t>		coded(TEST_SLICE_MAX * DATA_SIZE + TEST_GUARD);
+
+	for (unsigned int c = 0; c < SNAPSHOT_CODEC_NUM; c++)
+	{
+		SNAPSHOT_CODEC	codec	= (SNAPSHOT_CODEC)c;
+		double			bytes	= 0.0, asteroids = 0.0;
+
+		for (unsigned int s = 0; s < TEST_SLICES; s++)
+		{
+			bool	wild	= s % 4 == 3;
+			size_t	count	= sRandom() % (TEST_SLICE_MAX + 1);
+			testSlice(slice, count, wild);
+
+			size_t size = SnapshotEncode(codec, slice.data(), count, coded.data(), coded.size() - TEST_GUARD);
+			if (size == 0 && count > 0)
+			{
+				printf("codec %s: slice %u of %zu asteroids does not fit in %zu bytes\n",
+					SnapshotCodecName(codec), s, count, coded.size() - TEST_GUARD);
+				return 1;
+			}
+
+			decoded.assign(count, AsteroidData());
+			if (!SnapshotDecode(codec, coded.data(), size, count, decoded.data()))
+			{
+				printf("codec %s: slice %u of %zu asteroids refused by the decoder\n", SnapshotCodecName(codec), s, count);
+				return 1;
+			}
+			for (size_t i = 0; i < count; i++)
+			{
+				if (!testSame(codec, slice[i], decoded[i]))
+				{
+					printf("codec %s: slice %u (%s), asteroid %zu (id %u) differs after the round trip\n",
+						SnapshotCodecName(codec), s, wild ? "wild" : "match", i, slice[i].id);
+					return 1;
+				}
+			}
+			if (!wild)
+			{
+				bytes		+= (double)size;
+				asteroids	+= (double)count;
+			}
+
+			if (size < 2)
+				continue;
+
+			// too little room: 0, and nothing written past the room
+			size_t room = sRandom() % size;
+			memset(coded.data() + room, TEST_GUARD_BYTE, TEST_GUARD);
+			if (SnapshotEncode(codec, slice.data(), count, coded.data(), room) != 0)
+			{
+				printf("codec %s: slice %u of %zu bytes encoded into %zu\n", SnapshotCodecName(codec), s, size, room);
+				return 1;
+			}
+			for (size_t i = 0; i < TEST_GUARD; i++)
+			{
+				if (coded[room + i] != TEST_GUARD_BYTE)
+				{
+					printf("codec %s: slice %u written past the %zu bytes of room\n", SnapshotCodecName(codec), s, room);
+					return 1;
+				}
+			}
+
+			// a slice cut short is refused or decoded into something, never read past, checked by the sanitizers
+			std::vector<uint8_t> cut(coded.begin(), coded.begin() + (std::ptrdiff_t)room);
+			SnapshotDecode(codec, cut.data(), cut.size(), count, decoded.data());
+		}
+
+		printf("codec %s: %u slices round trip, %.2f bytes per asteroid of a match, ok\n",
+			SnapshotCodecName(codec), TEST_SLICES, asteroids > 0.0 ? bytes / asteroids : 0.0);
+	}
+
+	return 0;
+}
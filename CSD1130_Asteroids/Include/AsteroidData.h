@@ -1,10 +1,11 @@
 #ifndef ASTEROIDDATA_H
 #define ASTEROIDDATA_H
 #include <AEVec2.h>
-#define DATA_SIZE 41
+#define DATA_SIZE 45
 struct AsteroidData
 {
 	uint8_t owner;
+	uint32_t id; // network entity id, the GameObjHandle of the instance on the server
 	AEVec2 position;
 	AEVec2 scale;
 	AEVec2 velocity;
@@ -19,6 +20,9 @@ struct AsteroidData
 void SetOwner(AsteroidData* data, uint8_t owner);
 uint8_t GetOwner(AsteroidData* data);
 
+void SetId(AsteroidData* data, uint32_t id);
+uint32_t GetId(AsteroidData* data);
+
 void SetPosition(AsteroidData* data, AEVec2 position);
 AEVec2 GetPosition(AsteroidData* data);
 
@@ -39,6 +43,8 @@ float GetTime(AsteroidData* data);
 
 void CalculateLinearConvergent(::AsteroidData* data, float time);
 char* ToNetworkData(AsteroidData* data);
+// same as ToNetworkData() into DATA_SIZE bytes of the caller, without allocating
+void WriteNetworkData(AsteroidData* data, char* buffer);
 
 AsteroidData FromNetworkData(char* buffer);
 
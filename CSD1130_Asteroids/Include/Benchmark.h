@@ -0,0 +1,50 @@
+/******************************************************************************/
+/*!
+\file		Benchmark.h
+\brief		This file contains the declaration of the headless benchmarks that
+			can be started from the command line with "-bench <name> [count]":
+			BenchmarkRun();
+			BenchmarkCapacity();
+			BenchmarkVecMath();
+			BenchmarkSuite();
+			BenchmarkSweep();
+			BenchmarkUdp();
+			BenchmarkCodec();
+ */
+/******************************************************************************/
+
+#ifndef CSD1130_BENCHMARK_H_
+#define CSD1130_BENCHMARK_H_
+
+// ---------------------------------------------------------------------------
+// Function prototypes
+
+// parse "<name> [count]" and run the matching benchmark, returns the process exit code
+int BenchmarkRun(const char * args);
+
+// fill the instance storage with up to bulletMax moving bullets and time create, update and destroy,
+// returns 2 if create or destroy do not stay O(1)
+int BenchmarkCapacity(unsigned long bulletMax);
+
+// time the per object math of a tick on objCount objects with the AE_API functions and with Math2D.h
+int BenchmarkVecMath(unsigned long objCount);
+
+// time the collision test, the network serialization, the instance creation and the tick over a grid of
+// scenarios, print CSV and compare with a baseline (see Benchmark.cpp for the options), 2 on a regression
+int BenchmarkSuite(const char * args);
+
+// time the tick over a grid of players, asteroids and tick rates, print the percentiles, CPU and memory of every
+// point as CSV and where the tick budget breaks (see Benchmark.cpp for the options)
+int BenchmarkSweep(const char * args);
+
+// send snapshot rounds to loopback clients and receive input rounds from them through every transport backend, print
+// the time per datagram and the datagrams per system call as CSV (see Benchmark.cpp for the options)
+int BenchmarkUdp(const char * args);
+
+// run every snapshot codec over the slices of a recorded or simulated match, print the bytes per packet and per client
+// against the encode and decode time as CSV (see Benchmark.cpp for the options), 2 if a codec loses data
+int BenchmarkCodec(const char * args);
+
+// ---------------------------------------------------------------------------
+
+#endif // CSD1130_BENCHMARK_H_
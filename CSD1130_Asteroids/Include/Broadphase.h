@@ -0,0 +1,75 @@
+/******************************************************************************/
+/*!
+\file		Broadphase.h
+\brief		This file contains the declaration of the uniform grid broadphase used
+			by the dynamic-dynamic collision pass:
+			BroadphaseBegin();
+			BroadphaseAdd();
+			BroadphaseCollide();
+			BroadphaseFree();
+			CollisionEventLess();
+
+			Objects are added to one of two layers. Only target vs probe pairs
+			are tested (asteroids vs ships and bullets). The grid cells are split
+			in ranges that the worker pool tests in parallel, every thread writes
+			its hits to its own buffer and the buffers are merged and sorted, so
+			the hits are the same whatever the number of threads.
+ */
+/******************************************************************************/
+
+#ifndef CSD1130_BROADPHASE_H_
+#define CSD1130_BROADPHASE_H_
+
+#include <vector>
+
+#include "GameObjInst.h"
+
+// ---------------------------------------------------------------------------
+// settings
+
+const float			BROADPHASE_CELL_SIZE		= 128.0f;		// side of a grid cell, bigger than the biggest asteroid
+const unsigned long	BROADPHASE_CELL_MAX			= 1ul << 20;	// the cell size doubles until the grid fits in this many cells
+const unsigned int	BROADPHASE_JOBS_PER_THREAD	= 4;			// cell ranges per thread, for load balancing
+
+// ---------------------------------------------------------------------------
+// layers
+
+enum BROADPHASE_LAYER
+{
+	BROADPHASE_TARGET = 0,		// asteroids
+	BROADPHASE_PROBE,			// ship and bullets
+
+	BROADPHASE_LAYER_NUM
+};
+
+// ---------------------------------------------------------------------------
+
+// hit between an object of the target layer and an object of the probe layer
+struct CollisionEvent
+{
+	GameObjHandle		target;		// the asteroid
+	GameObjHandle		probe;		// the ship or the bullet
+	float				tFirst;		// time of collision inside the frame
+};
+
+// ---------------------------------------------------------------------------
+// Function prototypes
+
+// clear both layers and size the grid to cover world, dt is the frame time used to sweep the boxes
+void	BroadphaseBegin(const AABB& world, float dt);
+
+// add an active instance, its boundingBox must be up to date
+void	BroadphaseAdd(BROADPHASE_LAYER layer, GameObjInst * pInst);
+
+// test every target vs probe pair sharing a cell and write the hits, sorted with CollisionEventLess, to hits
+void	BroadphaseCollide(std::vector<CollisionEvent>& hits);
+
+// release the memory of the grid
+void	BroadphaseFree();
+
+// order of resolution of the hits: earliest first, then by slot
+bool	CollisionEventLess(const CollisionEvent& a, const CollisionEvent& b);
+
+// ---------------------------------------------------------------------------
+
+#endif // CSD1130_BROADPHASE_H_
@@ -18,17 +18,7 @@ prior written consent of DigiPen Institute of Technology is prohibited.
 #define CSD1130_COLLISION_H_
 
 #include "AEEngine.h"
-
-/**************************************************************************/
-/*!
-
-	*/
-/**************************************************************************/
-struct AABB
-{
-	AEVec2	min;
-	AEVec2	max;
-};
+#include "Math2D.h"		// struct AABB
 
 bool CollisionIntersection_RectRect(const AABB& aabb1,            //Input
 									const AEVec2& vel1,           //Input 
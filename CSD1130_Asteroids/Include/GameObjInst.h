@@ -0,0 +1,160 @@
+/******************************************************************************/
+/*!
+\file		GameObjInst.h
+\brief		This file contains the game object and game object instance structures
+			and the declaration of the chunked instance storage:
+			gameObjInstStorageInit();
+			gameObjInstStorageFree();
+			gameObjInstStorageAlloc();
+			gameObjInstStorageRelease();
+			gameObjInstStorageFind();
+			gameObjInstGetHandle();
+			gameObjInstStorageCount();
+			gameObjInstStorageSize();
+			gameObjInstStorageAt();
+			gameObjInstStorageFreeList();
+			gameObjInstStorageRestore();
+
+			Instances live in fixed size chunks that are never moved once they are
+			allocated, so a GameObjInst pointer stays valid while the storage grows.
+			References that outlive a frame (other threads, network snapshots) use a
+			32 bit GameObjHandle instead: the slot index in the low 20 bits and the
+			slot generation in the high 12 bits. The same value is used as the
+			network entity id, so resolving an id is one chunk lookup and a compare.
+ */
+/******************************************************************************/
+
+#ifndef CSD1130_GAME_OBJ_INST_H_
+#define CSD1130_GAME_OBJ_INST_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "AEEngine.h"
+#include "Collision.h"
+
+// ---------------------------------------------------------------------------
+// storage limits
+
+const unsigned long	GAME_OBJ_INST_CHUNK_SIZE	= 1024;			// number of instances in one chunk
+const unsigned long	GAME_OBJ_INST_CHUNK_MAX		= 1024;			// maximum number of chunks
+const unsigned long	GAME_OBJ_INST_NUM_MAX		= GAME_OBJ_INST_CHUNK_SIZE * GAME_OBJ_INST_CHUNK_MAX;	// hard cap of game object instances
+
+// ---------------------------------------------------------------------------
+// handle layout
+
+typedef uint32_t		GameObjHandle;
+
+const unsigned long	GAME_OBJ_HANDLE_INDEX_BITS		= 20;										// low bits: slot index
+const unsigned long	GAME_OBJ_HANDLE_INDEX_MASK		= (1ul << GAME_OBJ_HANDLE_INDEX_BITS) - 1;
+const unsigned long	GAME_OBJ_HANDLE_GENERATION_MASK	= (1ul << (32 - GAME_OBJ_HANDLE_INDEX_BITS)) - 1;	// high bits: slot generation
+const GameObjHandle	GAME_OBJ_HANDLE_NONE			= 0;										// never resolves, generations start at 1
+
+// owner of the instances no player created (asteroids, wall, populated bullets)
+const uint32_t		GAME_PLAYER_NONE				= 0xFFFFFFFFu;
+
+static_assert(GAME_OBJ_INST_NUM_MAX <= GAME_OBJ_HANDLE_INDEX_MASK + 1, "slot index does not fit in a GameObjHandle");
+
+// ---------------------------------------------------------------------------
+// object flag definition
+
+const unsigned long FLAG_ACTIVE				= 0x00000001;
+const unsigned long FLAG_DESTROY_PENDING	= 0x00000002;	// queued for destruction, still holds its slot
+
+// ---------------------------------------------------------------------------
+
+//Game object structure
+struct GameObj
+{
+	unsigned long		type;		// object type
+	AEGfxVertexList *	pMesh;		// This will hold the triangles which will form the shape of the object
+};
+
+// ---------------------------------------------------------------------------
+
+//Game object instance structure
+struct GameObjInst
+{
+	GameObj *			pObject;	// pointer to the 'original' shape
+	unsigned long		flag;		// bit flag or-ed together
+	AEVec2				scale;		// scaling value of the object instance
+	AEVec2				posCurr;	// object current position
+
+	AEVec2				posPrev;	// object previous position -> it's the position calculated in the previous loop
+
+	AEVec2				velCurr;	// object current velocity
+	float				dirCurr;	// object current direction
+	AABB				boundingBox;// object bouding box that encapsulates the object
+
+	uint32_t			owner;		// player of a ship or of the ship that fired a bullet, GAME_PLAYER_NONE otherwise
+
+	unsigned long		index;		// slot of this instance in the storage, never changes
+	unsigned long		generation;	// bumped every time the slot is released, used to catch stale handles (1 to GAME_OBJ_HANDLE_GENERATION_MASK)
+};
+
+// ---------------------------------------------------------------------------
+// externs
+
+// chunk table, every chunk holds GAME_OBJ_INST_CHUNK_SIZE instances
+extern std::vector<GameObjInst *>	gGameObjInstChunks;
+
+// ---------------------------------------------------------------------------
+// Function prototypes
+
+// drop every chunk and start with an empty storage
+void				gameObjInstStorageInit();
+
+// release the memory of every chunk
+void				gameObjInstStorageFree();
+
+// take an unused slot and mark it FLAG_ACTIVE, growing the storage by one chunk if needed (0 when GAME_OBJ_INST_NUM_MAX is reached)
+GameObjInst *		gameObjInstStorageAlloc();
+
+// give a slot back to the storage and invalidate every reference to it
+void				gameObjInstStorageRelease(GameObjInst * pInst);
+
+// number of live instances
+unsigned long		gameObjInstStorageCount();
+
+// unused slots, the next one to be taken is at the back
+const std::vector<unsigned long>&	gameObjInstStorageFreeList();
+
+// rebuild the storage with chunkCount chunks and the given free list (used to restore a saved state).
+// every slot is left inactive, the caller sets flag, generation and data of the slots that are not in freeList.
+bool				gameObjInstStorageRestore(unsigned long chunkCount, const std::vector<unsigned long>& freeList);
+
+// number of slots, this is the upper bound when walking the storage
+inline unsigned long gameObjInstStorageSize()
+{
+	return (unsigned long)gGameObjInstChunks.size() * GAME_OBJ_INST_CHUNK_SIZE;
+}
+
+// slot at index, index must be smaller than gameObjInstStorageSize()
+inline GameObjInst * gameObjInstStorageAt(unsigned long index)
+{
+	return gGameObjInstChunks[index / GAME_OBJ_INST_CHUNK_SIZE] + (index % GAME_OBJ_INST_CHUNK_SIZE);
+}
+
+// handle of a live instance, it stays valid until the instance is released
+inline GameObjHandle gameObjInstGetHandle(const GameObjInst * pInst)
+{
+	return (GameObjHandle)((pInst->generation << GAME_OBJ_HANDLE_INDEX_BITS) | pInst->index);
+}
+
+// instance of a handle in O(1), 0 if the handle is GAME_OBJ_HANDLE_NONE or the instance was released since
+inline GameObjInst * gameObjInstStorageFind(GameObjHandle handle)
+{
+	unsigned long index = handle & GAME_OBJ_HANDLE_INDEX_MASK;
+	if (index >= gameObjInstStorageSize())
+		return 0;
+
+	GameObjInst * pInst = gameObjInstStorageAt(index);
+	if (pInst->flag == 0 || pInst->generation != (handle >> GAME_OBJ_HANDLE_INDEX_BITS))
+		return 0;
+
+	return pInst;
+}
+
+// ---------------------------------------------------------------------------
+
+#endif // CSD1130_GAME_OBJ_INST_H_
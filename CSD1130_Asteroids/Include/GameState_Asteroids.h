@@ -9,9 +9,23 @@
 			GameStateAsteroidsLoad();
 			GameStateAsteroidsInit();
 			GameStateAsteroidsUpdate();
+			GameStateAsteroidsTick();
 			GameStateAsteroidsDraw();
 			GameStateAsteroidsFree();
 			GameStateAsteroidsUnload();
+			GameStateAsteroidsSetWorldSize();
+			GameStateAsteroidsSetViewEnabled();
+			GameStateAsteroidsSetSeed();
+			GameStateAsteroidsSetRecordPath();
+			GameStateAsteroidsPlayerJoin();
+			GameStateAsteroidsPlayerLeave();
+			GameStateAsteroidsChecksum();
+			GameStateAsteroidsSaveKeyframe();
+			GameStateAsteroidsLoadKeyframe();
+			GameStateAsteroidsSetEndless();
+			GameStateAsteroidsPopulate();
+			GameStateAsteroidsGetAsteroids();
+			GameStateAsteroidsEvents();
 			This 5 function below is declare and define in the GameState_Asteroids.cpp file
 			gameObjInstCreate ();
 			gameObjInstDestroy();
@@ -28,6 +42,30 @@ prior written consent of DigiPen Institute of Technology is prohibited.
 #ifndef CSD1130_GAME_STATE_PLAY_H_
 #define CSD1130_GAME_STATE_PLAY_H_
 
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "InputCommand.h"
+
+struct AsteroidData;
+
+// what a tick did that every player must hear of, the server sends them on its reliable channel
+enum GAME_EVENT
+{
+	GAME_EVENT_ASTEROID_DESTROYED = 1,	// id: network id of the asteroid, value: player whose ship or bullet hit it
+	GAME_EVENT_SHIP_HIT,				// id: player, value: lives left
+	GAME_EVENT_SCORE,					// id: player, value: score after the tick
+	GAME_EVENT_MATCH_OVER,				// value: 1 won, 0 lost
+};
+
+struct GameEvent
+{
+	uint8_t			type;				// GAME_EVENT
+	uint32_t		id;
+	int32_t			value;
+};
+
 // ---------------------------------------------------------------------------
 
 void GameStateAsteroidsLoad(void);
@@ -37,6 +75,43 @@ void GameStateAsteroidsDraw(void);
 void GameStateAsteroidsFree(void);
 void GameStateAsteroidsUnload(void);
 
+// run one tick of the simulation with the given frame time and input commands, Update() calls it with the keyboard
+void GameStateAsteroidsTick(float dt, const InputCommand * pCommands, unsigned int commandCount);
+
+// set the playfield size (world units), decoupled from the window size, returns the size applied (never below the window)
+AEVec2 GameStateAsteroidsSetWorldSize(float width, float height);
+
+// turn the view stage (transforms and drawing) on or off, a headless server turns it off
+void GameStateAsteroidsSetViewEnabled(bool enabled);
+
+// seed the random generator of the next matches with seed instead of the clock
+void GameStateAsteroidsSetSeed(uint32_t seed);
+
+// record the next matches to path (input log replayed with -replay), nullptr or "" to stop
+void GameStateAsteroidsSetRecordPath(const char * path);
+
+// add/remove a player and its ship, only the commands of players in the match are applied
+void GameStateAsteroidsPlayerJoin(uint32_t player);
+void GameStateAsteroidsPlayerLeave(uint32_t player);
+
+// hash of the simulation state, equal on two runs that ended the same
+uint32_t GameStateAsteroidsChecksum();
+
+// save the whole simulation state to keyframe / restore it, used by the replay keyframes
+void GameStateAsteroidsSaveKeyframe(std::vector<uint8_t>& keyframe);
+bool GameStateAsteroidsLoadKeyframe(const uint8_t * pData, size_t size);
+
+// no game over and no win, for the benchmarks and the load tests
+void GameStateAsteroidsSetEndless(bool endless);
+
+// add random asteroids and bullets until the world holds at least that many of each, recorded
+void GameStateAsteroidsPopulate(unsigned long asteroidCount, unsigned long bulletCount);
+
+// network data of every active asteroid, sent in the snapshots of the server
+void GameStateAsteroidsGetAsteroids(std::vector<AsteroidData>& asteroids, float time);
+// events of the last tick, in the order they happened
+const std::vector<GameEvent>& GameStateAsteroidsEvents();
+
 // ---------------------------------------------------------------------------
 
 #endif // CSD1130_GAME_STATE_PLAY_H_
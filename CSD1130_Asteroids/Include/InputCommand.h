@@ -0,0 +1,35 @@
+/******************************************************************************/
+/*!
+\file		InputCommand.h
+\brief		This file contains the input command of a player for one tick. The
+			simulation only reads its input from these commands, never from the
+			keyboard directly, so a match can be recorded and played back.
+ */
+/******************************************************************************/
+
+#ifndef CSD1130_INPUT_COMMAND_H_
+#define CSD1130_INPUT_COMMAND_H_
+
+#include <cstdint>
+
+// ---------------------------------------------------------------------------
+// buttons
+
+const uint8_t	INPUT_FORWARD		= 0x01;		// held: accelerate forward
+const uint8_t	INPUT_BACKWARD		= 0x02;		// held: accelerate backward
+const uint8_t	INPUT_LEFT			= 0x04;		// held: turn left
+const uint8_t	INPUT_RIGHT			= 0x08;		// held: turn right
+const uint8_t	INPUT_FIRE			= 0x10;		// pressed this tick: shoot a bullet
+
+// ---------------------------------------------------------------------------
+
+// buttons of one player for one tick
+struct InputCommand
+{
+	uint32_t			player;		// id of the player
+	uint8_t				buttons;	// combination of the INPUT_ flags
+};
+
+// ---------------------------------------------------------------------------
+
+#endif // CSD1130_INPUT_COMMAND_H_
@@ -0,0 +1,40 @@
+/******************************************************************************/
+/*!
+\file		LoadGen.h
+\brief		This file contains the declaration of the load generator, a swarm
+			of bots that play against the headless server over UDP:
+			LoadGenRun();
+
+			Every bot has its own socket, runs the CONNECT handshake of
+			NetProtocol.h and then streams thrust, rotate and fire inputs. It
+			measures the snapshots it receives, the snapshots lost on the way
+			and the time between an input and the snapshot that acknowledges it.
+			It rebuilds the leaderboard from the deltas and acknowledges them,
+			and reads the events of the reliable channel of NetChannel.h and
+			the asteroids in the codec the server named, see SnapshotCodec.h.
+ */
+/******************************************************************************/
+
+#ifndef CSD1130_LOAD_GEN_H_
+#define CSD1130_LOAD_GEN_H_
+
+// ---------------------------------------------------------------------------
+// settings
+
+const unsigned int	LOADGEN_INPUT_RATE			= 30;		// inputs per second sent by a bot
+const float			LOADGEN_FIRE_RATE			= 2.0f;		// shots per second of a bot
+const double		LOADGEN_CONNECT_RESEND		= 0.25;		// seconds between two CONNECT of a bot without answer
+const double		LOADGEN_CONNECT_TIMEOUT		= 5.0;		// seconds without ACCEPT before a bot gives up
+const unsigned int	LOADGEN_INPUT_HISTORY		= 256;		// send times kept per bot to measure the ack latency
+
+// ---------------------------------------------------------------------------
+// Function prototypes
+
+// "[server=127.0.0.1] [port=7777] [bots=100] [rate=30] [fire=2] [seconds=10] [ramp=1] [threads=1] [csv=file]":
+// run the bots against the server and print the summary, csv= also writes one line per bot.
+// returns the process exit code, 1 if a bot could not connect
+int		LoadGenRun(const char * args);
+
+// ---------------------------------------------------------------------------
+
+#endif // CSD1130_LOAD_GEN_H_
@@ -0,0 +1,104 @@
+/******************************************************************************/
+/*!
+\file		Log.h
+\brief		This file contains the declaration of the asynchronous structured
+			log:
+			LogStart();
+			LogStop();
+			LogWrite();
+			LogDropped();
+
+			A record is an event name and a few typed key/value fields. The
+			thread that writes it only copies it into a ring of its own, a
+			background thread formats the records of every ring as "key=value"
+			lines and writes them in batches. When a ring is full the record is
+			dropped and counted, the writer never waits for the console.
+ */
+/******************************************************************************/
+
+#ifndef CSD1130_LOG_H_
+#define CSD1130_LOG_H_
+
+#include <cstdint>
+#include <initializer_list>
+
+// ---------------------------------------------------------------------------
+// settings
+
+const unsigned int	LOG_FIELD_MAX				= 6;		// fields kept per record, the others are dropped
+const unsigned int	LOG_RING_SIZE				= 1024;		// records per thread, a power of 2
+const unsigned int	LOG_FLUSH_MS				= 20;		// longest time a record waits for the background thread
+
+// ---------------------------------------------------------------------------
+
+// importance of a record
+enum LOG_LEVEL
+{
+	LOG_DEBUG = 0,
+	LOG_INFO,
+	LOG_WARN,
+	LOG_ERROR,
+};
+
+// type of the value of a field
+enum LOG_FIELD_TYPE
+{
+	LOG_FIELD_INT = 0,
+	LOG_FIELD_FLOAT,
+	LOG_FIELD_TEXT,
+};
+
+// one key=value of a record. The key and the text of a LOG_FIELD_TEXT are not copied,
+// they must live until the record is written: string literals, or strings kept until LogStop()
+struct LogField
+{
+	const char *		key;
+	uint8_t				type;		// LOG_FIELD_TYPE
+	union
+	{
+		int64_t			i;
+		double			f;
+		const char *	s;
+	}					value;
+};
+
+inline LogField LogInt(const char * key, int64_t value)
+{
+	LogField field = { key, LOG_FIELD_INT, {} };
+	field.value.i = value;
+	return field;
+}
+
+inline LogField LogFloat(const char * key, double value)
+{
+	LogField field = { key, LOG_FIELD_FLOAT, {} };
+	field.value.f = value;
+	return field;
+}
+
+inline LogField LogText(const char * key, const char * text)
+{
+	LogField field = { key, LOG_FIELD_TEXT, {} };
+	field.value.s = text;
+	return field;
+}
+
+// ---------------------------------------------------------------------------
+// Function prototypes
+
+// start the background thread, the lines go to the file at path (appended) or to stdout if path is 0.
+// returns false if the file cannot be opened
+bool		LogStart(const char * path = 0);
+
+// write what is left, report the drops and stop the background thread
+void		LogStop();
+
+// queue a record, event is a string literal. Without LogStart() the line is written at once
+void		LogWrite(LOG_LEVEL level, const char * event, std::initializer_list<LogField> fields = {});
+
+// records dropped because a ring was full, since the program started
+uint64_t	LogDropped();
+
+// ---------------------------------------------------------------------------
+
+#endif // CSD1130_LOG_H_
@@ -27,7 +27,7 @@ extern double	g_appTime;
 // includes
 
 #include "AEEngine.h"
-#include "Math.h"
+#include <math.h>
 
 #include "GameStateMgr.h"
 #include "GameState_Asteroids.h"
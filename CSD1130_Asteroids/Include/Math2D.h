@@ -0,0 +1,164 @@
+/******************************************************************************/
+/*!
+\file		Math2D.h
+\brief		This file contains the header only 2D math used by the simulation:
+			vectors, axis aligned bounding boxes and 3x3 affine matrices.
+
+			The functions work on AEVec2 and AEMtx33 themselves, so the data can
+			be handed to the Alpha Engine as is. Unlike the AE_API functions,
+			that live in Alpha_Engine.dll and are always a real call, these are
+			visible to the compiler and get inlined and vectorized in the hot
+			loops. Everything that does not need sinf/cosf/sqrtf is constexpr.
+ */
+/******************************************************************************/
+
+#ifndef CSD1130_MATH_2D_H_
+#define CSD1130_MATH_2D_H_
+
+#include <math.h>
+
+#include "AEVec2.h"
+#include "AEMtx33.h"
+
+static_assert(sizeof(AEVec2) == 2 * sizeof(float), "AEVec2 layout changed");
+static_assert(sizeof(AEMtx33) == 9 * sizeof(float), "AEMtx33 layout changed");
+
+// ---------------------------------------------------------------------------
+
+// axis aligned bounding box
+struct AABB
+{
+	AEVec2	min;
+	AEVec2	max;
+};
+
+// ---------------------------------------------------------------------------
+// scalar
+
+// wraparound of x in [x0, x1], same as AEWrap: only works if x is less than one range outside
+constexpr float Wrap(float x, float x0, float x1)
+{
+	return x < x0 ? x + (x1 - x0) : (x > x1 ? x - (x1 - x0) : x);
+}
+
+constexpr float Clamp(float x, float min, float max)
+{
+	return x < min ? min : (x > max ? max : x);
+}
+
+// ---------------------------------------------------------------------------
+// 2D vector
+
+constexpr AEVec2 Vec2Make(float x, float y)
+{
+	return AEVec2{ x, y };
+}
+
+constexpr AEVec2 Vec2Add(const AEVec2& a, const AEVec2& b)
+{
+	return AEVec2{ a.x + b.x, a.y + b.y };
+}
+
+constexpr AEVec2 Vec2Sub(const AEVec2& a, const AEVec2& b)
+{
+	return AEVec2{ a.x - b.x, a.y - b.y };
+}
+
+constexpr AEVec2 Vec2Scale(const AEVec2& a, float s)
+{
+	return AEVec2{ a.x * s, a.y * s };
+}
+
+// a + b * s, the usual position/velocity integration step
+constexpr AEVec2 Vec2ScaleAdd(const AEVec2& a, const AEVec2& b, float s)
+{
+	return AEVec2{ a.x + b.x * s, a.y + b.y * s };
+}
+
+constexpr float Vec2Dot(const AEVec2& a, const AEVec2& b)
+{
+	return a.x * b.x + a.y * b.y;
+}
+
+constexpr float Vec2LengthSq(const AEVec2& a)
+{
+	return a.x * a.x + a.y * a.y;
+}
+
+inline float Vec2Length(const AEVec2& a)
+{
+	return sqrtf(Vec2LengthSq(a));
+}
+
+// unit vector pointing at angle (radian)
+inline AEVec2 Vec2FromAngle(float angle)
+{
+	return AEVec2{ cosf(angle), sinf(angle) };
+}
+
+// ---------------------------------------------------------------------------
+// AABB
+
+// box of the given size centered on center
+constexpr AABB AABBFromCenter(const AEVec2& center, const AEVec2& size)
+{
+	return AABB{ { center.x - size.x * 0.5f, center.y - size.y * 0.5f },
+				 { center.x + size.x * 0.5f, center.y + size.y * 0.5f } };
+}
+
+constexpr bool AABBOverlap(const AABB& a, const AABB& b)
+{
+	return !(a.max.x < b.min.x || a.min.x > b.max.x || a.max.y < b.min.y || a.min.y > b.max.y);
+}
+
+// box covering a and a moved by move
+constexpr AABB AABBSweep(const AABB& a, const AEVec2& move)
+{
+	return AABB{ { move.x < 0.0f ? a.min.x + move.x : a.min.x, move.y < 0.0f ? a.min.y + move.y : a.min.y },
+				 { move.x > 0.0f ? a.max.x + move.x : a.max.x, move.y > 0.0f ? a.max.y + move.y : a.max.y } };
+}
+
+// ---------------------------------------------------------------------------
+// 3x3 affine matrix, same storage as AEMtx33: m[row][col], translation in the last column
+
+constexpr AEMtx33 Mtx33Identity()
+{
+	return AEMtx33{ { { 1.0f, 0.0f, 0.0f },
+					  { 0.0f, 1.0f, 0.0f },
+					  { 0.0f, 0.0f, 1.0f } } };
+}
+
+// a * b
+constexpr AEMtx33 Mtx33Concat(const AEMtx33& a, const AEMtx33& b)
+{
+	AEMtx33 result{};
+	for (int row = 0; row < 3; row++)
+		for (int col = 0; col < 3; col++)
+			result.m[row][col] = a.m[row][0] * b.m[0][col] + a.m[row][1] * b.m[1][col] + a.m[row][2] * b.m[2][col];
+	return result;
+}
+
+// Trans * Rot * Scale in one go, from the cosine and sine of the rotation
+constexpr AEMtx33 Mtx33TRSCosSin(const AEVec2& scale, float cosAngle, float sinAngle, const AEVec2& pos)
+{
+	return AEMtx33{ { { cosAngle * scale.x, -sinAngle * scale.y, pos.x },
+					  { sinAngle * scale.x,  cosAngle * scale.y, pos.y },
+					  { 0.0f,                0.0f,               1.0f } } };
+}
+
+// Trans * Rot * Scale in one go
+inline AEMtx33 Mtx33TRS(const AEVec2& scale, float angle, const AEVec2& pos)
+{
+	return Mtx33TRSCosSin(scale, cosf(angle), sinf(angle), pos);
+}
+
+// mtx * (v, 1)
+constexpr AEVec2 Mtx33MultVec(const AEMtx33& mtx, const AEVec2& v)
+{
+	return AEVec2{ mtx.m[0][0] * v.x + mtx.m[0][1] * v.y + mtx.m[0][2],
+				   mtx.m[1][0] * v.x + mtx.m[1][1] * v.y + mtx.m[1][2] };
+}
+
+// ---------------------------------------------------------------------------
+
+#endif // CSD1130_MATH_2D_H_
@@ -0,0 +1,119 @@
+/******************************************************************************/
+/*!
+\file		Metrics.h
+\brief		This file contains the declaration of the metrics of the simulation
+			and of the server, and of the HTTP endpoint that exports them:
+			MetricsAdd();
+			MetricsSet();
+			MetricsObserveTick();
+			MetricsSetClients();
+			MetricsWrite();
+			MetricsServe();
+			MetricsStop();
+
+			The counters are sharded per thread: a thread only writes the
+			shard it owns, in a block of cache lines of its own, and the
+			scrape adds the shards up. A gauge has a cache line to itself. No
+			update takes a lock or a locked instruction, the tick pays a few
+			plain stores. The endpoint answers "GET /metrics" in the text
+			format of Prometheus on the loopback interface.
+ */
+/******************************************************************************/
+
+#ifndef CSD1130_METRICS_H_
+#define CSD1130_METRICS_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// ---------------------------------------------------------------------------
+// settings
+
+const uint16_t		METRICS_DEFAULT_PORT		= 9100;		// port of the endpoint
+const unsigned int	METRICS_TICK_BUCKET_NUM		= 10;		// upper bounds of the tick time histogram, +Inf apart
+const double		METRICS_TICK_BUCKETS[METRICS_TICK_BUCKET_NUM] =
+{
+	0.00025, 0.0005, 0.001, 0.002, 0.004, 0.008, 0.0167, 0.0333, 0.0667, 0.25		// seconds
+};
+
+// ---------------------------------------------------------------------------
+
+// monotonic counters, exported as asteroids_<name>_total
+enum METRIC_COUNTER
+{
+	METRIC_PACKETS_IN = 0,		// datagrams received by the server
+	METRIC_PACKETS_OUT,			// datagrams sent by the server
+	METRIC_BYTES_IN,
+	METRIC_BYTES_OUT,
+	METRIC_CLIENTS_JOINED,
+	METRIC_CLIENTS_LEFT,
+	METRIC_CLIENTS_REJECTED,
+	METRIC_SNAPSHOTS,			// snapshot rounds sent
+	METRIC_RECV_CALLS,			// system calls of the transport, the datagrams per call are the batch sizes
+	METRIC_SEND_CALLS,
+	METRIC_SEND_DROPPED,		// datagrams the system refused to send
+	METRIC_SHARD_DROPPED,		// commands a socket shard found no room for in its queue
+	METRIC_SEND_SEGMENTED,		// datagrams sent in segmented messages, part of the packets out
+	METRIC_MESSAGES_SENT,		// reliable messages written into snapshots, the resends included
+	METRIC_MESSAGES_RESENT,
+	METRIC_MESSAGES_REFUSED,	// reliable messages a session had no room for
+
+	METRIC_COUNTER_NUM
+};
+
+// last values, exported as asteroids_<name>
+enum METRIC_GAUGE
+{
+	METRIC_CLIENTS = 0,			// sessions of the server
+	METRIC_SHIPS,				// active instances per type, after the last tick
+	METRIC_ASTEROIDS,
+	METRIC_BULLETS,
+	METRIC_RECV_BATCH_MAX,		// largest batch of the transport so far
+	METRIC_SEND_BATCH_MAX,
+	METRIC_PACKET_BUFFERS,		// buffers allocated by the packet pool, flat in the steady state
+	METRIC_PACKETS_IN_USE,		// packet buffers held by a queue or a writer
+	METRIC_SNAPSHOT_RATE,		// snapshots per second a session got over the last period, the mean of the sessions
+
+	METRIC_GAUGE_NUM
+};
+
+// what the server measured of one session, exported with a player label
+struct MetricsClient
+{
+	uint32_t		player;
+	float			rttMs;			// smoothed round trip time, 0 before the first sample
+	float			loss;			// fraction of the inputs lost over the last period
+	float			snapshotRate;	// snapshot rounds per second it got over the last period
+	float			snapshotLoss;	// smoothed fraction of the snapshots lost, from their acknowledgements
+	float			bandwidth;		// bytes per second delivered, from the acknowledgements
+	float			budget;			// bytes of a snapshot at most
+};
+
+// ---------------------------------------------------------------------------
+// Function prototypes
+
+// add value to a counter, in the shard of the calling thread
+void		MetricsAdd(METRIC_COUNTER counter, uint64_t value = 1);
+
+// set a gauge
+void		MetricsSet(METRIC_GAUGE gauge, double value);
+
+// count one tick of the given length in the tick time histogram
+void		MetricsObserveTick(double seconds);
+
+// replace the per session table, copied: the caller publishes it now and then, not every tick
+void		MetricsSetClients(const MetricsClient * pClients, size_t count);
+
+// append every metric to out in the Prometheus text format
+void		MetricsWrite(std::string& out);
+
+// start the HTTP endpoint on 127.0.0.1:port in a thread of its own, returns false if the port cannot be bound
+bool		MetricsServe(uint16_t port = METRICS_DEFAULT_PORT);
+
+// stop the endpoint, the metrics keep counting
+void		MetricsStop();
+
+// ---------------------------------------------------------------------------
+
+#endif // CSD1130_METRICS_H_
@@ -0,0 +1,125 @@
+/******************************************************************************/
+/*!
+\file		NetChannel.h
+\brief		This file contains the declaration of the reliable ordered message
+			channel carried by the numbered packets of NetProtocol.h:
+			NetChannelQueue();
+			NetChannelWrite();
+			NetChannelAck();
+			NetChannelReceivePacket();
+			NetChannelRead();
+
+			The sender numbers its messages and writes the ones not
+			acknowledged yet into the packets it sends anyway, in front of
+			their unreliable payload. It remembers which messages went in
+			which packet. The receiver acknowledges the last packet it got
+			and the 32 before it in a bitfield, a message is done once a
+			packet that held it is acknowledged, and only the messages of the
+			packets lost are sent again. The receiver hands the messages out
+			in order and keeps the ones that come early, a lost message only
+			holds back the messages behind it, never the payloads.
+
+			A message section is a u8 count, then per message u16 id, u8
+			type, u8 size and size bytes. The channel is for small messages
+			that must all arrive, state where only the latest counts, like
+			the leaderboard deltas, goes in packets of its own.
+ */
+/******************************************************************************/
+
+#ifndef CSD1130_NET_CHANNEL_H_
+#define CSD1130_NET_CHANNEL_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// settings
+
+const unsigned int	NET_CHANNEL_QUEUE			= 128;		// messages a sender keeps until they are acknowledged, a power of 2
+const unsigned int	NET_CHANNEL_WINDOW			= 64;		// messages sent past the oldest not acknowledged, what a receiver keeps early
+const unsigned int	NET_CHANNEL_PACKETS			= 64;		// packets a sender remembers the messages of, a power of 2 over 33
+const unsigned int	NET_CHANNEL_PACKET_MESSAGES	= 16;		// messages in one packet at most
+const size_t		NET_MESSAGE_PAYLOAD_MAX		= 12;		// bytes of one message
+const size_t		NET_MESSAGE_HEADER_SIZE		= 4;		// u16 id, u8 type, u8 size
+
+// ---------------------------------------------------------------------------
+
+// one message of the channel
+struct NetMessage
+{
+	uint16_t			id;
+	uint8_t				type;
+	uint8_t				size;
+	uint8_t				payload[NET_MESSAGE_PAYLOAD_MAX];
+};
+
+// what a sender did since it was created
+struct NetChannelSenderStats
+{
+	uint64_t			queued;
+	uint64_t			sent;				// messages written into a packet, the resends included
+	uint64_t			resent;
+	uint64_t			acked;
+	uint64_t			refused;			// queued with the queue full
+};
+
+// the sending side of a channel
+struct NetChannelSender
+{
+	NetMessage			messages[NET_CHANNEL_QUEUE];	// by id
+	double				sentAt[NET_CHANNEL_QUEUE];		// last time a message was written, negative before the first
+	bool				acked[NET_CHANNEL_QUEUE];
+	uint16_t			oldest;							// oldest message not acknowledged, the next if none
+	uint16_t			next;							// id of the next message queued
+
+	uint32_t			packetSequence[NET_CHANNEL_PACKETS];	// packets that held messages, by sequence
+	uint8_t				packetCount[NET_CHANNEL_PACKETS];		// 0 for a slot with no packet
+	uint16_t			packetIds[NET_CHANNEL_PACKETS][NET_CHANNEL_PACKET_MESSAGES];
+
+	NetChannelSenderStats	stats;
+};
+
+// the receiving side of a channel
+struct NetChannelReceiver
+{
+	bool				anyPacket;			// lastSequence is valid
+	uint32_t			lastSequence;		// last packet received
+	uint32_t			ackBits;			// bit i: packet lastSequence - 1 - i received
+	uint16_t			expected;			// id of the next message handed out
+	NetMessage			early[NET_CHANNEL_WINDOW];		// came before expected, by id
+	bool				present[NET_CHANNEL_WINDOW];
+
+	uint64_t			delivered;
+	uint64_t			duplicates;			// messages received again, the resends of a lost ack
+	uint64_t			heldBack;			// messages kept until the ones before them came
+};
+
+// ---------------------------------------------------------------------------
+// Function prototypes
+
+// reset a sender or a receiver
+void		NetChannelInit(NetChannelSender& sender);
+void		NetChannelInit(NetChannelReceiver& receiver);
+
+// queue a message of size bytes (at most NET_MESSAGE_PAYLOAD_MAX), returns false with the queue full
+bool		NetChannelQueue(NetChannelSender& sender, uint8_t type, const void * pPayload, size_t size);
+
+// append the message section of the packet with that sequence: the messages never sent or not acknowledged for
+// resendAfter seconds, oldest first, in budget bytes and the window. Returns the messages written
+unsigned int	NetChannelWrite(NetChannelSender& sender, uint32_t sequence, double now, double resendAfter, size_t budget,
+							std::vector<uint8_t>& packet);
+
+// the receiver got packet ack and the ones of bits before it
+void		NetChannelAck(NetChannelSender& sender, uint32_t ack, uint32_t bits);
+
+// count a packet received, for the acknowledgement of the next packet sent back
+void		NetChannelReceivePacket(NetChannelReceiver& receiver, uint32_t sequence);
+
+// read a message section, append the messages that are now in order to delivered. Returns false on a section cut short
+bool		NetChannelRead(NetChannelReceiver& receiver, const uint8_t *& pCursor, const uint8_t * pEnd,
+						   std::vector<NetMessage>& delivered);
+
+// ---------------------------------------------------------------------------
+
+#endif // CSD1130_NET_CHANNEL_H_
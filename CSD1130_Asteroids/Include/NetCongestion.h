@@ -0,0 +1,103 @@
+/******************************************************************************/
+/*!
+\file		NetCongestion.h
+\brief		This file contains the declaration of the congestion control of one
+			session, what picks its snapshot rate and the size of its packets:
+			NetCongestionInit();
+			NetCongestionSent();
+			NetCongestionAck();
+			NetCongestionUpdate();
+
+			The sender remembers the send time and the size of the numbered
+			packets. The acknowledgements of NetChannel.h tell which of them
+			came through: the bytes acknowledged over the time between the
+			acknowledgements are the delivery rate, the packets the last one
+			skipped over without their bit are lost, and the echo of the last
+			packet is a round trip sample. Over each period the controller
+			keeps a target rate in bytes per second: a clean period probes
+			above it, a period with loss or a round trip grown by queueing
+			falls below what was delivered. The target then picks the fastest
+			snapshot rate of NET_CONGESTION_DIVISORS full snapshots fit in,
+			and below the slowest, smaller packets. A rate is only raised after
+			a hold that doubles each time the link had to step down, so a link
+			at its limit does not swing between two rates.
+ */
+/******************************************************************************/
+
+#ifndef CSD1130_NET_CONGESTION_H_
+#define CSD1130_NET_CONGESTION_H_
+
+#include <cstddef>
+#include <cstdint>
+
+// ---------------------------------------------------------------------------
+// settings
+
+const unsigned int	NET_CONGESTION_HISTORY		= 256;		// packets remembered, a power of 2
+const unsigned int	NET_CONGESTION_LEVELS		= 3;
+const unsigned int	NET_CONGESTION_DIVISORS[NET_CONGESTION_LEVELS] =
+{
+	3, 2, 1		// of the round rate, slowest first: 20, 30 and 60 Hz at 60 rounds per second
+};
+const double		NET_CONGESTION_PERIOD		= 0.5;		// seconds of one estimate at least
+const double		NET_CONGESTION_PERIOD_MAX	= 2.0;		// seconds of one estimate at most, a period without ack is a blackout
+const unsigned int	NET_CONGESTION_SAMPLES		= 20;		// packets an estimate wants before NET_CONGESTION_PERIOD_MAX
+const float			NET_CONGESTION_LOSS_HIGH	= 0.08f;	// smoothed loss that steps down
+const float			NET_CONGESTION_LOSS_LOW		= 0.03f;	// smoothed loss under which the target probes up
+const float			NET_CONGESTION_DELAY_MS		= 30.0f;	// round trip over the lowest seen, plus a quarter of it, that steps down
+const float			NET_CONGESTION_PROBE		= 1.25f;	// target growth of a clean period
+const float			NET_CONGESTION_BACKOFF		= 0.8f;		// part of the delivery rate kept after a congested period
+const double		NET_CONGESTION_HOLD			= 2.0;		// seconds clean before a rate goes up, doubled per step down
+const double		NET_CONGESTION_HOLD_MAX		= 16.0;
+const size_t		NET_CONGESTION_BUDGET_MIN	= 256;		// bytes of a packet at least, the header and the messages fit
+
+// ---------------------------------------------------------------------------
+
+// the controller of one session
+struct NetCongestion
+{
+	uint32_t			sequence[NET_CONGESTION_HISTORY];	// packet in the slot
+	double				sentAt[NET_CONGESTION_HISTORY];		// negative for a slot never used
+	uint16_t			bytes[NET_CONGESTION_HISTORY];
+	bool				done[NET_CONGESTION_HISTORY];		// acknowledged or counted lost
+	bool				anyAck;
+	uint32_t			lastAck;			// last packet echoed
+
+	double				periodStart;
+	double				firstAckAt;			// first and last acknowledgement of the period, negative before
+	double				lastAckAt;
+	uint32_t			periodAcked;		// packets of the period acknowledged, lost
+	uint32_t			periodLost;
+	uint64_t			periodBytes;		// bytes acknowledged after the first acknowledgement of the period
+
+	float				rttMs;				// smoothed round trip time, 0 before the first sample
+	float				minRttMs;			// lowest sample, 0 before the first
+	float				loss;				// smoothed fraction of the packets lost
+	float				bandwidth;			// bytes per second delivered over the last period
+	float				target;				// bytes per second the session is allowed
+	unsigned int		level;				// index in NET_CONGESTION_DIVISORS
+	size_t				budget;				// bytes of a packet at most
+	double				hold;				// seconds clean before the next step up
+	double				cleanSince;			// start of the clean streak, negative while congested
+};
+
+// ---------------------------------------------------------------------------
+// Function prototypes
+
+// start at the slowest rate with full packets of packetBytes
+void		NetCongestionInit(NetCongestion& congestion, size_t packetBytes, double now);
+
+// packet sequence of bytes was sent at time now
+void		NetCongestionSent(NetCongestion& congestion, uint32_t sequence, size_t bytes, double now);
+
+// the receiver got packet ack and the ones of bits before it, and held ack heldMs before it answered
+void		NetCongestionAck(NetCongestion& congestion, uint32_t ack, uint32_t bits, float heldMs, double now);
+
+// close the period if it is over and set the level and the budget from it. roundRate rounds per second of parts
+// packets of packetBytes each are the fastest rate. returns true when the level changed
+bool		NetCongestionUpdate(NetCongestion& congestion, double now, unsigned int roundRate, unsigned int parts,
+								size_t packetBytes);
+
+// ---------------------------------------------------------------------------
+
+#endif // CSD1130_NET_CONGESTION_H_
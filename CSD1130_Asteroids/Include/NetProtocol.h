@@ -0,0 +1,179 @@
+/******************************************************************************/
+/*!
+\file		NetProtocol.h
+\brief		This file contains the UDP protocol between the headless server and
+			its clients, and the header only functions to write and read it.
+
+			Every packet starts with NET_PROTOCOL_ID and a NET_PACKET type. A
+			client sends CONNECT with a random nonce until the server answers
+			ACCEPT (with the player id of the session) or REJECT. It then
+			streams INPUT packets, numbered so the server can acknowledge them,
+			and receives numbered SNAPSHOT packets at the snapshot rate of the
+			server. A snapshot holds the number of the last input the tick
+			applied and a slice of the asteroids in the AsteroidData format of
+			ToNetworkData(). The leaderboard comes in LEADERBOARD deltas from
+			the version the client acknowledges in its inputs, see
+			Scoreboard.h. An input also echoes the last snapshot the client
+			received and how long it held it, the server measures the round
+			trip time from it.
+
+			The snapshots also carry the reliable ordered channel of
+			NetChannel.h: the events of the match (GAME_EVENT) come as
+			messages between the header and the asteroids, and the inputs
+			acknowledge the last snapshot and the 32 before it. A lost event
+			is sent again in a later snapshot, the asteroids never are.
+
+			The asteroids of a snapshot are written with the SNAPSHOT_CODEC
+			of SnapshotCodec.h the ACCEPT names: raw they are the AsteroidData
+			format, coded they are one range coded stream of the count
+			asteroids that ends with the packet.
+
+			Every field is in network byte order, like the AsteroidData ones.
+ */
+/******************************************************************************/
+
+#ifndef CSD1130_NET_PROTOCOL_H_
+#define CSD1130_NET_PROTOCOL_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "AsteroidData.h"
+
+// ---------------------------------------------------------------------------
+// packet format
+
+const uint32_t		NET_PROTOCOL_ID				= 0x4E545341;	// "ASTN", first bytes of every packet
+const uint8_t		NET_PROTOCOL_VERSION		= 5;
+const size_t		NET_HEADER_SIZE				= 5;			// u32 protocol id, u8 packet type
+const size_t		NET_PACKET_MAX				= 1200;			// largest packet, stays under the usual MTU
+const uint16_t		NET_DEFAULT_PORT			= 7777;
+
+// type of a packet, the byte after the protocol id
+enum NET_PACKET
+{
+	NET_PACKET_CONNECT = 1,		// client: u8 version, u32 nonce
+	NET_PACKET_ACCEPT,			// server: u32 nonce, u32 player, u16 tick rate, u16 snapshot rate at most, u8 SNAPSHOT_CODEC
+	NET_PACKET_REJECT,			// server: u32 nonce, u8 NET_REJECT reason
+	NET_PACKET_INPUT,			// client: u32 player, u32 input sequence, u8 INPUT_ buttons, u32 leaderboard version held,
+								//         u32 last snapshot received, u32 bits of the 32 snapshots before it received,
+								//         u16 milliseconds since the last arrived (NET_INPUT_NO_SNAPSHOT before the first)
+	NET_PACKET_SNAPSHOT,		// server: u32 snapshot sequence, u32 tick, u32 last input applied, u16 count, message section of
+								//         NetChannel.h, then count asteroids in the codec of the ACCEPT to the end
+	NET_PACKET_DISCONNECT,		// client: u32 player
+	NET_PACKET_LEADERBOARD,		// server: ScoreboardWriteDelta() body, sent with the snapshots until the client holds the latest version
+};
+
+// why a connection was refused
+enum NET_REJECT
+{
+	NET_REJECT_FULL = 1,		// the server has no room for another player
+	NET_REJECT_VERSION,			// the client speaks another version of the protocol
+};
+
+const size_t		NET_SNAPSHOT_SEQUENCE_AT	= NET_HEADER_SIZE;		// offset of the snapshot sequence
+const size_t		NET_SNAPSHOT_ACK_AT			= NET_HEADER_SIZE + 8;	// offset of the last input applied
+const size_t		NET_SNAPSHOT_COUNT_AT		= NET_HEADER_SIZE + 12;	// offset of the asteroid count
+const size_t		NET_SNAPSHOT_HEADER_SIZE	= NET_HEADER_SIZE + 14;	// header, sequence, tick, input ack, count
+const size_t		NET_SNAPSHOT_MESSAGE_BUDGET	= 161;					// bytes of the message section at most, 10 events
+const uint16_t		NET_INPUT_NO_SNAPSHOT		= 0xFFFF;				// hold time of an input sent before any snapshot
+const uint16_t		NET_SNAPSHOT_ASTEROID_MAX	= (uint16_t)((NET_PACKET_MAX - NET_SNAPSHOT_HEADER_SIZE - NET_SNAPSHOT_MESSAGE_BUDGET) / DATA_SIZE);
+const size_t		NET_EVENT_SIZE				= 8;					// payload of a GAME_EVENT message: u32 id, i32 value
+
+// ---------------------------------------------------------------------------
+// writing, appends to the packet
+
+inline void NetPutU8(std::vector<uint8_t>& packet, uint8_t value)
+{
+	packet.push_back(value);
+}
+
+inline void NetPutU16(std::vector<uint8_t>& packet, uint16_t value)
+{
+	packet.push_back((uint8_t)(value >> 8));
+	packet.push_back((uint8_t)value);
+}
+
+inline void NetPutU32(std::vector<uint8_t>& packet, uint32_t value)
+{
+	packet.push_back((uint8_t)(value >> 24));
+	packet.push_back((uint8_t)(value >> 16));
+	packet.push_back((uint8_t)(value >> 8));
+	packet.push_back((uint8_t)value);
+}
+
+// overwrite 2 bytes written before
+inline void NetSetU16(std::vector<uint8_t>& packet, size_t offset, uint16_t value)
+{
+	packet[offset]		= (uint8_t)(value >> 8);
+	packet[offset + 1]	= (uint8_t)value;
+}
+
+// overwrite 4 bytes written before, for the fields that differ between the copies of a packet
+inline void NetSetU32(std::vector<uint8_t>& packet, size_t offset, uint32_t value)
+{
+	packet[offset]		= (uint8_t)(value >> 24);
+	packet[offset + 1]	= (uint8_t)(value >> 16);
+	packet[offset + 2]	= (uint8_t)(value >> 8);
+	packet[offset + 3]	= (uint8_t)value;
+}
+
+// start a packet of the given type
+inline void NetPutHeader(std::vector<uint8_t>& packet, NET_PACKET type)
+{
+	packet.clear();
+	NetPutU32(packet, NET_PROTOCOL_ID);
+	NetPutU8(packet, (uint8_t)type);
+}
+
+// ---------------------------------------------------------------------------
+// reading, pCursor is set to 0 when going past pEnd and every later read gives 0
+
+inline uint8_t NetGetU8(const uint8_t *& pCursor, const uint8_t * pEnd)
+{
+	if (pCursor == 0 || pEnd - pCursor < 1)
+	{
+		pCursor = 0;
+		return 0;
+	}
+	return *pCursor++;
+}
+
+inline uint16_t NetGetU16(const uint8_t *& pCursor, const uint8_t * pEnd)
+{
+	if (pCursor == 0 || pEnd - pCursor < 2)
+	{
+		pCursor = 0;
+		return 0;
+	}
+	uint16_t value = (uint16_t)((pCursor[0] << 8) | pCursor[1]);
+	pCursor += 2;
+	return value;
+}
+
+inline uint32_t NetGetU32(const uint8_t *& pCursor, const uint8_t * pEnd)
+{
+	if (pCursor == 0 || pEnd - pCursor < 4)
+	{
+		pCursor = 0;
+		return 0;
+	}
+	uint32_t value = ((uint32_t)pCursor[0] << 24) | ((uint32_t)pCursor[1] << 16) | ((uint32_t)pCursor[2] << 8) | pCursor[3];
+	pCursor += 4;
+	return value;
+}
+
+// check the protocol id and read the type, returns 0 if the packet is not one of ours
+inline uint8_t NetGetHeader(const uint8_t *& pCursor, const uint8_t * pEnd)
+{
+	if (NetGetU32(pCursor, pEnd) != NET_PROTOCOL_ID)
+		return 0;
+	uint8_t type = NetGetU8(pCursor, pEnd);
+	return pCursor ? type : 0;
+}
+
+// ---------------------------------------------------------------------------
+
+#endif // CSD1130_NET_PROTOCOL_H_
@@ -0,0 +1,100 @@
+/******************************************************************************/
+/*!
+\file		NetSim.h
+\brief		This file contains the declaration of the network condition
+			simulator, a delay line for the datagrams of one direction:
+			NetSimCreate();
+			NetSimDestroy();
+			NetSimPush();
+			NetSimPop();
+			NetSimNextDue();
+			NetSimGetStats();
+			NetSimNow();
+			NetSimParse();
+
+			A datagram pushed into the line is lost, or copied into a buffer
+			of PacketPool.h and given a time to come out: the latency, plus or
+			minus the jitter. The datagrams keep their order unless one is
+			picked to be reordered, it then comes out after the ones pushed
+			behind it. One may also come out twice. Every draw comes from a
+			generator seeded by the caller: the same datagrams pushed at the
+			same times come out the same way. The transport puts a line on
+			each side of its socket with TransportSetConditions().
+ */
+/******************************************************************************/
+
+#ifndef CSD1130_NET_SIM_H_
+#define CSD1130_NET_SIM_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "Socket.h"
+#include "PacketPool.h"
+
+// ---------------------------------------------------------------------------
+// settings
+
+const float			NETSIM_REORDER_MS			= 20.0f;	// extra delay of a reordered datagram, over the jitter
+
+// ---------------------------------------------------------------------------
+
+// what the line does to the datagrams of its direction
+struct NetSimConditions
+{
+	float				latencyMs;			// one way, half of the round trip when both directions have it
+	float				jitterMs;			// the delay is latency +- jitter, uniform
+	float				loss;				// fraction of the datagrams dropped
+	float				duplicate;			// fraction sent twice, the copy delayed on its own
+	float				reorder;			// fraction held NETSIM_REORDER_MS + jitter longer than the ones behind
+};
+
+// a datagram that came out of the line, the packet belongs to the line until the next NetSimPop()
+struct NetSimDatagram
+{
+	PacketBuffer *		pPacket;
+	SocketAddress		address;			// where it goes, or where it came from
+};
+
+// what the line did since it was created
+struct NetSimStats
+{
+	uint64_t			pushed;
+	uint64_t			lost;
+	uint64_t			duplicated;
+	uint64_t			reordered;
+	uint64_t			delivered;
+};
+
+struct NetSim;
+
+// ---------------------------------------------------------------------------
+// Function prototypes
+
+// a line with the conditions, its generator seeded with seed
+NetSim *			NetSimCreate(const NetSimConditions& conditions, uint32_t seed);
+
+// drop the line and the datagrams in it
+void				NetSimDestroy(NetSim * pSim);
+
+// put head then body into the line at time now, a datagram longer than PACKET_BUFFER_SIZE is lost
+void				NetSimPush(NetSim * pSim, const void * pHead, size_t headSize, const void * pBody, size_t bodySize,
+							   const SocketAddress& address, double now);
+
+// take the datagrams due at time now, in the order they come out. returns how many, pDatagrams points to them
+unsigned int		NetSimPop(NetSim * pSim, double now, const NetSimDatagram *& pDatagrams);
+
+// time the next datagram is due, a negative time if the line is empty
+double				NetSimNextDue(const NetSim * pSim);
+
+const NetSimStats&	NetSimGetStats(const NetSim * pSim);
+
+// seconds on the steady clock, the times of the lines
+double				NetSimNow();
+
+// "latency:75,jitter:10,loss:0.05,dup:0.01,reorder:0.02", any of them, the others 0. returns false on a bad item
+bool				NetSimParse(const char * text, NetSimConditions& conditions);
+
+// ---------------------------------------------------------------------------
+
+#endif // CSD1130_NET_SIM_H_
@@ -0,0 +1,41 @@
+/******************************************************************************/
+/*!
+\file		Options.h
+\brief		This file contains the header only parser of the "key=value"
+			options taken by the headless tools (benchmark suite, server, load
+			generator), separated by spaces.
+ */
+/******************************************************************************/
+
+#ifndef CSD1130_OPTIONS_H_
+#define CSD1130_OPTIONS_H_
+
+#include <string>
+
+// ---------------------------------------------------------------------------
+
+// read the next option of args into key and value (empty without '='), returns false once there is none left
+inline bool OptionNext(const char *& pCursor, std::string& key, std::string& value)
+{
+	if (pCursor == 0)
+		return false;
+
+	while (*pCursor == ' ' || *pCursor == '\t')
+		++pCursor;
+	if (*pCursor == 0)
+		return false;
+
+	const char * pStart = pCursor;
+	while (*pCursor && *pCursor != ' ' && *pCursor != '\t')
+		++pCursor;
+
+	std::string option(pStart, pCursor);
+	size_t equal = option.find('=');
+	key		= option.substr(0, equal);
+	value	= equal == std::string::npos ? "" : option.substr(equal + 1);
+	return true;
+}
+
+// ---------------------------------------------------------------------------
+
+#endif // CSD1130_OPTIONS_H_
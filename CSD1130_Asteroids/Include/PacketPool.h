@@ -0,0 +1,71 @@
+/******************************************************************************/
+/*!
+\file		PacketPool.h
+\brief		This file contains the declaration of the pool of packet buffers:
+			PacketAcquire();
+			PacketRetain();
+			PacketRelease();
+			PacketPoolGetStats();
+
+			A packet buffer holds one encoded datagram, or the part of one
+			that many datagrams share, and counts its references. A snapshot
+			slice is written once into a buffer, every send queue that holds
+			it takes a reference and the last release gives it back to the
+			pool. The buffers are allocated by slabs and never freed: once
+			the pool has grown to what the server needs, acquiring and
+			releasing never touch the heap. Every thread keeps a cache of free
+			buffers, it only locks the shared list to move half a cache.
+ */
+/******************************************************************************/
+
+#ifndef CSD1130_PACKET_POOL_H_
+#define CSD1130_PACKET_POOL_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// ---------------------------------------------------------------------------
+// settings
+
+const size_t		PACKET_BUFFER_SIZE			= 1500;		// bytes of a buffer, the largest datagram
+const unsigned int	PACKET_SLAB_BUFFERS			= 256;		// buffers allocated at once when the pool is empty
+const unsigned int	PACKET_CACHE_BUFFERS		= 64;		// free buffers a thread keeps, an even number
+
+// ---------------------------------------------------------------------------
+
+// one buffer of the pool. size is what the writer put in data, the pool does not look at it
+struct PacketBuffer
+{
+	std::atomic<uint32_t>	refs;
+	uint32_t				size;
+	PacketBuffer *			pNext;			// in a free list, the pool only
+	uint8_t					data[PACKET_BUFFER_SIZE];
+};
+
+// what the pool did since the process started
+struct PacketPoolStats
+{
+	uint64_t			slabs;				// slabs allocated, flat once the pool is warm
+	uint64_t			buffers;			// buffers of those slabs
+	uint64_t			acquired;			// PacketAcquire() calls
+	uint64_t			inUse;				// buffers acquired and not released yet, the thread caches apart
+};
+
+// ---------------------------------------------------------------------------
+// Function prototypes
+
+// a buffer with one reference and a size of 0, from the cache of the calling thread. Never 0
+PacketBuffer *		PacketAcquire();
+
+// one more reference, for another holder of the buffer
+void				PacketRetain(PacketBuffer * pPacket);
+
+// drop a reference, the last one gives the buffer back to the pool. Any thread may release
+void				PacketRelease(PacketBuffer * pPacket);
+
+PacketPoolStats		PacketPoolGetStats();
+
+// ---------------------------------------------------------------------------
+
+#endif // CSD1130_PACKET_POOL_H_
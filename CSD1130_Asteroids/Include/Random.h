@@ -0,0 +1,57 @@
+/******************************************************************************/
+/*!
+\file		Random.h
+\brief		This file contains the seeded random number generator of the
+			simulation (PCG32). Unlike rand() its state is owned by the caller, so
+			a match started with the same seed draws the same numbers on every
+			platform:
+			RandomSeed();
+			RandomNext();
+			RandomFloat01();
+ */
+/******************************************************************************/
+
+#ifndef CSD1130_RANDOM_H_
+#define CSD1130_RANDOM_H_
+
+#include <cstdint>
+
+// ---------------------------------------------------------------------------
+
+// state of a generator
+struct RandomState
+{
+	uint64_t			state;
+};
+
+// ---------------------------------------------------------------------------
+
+// next 32 random bits
+inline uint32_t RandomNext(RandomState& rng)
+{
+	uint64_t old = rng.state;
+	rng.state = old * 6364136223846793005ull + 1442695040888963407ull;
+
+	uint32_t xorShifted	= (uint32_t)(((old >> 18u) ^ old) >> 27u);
+	uint32_t rot		= (uint32_t)(old >> 59u);
+	return (xorShifted >> rot) | (xorShifted << ((32u - rot) & 31u));
+}
+
+// restart the sequence of seed
+inline void RandomSeed(RandomState& rng, uint32_t seed)
+{
+	rng.state = 0;
+	RandomNext(rng);
+	rng.state += seed;
+	RandomNext(rng);
+}
+
+// random float in [0, 1)
+inline float RandomFloat01(RandomState& rng)
+{
+	return (float)(RandomNext(rng) >> 8) * (1.0f / 16777216.0f);
+}
+
+// ---------------------------------------------------------------------------
+
+#endif // CSD1130_RANDOM_H_
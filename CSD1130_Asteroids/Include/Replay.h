@@ -0,0 +1,166 @@
+/******************************************************************************/
+/*!
+\file		Replay.h
+\brief		This file contains the declaration of the match recorder, of the
+			replay reader and of the headless replay runner:
+			ReplayRecordStart();
+			ReplayRecordKeyframeDue();
+			ReplayRecordKeyframe();
+			ReplayRecordTick();
+			ReplayRecordJoin();
+			ReplayRecordLeave();
+			ReplayRecordPopulate();
+			ReplayRecordStop();
+			ReplayOpen();
+			ReplayClose();
+			ReplayBegin();
+			ReplayStep();
+			ReplaySeek();
+			ReplayRun();
+			ReplayPut...(); ReplayGet...();
+
+			A replay file is a header (seed, world size, endless flag) followed by
+			one record per tick (frame time and input commands) and one record per
+			join, leave or populate, in the order the simulation saw them. The simulation draws every
+			random number from the seed and reads every input from the commands,
+			so running the records again gives the same match.
+
+			Every REPLAY_KEYFRAME_TICKS ticks a keyframe record holds the whole
+			world as it was before that tick. The file ends with an index of the
+			keyframes and a fixed size trailer pointing at it. A reader maps the
+			file in memory, finds the keyframe of any tick in O(1), restores it and
+			only re-simulates the ticks since the keyframe.
+
+			The tick only appends the records to a memory buffer. Full buffers are
+			handed to a writer thread that does the file I/O, so recording never
+			blocks the tick on the disk.
+ */
+/******************************************************************************/
+
+#ifndef CSD1130_REPLAY_H_
+#define CSD1130_REPLAY_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "InputCommand.h"
+
+// ---------------------------------------------------------------------------
+// file format
+
+const uint32_t		REPLAY_MAGIC				= 0x50525341;	// "ASRP", first bytes of the file
+const uint32_t		REPLAY_INDEX_MAGIC			= 0x49525341;	// "ASRI", last bytes of the file
+const uint32_t		REPLAY_VERSION				= 6;
+const size_t		REPLAY_HEADER_SIZE			= 28;			// u32 magic, u32 version, u32 seed, f32 world width, f32 world height, u32 keyframe interval, u32 flags
+const uint32_t		REPLAY_FLAG_ENDLESS			= 0x01;			// header flag: no game over and no win, see GameStateAsteroidsSetEndless()
+const size_t		REPLAY_TRAILER_SIZE			= 12;			// u64 offset of the index, u32 index magic
+
+// type of a record, the first byte of every record
+enum REPLAY_RECORD
+{
+	REPLAY_RECORD_TICK = 1,		// f32 dt, u32 command count, then per command: u32 player, u8 buttons
+	REPLAY_RECORD_JOIN,			// u32 player
+	REPLAY_RECORD_LEAVE,		// u32 player
+	REPLAY_RECORD_END,			// u32 tick count, u32 checksum of the world after the last tick
+	REPLAY_RECORD_KEYFRAME,		// u32 tick, u32 size, then the state saved by GameStateAsteroidsSaveKeyframe()
+	REPLAY_RECORD_INDEX,		// u32 keyframe count, then per keyframe: u32 tick, u64 offset of the keyframe record
+	REPLAY_RECORD_POPULATE,		// u32 asteroid count, u32 bullet count, see GameStateAsteroidsPopulate()
+};
+
+// ---------------------------------------------------------------------------
+// settings
+
+const unsigned long	REPLAY_FLUSH_BYTES			= 16 * 1024;	// a buffer is handed to the writer thread once this full
+const unsigned long	REPLAY_FLUSH_TICKS			= 60;			// or after this many ticks, so a crash loses at most a second
+const uint32_t		REPLAY_KEYFRAME_TICKS		= 600;			// ticks between two keyframes, 10 seconds at 60 fps
+
+// ---------------------------------------------------------------------------
+
+// keyframe of the index
+struct ReplayKeyframe
+{
+	uint32_t			tick;		// the keyframe holds the world before this tick
+	uint64_t			offset;		// offset of the keyframe record in the file
+};
+
+// replay file open for reading, and the playback position in it
+struct ReplayFile
+{
+	const uint8_t *		pData;			// the whole file, memory mapped
+	size_t				size;			// size of the file
+	uint32_t			seed;			// header
+	float				worldWidth;		// header
+	float				worldHeight;	// header
+	uint32_t			keyframeTicks;	// header: ticks between two keyframes
+	bool				endless;		// header: the match was endless
+
+	std::vector<ReplayKeyframe>	keyframes;	// index, rebuilt by scanning the records if the file has no trailer
+	bool				ended;			// the file has an end record
+	uint32_t			tickCount;		// end record: ticks recorded (the ticks found if the file is truncated)
+	uint32_t			checksum;		// end record: checksum after the last tick
+
+	const uint8_t *		pCursor;		// next record to play, 0 once the end is reached
+	uint32_t			tick;			// ticks played since the start of the match
+
+	void *				hFile;			// platform handles of the mapping
+	void *				hMapping;
+};
+
+// ---------------------------------------------------------------------------
+// Function prototypes
+
+// open path and write the header, returns false if the file cannot be created
+bool	ReplayRecordStart(const char * path, uint32_t seed, float worldWidth, float worldHeight, bool endless);
+
+// true when a keyframe should be recorded before the next tick
+bool	ReplayRecordKeyframeDue();
+
+// record the state saved by GameStateAsteroidsSaveKeyframe() before the next tick
+void	ReplayRecordKeyframe(const std::vector<uint8_t>& keyframe);
+
+// record the frame time and the input commands of a tick, does nothing if not recording
+void	ReplayRecordTick(float dt, const InputCommand * pCommands, unsigned int commandCount);
+
+// record a player joining or leaving, does nothing if not recording
+void	ReplayRecordJoin(uint32_t player);
+void	ReplayRecordLeave(uint32_t player);
+
+// record a top up of the world by GameStateAsteroidsPopulate(), does nothing if not recording
+void	ReplayRecordPopulate(uint32_t asteroidCount, uint32_t bulletCount);
+
+// write the end record and the keyframe index, wait for the writer thread and close the file
+void	ReplayRecordStop(uint32_t checksum);
+
+// map path in memory and read the header and the index, returns false if it is not a replay file
+bool	ReplayOpen(const char * path, ReplayFile& file);
+
+// unmap the file
+void	ReplayClose(ReplayFile& file);
+
+// set the game state up for the match of the file (world size, seed, endless, load, init) and rewind to tick 0
+void	ReplayBegin(ReplayFile& file);
+
+// play up to tickCount ticks of the file, returns the number of ticks played (less at the end of the file)
+uint32_t	ReplayStep(ReplayFile& file, uint32_t tickCount);
+
+// restore the last keyframe before tick and play the ticks up to it, returns false if tick is past the end
+bool	ReplaySeek(ReplayFile& file, uint32_t tick);
+
+// "<file> [tick]": play the file back headless as fast as possible, seeking to tick first if given, and compare the final checksum.
+// returns the process exit code
+int		ReplayRun(const char * args);
+
+// little endian writing and reading, the reads set pCursor to 0 when going past pEnd
+void		ReplayPutU8(std::vector<uint8_t>& buffer, uint8_t value);
+void		ReplayPutU32(std::vector<uint8_t>& buffer, uint32_t value);
+void		ReplayPutU64(std::vector<uint8_t>& buffer, uint64_t value);
+void		ReplayPutF32(std::vector<uint8_t>& buffer, float value);
+uint8_t		ReplayGetU8(const uint8_t *& pCursor, const uint8_t * pEnd);
+uint32_t	ReplayGetU32(const uint8_t *& pCursor, const uint8_t * pEnd);
+uint64_t	ReplayGetU64(const uint8_t *& pCursor, const uint8_t * pEnd);
+float		ReplayGetF32(const uint8_t *& pCursor, const uint8_t * pEnd);
+
+// ---------------------------------------------------------------------------
+
+#endif // CSD1130_REPLAY_H_
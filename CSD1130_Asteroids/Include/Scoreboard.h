@@ -1,3 +1,102 @@
-#pragma once
+/******************************************************************************/
+/*!
+\file		Scoreboard.h
+\brief		This file contains the declaration of the scoreboard, the score of
+			every player of the match and its leaderboard:
+			ScoreboardInit();
+			ScoreboardFree();
+			ScoreboardJoin();
+			ScoreboardLeave();
+			ScoreboardAdd();
+			ScoreboardSet();
+			ScoreboardFind();
+			ScoreboardPlayerCount();
+			ScoreboardTop();
+			ScoreboardPublish();
+			ScoreboardVersion();
+			ScoreboardWriteDelta();
+			ScoreboardApplyDelta();
 
-#include <map>
\ No newline at end of file
+			The scores live in a flat open addressing table keyed by player id,
+			the best players in a heap of at most the top count entries that is
+			kept up to date by every score event, so the leaderboard never needs
+			a sort of the whole table.
+
+			The leaderboard goes to the clients as deltas: every published
+			leaderboard gets a version, a client acknowledges the version it
+			holds and is sent only the ranks that changed since then. A lost
+			delta is sent again from the same base, so the client always ends
+			up with the latest leaderboard and the traffic only depends on the
+			size of the leaderboard, not on the number of players.
+ */
+/******************************************************************************/
+
+#ifndef CSD1130_SCOREBOARD_H_
+#define CSD1130_SCOREBOARD_H_
+
+#include <cstdint>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// settings
+
+const unsigned int	SCOREBOARD_TOP_COUNT		= 10;		// players on the leaderboard by default
+const unsigned int	SCOREBOARD_CAPACITY_MIN		= 64;		// slots of an empty table, a power of 2
+const unsigned int	SCOREBOARD_HISTORY			= 64;		// published versions kept as bases of the deltas
+const unsigned int	SCOREBOARD_TOP_MAX			= 255;		// longest leaderboard a delta can carry
+
+// ---------------------------------------------------------------------------
+
+// score of one player, one line of the leaderboard
+struct ScoreboardEntry
+{
+	uint32_t			player;
+	int32_t				score;
+};
+
+// ---------------------------------------------------------------------------
+// Function prototypes
+
+// start an empty scoreboard whose leaderboard holds the topCount best players
+void			ScoreboardInit(unsigned int topCount = SCOREBOARD_TOP_COUNT);
+
+// release the table and the leaderboard
+void			ScoreboardFree();
+
+// add a player with a score of 0, nothing happens if it is already there
+void			ScoreboardJoin(uint32_t player);
+
+// remove a player, its place on the leaderboard goes to the best of the others
+void			ScoreboardLeave(uint32_t player);
+
+// score event: add points (negative to take them away) to a player, a player that has not joined is ignored
+void			ScoreboardAdd(uint32_t player, int32_t points);
+
+// replace the score of a player, for a restored match
+void			ScoreboardSet(uint32_t player, int32_t score);
+
+// score of a player, returns false if it has not joined
+bool			ScoreboardFind(uint32_t player, int32_t& score);
+
+// players on the scoreboard
+unsigned int	ScoreboardPlayerCount();
+
+// the leaderboard, best score first, ties go to the lowest player id
+void			ScoreboardTop(std::vector<ScoreboardEntry>& top);
+
+// give the leaderboard a new version if it changed since the last one, returns the latest version (0 before the first)
+uint32_t		ScoreboardPublish();
+uint32_t		ScoreboardVersion();
+
+// append the NET_PACKET_LEADERBOARD body that takes a client from baseVersion to the latest version,
+// the whole leaderboard if baseVersion is 0 or no longer kept
+void			ScoreboardWriteDelta(uint32_t baseVersion, std::vector<uint8_t>& packet);
+
+// client side: apply a NET_PACKET_LEADERBOARD body to the leaderboard held at version,
+// returns false (and changes nothing) if the delta is not based on that version or is broken
+bool			ScoreboardApplyDelta(const uint8_t * pData, const uint8_t * pEnd,
+									 std::vector<ScoreboardEntry>& board, uint32_t& version);
+
+// ---------------------------------------------------------------------------
+
+#endif // CSD1130_SCOREBOARD_H_
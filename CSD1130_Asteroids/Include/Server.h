@@ -0,0 +1,63 @@
+/******************************************************************************/
+/*!
+\file		Server.h
+\brief		This file contains the declaration of the headless UDP server that
+			runs the simulation for remote players:
+			ServerRun();
+
+			The server speaks the protocol of NetProtocol.h on one UDP port. It
+			runs the tick at a fixed rate with the last input of every player
+			and sends snapshot rounds at the snapshot rate. Every player gets
+			the rounds its link affords, at the rate and in the packet size
+			the congestion control of NetCongestion.h picks from its
+			acknowledgements. It measures the round trip time, the input loss,
+			the snapshot loss and the effective snapshot rate of every player
+			for the metrics of Metrics.h. The events of every tick go to every
+			player on the reliable channel of NetChannel.h, in the snapshots.
+			With shards= the port is opened by several sockets of one
+			SO_REUSEPORT group, the ones past the first are drained and
+			decoded by I/O threads of their own. With parts= a round sends
+			several snapshots to every player, back to back: the transport
+			hands them over as one segmented message where it can. With net=
+			the transports simulate latency, jitter, loss, duplication and
+			reordering on the datagrams, see NetSim.h. With codec= the
+			asteroids of the snapshots are range coded, see SnapshotCodec.h.
+ */
+/******************************************************************************/
+
+#ifndef CSD1130_SERVER_H_
+#define CSD1130_SERVER_H_
+
+// ---------------------------------------------------------------------------
+// settings
+
+const unsigned int	SERVER_TICK_RATE			= 60;		// ticks per second
+const unsigned int	SERVER_SNAPSHOT_RATE		= 60;		// snapshot rounds per second, the fastest rate of a player
+const unsigned int	SERVER_CLIENT_MAX			= 4096;		// players at once
+const double		SERVER_CLIENT_TIMEOUT		= 5.0;		// seconds without a packet before a player is dropped
+const unsigned int	SERVER_CATCH_UP_MAX			= 4;		// ticks run back to back before the socket is read again
+const double		SERVER_STATS_PERIOD			= 5.0;		// seconds between two lines of statistics
+const double		SERVER_METRICS_PERIOD		= 1.0;		// seconds between two updates of the per session metrics
+const unsigned int	SERVER_SHARD_MAX			= 64;		// sockets on the port at most
+const unsigned int	SERVER_SHARD_QUEUE			= 8192;		// commands an I/O thread queues for the simulation, a power of 2
+const int			SERVER_SHARD_WAIT_MS		= 50;		// longest wait of an I/O thread, it sees the stop after this
+const unsigned int	SERVER_SNAPSHOT_PARTS_MAX	= 64;		// snapshots per player and round at most, the segments of one message
+const double		SERVER_RESEND_MIN			= 0.1;		// seconds before a reliable message is sent again, 1.5 round trips if longer
+
+// ---------------------------------------------------------------------------
+// Function prototypes
+
+// "[port=7777] [tick=60] [snapshot=20] [max=4096] [asteroids=0] [seconds=0] [log=file] [record=file] [metrics=0] [io=batch] [shards=1]
+// [parts=1] [gso=on] [net=] [netin=] [netout=] [netseed=1] [cc=on] [codec=raw]": serve the simulation headless, seconds=0 runs until
+// SIGINT or SIGTERM, the log goes to the console without log=, record=<file> records the match for -replay, metrics=<port> serves the metrics on
+// http://127.0.0.1:<port>/metrics, io=single|batch|uring|uring-sqpoll picks the TRANSPORT_BACKEND, shards=<n> opens the
+// port n times with SO_REUSEPORT, Linux only, parts=<n> sends n slices of the asteroids to every player per round,
+// gso=off sends them without UDP_SEGMENT. net=latency:75,loss:0.05 simulates the conditions of NetSimParse() both ways,
+// netin= only on what the players send, netout= only on what they receive, drawn from netseed=. cc=off sends every
+// round to every player in full, snapshot=20 cc=off is the fixed rate of old. codec=quantized|adaptive|static picks the
+// SNAPSHOT_CODEC of the asteroids, sent to the players in the ACCEPT. returns the process exit code
+int		ServerRun(const char * args);
+
+// ---------------------------------------------------------------------------
+
+#endif // CSD1130_SERVER_H_
@@ -0,0 +1,95 @@
+/******************************************************************************/
+/*!
+\file		SnapshotCodec.h
+\brief		This file contains the declaration of the codecs of the asteroids of
+			a snapshot:
+			SnapshotEncode();
+			SnapshotDecode();
+			SnapshotCount();
+			SnapshotCodecParse();
+			SnapshotCodecName();
+
+			SNAPSHOT_CODEC_RAW writes every asteroid with WriteNetworkData().
+			The others quantize the fields first: the position, the scale and
+			the velocity to SNAPSHOT_QUANTUM units, the direction to an angle
+			of SNAPSHOT_ANGLE_STEPS steps. The owner, the id, the direction,
+			the score and the time go as the difference with the asteroid in
+			front, they rarely change inside a slice. Every field value is then
+			a bucket, the bit length of its zigzag form, and the bits below the
+			top one. A range coder writes the buckets with the model of the
+			field and the bits as they are: a flat model for
+			SNAPSHOT_CODEC_QUANTIZED, one that adapts to the symbols of the
+			slice for SNAPSHOT_CODEC_ADAPTIVE, and frequencies trained on a
+			recorded match for SNAPSHOT_CODEC_STATIC. Both ends build the same
+			models, a slice decodes on its own.
+ */
+/******************************************************************************/
+
+#ifndef CSD1130_SNAPSHOT_CODEC_H_
+#define CSD1130_SNAPSHOT_CODEC_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "AsteroidData.h"
+
+// ---------------------------------------------------------------------------
+// settings
+
+const float			SNAPSHOT_QUANTUM			= 0.125f;	// units of a quantized position, scale or velocity
+const unsigned int	SNAPSHOT_ANGLE_STEPS		= 4096;		// steps of a quantized direction per turn, a power of 2
+const unsigned int	SNAPSHOT_BUCKET_NUM			= 33;		// bit lengths of a 32 bit value, 0 included
+
+// ---------------------------------------------------------------------------
+
+// how the asteroids of a snapshot are written, sent in the ACCEPT
+enum SNAPSHOT_CODEC
+{
+	SNAPSHOT_CODEC_RAW = 0,		// DATA_SIZE bytes per asteroid
+	SNAPSHOT_CODEC_QUANTIZED,	// quantized, range coded with flat models
+	SNAPSHOT_CODEC_ADAPTIVE,	// quantized, range coded with models that adapt inside the slice
+	SNAPSHOT_CODEC_STATIC,		// quantized, range coded with the trained models
+
+	SNAPSHOT_CODEC_NUM
+};
+
+// the fields of an asteroid, one model each
+enum SNAPSHOT_FIELD
+{
+	SNAPSHOT_FIELD_OWNER = 0,
+	SNAPSHOT_FIELD_ID,
+	SNAPSHOT_FIELD_POSITION_X,
+	SNAPSHOT_FIELD_POSITION_Y,
+	SNAPSHOT_FIELD_SCALE_X,
+	SNAPSHOT_FIELD_SCALE_Y,
+	SNAPSHOT_FIELD_VELOCITY_X,
+	SNAPSHOT_FIELD_VELOCITY_Y,
+	SNAPSHOT_FIELD_DIRECTION,
+	SNAPSHOT_FIELD_SCORE,
+	SNAPSHOT_FIELD_TIME,
+
+	SNAPSHOT_FIELD_NUM
+};
+
+// ---------------------------------------------------------------------------
+// Function prototypes
+
+// write count asteroids into capacity bytes at pOut, returns the bytes written, 0 if they do not fit
+size_t			SnapshotEncode(SNAPSHOT_CODEC codec, const AsteroidData * pAsteroids, size_t count, uint8_t * pOut,
+							   size_t capacity);
+
+// read count asteroids from the size bytes at pData, returns false if they are not count asteroids of the codec
+bool			SnapshotDecode(SNAPSHOT_CODEC codec, const uint8_t * pData, size_t size, size_t count,
+							   AsteroidData * pAsteroids);
+
+// add the buckets of count asteroids to counts, what SNAPSHOT_CODEC_STATIC is trained on
+void			SnapshotCount(const AsteroidData * pAsteroids, size_t count,
+							  uint64_t counts[SNAPSHOT_FIELD_NUM][SNAPSHOT_BUCKET_NUM]);
+
+// "raw", "quantized", "adaptive" or "static", returns false for another name
+bool			SnapshotCodecParse(const char * name, SNAPSHOT_CODEC& codec);
+const char *	SnapshotCodecName(SNAPSHOT_CODEC codec);
+
+// ---------------------------------------------------------------------------
+
+#endif // CSD1130_SNAPSHOT_CODEC_H_
@@ -0,0 +1,98 @@
+/******************************************************************************/
+/*!
+\file		Socket.h
+\brief		This file contains the declaration of the UDP sockets used by the
+			server and by the load generator, and of the few TCP ones of the
+			metrics endpoint, on WinSock and on BSD sockets:
+			SocketStartup();
+			SocketCleanup();
+			SocketReserve();
+			SocketResolve();
+			SocketOpenUdp();
+			SocketClose();
+			SocketLocalPort();
+			SocketSetBufferSize();
+			SocketSendTo();
+			SocketRecvFrom();
+			SocketPoll();
+			SocketListenTcp();
+			SocketAccept();
+			SocketRecv();
+			SocketSend();
+
+			The UDP sockets and the listening ones are non-blocking, a thread
+			waits for packets or connections with SocketPoll(). An accepted
+			connection blocks, up to a timeout.
+ */
+/******************************************************************************/
+
+#ifndef CSD1130_SOCKET_H_
+#define CSD1130_SOCKET_H_
+
+#include <cstddef>
+#include <cstdint>
+
+// ---------------------------------------------------------------------------
+
+// SOCKET on WinSock, file descriptor elsewhere
+typedef intptr_t	SocketHandle;
+
+const SocketHandle	SOCKET_HANDLE_NONE			= -1;
+
+// IPv4 address and port, in host byte order
+struct SocketAddress
+{
+	uint32_t		ip;
+	uint16_t		port;
+};
+
+// ---------------------------------------------------------------------------
+// Function prototypes
+
+// start/stop the socket library, WSAStartup() on Windows, every SocketStartup() needs its SocketCleanup()
+bool	SocketStartup();
+void	SocketCleanup();
+
+// make room for count open sockets (the descriptor limit of the process), returns false if the system refuses
+bool	SocketReserve(unsigned int count);
+
+// "a.b.c.d" or a host name, returns false if it cannot be resolved
+bool	SocketResolve(const char * host, uint16_t port, SocketAddress& address);
+
+// non-blocking UDP socket bound to port on every interface, 0 for any free port, SOCKET_HANDLE_NONE on failure.
+// shared joins the SO_REUSEPORT group of the port, the system spreads the senders over its sockets. Not on Windows
+SocketHandle	SocketOpenUdp(uint16_t port, bool shared = false);
+void			SocketClose(SocketHandle socket);
+
+// port the socket is bound to
+uint16_t	SocketLocalPort(SocketHandle socket);
+
+// ask for receive and send buffers of bytes each, the system may cap them. returns false if it refuses
+bool		SocketSetBufferSize(SocketHandle socket, int bytes);
+
+// send one datagram, returns false if it was not sent (full buffer, unreachable)
+bool	SocketSendTo(SocketHandle socket, const void * pData, size_t size, const SocketAddress& to);
+
+// receive one datagram, returns its size, 0 if none is waiting, -1 on error
+int		SocketRecvFrom(SocketHandle socket, void * pBuffer, size_t size, SocketAddress& from);
+
+// wait up to timeoutMs for one of the count sockets to have a datagram, pReadable[i] is set to 1 for those that do.
+// returns the number of readable sockets
+int		SocketPoll(const SocketHandle * pSockets, unsigned int count, uint8_t * pReadable, int timeoutMs);
+
+// non-blocking TCP socket listening on port, of 127.0.0.1 only if loopback, SOCKET_HANDLE_NONE on failure
+SocketHandle	SocketListenTcp(uint16_t port, bool loopback);
+
+// take a waiting connection, SOCKET_HANDLE_NONE if there is none. A receive or a send on it
+// that waits longer than timeoutMs fails
+SocketHandle	SocketAccept(SocketHandle listener, int timeoutMs);
+
+// receive from a connection, returns the bytes received, 0 once the peer closed it, -1 on error or timeout
+int		SocketRecv(SocketHandle socket, void * pBuffer, size_t size);
+
+// send everything to a connection, returns false on error or timeout
+bool	SocketSend(SocketHandle socket, const void * pData, size_t size);
+
+// ---------------------------------------------------------------------------
+
+#endif // CSD1130_SOCKET_H_
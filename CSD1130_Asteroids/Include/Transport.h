@@ -0,0 +1,166 @@
+/******************************************************************************/
+/*!
+\file		Transport.h
+\brief		This file contains the declaration of the datagram transport of
+			the server, the layer between its loop and the UDP socket:
+			TransportOpen();
+			TransportClose();
+			TransportSocket();
+			TransportBackend();
+			TransportSetSegmentation();
+			TransportSetConditions();
+			TransportGetConditionStats();
+			TransportWait();
+			TransportReceive();
+			TransportQueue();
+			TransportQueuePacket();
+			TransportFlush();
+			TransportGetStats();
+			TransportParseBackend();
+			TransportBackendName();
+
+			The loop waits with TransportWait(), receives what is waiting in
+			one call and queues what it sends during a tick, the transport
+			sends the queue at once on TransportFlush(). The single backend
+			makes one system call per datagram. The batch backend drains the
+			socket with recvmmsg() into buffers set up once and sends the
+			whole queue with sendmmsg(). The io_uring backends keep a multishot
+			receive armed on the socket, the kernel fills buffers of a
+			provided buffer ring and the loop reads the completions from
+			shared memory. The sends are queued to the same ring: one system
+			call per flush, none with the kernel thread of uring-sqpoll
+			polling the ring. The batch and io_uring backends are Linux only,
+			a backend that cannot be set up opens as the next simpler one.
+
+			Where the kernel has UDP_SEGMENT these two backends also hand a
+			run of datagrams of one size to one address over as a single
+			message. The kernel cuts it into the datagrams again, far down
+			the stack: the run crosses the stack once.
+
+			A body shared by many datagrams can be a buffer of PacketPool.h:
+			the queue holds a reference until the flush is done with it, the
+			caller drops its own as soon as it has queued.
+
+			TransportSetConditions() puts a line of NetSim.h on either side of
+			the socket: what is received goes through one before the caller
+			sees it, what is flushed through the other before the backend
+			sends it. TransportWait() wakes up when a datagram of a line is
+			due, the caller flushes then even with nothing of its own queued.
+ */
+/******************************************************************************/
+
+#ifndef CSD1130_TRANSPORT_H_
+#define CSD1130_TRANSPORT_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "Socket.h"
+#include "PacketPool.h"
+#include "NetSim.h"
+
+// ---------------------------------------------------------------------------
+// settings
+
+const unsigned int	TRANSPORT_RECV_BATCH		= 64;			// datagrams taken by one receive
+const unsigned int	TRANSPORT_SEND_BATCH		= 1024;			// datagrams given to one sendmmsg(), the UIO_MAXIOV of Linux
+const unsigned int	TRANSPORT_GSO_SEGMENTS		= 64;			// datagrams in one segmented message, the UDP_MAX_SEGMENTS of Linux
+const size_t		TRANSPORT_GSO_BYTES			= 65507;		// bytes of one segmented message, the largest UDP payload
+const size_t		TRANSPORT_DATAGRAM_MAX		= 1500;			// largest datagram received, a longer one is dropped
+const int			TRANSPORT_SOCKET_BUFFER		= 4 << 20;		// receive and send buffer asked of the system, it may give less
+const unsigned int	TRANSPORT_URING_ENTRIES		= 1024;			// submission queue of the io_uring backends
+const unsigned int	TRANSPORT_URING_COMPLETIONS	= 8192;			// completion queue, receives and sends
+const unsigned int	TRANSPORT_URING_BUFFERS		= 1024;			// buffers of the provided buffer ring, a power of 2
+const unsigned int	TRANSPORT_URING_IDLE_MS		= 1000;			// uring-sqpoll: the kernel thread sleeps after this long without work
+
+// ---------------------------------------------------------------------------
+
+// how the datagrams reach the system
+enum TRANSPORT_BACKEND
+{
+	TRANSPORT_SINGLE = 0,		// recvfrom() and sendto(), one call per datagram
+	TRANSPORT_BATCH,			// recvmmsg() and sendmmsg(), Linux only
+	TRANSPORT_URING,			// io_uring multishot receive and queued sends, Linux 6.0 and later
+	TRANSPORT_URING_SQPOLL,		// the same with a kernel thread polling the submission queue
+
+	TRANSPORT_BACKEND_NUM
+};
+
+// one datagram received, the data belongs to the transport until the next TransportReceive()
+struct TransportDatagram
+{
+	const uint8_t *		pData;
+	size_t				size;
+	SocketAddress		from;
+};
+
+// what the transport did since it was opened
+struct TransportStats
+{
+	uint64_t			recvCalls;			// system calls that received, the waits of TransportWait() apart
+	uint64_t			recvDatagrams;
+	uint64_t			recvBytes;
+	uint64_t			sendCalls;			// system calls that sent
+	uint64_t			sendDatagrams;
+	uint64_t			sendBytes;
+	uint64_t			sendDropped;		// datagrams the system refused, a full buffer
+	uint64_t			sendSegmented;		// datagrams sent in a segmented message, UDP_SEGMENT
+	uint64_t			recvBatchMax;		// largest batch received and sent in one call
+	uint64_t			sendBatchMax;
+};
+
+struct Transport;
+
+// ---------------------------------------------------------------------------
+// Function prototypes
+
+// open a transport on a UDP socket bound to port (0 for any), in the SO_REUSEPORT group of the port if shared. 0 on failure
+Transport *			TransportOpen(TRANSPORT_BACKEND backend, uint16_t port, bool shared = false);
+void				TransportClose(Transport * pTransport);
+
+// the socket, to wait on with SocketPoll() or to read the port of
+SocketHandle		TransportSocket(const Transport * pTransport);
+
+// the backend actually in use, a simpler one where the one asked for is not available
+TRANSPORT_BACKEND	TransportBackend(const Transport * pTransport);
+
+// send the runs of datagrams to one address as segmented messages or not, on by default where it is available.
+// returns whether it is on: never with the single backend or without UDP_SEGMENT
+bool				TransportSetSegmentation(Transport * pTransport, bool enabled);
+
+// simulate the conditions on the datagrams received (pIn) and sent (pOut), 0 for none. The lines draw from seed and seed + 1,
+// the datagrams still in the lines of a previous call are dropped
+void				TransportSetConditions(Transport * pTransport, const NetSimConditions * pIn, const NetSimConditions * pOut,
+										   uint32_t seed);
+
+// the counters of the lines, zeros for a direction without one
+void				TransportGetConditionStats(const Transport * pTransport, NetSimStats& in, NetSimStats& out);
+
+// wait up to timeoutMs for a datagram, returns true if one is waiting
+bool				TransportWait(Transport * pTransport, int timeoutMs);
+
+// receive the datagrams waiting, up to TRANSPORT_RECV_BATCH. returns how many, 0 if none, pDatagrams points to them
+unsigned int		TransportReceive(Transport * pTransport, const TransportDatagram *& pDatagrams);
+
+// queue a datagram made of head then body. The head is copied, the body (0 for none) must live until TransportFlush()
+void				TransportQueue(Transport * pTransport, const void * pHead, size_t headSize,
+								   const void * pBody, size_t bodySize, const SocketAddress& to);
+
+// queue a datagram made of head then size bytes of the packet at offset. The queue holds a reference to the packet
+// until TransportFlush() or TransportClose()
+void				TransportQueuePacket(Transport * pTransport, const void * pHead, size_t headSize,
+										 PacketBuffer * pPacket, size_t offset, size_t size, const SocketAddress& to);
+
+// send the queue, returns the datagrams sent. A datagram the system refuses is dropped, like the network would.
+// With conditions the queue goes into the line out and the datagrams due are sent
+unsigned int		TransportFlush(Transport * pTransport);
+
+const TransportStats&	TransportGetStats(const Transport * pTransport);
+
+// "single", "batch", "uring" or "uring-sqpoll", returns false for any other name
+bool				TransportParseBackend(const char * name, TRANSPORT_BACKEND& backend);
+const char *		TransportBackendName(TRANSPORT_BACKEND backend);
+
+// ---------------------------------------------------------------------------
+
+#endif // CSD1130_TRANSPORT_H_
@@ -0,0 +1,36 @@
+/******************************************************************************/
+/*!
+\file		WorkerPool.h
+\brief		This file contains the declaration of the worker thread pool used to
+			split the simulation work across the cores:
+			WorkerPoolInit();
+			WorkerPoolFree();
+			WorkerPoolThreadCount();
+			WorkerPoolRun();
+ */
+/******************************************************************************/
+
+#ifndef CSD1130_WORKER_POOL_H_
+#define CSD1130_WORKER_POOL_H_
+
+#include <functional>
+
+// ---------------------------------------------------------------------------
+// Function prototypes
+
+// start the worker threads, 0 means one thread per core (the calling thread counts as one)
+void			WorkerPoolInit(unsigned int threadCount);
+
+// stop and join the worker threads
+void			WorkerPoolFree();
+
+// number of threads that run jobs, including the calling thread
+unsigned int	WorkerPoolThreadCount();
+
+// run job(jobIndex, threadIndex) for every jobIndex in [0, jobCount) and wait for all of them.
+// threadIndex is in [0, WorkerPoolThreadCount()), 0 being the calling thread.
+void			WorkerPoolRun(unsigned int jobCount, const std::function<void(unsigned int, unsigned int)>& job);
+
+// ---------------------------------------------------------------------------
+
+#endif // CSD1130_WORKER_POOL_H_
@@ -22,9 +22,10 @@ export struct ClientPlayer
 
 export struct WorldState
 {
-	std::atomic<size_t> numPlayers;
-	std::atomic<size_t> numAsteroids;
-	std::atomic<size_t> numBullets;
+	// a cache line each, a thread bumping one does not slow the readers of the others
+	alignas(64) std::atomic<size_t> numPlayers;
+	alignas(64) std::atomic<size_t> numAsteroids;
+	alignas(64) std::atomic<size_t> numBullets;
 
 
 
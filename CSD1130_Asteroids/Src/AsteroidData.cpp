@@ -1,7 +1,27 @@
 #include "AsteroidData.h"
 
 #include <cstring>
+#ifdef _WIN32
 #include <WinSock2.h>
+#else
+#include <arpa/inet.h>
+
+// htonf/ntohf are WinSock extensions, same bit pattern swap as htonl/ntohl
+static uint32_t htonf(float value)
+{
+	uint32_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+	return htonl(bits);
+}
+
+static float ntohf(uint32_t value)
+{
+	uint32_t bits = ntohl(value);
+	float result;
+	memcpy(&result, &bits, sizeof(result));
+	return result;
+}
+#endif
 void SetOwner(AsteroidData* data, uint8_t owner)
 {
 	data->owner = owner;
@@ -12,6 +32,16 @@ uint8_t GetOwner(AsteroidData* data)
 	return data->owner;
 }
 
+void SetId(AsteroidData* data, uint32_t id)
+{
+	data->id = id;
+}
+
+uint32_t GetId(AsteroidData* data)
+{
+	return data->id;
+}
+
 void SetPosition(AsteroidData* data, AEVec2 position)
 {
 	data->position = position;
@@ -96,11 +126,11 @@ void CopyVec2(void* dest, AEVec2& src, bool ToNetwork=true )
 	float y = src.y;
 	if (ToNetwork)
 	{
-		u_long x1 = htonf(src.x);
-		u_long y1 = htonf(src.y);
+		uint32_t x1 = htonf(src.x);
+		uint32_t y1 = htonf(src.y);
 
-		memcpy(dest, &x1, sizeof(u_long));
-		memcpy(reinterpret_cast<char*>(dest) + sizeof(u_long), &y1, sizeof(u_long));
+		memcpy(dest, &x1, sizeof(uint32_t));
+		memcpy(reinterpret_cast<char*>(dest) + sizeof(uint32_t), &y1, sizeof(uint32_t));
 
 	}
 	else
@@ -116,9 +146,9 @@ AEVec2 ExtractVec2(void* src, bool FromNetwork = true)
 	float x, y;
 	if (FromNetwork)
 	{
-		u_long x1, y1;
-		memcpy(&x1, src, sizeof(u_long));
-		memcpy(&y1, reinterpret_cast<char*>(src) + sizeof(u_long), sizeof(u_long));
+		uint32_t x1, y1;
+		memcpy(&x1, src, sizeof(uint32_t));
+		memcpy(&y1, reinterpret_cast<char*>(src) + sizeof(uint32_t), sizeof(uint32_t));
 		x = ntohf(x1);
 		y = ntohf(y1);
 	}
@@ -134,37 +164,42 @@ AEVec2 ExtractVec2(void* src, bool FromNetwork = true)
 char* ToNetworkData(AsteroidData* data)
 {
 	char* buffer = new char[DATA_SIZE] {};
+	WriteNetworkData(data, buffer);
+	return buffer;
+}
 
+void WriteNetworkData(AsteroidData* data, char* buffer)
+{
 	memcpy(buffer, &data->owner, sizeof(uint8_t));
+	uint32_t id = htonl(data->id);
+	memcpy(buffer + 1, &id, sizeof(uint32_t));
 
-	CopyVec2(buffer + 1, data->position);
-	CopyVec2(buffer + 9, data->scale);
-	CopyVec2(buffer + 17, data->velocity);
-	CopyVec2(buffer + 25, data->direction);
-	u_long scoreCount = htonl(data->scoreCount);
-	memcpy(buffer + 33, &scoreCount, sizeof(u_long));
-	u_long n_time = htonf(data->time);
-	memcpy(buffer + 37, &n_time, sizeof(u_long));
-
-
-	return  buffer;
-
-
+	CopyVec2(buffer + 5, data->position);
+	CopyVec2(buffer + 13, data->scale);
+	CopyVec2(buffer + 21, data->velocity);
+	CopyVec2(buffer + 29, data->direction);
+	uint32_t scoreCount = htonl(data->scoreCount);
+	memcpy(buffer + 37, &scoreCount, sizeof(uint32_t));
+	uint32_t n_time = htonf(data->time);
+	memcpy(buffer + 41, &n_time, sizeof(uint32_t));
 }
 
 AsteroidData FromNetworkData(char* buffer)
 {
 	AsteroidData data;
 	data.owner = *buffer;
-	data.position = ExtractVec2(buffer + 1);
-	data.scale = ExtractVec2(buffer + 9);
-	data.velocity = ExtractVec2(buffer + 17);
-	data.direction = ExtractVec2(buffer + 25);
-	u_long scoreCount;
-	memcpy(&scoreCount, buffer + 33, sizeof(u_long));
+	uint32_t id;
+	memcpy(&id, buffer + 1, sizeof(uint32_t));
+	data.id = ntohl(id);
+	data.position = ExtractVec2(buffer + 5);
+	data.scale = ExtractVec2(buffer + 13);
+	data.velocity = ExtractVec2(buffer + 21);
+	data.direction = ExtractVec2(buffer + 29);
+	uint32_t scoreCount;
+	memcpy(&scoreCount, buffer + 37, sizeof(uint32_t));
 	data.scoreCount = ntohl(scoreCount);
-	u_long n_time;
-	memcpy(&n_time, buffer + 37, sizeof(u_long));
+	uint32_t n_time;
+	memcpy(&n_time, buffer + 41, sizeof(uint32_t));
 	data.time = ntohf(n_time);
 	return data;
 }
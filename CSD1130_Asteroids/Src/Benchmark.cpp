@@ -0,0 +1,1699 @@
+/******************************************************************************/
+/*!
+\file		Benchmark.cpp
+\brief		This file contains the definition of the headless benchmarks. They do
+			not need the Alpha Engine to be initialized and print their results
+			to the console.
+
+			The suite benchmark runs every hot path of the server (collision
+			test, network serialization, instance creation and the full tick)
+			over a grid of scenarios. It prints one CSV row per measure and
+			compares the rows with a stored baseline, the process fails when a
+			measure got slower than the tolerance allows.
+
+			The sweep benchmark runs the server tick over a grid of players,
+			asteroids and tick rates and records the tick time percentiles, the
+			CPU and the memory of every point. It prints the capacity curves as
+			CSV and the point of every curve where the tick budget breaks.
+
+			The udp benchmark sends snapshot rounds to loopback clients and
+			receives input rounds from them through every transport backend,
+			and prints the time per datagram and the datagrams per system
+			call of each.
+
+			The codec benchmark runs every snapshot codec over the slices a
+			server sends during a match and prints the bytes they save and
+			the time they cost.
+ */
+/******************************************************************************/
+
+#include "Main.h"
+#include "Benchmark.h"
+#include "GameObjInst.h"
+#include "Math2D.h"
+#include "AsteroidData.h"
+#include "Random.h"
+#include "Options.h"
+#include "Scoreboard.h"
+#include "Socket.h"
+#include "Transport.h"
+#include "NetProtocol.h"
+#include "PacketPool.h"
+#include "Replay.h"
+#include "SnapshotCodec.h"
+
+#include <algorithm>
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <time.h>
+#include <unistd.h>
+#else
+#include <psapi.h>
+#endif
+
+// ---------------------------------------------------------------------------
+// settings
+
+static const unsigned long	BENCH_CAPACITY_DEFAULT	= 131072;		// bullets at the last step of the capacity benchmark
+static const unsigned long	BENCH_CAPACITY_START	= 1024;			// bullets at the first step, doubled every step
+static const double			BENCH_CAPACITY_GROWTH	= 4.0;			// create and destroy fail past this many times the cheapest create step
+static const int			BENCH_TICKS				= 120;			// ticks simulated at every step
+static const unsigned long	BENCH_CHURN				= 60;			// 1 bullet out of BENCH_CHURN expires every tick and is replaced
+static const float			BENCH_DT				= 1.0f / 60.0f;	// fixed frame time of a tick
+static const unsigned long	BENCH_VECMATH_DEFAULT	= 65536;		// objects of the vector math benchmark
+static const int			BENCH_VECMATH_PASSES	= 100;			// passes over the objects for every kernel
+static const int			BENCH_SUITE_REPEATS		= 7;			// a micro benchmark keeps the fastest of this many runs
+static const unsigned long	BENCH_SUITE_RUN_OPS		= 200000;		// a run of a micro benchmark repeats its pass until this many operations
+static const int			BENCH_SUITE_TICKS		= 120;			// ticks timed for every tick scenario
+static const int			BENCH_SUITE_WARMUP		= 10;			// ticks run before the timing starts
+static const uint32_t		BENCH_SUITE_SEED		= 1130;			// seed of the worlds and of the inputs
+static const double			BENCH_SUITE_TOLERANCE	= 0.25;			// a measure fails when it is this much slower than the baseline
+static const float			BENCH_SUITE_DENSITY		= 6400.0f;		// world area (units^2) per asteroid, so a bigger world is not a denser one
+static const char *			BENCH_SUITE_ENTITIES	= "100,1000,10000";	// default asteroids of the scenarios
+static const char *			BENCH_SUITE_BULLETS		= "0,0.25";		// default bullets per asteroid
+static const char *			BENCH_SUITE_PLAYERS		= "1,32";		// default players sending commands
+static const char *			BENCH_SWEEP_PLAYERS		= "1,4,16,64,256";			// default players of the sweep
+static const char *			BENCH_SWEEP_ASTEROIDS	= "10,100,1000,10000,100000";	// default asteroids of the sweep
+static const char *			BENCH_SWEEP_RATES		= "30,60,120";				// default tick rates of the sweep
+static const double			BENCH_SWEEP_SECONDS		= 5.0;			// simulated seconds timed at every point
+static const double			BENCH_SWEEP_BULLETS		= 0.25;			// bullets per asteroid the world is topped up to
+static const char *			BENCH_UDP_BACKENDS		= "single,batch,uring,uring-sqpoll";	// default transports of the udp benchmark
+static const unsigned long	BENCH_UDP_CLIENTS		= 256;			// loopback clients, one datagram each per round
+static const unsigned long	BENCH_UDP_ROUNDS		= 200;			// rounds timed per direction
+static const size_t			BENCH_UDP_INPUT_SIZE	= 22;			// size of an INPUT, what the clients send
+static const int			BENCH_UDP_WAIT_MS		= 100;			// a receive round gives up on the datagrams missing after this
+static const unsigned long	BENCH_CODEC_ASTEROIDS	= 200;			// asteroids of the world of the codec benchmark
+static const unsigned long	BENCH_CODEC_PLAYERS		= 8;			// players of that world
+static const uint32_t		BENCH_CODEC_SEED		= 2024;			// seed of that world, not the BENCH_SUITE_SEED the static table is trained on
+static const double			BENCH_CODEC_SECONDS		= 60.0;			// seconds of the match taken
+static const unsigned long	BENCH_CODEC_RATE		= 20;			// snapshots per second taken from it
+static const uint64_t		BENCH_CODEC_TRAIN_TOTAL	= 4096;			// sum of a trained frequency table, about
+
+// the inline math must fold at compile time
+static_assert(Vec2Dot(Vec2Make(1.0f, 2.0f), Vec2Make(3.0f, 4.0f)) == 11.0f, "Math2D is not constexpr");
+static_assert(Wrap(4.0f, -3.0f, 3.0f) == -2.0f, "Wrap does not match AEWrap");
+static_assert(Mtx33MultVec(Mtx33Concat(Mtx33Identity(), Mtx33TRSCosSin(Vec2Make(2.0f, 3.0f), 1.0f, 0.0f, Vec2Make(5.0f, 6.0f))),
+						   Vec2Make(1.0f, 1.0f)).y == 9.0f, "Mtx33TRSCosSin does not match Trans * Rot * Scale");
+
+// one measure of the suite, one CSV row
+struct BenchSuiteResult
+{
+	std::string		name;			// collision, serialize, deserialize, create, scoreboard or tick
+	unsigned long	entities;		// asteroids (collision: box pairs, serialize: messages, scoreboard: players)
+	unsigned long	bullets;		// bullets in the world
+	unsigned long	players;		// players sending a command every tick
+	double			nsPerOp;		// time of one operation: fastest run of a micro benchmark, median tick
+	unsigned long	ops;			// operations timed per run
+};
+
+// one point of the sweep, one CSV row
+struct BenchSweepPoint
+{
+	unsigned long	players;		// players sending a command every tick
+	unsigned long	asteroids;		// asteroids the world is topped up to
+	unsigned long	rate;			// ticks per second
+	double			p50Ms;			// tick time percentiles
+	double			p95Ms;
+	double			p99Ms;
+	double			maxMs;
+	double			cpuPercent;		// CPU of the process while ticking, in percent of one core at the tick rate
+	double			memoryMb;		// resident memory after the last tick
+	bool			fits;			// p99 within the budget
+};
+
+// data of one object of the vector math benchmark
+struct BenchVecMathObj
+{
+	AEVec2		pos;
+	AEVec2		vel;
+	AEVec2		scale;
+	float		dir;
+	AABB		box;
+	AEMtx33		transform;
+};
+
+/******************************************************************************/
+/*!
+	Nanoseconds elapsed since start.
+*/
+/******************************************************************************/
+static double benchmarkElapsedNs(std::chrono::steady_clock::time_point start)
+{
+	return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now() - start).count();
+}
+
+/******************************************************************************/
+/*!
+	Take a slot from the storage and give it the data of a bullet. The position
+	and velocity only depend on n so every run creates the same bullets.
+*/
+/******************************************************************************/
+static GameObjInst * benchmarkSpawnBullet(unsigned long n)
+{
+	GameObjInst * pInst = gameObjInstStorageAlloc();
+	if (pInst == 0)
+		return 0;
+
+	pInst->scale.x		= 20.0f;
+	pInst->scale.y		= 3.0f;
+	pInst->posCurr.x	= (float)(n % 800) - 400.0f;
+	pInst->posCurr.y	= (float)(n % 600) - 300.0f;
+	pInst->velCurr.x	= (float)(n % 17) * 25.0f - 200.0f;
+	pInst->velCurr.y	= (float)(n % 13) * 30.0f - 180.0f;
+	pInst->dirCurr		= 0.0f;
+
+	return pInst;
+}
+
+/******************************************************************************/
+/*!
+	BenchmarkRun() reads the benchmark name and the optional count that follow
+	"-bench" on the command line and runs the benchmark.
+*/
+/******************************************************************************/
+int BenchmarkRun(const char * args)
+{
+	char			name[32] = {};
+	unsigned long	count = 0;
+
+#ifdef _MSC_VER
+	sscanf_s(args, " %31s %lu", name, (unsigned)sizeof(name), &count);
+#else
+	sscanf(args, " %31s %lu", name, &count);
+#endif
+
+	if (strcmp(name, "capacity") == 0)
+		return BenchmarkCapacity(count);
+	if (strcmp(name, "vecmath") == 0)
+		return BenchmarkVecMath(count);
+	if (strcmp(name, "suite") == 0)
+		return BenchmarkSuite(strstr(args, "suite") + strlen("suite"));
+	if (strcmp(name, "sweep") == 0)
+		return BenchmarkSweep(strstr(args, "sweep") + strlen("sweep"));
+	if (strcmp(name, "udp") == 0)
+		return BenchmarkUdp(strstr(args, "udp") + strlen("udp"));
+	if (strcmp(name, "codec") == 0)
+		return BenchmarkCodec(strstr(args, "codec") + strlen("codec"));
+
+	printf("Unknown benchmark \"%s\", available: capacity, vecmath, suite, sweep, udp, codec\n", name);
+	return 1;
+}
+
+/******************************************************************************/
+/*!
+	BenchmarkCapacity() grows the number of live bullets from
+	BENCH_CAPACITY_START to bulletMax, doubling it at every step. At every step
+	it times the creation of the new bullets, then BENCH_TICKS ticks in which
+	every bullet moves and some expire and are replaced, the same churn the
+	game sees with bullets leaving the world. Creating and destroying a
+	bullet take a slot from the free list and give it back, they must cost
+	the same at every count: returns 2 if the last create step or the
+	destroy costs more than BENCH_CAPACITY_GROWTH times the cheapest create
+	step. The tick per bullet is only reported, it grows once the bullets
+	no longer fit in the caches and the walk over them waits on memory.
+*/
+/******************************************************************************/
+int BenchmarkCapacity(unsigned long bulletMax)
+{
+	if (bulletMax == 0)
+		bulletMax = BENCH_CAPACITY_DEFAULT;
+
+	gameObjInstStorageInit();
+
+	printf("%12s %16s %18s %10s\n", "live", "create ns/op", "tick ns/bullet", "slots");
+
+	double			firstTickNs = 0.0;
+	double			lastTickNs = 0.0;
+	double			cheapestCreateNs = 0.0;
+	double			lastCreateNs = 0.0;
+	unsigned long	spawned = 0;
+	unsigned long	live = BENCH_CAPACITY_START < bulletMax ? BENCH_CAPACITY_START : bulletMax;
+
+	for (;;)
+	{
+		// create the bullets needed to reach this step
+		unsigned long toCreate = live - gameObjInstStorageCount();
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		for (unsigned long i = 0; i < toCreate; i++)
+		{
+			if (benchmarkSpawnBullet(spawned++) == 0)
+			{
+				printf("storage full at %lu bullets\n", gameObjInstStorageCount());
+				gameObjInstStorageFree();
+				return 1;
+			}
+		}
+		double createNs = toCreate ? benchmarkElapsedNs(start) / (double)toCreate : 0.0;
+
+		// simulate: move every bullet, expire some and replace them
+		start = std::chrono::steady_clock::now();
+		for (int tick = 0; tick < BENCH_TICKS; tick++)
+		{
+			unsigned long expired = 0;
+			for (unsigned long i = 0; i < gameObjInstStorageSize(); i++)
+			{
+				GameObjInst * pInst = gameObjInstStorageAt(i);
+
+				// skip non-active object
+				if ((pInst->flag & FLAG_ACTIVE) == 0)
+					continue;
+
+				pInst->posPrev		= pInst->posCurr;
+				pInst->posCurr.x	+= pInst->velCurr.x * BENCH_DT;
+				pInst->posCurr.y	+= pInst->velCurr.y * BENCH_DT;
+
+				if ((pInst->index + (unsigned long)tick) % BENCH_CHURN == 0)
+				{
+					gameObjInstStorageRelease(pInst);
+					++expired;
+				}
+			}
+
+			for (unsigned long i = 0; i < expired; i++)
+				benchmarkSpawnBullet(spawned++);
+		}
+		double tickNs = benchmarkElapsedNs(start) / ((double)BENCH_TICKS * (double)live);
+
+		if (firstTickNs == 0.0)
+			firstTickNs = tickNs;
+		lastTickNs = tickNs;
+		if (toCreate && (cheapestCreateNs == 0.0 || createNs < cheapestCreateNs))
+			cheapestCreateNs = createNs;
+		lastCreateNs = createNs;
+
+		printf("%12lu %16.1f %18.2f %10lu\n", live, createNs, tickNs, gameObjInstStorageSize());
+
+		if (live >= bulletMax)
+			break;
+		live = live * 2 < bulletMax ? live * 2 : bulletMax;
+	}
+
+	// destroy every bullet
+	unsigned long toDestroy = gameObjInstStorageCount();
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (unsigned long i = 0; i < gameObjInstStorageSize(); i++)
+		gameObjInstStorageRelease(gameObjInstStorageAt(i));
+	double destroyNs = toDestroy ? benchmarkElapsedNs(start) / (double)toDestroy : 0.0;
+
+	printf("destroy ns/op: %.1f\n", destroyNs);
+	printf("tick cost at %lu bullets vs %lu bullets: x%.2f, memory bound past the caches, not checked\n",
+		live, BENCH_CAPACITY_START < bulletMax ? BENCH_CAPACITY_START : bulletMax, lastTickNs / firstTickNs);
+
+	gameObjInstStorageFree();
+
+	// create and destroy are O(1), the cheapest create step is the cost of a slot
+	double createGrowth		= cheapestCreateNs > 0.0 ? lastCreateNs / cheapestCreateNs : 1.0;
+	double destroyGrowth	= cheapestCreateNs > 0.0 ? destroyNs / cheapestCreateNs : 1.0;
+	bool failed = createGrowth > BENCH_CAPACITY_GROWTH || destroyGrowth > BENCH_CAPACITY_GROWTH;
+
+	printf("capacity: create at %lu bullets x%.2f, destroy x%.2f of the cheapest create step, limit x%.1f%s\n",
+		live, createGrowth, destroyGrowth, BENCH_CAPACITY_GROWTH, failed ? "  FAILED" : "");
+	return failed ? 2 : 0;
+}
+
+/******************************************************************************/
+/*!
+	Fill the objects of the vector math benchmark, the data only depends on
+	the index so both variants of a kernel see the same input.
+*/
+/******************************************************************************/
+static void benchmarkVecMathReset(std::vector<BenchVecMathObj>& objs)
+{
+	for (unsigned long i = 0; i < objs.size(); i++)
+	{
+		BenchVecMathObj& obj = objs[i];
+		obj.pos			= Vec2Make((float)(i % 800) - 400.0f, (float)(i % 600) - 300.0f);
+		obj.vel			= Vec2Make((float)(i % 17) * 25.0f - 200.0f, (float)(i % 13) * 30.0f - 180.0f);
+		obj.scale		= Vec2Make(20.0f + (float)(i % 7), 3.0f + (float)(i % 5));
+		obj.dir			= (float)(i % 360) * (PI / 180.0f);
+		obj.box			= AABB{};
+		obj.transform	= Mtx33Identity();
+	}
+}
+
+/******************************************************************************/
+/*!
+	Time BENCH_VECMATH_PASSES passes of kernel over objs, returns ns per
+	object. The checksum of the result is added to sink so the work cannot be
+	optimized away.
+*/
+/******************************************************************************/
+template <typename KERNEL>
+static double benchmarkVecMathTime(std::vector<BenchVecMathObj>& objs, KERNEL kernel, volatile float& sink)
+{
+	benchmarkVecMathReset(objs);
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (int pass = 0; pass < BENCH_VECMATH_PASSES; pass++)
+		for (BenchVecMathObj& obj : objs)
+			kernel(obj);
+	double ns = benchmarkElapsedNs(start) / ((double)BENCH_VECMATH_PASSES * (double)objs.size());
+
+	float sum = 0.0f;
+	for (const BenchVecMathObj& obj : objs)
+		sum += obj.pos.x + obj.box.max.y + obj.transform.m[0][2];
+	sink = sink + sum;
+
+	return ns;
+}
+
+/******************************************************************************/
+/*!
+	BenchmarkVecMath() times the per object math of a tick, integration,
+	bounding box and transform, once with the AE_API functions exported by
+	Alpha_Engine.dll and once with the inline functions of Math2D.h.
+*/
+/******************************************************************************/
+int BenchmarkVecMath(unsigned long objCount)
+{
+	if (objCount == 0)
+		objCount = BENCH_VECMATH_DEFAULT;
+
+	std::vector<BenchVecMathObj>	objs(objCount);
+	volatile float					sink = 0.0f;
+
+	// pos += vel * dt
+	double integrateAE = benchmarkVecMathTime(objs, [](BenchVecMathObj& obj)
+	{
+		AEVec2 move;
+		AEVec2Scale(&move, &obj.vel, BENCH_DT);
+		AEVec2Add(&obj.pos, &obj.pos, &move);
+	}, sink);
+	double integrateInline = benchmarkVecMathTime(objs, [](BenchVecMathObj& obj)
+	{
+		obj.pos = Vec2ScaleAdd(obj.pos, obj.vel, BENCH_DT);
+	}, sink);
+
+	// bounding box centered on the position
+	double boxAE = benchmarkVecMathTime(objs, [](BenchVecMathObj& obj)
+	{
+		AEVec2 half;
+		AEVec2Scale(&half, &obj.scale, 0.5f);
+		AEVec2Sub(&obj.box.min, &obj.pos, &half);
+		AEVec2Add(&obj.box.max, &obj.pos, &half);
+	}, sink);
+	double boxInline = benchmarkVecMathTime(objs, [](BenchVecMathObj& obj)
+	{
+		obj.box = AABBFromCenter(obj.pos, obj.scale);
+	}, sink);
+
+	// Trans * Rot * Scale
+	double transformAE = benchmarkVecMathTime(objs, [](BenchVecMathObj& obj)
+	{
+		AEMtx33 scale, rot, trans;
+		AEMtx33Scale(&scale, obj.scale.x, obj.scale.y);
+		AEMtx33Rot(&rot, obj.dir);
+		AEMtx33Trans(&trans, obj.pos.x, obj.pos.y);
+		AEMtx33Concat(&obj.transform, &rot, &scale);
+		AEMtx33Concat(&obj.transform, &trans, &obj.transform);
+	}, sink);
+	double transformInline = benchmarkVecMathTime(objs, [](BenchVecMathObj& obj)
+	{
+		obj.transform = Mtx33TRS(obj.scale, obj.dir, obj.pos);
+	}, sink);
+
+	printf("%12s %14s %14s %10s\n", "kernel", "AE_API ns", "inline ns", "speedup");
+	printf("%12s %14.2f %14.2f %9.2fx\n", "integrate", integrateAE, integrateInline, integrateAE / integrateInline);
+	printf("%12s %14.2f %14.2f %9.2fx\n", "aabb", boxAE, boxInline, boxAE / boxInline);
+	printf("%12s %14.2f %14.2f %9.2fx\n", "transform", transformAE, transformInline, transformAE / transformInline);
+	printf("objects: %lu, passes: %d, checksum: %g\n", objCount, BENCH_VECMATH_PASSES, (double)sink);
+
+	return 0;
+}
+
+/******************************************************************************/
+/*!
+	Read a comma separated list of numbers, returns false if a value is not a
+	number.
+*/
+/******************************************************************************/
+static bool benchmarkParseList(const char * text, std::vector<double>& values)
+{
+	values.clear();
+	while (*text)
+	{
+		char * pEnd = 0;
+		double value = strtod(text, &pEnd);
+		if (pEnd == text || value < 0.0)
+			return false;
+		values.push_back(value);
+		text = *pEnd == ',' ? pEnd + 1 : pEnd;
+		if (pEnd == text && *text)
+			return false;
+	}
+	return !values.empty();
+}
+
+/******************************************************************************/
+/*!
+	Median of the samples, sorts them.
+*/
+/******************************************************************************/
+static double benchmarkMedian(std::vector<double>& samples)
+{
+	if (samples.empty())
+		return 0.0;
+	std::sort(samples.begin(), samples.end());
+	size_t middle = samples.size() / 2;
+	return samples.size() % 2 ? samples[middle] : (samples[middle - 1] + samples[middle]) * 0.5;
+}
+
+/******************************************************************************/
+/*!
+	Passes over count items so a run of a micro benchmark does at least
+	BENCH_SUITE_RUN_OPS operations, short runs are mostly timer noise.
+*/
+/******************************************************************************/
+static unsigned long benchmarkPasses(unsigned long count)
+{
+	return (BENCH_SUITE_RUN_OPS + count - 1) / count;
+}
+
+/******************************************************************************/
+/*!
+	Set a headless world up for a scenario and fill it with asteroids and
+	bullets. The world grows with the asteroids so their density, and with it
+	the rate of collisions, stays the same in every scenario.
+*/
+/******************************************************************************/
+static void benchmarkWorldBegin(unsigned long asteroids, unsigned long bullets, unsigned long players,
+								uint32_t seed = BENCH_SUITE_SEED)
+{
+	float side = sqrtf((float)asteroids * BENCH_SUITE_DENSITY);
+
+	GameStateAsteroidsSetViewEnabled(false);
+	GameStateAsteroidsSetSeed(seed);
+	GameStateAsteroidsSetEndless(true);
+	GameStateAsteroidsSetWorldSize(side * 4.0f / 3.0f, side);
+	GameStateAsteroidsLoad();
+	GameStateAsteroidsInit();
+
+	for (uint32_t player = 1; player < players; player++)
+		GameStateAsteroidsPlayerJoin(player);
+
+	GameStateAsteroidsPopulate(asteroids, bullets);
+}
+
+/******************************************************************************/
+/*!
+	Tear the world of a scenario down.
+*/
+/******************************************************************************/
+static void benchmarkWorldEnd()
+{
+	GameStateAsteroidsFree();
+	GameStateAsteroidsUnload();
+	GameStateAsteroidsSetEndless(false);
+}
+
+/******************************************************************************/
+/*!
+	CollisionIntersection_RectRect() on pairCount random pairs of moving boxes,
+	returns the ns per test of the fastest run.
+*/
+/******************************************************************************/
+static double benchmarkSuiteCollision(unsigned long pairCount)
+{
+	struct Pair
+	{
+		AABB	a, b;
+		AEVec2	velA, velB;
+	};
+
+	RandomState rng;
+	RandomSeed(rng, BENCH_SUITE_SEED);
+
+	std::vector<Pair> pairs(pairCount);
+	for (Pair& pair : pairs)
+	{
+		pair.a		= AABBFromCenter(Vec2Make(RandomFloat01(rng) * 800.0f, RandomFloat01(rng) * 600.0f),
+									 Vec2Make(10.0f + RandomFloat01(rng) * 50.0f, 10.0f + RandomFloat01(rng) * 50.0f));
+		pair.b		= AABBFromCenter(Vec2Make(RandomFloat01(rng) * 800.0f, RandomFloat01(rng) * 600.0f),
+									 Vec2Make(10.0f + RandomFloat01(rng) * 50.0f, 10.0f + RandomFloat01(rng) * 50.0f));
+		pair.velA	= Vec2Make(RandomFloat01(rng) * 800.0f - 400.0f, RandomFloat01(rng) * 800.0f - 400.0f);
+		pair.velB	= Vec2Make(RandomFloat01(rng) * 800.0f - 400.0f, RandomFloat01(rng) * 800.0f - 400.0f);
+	}
+
+	// the test reads the frame time from g_dt
+	g_dt = BENCH_DT;
+
+	unsigned long			passes	= benchmarkPasses(pairCount);
+	double					bestNs	= 0.0;
+	volatile unsigned long	sink	= 0;
+	for (int repeat = 0; repeat < BENCH_SUITE_REPEATS; repeat++)
+	{
+		unsigned long hits = 0;
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		for (unsigned long pass = 0; pass < passes; pass++)
+		{
+			for (const Pair& pair : pairs)
+			{
+				float tFirst = 0.0f;
+				if (CollisionIntersection_RectRect(pair.a, pair.velA, pair.b, pair.velB, tFirst))
+					++hits;
+			}
+		}
+		double ns = benchmarkElapsedNs(start) / ((double)passes * (double)pairCount);
+		bestNs = repeat == 0 || ns < bestNs ? ns : bestNs;
+		sink = sink + hits;
+	}
+
+	return bestNs;
+}
+
+/******************************************************************************/
+/*!
+	ToNetworkData() and FromNetworkData() on messageCount asteroids, gives the
+	ns per message of each in the fastest run. The buffers of ToNetworkData()
+	are freed outside of the timing.
+*/
+/******************************************************************************/
+static void benchmarkSuiteSerialize(unsigned long messageCount, double& serializeNs, double& deserializeNs)
+{
+	RandomState rng;
+	RandomSeed(rng, BENCH_SUITE_SEED);
+
+	std::vector<AsteroidData> messages(messageCount);
+	for (unsigned long i = 0; i < messageCount; i++)
+	{
+		AsteroidData& data = messages[i];
+		data.owner		= (uint8_t)(i % 4);
+		data.id			= RandomNext(rng);
+		data.position	= Vec2Make(RandomFloat01(rng) * 800.0f, RandomFloat01(rng) * 600.0f);
+		data.scale		= Vec2Make(10.0f + RandomFloat01(rng) * 50.0f, 10.0f + RandomFloat01(rng) * 50.0f);
+		data.velocity	= Vec2Make(RandomFloat01(rng) * 300.0f - 150.0f, RandomFloat01(rng) * 300.0f - 150.0f);
+		data.direction	= Vec2FromAngle(RandomFloat01(rng) * 2.0f * PI);
+		data.scoreCount	= (int)(i * 100);
+		data.time		= (float)i * BENCH_DT;
+	}
+
+	std::vector<char *>	buffers(messageCount);
+	unsigned long		passes	= benchmarkPasses(messageCount);
+	volatile float		sink	= 0.0f;
+	for (int repeat = 0; repeat < BENCH_SUITE_REPEATS; repeat++)
+	{
+		double encodeNs = 0.0, decodeNs = 0.0;
+		for (unsigned long pass = 0; pass < passes; pass++)
+		{
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			for (unsigned long i = 0; i < messageCount; i++)
+				buffers[i] = ToNetworkData(&messages[i]);
+			encodeNs += benchmarkElapsedNs(start);
+
+			float sum = 0.0f;
+			start = std::chrono::steady_clock::now();
+			for (unsigned long i = 0; i < messageCount; i++)
+			{
+				AsteroidData data = FromNetworkData(buffers[i]);
+				sum += data.position.x + data.time;
+			}
+			decodeNs += benchmarkElapsedNs(start);
+			sink = sink + sum;
+
+			for (char * pBuffer : buffers)
+				delete[] pBuffer;
+		}
+
+		encodeNs /= (double)passes * (double)messageCount;
+		decodeNs /= (double)passes * (double)messageCount;
+		serializeNs		= repeat == 0 || encodeNs < serializeNs ? encodeNs : serializeNs;
+		deserializeNs	= repeat == 0 || decodeNs < deserializeNs ? decodeNs : deserializeNs;
+	}
+}
+
+/******************************************************************************/
+/*!
+	gameObjInstCreate() through GameStateAsteroidsPopulate(), objCount
+	asteroids in an empty world, returns the ns per instance of the fastest
+	run. Every pass needs a new world, small counts use fewer passes.
+*/
+/******************************************************************************/
+static double benchmarkSuiteCreate(unsigned long objCount)
+{
+	unsigned long	passes	= benchmarkPasses(objCount) / 10 + 1;
+	double			bestNs	= 0.0;
+	for (int repeat = 0; repeat < BENCH_SUITE_REPEATS; repeat++)
+	{
+		double ns = 0.0;
+		for (unsigned long pass = 0; pass < passes; pass++)
+		{
+			benchmarkWorldBegin(0, 0, 1);
+
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			GameStateAsteroidsPopulate(objCount, 0);
+			ns += benchmarkElapsedNs(start);
+
+			benchmarkWorldEnd();
+		}
+
+		ns /= (double)passes * (double)objCount;
+		bestNs = repeat == 0 || ns < bestNs ? ns : bestNs;
+	}
+
+	return bestNs;
+}
+
+/******************************************************************************/
+/*!
+	ScoreboardAdd() with playerCount players on the scoreboard, random points
+	to random players so the leaderboard keeps changing, returns the ns per
+	score event of the fastest run.
+*/
+/******************************************************************************/
+static double benchmarkSuiteScoreboard(unsigned long playerCount)
+{
+	RandomState rng;
+	RandomSeed(rng, BENCH_SUITE_SEED);
+
+	std::vector<ScoreboardEntry> events(playerCount);
+	for (ScoreboardEntry& event : events)
+	{
+		event.player	= RandomNext(rng) % (uint32_t)playerCount;
+		event.score		= (int32_t)(RandomNext(rng) % 200);
+	}
+
+	ScoreboardInit();
+	for (unsigned long player = 0; player < playerCount; player++)
+		ScoreboardJoin((uint32_t)player);
+
+	unsigned long	passes	= benchmarkPasses(playerCount);
+	double			best	= 0.0;
+	for (int repeat = 0; repeat < BENCH_SUITE_REPEATS; repeat++)
+	{
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		for (unsigned long pass = 0; pass < passes; pass++)
+		{
+			for (const ScoreboardEntry& event : events)
+				ScoreboardAdd(event.player, event.score);
+		}
+		double ns = benchmarkElapsedNs(start) / ((double)passes * (double)playerCount);
+		best = repeat == 0 || ns < best ? ns : best;
+	}
+
+	ScoreboardFree();
+	return best;
+}
+
+/******************************************************************************/
+/*!
+	GameStateAsteroidsTick() in a world of asteroids and bullets with players
+	steering their ship and firing, returns the median ns per tick. The world is topped up
+	between two ticks, outside of the timing, so the bullets leaving the world
+	and the asteroids destroyed do not empty it.
+*/
+/******************************************************************************/
+static double benchmarkSuiteTick(unsigned long asteroids, unsigned long bullets, unsigned long players, int ticks)
+{
+	benchmarkWorldBegin(asteroids, bullets, players);
+
+	std::vector<InputCommand>	commands(players);
+	std::vector<double>			samples;
+	for (int tick = -BENCH_SUITE_WARMUP; tick < ticks; tick++)
+	{
+		// every player holds a different, changing set of buttons
+		for (uint32_t player = 0; player < players; player++)
+		{
+			commands[player].player		= player;
+			commands[player].buttons	= (uint8_t)((((uint32_t)tick + player) * 2654435761u) >> 27);
+		}
+
+		GameStateAsteroidsPopulate(asteroids, bullets);
+
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		GameStateAsteroidsTick(BENCH_DT, commands.data(), (unsigned int)players);
+		if (tick >= 0)
+			samples.push_back(benchmarkElapsedNs(start));
+	}
+
+	benchmarkWorldEnd();
+	return benchmarkMedian(samples);
+}
+
+/******************************************************************************/
+/*!
+	Write the results as CSV, with a header line.
+*/
+/******************************************************************************/
+static void benchmarkWriteCsv(FILE * pFile, const std::vector<BenchSuiteResult>& results)
+{
+	fprintf(pFile, "benchmark,entities,bullets,players,ns_per_op,ops\n");
+	for (const BenchSuiteResult& result : results)
+	{
+		fprintf(pFile, "%s,%lu,%lu,%lu,%.2f,%lu\n", result.name.c_str(),
+			result.entities, result.bullets, result.players, result.nsPerOp, result.ops);
+	}
+}
+
+/******************************************************************************/
+/*!
+	Read results written by benchmarkWriteCsv(), returns false if the file
+	cannot be opened.
+*/
+/******************************************************************************/
+static bool benchmarkReadCsv(const char * path, std::vector<BenchSuiteResult>& results)
+{
+	FILE * pFile = 0;
+#ifdef _MSC_VER
+	if (fopen_s(&pFile, path, "r") != 0)
+		pFile = 0;
+#else
+	pFile = fopen(path, "r");
+#endif
+	if (pFile == 0)
+		return false;
+
+	char line[256];
+	while (fgets(line, sizeof(line), pFile))
+	{
+		BenchSuiteResult	result;
+		char				name[32] = {};
+#ifdef _MSC_VER
+		int fields = sscanf_s(line, "%31[^,],%lu,%lu,%lu,%lf,%lu", name, (unsigned)sizeof(name),
+			&result.entities, &result.bullets, &result.players, &result.nsPerOp, &result.ops);
+#else
+		int fields = sscanf(line, "%31[^,],%lu,%lu,%lu,%lf,%lu", name,
+			&result.entities, &result.bullets, &result.players, &result.nsPerOp, &result.ops);
+#endif
+		// the header and the broken lines do not parse
+		if (fields != 6)
+			continue;
+		result.name = name;
+		results.push_back(result);
+	}
+
+	fclose(pFile);
+	return true;
+}
+
+/******************************************************************************/
+/*!
+	BenchmarkSuite() runs every hot path over the scenarios given by args:
+		entities=100,1000	asteroids of the scenarios
+		bullets=0,0.25		bullets per asteroid
+		players=1,32		players flying a ship each, sending a command every tick
+		ticks=120			ticks timed per tick scenario
+		csv=<file>			write the results there instead of the console
+		baseline=<file>		compare the results with this file
+		tolerance=0.25		slowdown allowed before a measure fails
+	The collision, serialization, creation and scoreboard measures run once per entity
+	count, the tick once per combination. Returns 2 if a measure is slower
+	than its baseline by more than the tolerance.
+*/
+/******************************************************************************/
+int BenchmarkSuite(const char * args)
+{
+	std::vector<double>	entityList, bulletList, playerList;
+	std::string			csvPath, baselinePath;
+	double				tolerance	= BENCH_SUITE_TOLERANCE;
+	int					ticks		= BENCH_SUITE_TICKS;
+
+	benchmarkParseList(BENCH_SUITE_ENTITIES, entityList);
+	benchmarkParseList(BENCH_SUITE_BULLETS, bulletList);
+	benchmarkParseList(BENCH_SUITE_PLAYERS, playerList);
+
+	std::string key, value;
+	while (OptionNext(args, key, value))
+	{
+		bool valid = !value.empty();
+		if (key == "entities")
+			valid = valid && benchmarkParseList(value.c_str(), entityList);
+		else if (key == "bullets")
+			valid = valid && benchmarkParseList(value.c_str(), bulletList);
+		else if (key == "players")
+			valid = valid && benchmarkParseList(value.c_str(), playerList);
+		else if (key == "ticks")
+			valid = valid && (ticks = atoi(value.c_str())) > 0;
+		else if (key == "tolerance")
+			valid = valid && (tolerance = atof(value.c_str())) > 0.0;
+		else if (key == "csv")
+			csvPath = value;
+		else if (key == "baseline")
+			baselinePath = value;
+		else
+			valid = false;
+
+		if (!valid)
+		{
+			fprintf(stderr, "suite: bad option \"%s=%s\"\n", key.c_str(), value.c_str());
+			return 1;
+		}
+	}
+
+	std::vector<BenchSuiteResult> results;
+	for (double entityValue : entityList)
+	{
+		unsigned long entities = (unsigned long)entityValue;
+		if (entities == 0)
+			continue;
+
+		BenchSuiteResult result = { "collision", entities, 0, 0, benchmarkSuiteCollision(entities), entities };
+		results.push_back(result);
+
+		double serializeNs = 0.0, deserializeNs = 0.0;
+		benchmarkSuiteSerialize(entities, serializeNs, deserializeNs);
+		result = { "serialize", entities, 0, 0, serializeNs, entities };
+		results.push_back(result);
+		result = { "deserialize", entities, 0, 0, deserializeNs, entities };
+		results.push_back(result);
+
+		result = { "create", entities, 0, 0, benchmarkSuiteCreate(entities), entities };
+		results.push_back(result);
+
+		result = { "scoreboard", entities, 0, 0, benchmarkSuiteScoreboard(entities), entities };
+		results.push_back(result);
+
+		for (double bulletValue : bulletList)
+		{
+			for (double playerValue : playerList)
+			{
+				unsigned long bullets = (unsigned long)(bulletValue * (double)entities);
+				unsigned long players = playerValue < 1.0 ? 1 : (unsigned long)playerValue;
+
+				result = { "tick", entities, bullets, players, benchmarkSuiteTick(entities, bullets, players, ticks), 1 };
+				results.push_back(result);
+			}
+		}
+	}
+
+	if (csvPath.empty())
+	{
+		benchmarkWriteCsv(stdout, results);
+	}
+	else
+	{
+		FILE * pFile = 0;
+#ifdef _MSC_VER
+		if (fopen_s(&pFile, csvPath.c_str(), "w") != 0)
+			pFile = 0;
+#else
+		pFile = fopen(csvPath.c_str(), "w");
+#endif
+		if (pFile == 0)
+		{
+			fprintf(stderr, "suite: cannot write %s\n", csvPath.c_str());
+			return 1;
+		}
+		benchmarkWriteCsv(pFile, results);
+		fclose(pFile);
+	}
+
+	if (baselinePath.empty())
+		return 0;
+
+	std::vector<BenchSuiteResult> baseline;
+	if (!benchmarkReadCsv(baselinePath.c_str(), baseline))
+	{
+		fprintf(stderr, "suite: cannot read the baseline %s\n", baselinePath.c_str());
+		return 1;
+	}
+
+	// a measure only fails against the same scenario, new scenarios are reported as such
+	unsigned long regressions = 0;
+	for (const BenchSuiteResult& result : results)
+	{
+		const BenchSuiteResult * pBase = 0;
+		for (const BenchSuiteResult& base : baseline)
+		{
+			if (base.name == result.name && base.entities == result.entities &&
+				base.bullets == result.bullets && base.players == result.players)
+			{
+				pBase = &base;
+				break;
+			}
+		}
+
+		if (pBase == 0 || pBase->nsPerOp <= 0.0)
+		{
+			fprintf(stderr, "%-12s %8lu %8lu %4lu  %12.2f ns  (no baseline)\n", result.name.c_str(),
+				result.entities, result.bullets, result.players, result.nsPerOp);
+			continue;
+		}
+
+		double change = result.nsPerOp / pBase->nsPerOp - 1.0;
+		bool regressed = change > tolerance;
+		regressions += regressed ? 1 : 0;
+
+		fprintf(stderr, "%-12s %8lu %8lu %4lu  %12.2f ns  baseline %12.2f ns  %+7.1f%%%s\n", result.name.c_str(),
+			result.entities, result.bullets, result.players, result.nsPerOp, pBase->nsPerOp,
+			change * 100.0, regressed ? "  REGRESSION" : "");
+	}
+
+	if (regressions)
+	{
+		fprintf(stderr, "suite: %lu measure(s) slower than the baseline by more than %.0f%%\n", regressions, tolerance * 100.0);
+		return 2;
+	}
+
+	fprintf(stderr, "suite: no measure slower than the baseline by more than %.0f%%\n", tolerance * 100.0);
+	return 0;
+}
+
+/******************************************************************************/
+/*!
+	CPU time used by every thread of the process, in seconds.
+*/
+/******************************************************************************/
+static double benchmarkProcessCpuSeconds()
+{
+#ifdef _WIN32
+	FILETIME creation, exit, kernel, user;
+	if (!GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user))
+		return 0.0;
+	ULARGE_INTEGER kernelTime = { { kernel.dwLowDateTime, kernel.dwHighDateTime } };
+	ULARGE_INTEGER userTime = { { user.dwLowDateTime, user.dwHighDateTime } };
+	return (double)(kernelTime.QuadPart + userTime.QuadPart) * 1e-7;
+#else
+	timespec now;
+	if (clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &now) != 0)
+		return 0.0;
+	return (double)now.tv_sec + (double)now.tv_nsec * 1e-9;
+#endif
+}
+
+/******************************************************************************/
+/*!
+	Resident memory of the process, in megabytes.
+*/
+/******************************************************************************/
+static double benchmarkResidentMb()
+{
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters;
+	if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+		return 0.0;
+	return (double)counters.WorkingSetSize / (1024.0 * 1024.0);
+#else
+	FILE * pFile = fopen("/proc/self/statm", "r");
+	if (pFile == 0)
+		return 0.0;
+	unsigned long size = 0, resident = 0;
+	int fields = fscanf(pFile, "%lu %lu", &size, &resident);
+	fclose(pFile);
+	return fields == 2 ? (double)resident * (double)sysconf(_SC_PAGESIZE) / (1024.0 * 1024.0) : 0.0;
+#endif
+}
+
+/******************************************************************************/
+/*!
+	Value at fraction p of the sorted samples.
+*/
+/******************************************************************************/
+static double benchmarkPercentile(const std::vector<double>& sorted, double p)
+{
+	if (sorted.empty())
+		return 0.0;
+	return sorted[(size_t)(p * (double)(sorted.size() - 1) + 0.5)];
+}
+
+/******************************************************************************/
+/*!
+	Run the tick of one point of the sweep for seconds of simulated time, like
+	benchmarkSuiteTick() the world is topped up outside of the timing. The CPU
+	is only counted around the ticks, so the worker threads of the tick are in
+	it and the top up is not.
+*/
+/******************************************************************************/
+static void benchmarkSweepPoint(BenchSweepPoint& point, double seconds, double bulletRatio, double budgetMs)
+{
+	unsigned long bullets = (unsigned long)(bulletRatio * (double)point.asteroids);
+	benchmarkWorldBegin(point.asteroids, bullets, point.players);
+
+	const float		dt		= 1.0f / (float)point.rate;
+	const int		ticks	= std::max(1, (int)(seconds * (double)point.rate));
+
+	std::vector<InputCommand>	commands(point.players);
+	std::vector<double>			samples;
+	double						cpuSeconds = 0.0;
+	for (int tick = -BENCH_SUITE_WARMUP; tick < ticks; tick++)
+	{
+		for (uint32_t player = 0; player < point.players; player++)
+		{
+			commands[player].player		= player;
+			commands[player].buttons	= (uint8_t)((((uint32_t)tick + player) * 2654435761u) >> 27);
+		}
+
+		GameStateAsteroidsPopulate(point.asteroids, bullets);
+
+		double cpuStart = benchmarkProcessCpuSeconds();
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		GameStateAsteroidsTick(dt, commands.data(), (unsigned int)point.players);
+		if (tick >= 0)
+		{
+			samples.push_back(benchmarkElapsedNs(start) * 1e-6);
+			cpuSeconds += benchmarkProcessCpuSeconds() - cpuStart;
+		}
+	}
+	point.memoryMb = benchmarkResidentMb();
+
+	benchmarkWorldEnd();
+
+	std::sort(samples.begin(), samples.end());
+	point.p50Ms			= benchmarkPercentile(samples, 0.50);
+	point.p95Ms			= benchmarkPercentile(samples, 0.95);
+	point.p99Ms			= benchmarkPercentile(samples, 0.99);
+	point.maxMs			= samples.back();
+	point.cpuPercent	= cpuSeconds / ((double)ticks / (double)point.rate) * 100.0;
+	point.fits			= point.p99Ms <= (budgetMs > 0.0 ? budgetMs : 1000.0 / (double)point.rate);
+}
+
+/******************************************************************************/
+/*!
+	BenchmarkSweep() measures the capacity curves over the grid given by args:
+		players=1,4,16,64,256				players flying a ship each, sending a command every tick
+		asteroids=10,100,1000,10000,100000	asteroids of the world
+		rates=30,60,120						ticks per second
+		bullets=0.25						bullets per asteroid
+		seconds=5							simulated seconds timed per point
+		budget=<ms>							tick budget, the tick period by default
+		csv=<file>							write the points there instead of the console
+	Every player fires on about half of the ticks, its bullets count in the
+	bullets per asteroid the world is topped up to. A curve is the asteroids
+	for one rate and one player count. It stops at its first point over
+	budget, the bigger worlds only take longer. The summary on stderr gives
+	the biggest world of every curve that fits and the one that breaks.
+	Returns 0, or 1 on a bad option.
+*/
+/******************************************************************************/
+int BenchmarkSweep(const char * args)
+{
+	std::vector<double>	playerList, asteroidList, rateList;
+	std::string			csvPath;
+	double				seconds		= BENCH_SWEEP_SECONDS;
+	double				bulletRatio	= BENCH_SWEEP_BULLETS;
+	double				budgetMs	= 0.0;
+
+	benchmarkParseList(BENCH_SWEEP_PLAYERS, playerList);
+	benchmarkParseList(BENCH_SWEEP_ASTEROIDS, asteroidList);
+	benchmarkParseList(BENCH_SWEEP_RATES, rateList);
+
+	std::string key, value;
+	while (OptionNext(args, key, value))
+	{
+		bool valid = !value.empty();
+		if (key == "players")
+			valid = valid && benchmarkParseList(value.c_str(), playerList);
+		else if (key == "asteroids")
+			valid = valid && benchmarkParseList(value.c_str(), asteroidList);
+		else if (key == "rates")
+			valid = valid && benchmarkParseList(value.c_str(), rateList);
+		else if (key == "bullets")
+			valid = valid && (bulletRatio = atof(value.c_str())) >= 0.0;
+		else if (key == "seconds")
+			valid = valid && (seconds = atof(value.c_str())) > 0.0;
+		else if (key == "budget")
+			valid = valid && (budgetMs = atof(value.c_str())) > 0.0;
+		else if (key == "csv")
+			csvPath = value;
+		else
+			valid = false;
+
+		if (!valid)
+		{
+			fprintf(stderr, "sweep: bad option \"%s=%s\"\n", key.c_str(), value.c_str());
+			return 1;
+		}
+	}
+	std::sort(asteroidList.begin(), asteroidList.end());
+
+	FILE * pFile = stdout;
+	if (!csvPath.empty())
+	{
+#ifdef _MSC_VER
+		if (fopen_s(&pFile, csvPath.c_str(), "w") != 0)
+			pFile = 0;
+#else
+		pFile = fopen(csvPath.c_str(), "w");
+#endif
+		if (pFile == 0)
+		{
+			fprintf(stderr, "sweep: cannot write %s\n", csvPath.c_str());
+			return 1;
+		}
+	}
+
+	fprintf(pFile, "players,asteroids,rate,p50_ms,p95_ms,p99_ms,max_ms,cpu_pct,memory_mb,fits\n");
+
+	std::vector<BenchSweepPoint> lastFits, firstBreaks;
+	for (double rateValue : rateList)
+	{
+		for (double playerValue : playerList)
+		{
+			BenchSweepPoint fit = {}, broken = {};
+			for (double asteroidValue : asteroidList)
+			{
+				BenchSweepPoint point = {};
+				point.players	= playerValue < 1.0 ? 1 : (unsigned long)playerValue;
+				point.asteroids	= (unsigned long)asteroidValue;
+				point.rate		= rateValue < 1.0 ? 1 : (unsigned long)rateValue;
+				benchmarkSweepPoint(point, seconds, bulletRatio, budgetMs);
+
+				fprintf(pFile, "%lu,%lu,%lu,%.3f,%.3f,%.3f,%.3f,%.1f,%.1f,%d\n", point.players, point.asteroids,
+					point.rate, point.p50Ms, point.p95Ms, point.p99Ms, point.maxMs, point.cpuPercent,
+					point.memoryMb, point.fits ? 1 : 0);
+				fflush(pFile);
+
+				if (!point.fits)
+				{
+					broken = point;
+					break;
+				}
+				fit = point;
+			}
+			lastFits.push_back(fit);
+			firstBreaks.push_back(broken);
+		}
+	}
+
+	if (pFile != stdout)
+		fclose(pFile);
+
+	for (size_t i = 0; i < lastFits.size(); i++)
+	{
+		const BenchSweepPoint& fit		= lastFits[i];
+		const BenchSweepPoint& broken	= firstBreaks[i];
+		const BenchSweepPoint& any		= fit.rate ? fit : broken;
+		double budget = budgetMs > 0.0 ? budgetMs : 1000.0 / (double)any.rate;
+
+		fprintf(stderr, "%4lu Hz %4lu players, budget %6.2f ms: ", any.rate, any.players, budget);
+		if (fit.rate)
+			fprintf(stderr, "fits %lu asteroids (p99 %.2f ms, %.0f%% CPU, %.0f MB)",
+				fit.asteroids, fit.p99Ms, fit.cpuPercent, fit.memoryMb);
+		else
+			fprintf(stderr, "fits no world of the sweep");
+		if (broken.rate)
+			fprintf(stderr, ", breaks at %lu (p99 %.2f ms)\n", broken.asteroids, broken.p99Ms);
+		else
+			fprintf(stderr, ", never breaks\n");
+	}
+	return 0;
+}
+
+/******************************************************************************/
+/*!
+	Read a comma separated list of transport backends, returns false on a name
+	that is not one.
+*/
+/******************************************************************************/
+static bool benchmarkParseBackends(const char * text, std::vector<TRANSPORT_BACKEND>& backends)
+{
+	backends.clear();
+	std::string list = text;
+	for (size_t start = 0; start <= list.size();)
+	{
+		size_t comma = list.find(',', start);
+		std::string name = list.substr(start, comma == std::string::npos ? std::string::npos : comma - start);
+
+		TRANSPORT_BACKEND backend;
+		if (!TransportParseBackend(name.c_str(), backend))
+			return false;
+		backends.push_back(backend);
+
+		if (comma == std::string::npos)
+			break;
+		start = comma + 1;
+	}
+	return !backends.empty();
+}
+
+/******************************************************************************/
+/*!
+	Read a list of "off" and "on" separated by commas, returns false if a
+	word is neither.
+*/
+/******************************************************************************/
+static bool benchmarkParseSwitches(const char * text, std::vector<bool>& switches)
+{
+	switches.clear();
+	std::string list = text;
+	for (size_t start = 0; start <= list.size();)
+	{
+		size_t comma = list.find(',', start);
+		std::string name = list.substr(start, comma == std::string::npos ? std::string::npos : comma - start);
+
+		if (name != "off" && name != "on")
+			return false;
+		switches.push_back(name == "on");
+
+		if (comma == std::string::npos)
+			break;
+		start = comma + 1;
+	}
+	return !switches.empty();
+}
+
+/******************************************************************************/
+/*!
+	BenchmarkUdp() compares the transport backends over loopback:
+		io=single,batch,uring,uring-sqpoll	backends measured
+		gso=off,on			sends measured without and with UDP_SEGMENT
+		clients=256			clients
+		parts=1				snapshot datagrams per client per round
+		rounds=200			rounds timed in each direction
+		size=1200			size of a snapshot datagram
+	A send round queues the parts of a snapshot for every client and times
+	the flush, the header of each is its own and the asteroids are shared
+	like on the server. The processor time of the flush is measured too, it
+	is what segmentation saves: on loopback the delivery to the clients runs
+	in the send call and is counted with it. A backend without segmentation
+	skips its gso=on row. A receive round has every client send an input and
+	times the drain of the server socket, once per backend. Loopback delivers
+	in the send call, the datagrams are waiting when the timing starts, the
+	io_uring backends may still be posting their completions and the round
+	waits for them. The drops are the datagrams that did not fit in a socket
+	buffer. The system calls are the ones of the transport, uring-sqpoll
+	leaves most of them to its kernel thread. Returns 0, or 1 on a bad option
+	or a socket that cannot be opened.
+*/
+/******************************************************************************/
+int BenchmarkUdp(const char * args)
+{
+	std::vector<TRANSPORT_BACKEND>	backends;
+	std::vector<bool>				segmentations;
+	unsigned long					clientCount	= BENCH_UDP_CLIENTS;
+	unsigned long					parts		= 1;
+	unsigned long					rounds		= BENCH_UDP_ROUNDS;
+	unsigned long					size		= NET_PACKET_MAX;
+
+	benchmarkParseBackends(BENCH_UDP_BACKENDS, backends);
+	benchmarkParseSwitches("off,on", segmentations);
+
+	std::string key, value;
+	while (OptionNext(args, key, value))
+	{
+		bool valid = !value.empty();
+		if (key == "io")
+			valid = valid && benchmarkParseBackends(value.c_str(), backends);
+		else if (key == "gso")
+			valid = valid && benchmarkParseSwitches(value.c_str(), segmentations);
+		else if (key == "clients")
+			valid = valid && (clientCount = strtoul(value.c_str(), 0, 10)) > 0;
+		else if (key == "parts")
+			valid = valid && (parts = strtoul(value.c_str(), 0, 10)) > 0 && parts <= TRANSPORT_GSO_SEGMENTS;
+		else if (key == "rounds")
+			valid = valid && (rounds = strtoul(value.c_str(), 0, 10)) > 0;
+		else if (key == "size")
+			valid = valid && (size = strtoul(value.c_str(), 0, 10)) >= NET_SNAPSHOT_HEADER_SIZE && size <= TRANSPORT_DATAGRAM_MAX;
+		else
+			valid = false;
+
+		if (!valid)
+		{
+			fprintf(stderr, "udp: bad option \"%s=%s\"\n", key.c_str(), value.c_str());
+			return 1;
+		}
+	}
+
+	if (!SocketStartup())
+	{
+		fprintf(stderr, "udp: cannot start the sockets\n");
+		return 1;
+	}
+	SocketReserve((unsigned int)clientCount + 1);
+
+	std::vector<SocketHandle>	clients(clientCount, SOCKET_HANDLE_NONE);
+	std::vector<SocketAddress>	addresses(clientCount);
+	for (unsigned long c = 0; c < clientCount; c++)
+	{
+		clients[c] = SocketOpenUdp(0);
+		if (clients[c] == SOCKET_HANDLE_NONE)
+		{
+			fprintf(stderr, "udp: cannot open client socket %lu\n", c);
+			for (SocketHandle client : clients)
+				SocketClose(client);
+			SocketCleanup();
+			return 1;
+		}
+		SocketSetBufferSize(clients[c], TRANSPORT_SOCKET_BUFFER);
+		SocketResolve("127.0.0.1", SocketLocalPort(clients[c]), addresses[c]);
+	}
+
+	std::vector<uint8_t>	snapshot(size, 0x5A);
+	std::vector<uint8_t>	input(BENCH_UDP_INPUT_SIZE, 0xA5);
+	uint8_t					buffer[TRANSPORT_DATAGRAM_MAX];
+
+	printf("io,gso,direction,clients,datagrams,dropped,ns_per_datagram,cpu_ns_per_datagram,syscalls,datagrams_per_call\n");
+	for (TRANSPORT_BACKEND backend : backends)
+	{
+		Transport * pTransport = TransportOpen(backend, 0);
+		if (pTransport == 0)
+		{
+			fprintf(stderr, "udp: cannot open the %s transport\n", TransportBackendName(backend));
+			continue;
+		}
+
+		SocketAddress server;
+		SocketResolve("127.0.0.1", SocketLocalPort(TransportSocket(pTransport)), server);
+		const char * name = TransportBackendName(TransportBackend(pTransport));
+
+		// server to clients, without and with segmentation
+		for (bool segmentation : segmentations)
+		{
+			if (TransportSetSegmentation(pTransport, segmentation) != segmentation)
+				continue;
+
+			TransportStats	before		= TransportGetStats(pTransport);
+			double			sendNs		= 0.0;
+			double			sendCpu		= 0.0;
+			unsigned long	delivered	= 0;
+			for (unsigned long r = 0; r < rounds; r++)
+			{
+				for (unsigned long c = 0; c < clientCount; c++)
+					for (unsigned long p = 0; p < parts; p++)
+						TransportQueue(pTransport, snapshot.data(), NET_SNAPSHOT_HEADER_SIZE,
+							snapshot.data() + NET_SNAPSHOT_HEADER_SIZE, size - NET_SNAPSHOT_HEADER_SIZE, addresses[c]);
+
+				double cpuStart = benchmarkProcessCpuSeconds();
+				std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+				TransportFlush(pTransport);
+				sendNs	+= benchmarkElapsedNs(start);
+				sendCpu	+= benchmarkProcessCpuSeconds() - cpuStart;
+
+				SocketAddress from;
+				for (SocketHandle client : clients)
+					while (SocketRecvFrom(client, buffer, sizeof(buffer), from) > 0)
+						++delivered;
+			}
+
+			const TransportStats&	after	= TransportGetStats(pTransport);
+			unsigned long			sent	= rounds * clientCount * parts;
+			uint64_t				calls	= after.sendCalls - before.sendCalls;
+			printf("%s,%s,send,%lu,%lu,%lu,%.1f,%.1f,%llu,%.2f\n", name, segmentation ? "on" : "off", clientCount,
+				sent, sent - delivered, sendNs / (double)sent, sendCpu * 1e9 / (double)sent, (unsigned long long)calls,
+				(double)(after.sendDatagrams - before.sendDatagrams) / (double)(calls ? calls : 1));
+		}
+
+		// clients to server
+		double			recvNs		= 0.0;
+		double			recvCpu		= 0.0;
+		unsigned long	received	= 0;
+		for (unsigned long r = 0; r < rounds; r++)
+		{
+			for (unsigned long c = 0; c < clientCount; c++)
+				SocketSendTo(clients[c], input.data(), input.size(), server);
+
+			double cpuStart = benchmarkProcessCpuSeconds();
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			const TransportDatagram *	pDatagrams	= 0;
+			unsigned long				expected	= received + clientCount;
+			while (received < expected)
+			{
+				unsigned int count = TransportReceive(pTransport, pDatagrams);
+				received += count;
+				if (count == 0 && !TransportWait(pTransport, BENCH_UDP_WAIT_MS))
+					break;
+			}
+			recvNs	+= benchmarkElapsedNs(start);
+			recvCpu	+= benchmarkProcessCpuSeconds() - cpuStart;
+		}
+
+		const TransportStats& recvStats = TransportGetStats(pTransport);
+		printf("%s,-,receive,%lu,%lu,%lu,%.1f,%.1f,%llu,%.2f\n", name, clientCount, received, rounds * clientCount - received,
+			received ? recvNs / (double)received : 0.0, received ? recvCpu * 1e9 / (double)received : 0.0,
+			(unsigned long long)recvStats.recvCalls,
+			(double)recvStats.recvDatagrams / (double)(recvStats.recvCalls ? recvStats.recvCalls : 1));
+		fflush(stdout);
+
+		TransportClose(pTransport);
+	}
+
+	for (SocketHandle client : clients)
+		SocketClose(client);
+	SocketCleanup();
+	return 0;
+}
+
+/******************************************************************************/
+/*!
+	Print the bucket counts of every field as the frequency table of
+	SNAPSHOT_CODEC_STATIC, scaled to about BENCH_CODEC_TRAIN_TOTAL with no
+	bucket under 1 so every value stays codable.
+*/
+/******************************************************************************/
+static void benchmarkCodecTable(const uint64_t counts[SNAPSHOT_FIELD_NUM][SNAPSHOT_BUCKET_NUM])
+{
+	static const char * const fieldNames[SNAPSHOT_FIELD_NUM] =
+	{
+		"owner", "id", "position x", "position y", "scale x", "scale y", "velocity x", "velocity y", "direction",
+		"score", "time"
+	};
+
+	fprintf(stderr, "static const uint16_t\tsSnapshotStaticFreq[SNAPSHOT_FIELD_NUM][SNAPSHOT_BUCKET_NUM] =\n{\n");
+	for (unsigned int f = 0; f < SNAPSHOT_FIELD_NUM; f++)
+	{
+		uint64_t total = 0;
+		for (unsigned int b = 0; b < SNAPSHOT_BUCKET_NUM; b++)
+			total += counts[f][b];
+
+		fprintf(stderr, "\t{ ");
+		for (unsigned int b = 0; b < SNAPSHOT_BUCKET_NUM; b++)
+		{
+			uint64_t freq = total ? counts[f][b] * BENCH_CODEC_TRAIN_TOTAL / total : 1;
+			fprintf(stderr, "%llu%s", (unsigned long long)(freq > 0 ? freq : 1), b + 1 < SNAPSHOT_BUCKET_NUM ? "," : "");
+		}
+		fprintf(stderr, " },\t// %s\n", fieldNames[f]);
+	}
+	fprintf(stderr, "};\n");
+}
+
+/******************************************************************************/
+/*!
+	BenchmarkCodec() takes the snapshot slices a server would send at rate
+	from a recorded match, or from a seeded world of the suite with players
+	that hold a new set of buttons every half second, and runs every
+	SNAPSHOT_CODEC over them. Options, all optional, key=value:
+		replay=<file>					match recorded with -record or with the record= of the server, the world of the options otherwise
+		asteroids=200 players=8 seed=2024	the world of the options
+		seconds=60						seconds of the match taken
+		rate=20							snapshots per second, one slice of NET_SNAPSHOT_ASTEROID_MAX each
+		train=on						print the table of SNAPSHOT_CODEC_STATIC trained on the slices to stderr
+		csv=<file>						write the rows there instead of the console
+	The table of SNAPSHOT_CODEC_STATIC is trained with seed=1130 train=on, the
+	default seed is another one so the static row is measured on a match the
+	table has not seen, like a replay= match.
+	A row gives the bytes of the asteroids of a packet and of one asteroid,
+	the saving over raw, the bytes per second a client gets at rate, the
+	fastest of BENCH_SUITE_REPEATS runs of the encode and the decode per
+	asteroid and of the encode of one slice, which the server does once per
+	round and part, and the largest error of a decoded position, scale or
+	velocity and of a direction in degrees. Returns 0, 1 on a bad option or
+	replay, 2 if a codec does not decode what it encoded.
+*/
+/******************************************************************************/
+int BenchmarkCodec(const char * args)
+{
+	std::string		replayPath, csvPath;
+	unsigned long	asteroids	= BENCH_CODEC_ASTEROIDS;
+	unsigned long	players		= BENCH_CODEC_PLAYERS;
+	uint32_t		seed		= BENCH_CODEC_SEED;
+	double			seconds		= BENCH_CODEC_SECONDS;
+	unsigned long	rate		= BENCH_CODEC_RATE;
+	bool			train		= false;
+
+	std::string key, value;
+	while (OptionNext(args, key, value))
+	{
+		bool valid = !value.empty();
+		if (key == "replay")
+			replayPath = value;
+		else if (key == "asteroids")
+			valid = valid && (asteroids = strtoul(value.c_str(), 0, 10)) > 0;
+		else if (key == "players")
+			valid = valid && (players = strtoul(value.c_str(), 0, 10)) > 0;
+		else if (key == "seed")
+			seed = (uint32_t)strtoul(value.c_str(), 0, 10);
+		else if (key == "seconds")
+			valid = valid && (seconds = atof(value.c_str())) > 0.0;
+		else if (key == "rate")
+			valid = valid && (rate = strtoul(value.c_str(), 0, 10)) > 0 && rate <= 60;
+		else if (key == "train")
+		{
+			valid	= value == "on" || value == "off";
+			train	= value == "on";
+		}
+		else if (key == "csv")
+			csvPath = value;
+		else
+			valid = false;
+
+		if (!valid)
+		{
+			fprintf(stderr, "codec: bad option \"%s=%s\"\n", key.c_str(), value.c_str());
+			return 1;
+		}
+	}
+
+	ReplayFile replay;
+	if (!replayPath.empty())
+	{
+		if (!ReplayOpen(replayPath.c_str(), replay))
+		{
+			fprintf(stderr, "codec: cannot read the replay %s\n", replayPath.c_str());
+			return 1;
+		}
+		GameStateAsteroidsSetViewEnabled(false);
+		ReplayBegin(replay);
+	}
+	else
+		benchmarkWorldBegin(asteroids, 0, players, seed);
+
+	// the slices of the match, one after the other, each from where the last one stopped like the server does
+	std::vector<AsteroidData>	slices;
+	std::vector<size_t>			sliceStarts;
+	std::vector<AsteroidData>	world;
+	std::vector<InputCommand>	commands(players);
+	unsigned long				ticks		= (unsigned long)(seconds / BENCH_DT);
+	unsigned long				period		= (unsigned long)(1.0f / BENCH_DT) / rate;
+	size_t						cursor		= 0;
+	float						time		= 0.0f;
+	for (unsigned long tick = 0; tick < ticks; tick++)
+	{
+		if (replayPath.empty())
+		{
+			for (uint32_t player = 0; player < players; player++)
+			{
+				commands[player].player		= player;
+				commands[player].buttons	= (uint8_t)((((uint32_t)(tick / 30) + player) * 2654435761u) >> 27);
+			}
+			GameStateAsteroidsTick(BENCH_DT, commands.data(), (unsigned int)players);
+		}
+		else if (ReplayStep(replay, 1) == 0)
+			break;
+		time += BENCH_DT;
+
+		if (tick % (period ? period : 1) != 0)
+			continue;
+
+		GameStateAsteroidsGetAsteroids(world, time);
+		if (world.empty())
+			continue;
+		size_t count = world.size() < NET_SNAPSHOT_ASTEROID_MAX ? world.size() : NET_SNAPSHOT_ASTEROID_MAX;
+		cursor = cursor < world.size() ? cursor : 0;
+		sliceStarts.push_back(slices.size());
+		for (size_t i = 0; i < count; i++)
+			slices.push_back(world[(cursor + i) % world.size()]);
+		cursor += count;
+	}
+	sliceStarts.push_back(slices.size());
+
+	if (replayPath.empty())
+		benchmarkWorldEnd();
+	else
+	{
+		GameStateAsteroidsFree();
+		GameStateAsteroidsUnload();
+		GameStateAsteroidsSetEndless(false);
+		ReplayClose(replay);
+	}
+
+	size_t sliceCount = sliceStarts.size() - 1;
+	if (sliceCount == 0)
+	{
+		fprintf(stderr, "codec: the match has no asteroids\n");
+		return 1;
+	}
+
+	if (train)
+	{
+		static uint64_t counts[SNAPSHOT_FIELD_NUM][SNAPSHOT_BUCKET_NUM];
+		memset(counts, 0, sizeof(counts));
+		for (size_t s = 0; s < sliceCount; s++)
+			SnapshotCount(&slices[sliceStarts[s]], sliceStarts[s + 1] - sliceStarts[s], counts);
+		benchmarkCodecTable(counts);
+	}
+
+	FILE * pFile = stdout;
+	if (!csvPath.empty())
+	{
+#ifdef _MSC_VER
+		if (fopen_s(&pFile, csvPath.c_str(), "w") != 0)
+			pFile = 0;
+#else
+		pFile = fopen(csvPath.c_str(), "w");
+#endif
+		if (pFile == 0)
+		{
+			fprintf(stderr, "codec: cannot write %s\n", csvPath.c_str());
+			return 1;
+		}
+	}
+
+	fprintf(pFile, "codec,packets,asteroids,bytes_per_packet,bytes_per_asteroid,saving_pct,client_bytes_per_s,"
+		"encode_ns_per_asteroid,decode_ns_per_asteroid,encode_us_per_round,max_error,max_angle_error_deg\n");
+
+	// every coded slice of the match at once, the decode runs on them after the encode
+	std::vector<uint8_t>		coded(sliceCount * PACKET_BUFFER_SIZE);
+	std::vector<size_t>			sizes(sliceCount);
+	std::vector<AsteroidData>	decoded(slices.size());
+	double						rawBytes	= 0.0;
+	int							result		= 0;
+	for (unsigned int c = 0; c < SNAPSHOT_CODEC_NUM; c++)
+	{
+		SNAPSHOT_CODEC	codec		= (SNAPSHOT_CODEC)c;
+		double			encodeNs	= 0.0;
+		double			decodeNs	= 0.0;
+		bool			sound		= true;
+		for (int repeat = 0; repeat < BENCH_SUITE_REPEATS; repeat++)
+		{
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			for (size_t s = 0; s < sliceCount; s++)
+				sizes[s] = SnapshotEncode(codec, &slices[sliceStarts[s]], sliceStarts[s + 1] - sliceStarts[s],
+										  &coded[s * PACKET_BUFFER_SIZE], PACKET_BUFFER_SIZE);
+			double elapsed = benchmarkElapsedNs(start);
+			encodeNs = repeat == 0 || elapsed < encodeNs ? elapsed : encodeNs;
+
+			start = std::chrono::steady_clock::now();
+			for (size_t s = 0; s < sliceCount; s++)
+				sound = SnapshotDecode(codec, &coded[s * PACKET_BUFFER_SIZE], sizes[s], sliceStarts[s + 1] - sliceStarts[s],
+									   &decoded[sliceStarts[s]]) && sound;
+			elapsed = benchmarkElapsedNs(start);
+			decodeNs = repeat == 0 || elapsed < decodeNs ? elapsed : decodeNs;
+		}
+
+		double bytes = 0.0, maxError = 0.0, maxAngle = 0.0;
+		for (size_t s = 0; s < sliceCount; s++)
+			bytes += (double)sizes[s];
+		for (size_t i = 0; i < slices.size(); i++)
+		{
+			const AsteroidData& a = slices[i];
+			const AsteroidData& b = decoded[i];
+			float errors[] =
+			{
+				fabsf(a.position.x - b.position.x), fabsf(a.position.y - b.position.y), fabsf(a.scale.x - b.scale.x),
+				fabsf(a.scale.y - b.scale.y), fabsf(a.velocity.x - b.velocity.x), fabsf(a.velocity.y - b.velocity.y)
+			};
+			for (float error : errors)
+				maxError = error > maxError ? error : maxError;
+
+			double angle = fabs(atan2((double)a.direction.y, (double)a.direction.x) - atan2((double)b.direction.y, (double)b.direction.x));
+			angle = angle > 3.14159265358979 ? 2.0 * 3.14159265358979 - angle : angle;
+			maxAngle = angle > maxAngle ? angle : maxAngle;
+			sound = sound && a.id == b.id && a.owner == b.owner && a.scoreCount == b.scoreCount && a.time == b.time;
+		}
+		if (codec == SNAPSHOT_CODEC_RAW)
+			rawBytes = bytes;
+
+		fprintf(pFile, "%s,%zu,%zu,%.1f,%.2f,%.1f,%.0f,%.1f,%.1f,%.2f,%.4f,%.3f\n", SnapshotCodecName(codec), sliceCount,
+			slices.size(), bytes / (double)sliceCount, bytes / (double)slices.size(), 100.0 * (1.0 - bytes / rawBytes),
+			bytes / (double)sliceCount * (double)rate, encodeNs / (double)slices.size(), decodeNs / (double)slices.size(),
+			encodeNs / (double)sliceCount / 1000.0, maxError, maxAngle * 180.0 / 3.14159265358979);
+		fflush(pFile);
+
+		if (!sound)
+		{
+			fprintf(stderr, "codec: %s does not decode what it encoded\n", SnapshotCodecName(codec));
+			result = 2;
+		}
+	}
+
+	if (pFile != stdout)
+		fclose(pFile);
+	return result;
+}
@@ -0,0 +1,263 @@
+/******************************************************************************/
+/*!
+\file		Broadphase.cpp
+\brief		This file contains the definition of the uniform grid broadphase.
+			Every object is inserted in all the cells its swept box (the box at
+			the start of the frame grown by the motion of the frame) touches.
+			A pair that shares several cells is only tested in the cell holding
+			the min corner of the overlap of the two swept boxes, so each pair
+			is tested once.
+ */
+/******************************************************************************/
+
+#include "Broadphase.h"
+#include "WorkerPool.h"
+#include "Math2D.h"
+
+#include <algorithm>
+#include <math.h>
+
+// ---------------------------------------------------------------------------
+
+// object added to a layer
+struct BroadphaseItem
+{
+	AABB				swept;		// bounding box over the whole frame
+	GameObjInst *		pInst;		// the object
+};
+
+// ---------------------------------------------------------------------------
+// static variables
+
+static AABB									sGridWorld;							// area covered by the grid
+static float								sGridCellSize;						// side of a cell
+static long									sGridCellsX;						// number of columns
+static long									sGridCellsY;						// number of rows
+static float								sGridDt;							// frame time
+
+static std::vector<BroadphaseItem>			sGridItems[BROADPHASE_LAYER_NUM];		// objects of each layer
+static std::vector<unsigned long>			sGridCellStart[BROADPHASE_LAYER_NUM];	// first entry of each cell in sGridCellItems, one extra at the end
+static std::vector<unsigned long>			sGridCellItems[BROADPHASE_LAYER_NUM];	// item indices sorted by cell
+static std::vector<std::vector<CollisionEvent>>	sGridThreadHits;				// hits found by each thread
+
+/******************************************************************************/
+/*!
+	Column or row of a coordinate, clamped to the grid so objects wrapping
+	slightly outside of the world land in the border cells.
+*/
+/******************************************************************************/
+static long BroadphaseCell(float value, float min, long count)
+{
+	long cell = (long)floorf((value - min) / sGridCellSize);
+	return cell < 0 ? 0 : (cell >= count ? count - 1 : cell);
+}
+
+/******************************************************************************/
+/*!
+	Sort the items of a layer by cell: count the entries of every cell, turn the
+	counts into start offsets, then write the item indices.
+*/
+/******************************************************************************/
+static void BroadphaseBuildLayer(unsigned int layer)
+{
+	std::vector<BroadphaseItem>&	items = sGridItems[layer];
+	std::vector<unsigned long>&		start = sGridCellStart[layer];
+	std::vector<unsigned long>&		cells = sGridCellItems[layer];
+
+	start.assign((size_t)(sGridCellsX * sGridCellsY) + 1, 0);
+
+	for (const BroadphaseItem& item : items)
+	{
+		long x0 = BroadphaseCell(item.swept.min.x, sGridWorld.min.x, sGridCellsX);
+		long x1 = BroadphaseCell(item.swept.max.x, sGridWorld.min.x, sGridCellsX);
+		long y0 = BroadphaseCell(item.swept.min.y, sGridWorld.min.y, sGridCellsY);
+		long y1 = BroadphaseCell(item.swept.max.y, sGridWorld.min.y, sGridCellsY);
+
+		for (long y = y0; y <= y1; y++)
+			for (long x = x0; x <= x1; x++)
+				++start[(size_t)(y * sGridCellsX + x) + 1];
+	}
+
+	for (size_t c = 1; c < start.size(); c++)
+		start[c] += start[c - 1];
+
+	cells.resize(start.back());
+
+	// write cursor of every cell, starts at the cell offset
+	std::vector<unsigned long> cursor(start.begin(), start.end() - 1);
+	for (unsigned long i = 0; i < items.size(); i++)
+	{
+		const BroadphaseItem& item = items[i];
+		long x0 = BroadphaseCell(item.swept.min.x, sGridWorld.min.x, sGridCellsX);
+		long x1 = BroadphaseCell(item.swept.max.x, sGridWorld.min.x, sGridCellsX);
+		long y0 = BroadphaseCell(item.swept.min.y, sGridWorld.min.y, sGridCellsY);
+		long y1 = BroadphaseCell(item.swept.max.y, sGridWorld.min.y, sGridCellsY);
+
+		for (long y = y0; y <= y1; y++)
+			for (long x = x0; x <= x1; x++)
+				cells[cursor[(size_t)(y * sGridCellsX + x)]++] = i;
+	}
+}
+
+/******************************************************************************/
+/*!
+	Test the pairs of the cells [cellBegin, cellEnd) and append the hits to hits.
+*/
+/******************************************************************************/
+static void BroadphaseCollideCells(long cellBegin, long cellEnd, std::vector<CollisionEvent>& hits)
+{
+	const std::vector<unsigned long>& targetStart	= sGridCellStart[BROADPHASE_TARGET];
+	const std::vector<unsigned long>& targetCells	= sGridCellItems[BROADPHASE_TARGET];
+	const std::vector<unsigned long>& probeStart	= sGridCellStart[BROADPHASE_PROBE];
+	const std::vector<unsigned long>& probeCells	= sGridCellItems[BROADPHASE_PROBE];
+
+	for (long c = cellBegin; c < cellEnd; c++)
+	{
+		for (unsigned long t = targetStart[c]; t < targetStart[c + 1]; t++)
+		{
+			const BroadphaseItem& target = sGridItems[BROADPHASE_TARGET][targetCells[t]];
+
+			for (unsigned long p = probeStart[c]; p < probeStart[c + 1]; p++)
+			{
+				const BroadphaseItem& probe = sGridItems[BROADPHASE_PROBE][probeCells[p]];
+
+				// the swept boxes must overlap for the objects to meet during the frame
+				if (!AABBOverlap(target.swept, probe.swept))
+					continue;
+
+				// only the cell holding the min corner of the overlap tests the pair
+				float cornerX = target.swept.min.x > probe.swept.min.x ? target.swept.min.x : probe.swept.min.x;
+				float cornerY = target.swept.min.y > probe.swept.min.y ? target.swept.min.y : probe.swept.min.y;
+				long owner = BroadphaseCell(cornerY, sGridWorld.min.y, sGridCellsY) * sGridCellsX +
+							 BroadphaseCell(cornerX, sGridWorld.min.x, sGridCellsX);
+				if (owner != c)
+					continue;
+
+				float Tfirst = 0.0f;
+				if (CollisionIntersection_RectRect(target.pInst->boundingBox, target.pInst->velCurr,
+												   probe.pInst->boundingBox, probe.pInst->velCurr, Tfirst) == true)
+				{
+					CollisionEvent hit = { gameObjInstGetHandle(target.pInst), gameObjInstGetHandle(probe.pInst), Tfirst };
+					hits.push_back(hit);
+				}
+			}
+		}
+	}
+}
+
+/******************************************************************************/
+/*!
+	BroadphaseBegin() empties both layers and sizes the grid so it covers the
+	world with cells of BROADPHASE_CELL_SIZE, or bigger ones if the world would
+	need more than BROADPHASE_CELL_MAX cells.
+*/
+/******************************************************************************/
+void BroadphaseBegin(const AABB& world, float dt)
+{
+	sGridWorld		= world;
+	sGridDt			= dt;
+	sGridCellSize	= BROADPHASE_CELL_SIZE;
+
+	for (;;)
+	{
+		sGridCellsX = (long)ceilf((world.max.x - world.min.x) / sGridCellSize);
+		sGridCellsY = (long)ceilf((world.max.y - world.min.y) / sGridCellSize);
+		sGridCellsX = sGridCellsX > 0 ? sGridCellsX : 1;
+		sGridCellsY = sGridCellsY > 0 ? sGridCellsY : 1;
+
+		if ((unsigned long)(sGridCellsX * sGridCellsY) <= BROADPHASE_CELL_MAX)
+			break;
+		sGridCellSize *= 2.0f;
+	}
+
+	for (unsigned int layer = 0; layer < BROADPHASE_LAYER_NUM; layer++)
+		sGridItems[layer].clear();
+}
+
+/******************************************************************************/
+/*!
+	BroadphaseAdd() adds an object to a layer. Its swept box is the bounding
+	box at the start of the frame grown by velCurr * dt.
+*/
+/******************************************************************************/
+void BroadphaseAdd(BROADPHASE_LAYER layer, GameObjInst * pInst)
+{
+	BroadphaseItem item;
+	item.pInst = pInst;
+	item.swept = AABBSweep(pInst->boundingBox, Vec2Scale(pInst->velCurr, sGridDt));
+
+	sGridItems[layer].push_back(item);
+}
+
+/******************************************************************************/
+/*!
+	BroadphaseCollide() bins both layers in the grid, splits the cells in
+	BROADPHASE_JOBS_PER_THREAD ranges per thread and runs the narrow phase on
+	the worker pool. The hits of every thread are then merged and sorted.
+*/
+/******************************************************************************/
+void BroadphaseCollide(std::vector<CollisionEvent>& hits)
+{
+	hits.clear();
+
+	if (sGridItems[BROADPHASE_TARGET].empty() || sGridItems[BROADPHASE_PROBE].empty())
+		return;
+
+	for (unsigned int layer = 0; layer < BROADPHASE_LAYER_NUM; layer++)
+		BroadphaseBuildLayer(layer);
+
+	unsigned int threadCount = WorkerPoolThreadCount();
+	if (sGridThreadHits.size() < threadCount)
+		sGridThreadHits.resize(threadCount);
+	for (std::vector<CollisionEvent>& threadHits : sGridThreadHits)
+		threadHits.clear();
+
+	long cellCount	= sGridCellsX * sGridCellsY;
+	long jobCount	= (long)(threadCount * BROADPHASE_JOBS_PER_THREAD);
+	jobCount = jobCount < cellCount ? jobCount : cellCount;
+
+	WorkerPoolRun((unsigned int)jobCount, [&](unsigned int jobIndex, unsigned int threadIndex)
+	{
+		long cellBegin	= cellCount * (long)jobIndex / jobCount;
+		long cellEnd	= cellCount * ((long)jobIndex + 1) / jobCount;
+		BroadphaseCollideCells(cellBegin, cellEnd, sGridThreadHits[threadIndex]);
+	});
+
+	for (const std::vector<CollisionEvent>& threadHits : sGridThreadHits)
+		hits.insert(hits.end(), threadHits.begin(), threadHits.end());
+
+	// which thread found a hit depends on scheduling, the sorted list does not
+	std::sort(hits.begin(), hits.end(), CollisionEventLess);
+}
+
+/******************************************************************************/
+/*!
+	BroadphaseFree() releases the memory of the grid.
+*/
+/******************************************************************************/
+void BroadphaseFree()
+{
+	for (unsigned int layer = 0; layer < BROADPHASE_LAYER_NUM; layer++)
+	{
+		std::vector<BroadphaseItem>().swap(sGridItems[layer]);
+		std::vector<unsigned long>().swap(sGridCellStart[layer]);
+		std::vector<unsigned long>().swap(sGridCellItems[layer]);
+	}
+	std::vector<std::vector<CollisionEvent>>().swap(sGridThreadHits);
+}
+
+/******************************************************************************/
+/*!
+	CollisionEventLess() orders the hits by time of collision, then by the slot
+	of the target, then by the slot of the probe. Every pair is found once so
+	this is a total order.
+*/
+/******************************************************************************/
+bool CollisionEventLess(const CollisionEvent& a, const CollisionEvent& b)
+{
+	if (a.tFirst != b.tFirst)
+		return a.tFirst < b.tFirst;
+	if ((a.target & GAME_OBJ_HANDLE_INDEX_MASK) != (b.target & GAME_OBJ_HANDLE_INDEX_MASK))
+		return (a.target & GAME_OBJ_HANDLE_INDEX_MASK) < (b.target & GAME_OBJ_HANDLE_INDEX_MASK);
+	return (a.probe & GAME_OBJ_HANDLE_INDEX_MASK) < (b.probe & GAME_OBJ_HANDLE_INDEX_MASK);
+}
@@ -14,7 +14,7 @@ prior written consent of DigiPen Institute of Technology is prohibited.
  */
 /******************************************************************************/
 
-#include "main.h"
+#include "Main.h"
 
 /**************************************************************************/
 /*!
@@ -77,7 +77,7 @@ bool CollisionIntersection_RectRect(const AABB & aabb1,          //Input
 		// step2...
 		// assign initial value for both tFirst and tLast
 		firstTimeOfCollision = 0;
-		tLast = (float)AEFrameRateControllerGetFrameTime();
+		tLast = g_dt; // frame time of the tick, the same when the tick is replayed
 		// calculate the relative velocity
 		AEVec2 Vrel = { 0,0 };
 		Vrel.x = (vel2.x - vel1.x);
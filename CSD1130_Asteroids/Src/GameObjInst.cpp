@@ -0,0 +1,182 @@
+/******************************************************************************/
+/*!
+\file		GameObjInst.cpp
+\brief		This file contains the definition of the chunked game object instance
+			storage. Free slots are kept in a stack so allocating and releasing an
+			instance is O(1) no matter how many instances are alive.
+ */
+/******************************************************************************/
+
+#include "GameObjInst.h"
+#include "Log.h"
+
+// ---------------------------------------------------------------------------
+// globals
+
+std::vector<GameObjInst *>		gGameObjInstChunks;
+
+// ---------------------------------------------------------------------------
+// static variables
+
+static std::vector<unsigned long>	sGameObjInstFree;			// indices of the unused slots, the next one to use is at the back
+static unsigned long				sGameObjInstCount;			// number of live instances
+static bool							sGameObjInstFullReported;	// the "storage full" message is printed only once
+
+/******************************************************************************/
+/*!
+	Allocate one more chunk and push its slots on the free stack, lowest index
+	on top. Return false if GAME_OBJ_INST_CHUNK_MAX chunks are already in use.
+*/
+/******************************************************************************/
+static bool gameObjInstStorageGrow()
+{
+	if (gGameObjInstChunks.size() >= GAME_OBJ_INST_CHUNK_MAX)
+		return false;
+
+	unsigned long first = gameObjInstStorageSize();
+	GameObjInst * pChunk = new GameObjInst[GAME_OBJ_INST_CHUNK_SIZE]{};
+
+	for (unsigned long i = 0; i < GAME_OBJ_INST_CHUNK_SIZE; i++)
+	{
+		pChunk[i].index			= first + i;
+		pChunk[i].generation	= 1;
+	}
+
+	gGameObjInstChunks.push_back(pChunk);
+
+	sGameObjInstFree.reserve(sGameObjInstFree.size() + GAME_OBJ_INST_CHUNK_SIZE);
+	for (unsigned long i = GAME_OBJ_INST_CHUNK_SIZE; i > 0; i--)
+		sGameObjInstFree.push_back(first + i - 1);
+
+	return true;
+}
+
+/******************************************************************************/
+/*!
+	gameObjInstStorageInit() drops all the chunks so the storage starts empty.
+*/
+/******************************************************************************/
+void gameObjInstStorageInit()
+{
+	gameObjInstStorageFree();
+}
+
+/******************************************************************************/
+/*!
+	gameObjInstStorageFree() releases the memory of every chunk.
+*/
+/******************************************************************************/
+void gameObjInstStorageFree()
+{
+	for (GameObjInst * pChunk : gGameObjInstChunks)
+		delete[] pChunk;
+
+	gGameObjInstChunks.clear();
+	sGameObjInstFree.clear();
+	sGameObjInstCount			= 0;
+	sGameObjInstFullReported	= false;
+}
+
+/******************************************************************************/
+/*!
+	gameObjInstStorageAlloc() returns an unused slot. The storage grows by one
+	chunk when there is no free slot left. The slot is marked FLAG_ACTIVE, the
+	rest of the instance is left for the caller to fill.
+*/
+/******************************************************************************/
+GameObjInst * gameObjInstStorageAlloc()
+{
+	if (sGameObjInstFree.empty() && !gameObjInstStorageGrow())
+	{
+		// cannot grow anymore => report it once and return 0
+		if (!sGameObjInstFullReported)
+		{
+			LogWrite(LOG_WARN, "storage_full", { LogInt("instances", (int64_t)GAME_OBJ_INST_NUM_MAX) });
+			sGameObjInstFullReported = true;
+		}
+		return 0;
+	}
+
+	unsigned long index = sGameObjInstFree.back();
+	sGameObjInstFree.pop_back();
+	++sGameObjInstCount;
+
+	GameObjInst * pInst = gameObjInstStorageAt(index);
+	pInst->flag = FLAG_ACTIVE;
+
+	return pInst;
+}
+
+/******************************************************************************/
+/*!
+	gameObjInstStorageRelease() gives the slot back. The generation is bumped so
+	any reference taken before the release no longer resolves to this slot.
+*/
+/******************************************************************************/
+void gameObjInstStorageRelease(GameObjInst * pInst)
+{
+	// if instance is released before, just return
+	if (pInst->flag == 0)
+		return;
+
+	pInst->flag = 0;
+	--sGameObjInstCount;
+
+	// wrap the generation inside the handle bits, skipping 0 so GAME_OBJ_HANDLE_NONE never resolves
+	pInst->generation = (pInst->generation + 1) & GAME_OBJ_HANDLE_GENERATION_MASK;
+	if (pInst->generation == 0)
+		pInst->generation = 1;
+
+	sGameObjInstFree.push_back(pInst->index);
+}
+
+/******************************************************************************/
+/*!
+	gameObjInstStorageCount() returns the number of live instances.
+*/
+/******************************************************************************/
+unsigned long gameObjInstStorageCount()
+{
+	return sGameObjInstCount;
+}
+
+/******************************************************************************/
+/*!
+	gameObjInstStorageFreeList() returns the stack of unused slots.
+*/
+/******************************************************************************/
+const std::vector<unsigned long>& gameObjInstStorageFreeList()
+{
+	return sGameObjInstFree;
+}
+
+/******************************************************************************/
+/*!
+	gameObjInstStorageRestore() reallocates chunkCount chunks and replaces the
+	free stack, so the slots are taken in the same order as in the saved
+	storage. Every slot not in freeList is counted as live. Returns false if
+	the layout does not fit the storage.
+*/
+/******************************************************************************/
+bool gameObjInstStorageRestore(unsigned long chunkCount, const std::vector<unsigned long>& freeList)
+{
+	gameObjInstStorageFree();
+
+	if (chunkCount > GAME_OBJ_INST_CHUNK_MAX)
+		return false;
+	for (unsigned long c = 0; c < chunkCount; c++)
+		gameObjInstStorageGrow();
+
+	unsigned long size = gameObjInstStorageSize();
+	if (freeList.size() > size)
+		return false;
+	for (unsigned long index : freeList)
+	{
+		if (index >= size)
+			return false;
+	}
+
+	sGameObjInstFree	= freeList;
+	sGameObjInstCount	= size - (unsigned long)freeList.size();
+	return true;
+}
@@ -4,19 +4,37 @@
 \author 	Cheong Jia Zen, jiazen.c, 2301549
 \par    	jiazen.c@digipen.edu
 \date   	February 06, 2024
-\brief		This file contains the definition of 11 functions needed for 
+\brief		This file contains the definition of 29 functions needed for 
 			state GS-ASTEROID. They are:
 			GameStateAsteroidsLoad();
 			GameStateAsteroidsInit();
 			GameStateAsteroidsUpdate();	
+			GameStateAsteroidsTick();
 			GameStateAsteroidsDraw();
 			GameStateAsteroidsFree();
 			GameStateAsteroidsUnload();
 			gameObjInstCreate ();
 			gameObjInstDestroy();
+			gameObjInstQueueCreate();
+			gameObjInstQueueDestroy();
+			gameObjInstApplyQueues();
 			Helper_Wall_Collision();
+			Helper_Build_View_Transforms();
 			Random_value_Generator();
 			Random_number_asteroid_generator();
+			GameStateAsteroidsSetWorldSize();
+			GameStateAsteroidsSetViewEnabled();
+			GameStateAsteroidsSetSeed();
+			GameStateAsteroidsSetRecordPath();
+			GameStateAsteroidsPlayerJoin();
+			GameStateAsteroidsPlayerLeave();
+			GameStateAsteroidsChecksum();
+			GameStateAsteroidsSaveKeyframe();
+			GameStateAsteroidsLoadKeyframe();
+			GameStateAsteroidsSetEndless();
+			GameStateAsteroidsPopulate();
+			GameStateAsteroidsGetAsteroids();
+			gameStateAsteroidsApplyCommand();
 			
 Copyright (C) 2024 DigiPen Institute of Technology.
 Reproduction or disclosure of this file or its contents without the
@@ -24,9 +42,23 @@ prior written consent of DigiPen Institute of Technology is prohibited.
  */
 /******************************************************************************/
 
-#include "main.h"
+#include "Main.h"
+#include "GameObjInst.h"
+#include "Math2D.h"
+#include "Broadphase.h"
+#include "WorkerPool.h"
+#include "Random.h"
+#include "Replay.h"
+#include "AsteroidData.h"
+#include "Scoreboard.h"
+#include "Log.h"
+#include "Metrics.h"
+#include <algorithm>
 #include <stdlib.h>
+#include <string>
 #include <time.h>
+#include <unordered_map>
+#include <vector>
 /******************************************************************************/
 /*!
 	Defines
@@ -34,7 +66,6 @@ prior written consent of DigiPen Institute of Technology is prohibited.
 /******************************************************************************/
 // all the variable needed goes here...
 const unsigned int	GAME_OBJ_NUM_MAX		= 32;			// The total number of different objects (Shapes)
-const unsigned int	GAME_OBJ_INST_NUM_MAX	= 2048;			// The total number of different game object instances
 
 
 const unsigned int	SHIP_INITIAL_NUM		= 3;			// initial number of ship lives
@@ -58,6 +89,12 @@ const float			BULLET_SPEED			= 400.0f;		// bullet speed (m/s)
 
 const float         BOUNDING_RECT_SIZE      = 1.0f;         // this is the normalized bounding rectangle (width and height) sizes - AABB collision data
 
+const float			WORLD_DEFAULT_WIDTH		= 800.0f;		// default world width, same as the debug window
+const float			WORLD_DEFAULT_HEIGHT	= 600.0f;		// default world height, same as the debug window
+
+const uint32_t		GAME_LOCAL_PLAYER		= 0;			// player of the keyboard, its ship starts at the origin
+const unsigned long	GAME_WIN_SCORE			= 5000;			// score that wins the match
+
 static bool			onValueChange			= false;
 
 // -----------------------------------------------------------------------------
@@ -72,44 +109,31 @@ enum TYPE
 	TYPE_NUM
 };
 
-// -----------------------------------------------------------------------------
-// object flag definition
-
-const unsigned long FLAG_ACTIVE				= 0x00000001;
-
 /******************************************************************************/
 /*!
 	Struct/Class Definitions
 */
 /******************************************************************************/
 
-//Game object structure
-struct GameObj
+// game object instance waiting to be created
+struct GameObjSpawn
 {
 	unsigned long		type;		// object type
-	AEGfxVertexList *	pMesh;		// This will hold the triangles which will form the shape of the object
+	AEVec2				scale;		// scaling value of the object instance
+	AEVec2				pos;		// object position
+	AEVec2				vel;		// object velocity
+	float				dir;		// object direction
 };
 
-// ---------------------------------------------------------------------------
-
-//Game object instance structure
-struct GameObjInst
+// player of the match
+struct GamePlayer
 {
-	GameObj *			pObject;	// pointer to the 'original' shape
-	unsigned long		flag;		// bit flag or-ed together
-	AEVec2				scale;		// scaling value of the object instance
-	AEVec2				posCurr;	// object current position
-
-	AEVec2				posPrev;	// object previous position -> it's the position calculated in the previous loop
-
-	AEVec2				velCurr;	// object current velocity
-	float				dirCurr;	// object current direction
-	AABB				boundingBox;// object bouding box that encapsulates the object
-	AEMtx33				transform;	// object transformation matrix: Each frame, 
-									// calculate the object instance's transformation matrix and save it here
-
+	uint32_t			player;		// player id of the input commands
+	GameObjHandle		ship;		// handle of its ship
 };
 
+// ---------------------------------------------------------------------------
+
 /******************************************************************************/
 /*!
 	Static Variables
@@ -120,34 +144,85 @@ struct GameObjInst
 static GameObj				sGameObjList[GAME_OBJ_NUM_MAX];				// Each element in this array represents a unique game object (shape)
 static unsigned long		sGameObjNum;								// The number of defined game objects
 
-// list of object instances
-static GameObjInst			sGameObjInstList[GAME_OBJ_INST_NUM_MAX];	// Each element in this array represents a unique game object instance (sprite)
-static unsigned long		sGameObjInstNum;							// The number of used game object instances
-
-// pointer to the ship object
-static GameObjInst *		spShip;										// Pointer to the "Ship" game object instance
+// object instances live in the chunked storage, see GameObjInst.h
 
-// pointer to the wall object
-static GameObjInst *		spWall;										// Pointer to the "Wall" game object instance
+// handle of the wall object
+static GameObjHandle		sWallHandle;								// Handle of the "Wall" game object instance
 
-// number of ship available (lives 0 = game over)
+// number of ship available (lives 0 = game over), shared by every ship of the match
 static long					sShipLives;									// The number of lives left
 
-// the score = number of asteroid destroyed
+// the score = number of asteroid destroyed, by every player together
 static unsigned long		sScore;										// Current score
 
+// world bounds, centered on the origin and independent of the window size
+static AABB					sWorldBounds = { { -WORLD_DEFAULT_WIDTH / 2.0f, -WORLD_DEFAULT_HEIGHT / 2.0f },
+											 {  WORLD_DEFAULT_WIDTH / 2.0f,  WORLD_DEFAULT_HEIGHT / 2.0f } };
+
+// scale applied when drawing so the whole world fits in the debug window
+static float				sViewScale = 1.0f;
+
+// the view stage (transforms + drawing) only runs when enabled, a headless server skips it
+static bool					sViewEnabled = true;
+
+// transform of every slot of the instance storage, only valid for active instances after the view stage
+static std::vector<AEMtx33>	sViewTransforms;
+
+// hits found during the dynamic-dynamic collision pass
+static std::vector<CollisionEvent>	sCollisionEvents;
+
+// command buffers applied at the end of the collision pass
+static std::vector<GameObjHandle>	sDestroyQueue;						// instances to destroy
+static std::vector<GameObjSpawn>	sSpawnQueue;						// instances to create
+
+// every random number of the match comes from this generator
+static RandomState			sRandom;									// generator of the match
+static uint32_t				sRandomSeed;								// seed of the next match
+static bool					sRandomSeedSet;								// false: seed the next match from the clock
+
+// players whose input commands are applied, each one flies its own ship
+static std::vector<GamePlayer>				sPlayers;
+static std::unordered_map<uint32_t, size_t>	sPlayerIndex;				// index in sPlayers of every player
+
+// players credited by the hits of the current tick, a SCORE event is sent to each
+static std::vector<uint32_t>	sScoredPlayers;
+
+// the match is recorded to this file when not empty
+static std::string			sRecordPath;
+
+// the win condition was met, everything stops like at game over
+static bool					sGameWon;
+
+// keyframe of the recording, kept to reuse its memory
+static std::vector<uint8_t>	sKeyframe;
+
+// the ship is never lost and the match never won, the world runs until it is freed
+static bool					sEndless;
+
+// events of the last tick, for the server
+static std::vector<GameEvent>	sEvents;
+
 // ---------------------------------------------------------------------------
 
 // functions to create/destroy a game object instance
 GameObjInst *		gameObjInstCreate (unsigned long type, AEVec2* scale,
 											   AEVec2 * pPos, AEVec2 * pVel, float dir);
 void				gameObjInstDestroy(GameObjInst * pInst);
+// deferred versions, applied by gameObjInstApplyQueues()
+void				gameObjInstQueueCreate(unsigned long type, AEVec2* scale,
+											   AEVec2 * pPos, AEVec2 * pVel, float dir);
+void				gameObjInstQueueDestroy(GameObjInst * pInst);
+void				gameObjInstApplyQueues();
 // helper function for wall collision
 void				Helper_Wall_Collision();
+// view stage, compute the transform of every active instance
+void				Helper_Build_View_Transforms();
 // random generator for number and for asteroid scale, position, velocity
 void				Random_value_Generator(AEVec2& scale, AEVec2& pPos, AEVec2& pVel);
 
 void				Random_number_asteroid_generator(int& number);
+// apply the input command of a player to its ship
+void				gameStateAsteroidsApplyCommand(GameObjInst * spShip, const InputCommand& command, float dt);
 
 /******************************************************************************/
 /*!
@@ -169,17 +244,31 @@ void GameStateAsteroidsLoad(void)
 	// No game objects (shapes) at this point
 	sGameObjNum = 0;
 
-	// zero the game object instance array
-	memset(sGameObjInstList, 0, sizeof(GameObjInst) * GAME_OBJ_INST_NUM_MAX);
+	// empty the game object instance storage
 	// No game object instances (sprites) at this point
-	sGameObjInstNum = 0;
+	gameObjInstStorageInit();
+
+	// start the threads used by the collision pass, one per core
+	WorkerPoolInit(0);
 
-	// The ship object instance hasn't been created yet, so this "spShip" pointer is initialized to 0
-	spShip = nullptr;
+	// no player and so no ship yet, PlayerJoin() creates them
+	sPlayers.clear();
+	sPlayerIndex.clear();
 
 	// load/create the mesh data (game objects / Shapes)
 	GameObj * pObj;
 
+	// a headless server has no graphics system, the objects are created without a mesh
+	if (!sViewEnabled)
+	{
+		for (unsigned long type = 0; type < TYPE_NUM; type++)
+		{
+			pObj		= sGameObjList + sGameObjNum++;
+			pObj->type	= type;
+		}
+		return;
+	}
+
 	// =====================
 	// create the ship shape
 	// =====================
@@ -273,50 +362,64 @@ void GameStateAsteroidsLoad(void)
 /******************************************************************************/
 void GameStateAsteroidsInit(void)
 {
-	// create the main ship
-	AEVec2 scale;
-	AEVec2Set(&scale, SHIP_SCALE_X, SHIP_SCALE_Y);
-	spShip = gameObjInstCreate(TYPE_SHIP, &scale, nullptr, nullptr, 0.0f);
-	AE_ASSERT(spShip);
+	// seed the match, from the clock unless a seed was given
+	if (!sRandomSeedSet)
+		sRandomSeed = (uint32_t)time(NULL);
+	RandomSeed(sRandom, sRandomSeed);
+
+	// record the match, the join of the local player below is the first event
+	if (!sRecordPath.empty() &&
+		ReplayRecordStart(sRecordPath.c_str(), sRandomSeed, sWorldBounds.max.x - sWorldBounds.min.x, sWorldBounds.max.y - sWorldBounds.min.y, sEndless))
+	{
+		printf("Recording to %s (seed %u)\n", sRecordPath.c_str(), sRandomSeed);
+	}
+
+	// the keyboard player is always in the match, its ship is the first object
+	sPlayers.clear();
+	sPlayerIndex.clear();
+	ScoreboardInit();
+	GameStateAsteroidsPlayerJoin(GAME_LOCAL_PLAYER);
 
-	
 	// create the initial 4 asteroids instances using the "gameObjInstCreate" function
+	AEVec2 scale;
 	AEVec2 pos = { 0,0 }, vel = { 0,0 };
 
 	//Asteroid 1
 	pos.x = 90.0f;		pos.y = -220.0f;
 	vel.x = -60.0f;		vel.y = -30.0f;
-	AEVec2Set(&scale, ASTEROID_MIN_SCALE_X, ASTEROID_MAX_SCALE_Y);
+	scale = Vec2Make(ASTEROID_MIN_SCALE_X, ASTEROID_MAX_SCALE_Y);
 	gameObjInstCreate(TYPE_ASTEROID, &scale, &pos, &vel, 0.0f);
 
 	//Asteroid 2
 	pos.x = -260.0f;	pos.y = -250.0f;
 	vel.x = 39.0f;		vel.y = -130.0f;
-	AEVec2Set(&scale, ASTEROID_MAX_SCALE_X, ASTEROID_MIN_SCALE_Y);
+	scale = Vec2Make(ASTEROID_MAX_SCALE_X, ASTEROID_MIN_SCALE_Y);
 	gameObjInstCreate(TYPE_ASTEROID, &scale, &pos, &vel, 0.0f);
 
 	//Asteroid 3
 	pos.x = -90.0f;		pos.y = 220.0f;
 	vel.x = 60.0f;		vel.y = 30.0f;
-	AEVec2Set(&scale, ASTEROID_MAX_SCALE_X, ASTEROID_MAX_SCALE_Y);
+	scale = Vec2Make(ASTEROID_MAX_SCALE_X, ASTEROID_MAX_SCALE_Y);
 	gameObjInstCreate(TYPE_ASTEROID, &scale, &pos, &vel, 0.0f);
 	//Asteroid 4
 	pos.x = 260.0f;		pos.y = 250.0f;
 	vel.x = -39.0f;		vel.y = 130.0f;
-	AEVec2Set(&scale, ASTEROID_MIN_SCALE_X, ASTEROID_MIN_SCALE_Y);
+	scale = Vec2Make(ASTEROID_MIN_SCALE_X, ASTEROID_MIN_SCALE_Y);
 	gameObjInstCreate(TYPE_ASTEROID, &scale, &pos, &vel, 0.0f);
 
 	// create the static wall
-	AEVec2Set(&scale, WALL_SCALE_X, WALL_SCALE_Y);
+	scale = Vec2Make(WALL_SCALE_X, WALL_SCALE_Y);
 	AEVec2 position;
-	AEVec2Set(&position, 300.0f, 150.0f);
-	spWall = gameObjInstCreate(TYPE_WALL, &scale, &position, nullptr, 0.0f);
+	position = Vec2Make(300.0f, 150.0f);
+	GameObjInst * spWall = gameObjInstCreate(TYPE_WALL, &scale, &position, nullptr, 0.0f);
 	AE_ASSERT(spWall);
+	sWallHandle = gameObjInstGetHandle(spWall);
 
 
 	// reset the score and the number of ships
 	sScore      = 0;
 	sShipLives  = SHIP_INITIAL_NUM;
+	sGameWon	= false;
 }
 
 /******************************************************************************/
@@ -326,87 +429,68 @@ void GameStateAsteroidsInit(void)
 /******************************************************************************/
 /******************************************************************************/
 /*!
-	Function GameStateAsteroidsUpdate() will update all the object behavior
-	according to the input by user, such as checking collision, key triggered,
-	update position, save position, update matrix of objects, wrap objects etc.
+	Function GameStateAsteroidsUpdate() reads the keyboard into the input
+	command of the local player and runs one tick of the simulation with it.
 */
 /******************************************************************************/
 void GameStateAsteroidsUpdate(void)
 {
-	// =========================================================
-	// update according to input
-	// =========================================================
+	InputCommand command = { GAME_LOCAL_PLAYER, 0 };
+	if (AEInputCheckCurr(AEVK_UP))
+		command.buttons |= INPUT_FORWARD;
+	if (AEInputCheckCurr(AEVK_DOWN))
+		command.buttons |= INPUT_BACKWARD;
+	if (AEInputCheckCurr(AEVK_LEFT))
+		command.buttons |= INPUT_LEFT;
+	if (AEInputCheckCurr(AEVK_RIGHT))
+		command.buttons |= INPUT_RIGHT;
+	if (AEInputCheckTriggered(AEVK_SPACE))
+		command.buttons |= INPUT_FIRE;
+
+	GameStateAsteroidsTick(g_dt, &command, 1);
+}
 
-	// This input handling moves the ship without any velocity nor acceleration
-	// It should be changed when implementing the Asteroids project
-	//
-	// Updating the velocity and position according to acceleration is 
-	// done by using the following:
-	// Pos1 = 1/2 * a*t*t + v0*t + Pos0
-	//
-	// In our case we need to divide the previous equation into two parts in order 
-	// to have control over the velocity and that is done by:
-	//
-	// v1 = a*t + v0		//This is done when the UP or DOWN key is pressed 
-	// Pos1 = v1*t + Pos0
-	srand((unsigned int)time(NULL));
-	if (AEInputCheckCurr(AEVK_UP) && sShipLives >= 0)
+/******************************************************************************/
+/*!
+	Function GameStateAsteroidsTick() will update all the object behavior
+	according to the input commands, such as checking collision, save position,
+	wrap objects etc. It only depends on dt, the commands and the state, so the
+	same inputs replayed from the same seed give the same match. The
+	transformation matrices are computed by the view stage in
+	GameStateAsteroidsDraw().
+*/
+/******************************************************************************/
+void GameStateAsteroidsTick(float dt, const InputCommand * pCommands, unsigned int commandCount)
+{
+	// the recording holds exactly what the simulation is given, and now and then the whole world before it
+	if (ReplayRecordKeyframeDue())
 	{
-		AEVec2 added;
-		AEVec2Set(&added, cosf(spShip->dirCurr), sinf(spShip->dirCurr));
-		//AEVec2Add(&spShip->posCurr, &spShip->posCurr, &added);//YOU MAY NEED TO CHANGE/REPLACE THIS LINE
-
-		// Find the velocity according to the acceleration
-		
-		//AEVec2Add(&spShip->velCurr, &spShip->velCurr, &added);
-		AEVec2Scale(&added, &added, SHIP_ACCEL_FORWARD * (float) AEFrameRateControllerGetFrameTime());
-		AEVec2Add(&added, &added, &spShip->velCurr);
-		// Limit your speed over here
-		AEVec2Set(&spShip->velCurr, added.x, added.y);
-		spShip->velCurr.x = spShip->velCurr.x * 0.99f;
-		spShip->velCurr.y = spShip->velCurr.y * 0.99f;
+		GameStateAsteroidsSaveKeyframe(sKeyframe);
+		ReplayRecordKeyframe(sKeyframe);
 	}
+	ReplayRecordTick(dt, pCommands, commandCount);
 
-	if (AEInputCheckCurr(AEVK_DOWN) && sShipLives >= 0)
-	{
-		AEVec2 added;
-		AEVec2Set(&added, -cosf(spShip->dirCurr), -sinf(spShip->dirCurr));
-		// AEVec2Add(&spShip->posCurr, &spShip->posCurr, &added);//YOU MAY NEED TO CHANGE/REPLACE THIS LINE
+	// frame time of this tick, also read by the collision test
+	g_dt = dt;
 
-		// Find the velocity according to the decceleration
-		AEVec2Scale(&added, &added, SHIP_ACCEL_BACKWARD * (float) AEFrameRateControllerGetFrameTime());
-		AEVec2Add(&added, &added, &spShip->velCurr);
-		// Limit your speed over here
-		AEVec2Set(&spShip->velCurr, added.x, added.y);
-		spShip->velCurr.x = spShip->velCurr.x * 0.99f;
-		spShip->velCurr.y = spShip->velCurr.y * 0.99f;
-	}
-
-	if (AEInputCheckCurr(AEVK_LEFT) && sShipLives >= 0)
-	{
-		spShip->dirCurr += SHIP_ROT_SPEED * (float)(AEFrameRateControllerGetFrameTime ());
-		spShip->dirCurr =  AEWrap(spShip->dirCurr, -PI, PI);
-	}
+	sEvents.clear();
+	sScoredPlayers.clear();
+	const bool			overBefore	= sShipLives < 0;
 
-	if (AEInputCheckCurr(AEVK_RIGHT) && sShipLives >= 0)
+	// =========================================================
+	// update according to input
+	// =========================================================
+	for (unsigned int c = 0; c < commandCount; c++)
 	{
-		spShip->dirCurr -= SHIP_ROT_SPEED * (float)(AEFrameRateControllerGetFrameTime ());
-		spShip->dirCurr =  AEWrap(spShip->dirCurr, -PI, PI);
-	}
-
+		// commands of players that are not in the match are dropped
+		std::unordered_map<uint32_t, size_t>::const_iterator it = sPlayerIndex.find(pCommands[c].player);
+		if (it == sPlayerIndex.end())
+			continue;
 
-	// Shoot a bullet if space is triggered (Create a new object instance)
-	if (AEInputCheckTriggered(AEVK_SPACE) && sShipLives >= 0)
-	{
-		AEVec2 added_vel = { 0,0 };
-		AEVec2 scale;
-		// Get the bullet's direction according to the ship's direction	
-		AEVec2Set(&added_vel, cosf(spShip->dirCurr), sinf(spShip->dirCurr));
-		// Set the velocity
-		AEVec2Scale(&added_vel, &added_vel, (BULLET_SPEED));
-		// Create an instance, based on BULLET_SCALE_X and BULLET_SCALE_Y
-		AEVec2Set(&scale, BULLET_SCALE_X, BULLET_SCALE_Y);
-		gameObjInstCreate(TYPE_BULLET, &scale, &spShip->posCurr, &added_vel, spShip->dirCurr);
+		// resolve the ship handle, the pointer is only kept for this command
+		GameObjInst * spShip = gameObjInstStorageFind(sPlayers[it->second].ship);
+		if (spShip)
+			gameStateAsteroidsApplyCommand(spShip, pCommands[c], dt);
 	}
 
 	// ======================================================================
@@ -414,16 +498,15 @@ void GameStateAsteroidsUpdate(void)
 	//  -- For all instances
 	// [DO NOT UPDATE THIS PARAGRAPH'S CODE]
 	// ======================================================================
-	for (unsigned long i = 0; i < GAME_OBJ_INST_NUM_MAX; i++)
+	for (unsigned long i = 0; i < gameObjInstStorageSize(); i++)
 	{
-		GameObjInst* pInst = sGameObjInstList + i;
+		GameObjInst* pInst = gameObjInstStorageAt(i);
 
 		// skip non-active object
 		if ((pInst->flag & FLAG_ACTIVE) == 0)
 			continue;
 
-		pInst->posPrev.x = pInst->posCurr.x;
-		pInst->posPrev.y = pInst->posCurr.y;
+		pInst->posPrev = pInst->posCurr;
 	}
 
 	// ======================================================================
@@ -434,19 +517,15 @@ void GameStateAsteroidsUpdate(void)
 	//
 	//	-- New position of the active instance is updated here with the velocity calculated earlier
 	// ======================================================================
-	for (unsigned long i = 0; i < GAME_OBJ_INST_NUM_MAX; i++)
+	for (unsigned long i = 0; i < gameObjInstStorageSize(); i++)
 	{
-		GameObjInst* pInst = sGameObjInstList + i;
+		GameObjInst* pInst = gameObjInstStorageAt(i);
 
 		// skip non-active object
 		if ((pInst->flag & FLAG_ACTIVE) == 0)
 			continue;
-		pInst->boundingBox.min.x = -(BOUNDING_RECT_SIZE / 2.0f) * pInst->scale.x + pInst->posPrev.x;
-		pInst->boundingBox.max.x = +(BOUNDING_RECT_SIZE / 2.0f) * pInst->scale.x + pInst->posPrev.x;
-		pInst->boundingBox.min.y = -(BOUNDING_RECT_SIZE / 2.0f) * pInst->scale.y + pInst->posPrev.y;
-		pInst->boundingBox.max.y = +(BOUNDING_RECT_SIZE / 2.0f) * pInst->scale.y + pInst->posPrev.y;
-		pInst->posCurr.x += pInst->velCurr.x * (float)AEFrameRateControllerGetFrameTime();
-		pInst->posCurr.y += pInst->velCurr.y * (float)AEFrameRateControllerGetFrameTime();
+		pInst->boundingBox = AABBFromCenter(pInst->posPrev, Vec2Scale(pInst->scale, BOUNDING_RECT_SIZE));
+		pInst->posCurr = Vec2ScaleAdd(pInst->posCurr, pInst->velCurr, dt);
 	}
 
 
@@ -459,6 +538,9 @@ void GameStateAsteroidsUpdate(void)
 
 	// ======================================================================
 	// check for dynamic-dynamic collisions
+	//  -- Detect: collect every asteroid vs ship/bullet hit, nothing is modified
+	//  -- Resolve: walk the hits in a fixed order and queue the destroys/spawns
+	//  -- Apply the queues at one sync point, after the whole pass
 	// ======================================================================
 
 	// psuedocode...
@@ -468,93 +550,111 @@ void GameStateAsteroidsUpdate(void)
 			skip
 
 		if oi1 is an asteroid
-			for each object instance oi2
-				if(oi2 is not active or oi2 is an asteroid)
-					skip
-
-				if(oi2 is the ship)
-					Check for collision between ship and asteroids (Rectangle - Rectangle)
-					Update game behavior accordingly
-					Update "Object instances array"
-				else
-				if(oi2 is a bullet)
-					Check for collision between bullet and asteroids (Rectangle - Rectangle)
-					Update game behavior accordingly
-					Update "Object instances array"
+			add oi1 to the target layer of the broadphase
+		else if oi1 is a ship or a bullet
+			add oi1 to the probe layer of the broadphase
+
+	the broadphase tests every asteroid vs ship/bullet pair sharing a grid cell
+	(Rectangle - Rectangle) on the worker threads and returns the hits sorted by
+	time of collision, then by slot
+
+	for each hit
+		if the asteroid or the bullet is already queued for destruction
+			skip
+		Update game behavior accordingly
+		Queue the destroys and the spawns
+
+	Apply the queues
 	*/
 	// implementation...
-	for (unsigned long i = 0; i < GAME_OBJ_INST_NUM_MAX && sShipLives >= 0; i++) // first loop
+	sCollisionEvents.clear();
+	if (sShipLives >= 0)
 	{
-		GameObjInst* pInst1 = sGameObjInstList + i;
+		BroadphaseBegin(sWorldBounds, dt);
 
-		// skip non-active object
-		if ((pInst1->flag & FLAG_ACTIVE) == 0)
+		for (unsigned long i = 0; i < gameObjInstStorageSize(); i++)
 		{
-			continue;
+			GameObjInst* pInst = gameObjInstStorageAt(i);
+
+			// skip non-active object
+			if ((pInst->flag & FLAG_ACTIVE) == 0)
+			{
+				continue;
+			}
+
+			if (pInst->pObject->type == TYPE_ASTEROID)
+			{
+				BroadphaseAdd(BROADPHASE_TARGET, pInst);
+			}
+			else if (pInst->pObject->type == TYPE_SHIP || pInst->pObject->type == TYPE_BULLET)
+			{
+				BroadphaseAdd(BROADPHASE_PROBE, pInst);
+			}
 		}
 
-		if ((pInst1->pObject->type == TYPE_ASTEROID))
+		BroadphaseCollide(sCollisionEvents);
+	}
+
+	for (const CollisionEvent& hit : sCollisionEvents)
+	{
+		// no more collision once the game is over
+		if (sShipLives < 0)
+			break;
+
+		GameObjInst* pAsteroid	= gameObjInstStorageFind(hit.target);
+		GameObjInst* pOther		= gameObjInstStorageFind(hit.probe);
+
+		// an asteroid or a bullet can only be used by one hit
+		if ((pAsteroid->flag & FLAG_DESTROY_PENDING) || (pOther->flag & FLAG_DESTROY_PENDING))
+			continue;
+
+		// declare and initiate the variable needed for the new asteroids
+		AEVec2 asteroid_scale = { 0,0 };
+		AEVec2 asteroid_pos = { 0,0 };
+		AEVec2 asteroid_vel = { 0,0 };
+
+		if (pOther->pObject->type == TYPE_SHIP)
 		{
-			for (unsigned long j = 0; j < GAME_OBJ_INST_NUM_MAX; j++) // second loop
+			// destroy the asteroid
+			gameObjInstQueueDestroy(pAsteroid);
+			if (!sEndless)
+				--sShipLives; // decrement the ship lives
+			sEvents.push_back({ GAME_EVENT_ASTEROID_DESTROYED, hit.target, (int32_t)pOther->owner });
+			sEvents.push_back({ GAME_EVENT_SHIP_HIT, pOther->owner, (int32_t)(sShipLives >= 0 ? sShipLives : 0) });
+			sScore += 100; // increase the score
+			ScoreboardAdd(pOther->owner, 100); // credit the player of the ship
+			sScoredPlayers.push_back(pOther->owner);
+			// reset the ship position
+			pOther->posCurr = { 0,0 };
+			pOther->velCurr = { 0,0 };
+			// add one random aestroid using function
+			Random_value_Generator(asteroid_scale, asteroid_pos, asteroid_vel); // call random generator to randomly generate the variable needed
+			gameObjInstQueueCreate(TYPE_ASTEROID, &asteroid_scale, &asteroid_pos, &asteroid_vel, 0.0f); // create the object
+		}
+		else
+		{
+			gameObjInstQueueDestroy(pAsteroid); // destroy the asteroid
+			gameObjInstQueueDestroy(pOther); // destroy the bullet
+			sEvents.push_back({ GAME_EVENT_ASTEROID_DESTROYED, hit.target, (int32_t)pOther->owner });
+			sScore += 100; // increase the score
+			ScoreboardAdd(pOther->owner, 100); // credit the player that fired the bullet, if any
+			sScoredPlayers.push_back(pOther->owner);
+			// add 1 or 2 random aestroid using function
+			int number = 0;
+			Random_number_asteroid_generator(number); // randomly generate number between 1 and 2, to decide how many asteroid to be spawned
+			for (int k = 0; k < number; k++) // for loop to spawn
 			{
-				GameObjInst* pInst2 = sGameObjInstList + j;
-				if ((pInst2->flag & FLAG_ACTIVE) == 0 || pInst2->pObject->type == TYPE_ASTEROID) // if it is non active object or is asteroid, skip
-				{
-					continue;
-				}
-				else if (pInst2->pObject->type == TYPE_SHIP)
-				{
-					float Tfirst = 0.0f;
-					// collision between asteroid and ship
-					if (CollisionIntersection_RectRect(pInst1->boundingBox, pInst1->velCurr, pInst2->boundingBox, pInst2->velCurr, Tfirst) == true) // static collision
-					{
-						// destroy the asteroid
-						gameObjInstDestroy(pInst1);
-						--sShipLives; // decrement the ship lives
-						sScore += 100; // increase the score
-						// reset the ship position
-						pInst2->posCurr = { 0,0 };
-						pInst2->velCurr = { 0,0 };
-						// add one random aestroid using function
-						// declare and initiate the variable needed
-						AEVec2 asteroid_scale = { 0,0 }; 
-						AEVec2 asteroid_pos = { 0,0 };
-						AEVec2 asteroid_vel = { 0,0 };
-						Random_value_Generator(asteroid_scale, asteroid_pos, asteroid_vel); // call random generator to randomly generate the variable needed
-						gameObjInstCreate(TYPE_ASTEROID, &asteroid_scale, &asteroid_pos, &asteroid_vel, 0.0f); // create the object
-						
-						onValueChange = true;  // if collision happen, need to print out the score and ship lives
-
-					}
-				}
-				// collision between asteroid and bullet
-				else if (pInst2->pObject->type == TYPE_BULLET)
-				{
-					float Tfirst = 0.0f;
-					if (CollisionIntersection_RectRect(pInst1->boundingBox, pInst1->velCurr, pInst2->boundingBox, pInst2->velCurr, Tfirst) == true)
-					{
-						gameObjInstDestroy(pInst1); // destroy the asteroid
-						gameObjInstDestroy(pInst2); // destroy the bullet
-						sScore += 100; // increase the score
-						// add 1 or 2 random aestroid using function
-						// declare and initiate the variable needed
-						AEVec2 asteroid_scale = { 0,0 };
-						AEVec2 asteroid_pos = { 0,0 };
-						AEVec2 asteroid_vel = { 0,0 };
-						int number = 0;
-						Random_number_asteroid_generator(number); // randomly generate number between 1 and 2, to decide how many asteroid to be spawned
-						for (int k = 0; k < number; k++) // for loop to spawn
-						{
-							Random_value_Generator(asteroid_scale, asteroid_pos, asteroid_vel);  // call random generator to randomly generate the variable needed
-							gameObjInstCreate(TYPE_ASTEROID, &asteroid_scale, &asteroid_pos, &asteroid_vel, 0.0f); // create the object
-						}
-						onValueChange = true; // if collision happen, need to print out the score and ship lives
-					}
-				}
+				Random_value_Generator(asteroid_scale, asteroid_pos, asteroid_vel);  // call random generator to randomly generate the variable needed
+				gameObjInstQueueCreate(TYPE_ASTEROID, &asteroid_scale, &asteroid_pos, &asteroid_vel, 0.0f); // create the object
 			}
 		}
+
+		onValueChange = true;  // if collision happen, need to print out the score and ship lives
 	}
 
+	// sync point: the destroyed slots are released before the new asteroids take a slot
+	gameObjInstApplyQueues();
+
 	// ===================================================================
 	// update active game object instances
 	// Example:
@@ -564,9 +664,10 @@ void GameStateAsteroidsUpdate(void)
 	//			(Homing missiles are not required for the Asteroids project)
 	//		-- Update a particle effect (Not required for the Asteroids project)
 	// ===================================================================
-	for (unsigned long i = 0; i < GAME_OBJ_INST_NUM_MAX; i++)
+	unsigned long typeCounts[TYPE_NUM] = {};	// active instances per type, for the metrics
+	for (unsigned long i = 0; i < gameObjInstStorageSize(); i++)
 	{
-		GameObjInst * pInst = sGameObjInstList + i;
+		GameObjInst * pInst = gameObjInstStorageAt(i);
 
 		// skip non-active object
 		if ((pInst->flag & FLAG_ACTIVE) == 0)
@@ -576,55 +677,55 @@ void GameStateAsteroidsUpdate(void)
 		if (pInst->pObject->type == TYPE_SHIP)
 		{
 			// Wrap the ship from one end of the screen to the other
-			pInst->posCurr.x = AEWrap(pInst->posCurr.x, AEGfxGetWinMinX() - SHIP_SCALE_X, 
-														AEGfxGetWinMaxX() + SHIP_SCALE_X);
-			pInst->posCurr.y = AEWrap(pInst->posCurr.y, AEGfxGetWinMinY() - SHIP_SCALE_Y,
-														AEGfxGetWinMaxY() + SHIP_SCALE_Y);
+			pInst->posCurr.x = Wrap(pInst->posCurr.x, sWorldBounds.min.x - SHIP_SCALE_X, 
+														sWorldBounds.max.x + SHIP_SCALE_X);
+			pInst->posCurr.y = Wrap(pInst->posCurr.y, sWorldBounds.min.y - SHIP_SCALE_Y,
+														sWorldBounds.max.y + SHIP_SCALE_Y);
 		}
 
 		// Wrap asteroids here
 		if (pInst->pObject->type == TYPE_ASTEROID)
 		{
-			pInst->posCurr.x = AEWrap(pInst->posCurr.x, AEGfxGetWinMinX() - ASTEROID_MAX_SCALE_X,
-														AEGfxGetWinMaxX() + ASTEROID_MAX_SCALE_X);
-			pInst->posCurr.y = AEWrap(pInst->posCurr.y, AEGfxGetWinMinY() - ASTEROID_MAX_SCALE_Y,
-														AEGfxGetWinMaxY() + ASTEROID_MAX_SCALE_Y);
+			pInst->posCurr.x = Wrap(pInst->posCurr.x, sWorldBounds.min.x - ASTEROID_MAX_SCALE_X,
+														sWorldBounds.max.x + ASTEROID_MAX_SCALE_X);
+			pInst->posCurr.y = Wrap(pInst->posCurr.y, sWorldBounds.min.y - ASTEROID_MAX_SCALE_Y,
+														sWorldBounds.max.y + ASTEROID_MAX_SCALE_Y);
 		}
 		// Remove bullets that go out of bounds
 		if (pInst->pObject->type == TYPE_BULLET)
 		{
-			if (pInst->posCurr.x > AEGfxGetWinMaxX() || pInst->posCurr.x < AEGfxGetWinMinX() || pInst->posCurr.y > AEGfxGetWinMaxY() || pInst->posCurr.y < AEGfxGetWinMinY())
+			if (pInst->posCurr.x > sWorldBounds.max.x || pInst->posCurr.x < sWorldBounds.min.x || pInst->posCurr.y > sWorldBounds.max.y || pInst->posCurr.y < sWorldBounds.min.y)
 			{
 				gameObjInstDestroy(pInst);
+				continue;
 			}
 		}
+
+		++typeCounts[pInst->pObject->type];
 	}
 
-	// =====================================================================
-	// calculate the matrix for all objects
-	// =====================================================================
+	MetricsSet(METRIC_SHIPS,		(double)typeCounts[TYPE_SHIP]);
+	MetricsSet(METRIC_ASTEROIDS,	(double)typeCounts[TYPE_ASTEROID]);
+	MetricsSet(METRIC_BULLETS,		(double)typeCounts[TYPE_BULLET]);
 
-	for (unsigned long i = 0; i < GAME_OBJ_INST_NUM_MAX; i++)
+	// win condition, everything stops like at game over
+	if (sScore >= GAME_WIN_SCORE && !sGameWon && !sEndless)
 	{
-		GameObjInst * pInst = sGameObjInstList + i;
-		AEMtx33		 trans, rot, scale;
-		
-		// skip non-active object
-		if ((pInst->flag & FLAG_ACTIVE) == 0)
-		{
-			continue;
-		}
-		
-		// Compute the scaling matrix
-		AEMtx33Scale(&scale, pInst->scale.x, pInst->scale.y);
-		// Compute the rotation matrix 
-		AEMtx33Rot(&rot, pInst->dirCurr);
-		// Compute the translation matrix
-		AEMtx33Trans(&trans, pInst->posCurr.x, pInst->posCurr.y);
-		// Concatenate the 3 matrix in the correct order in the object instance's "transform" matrix
-		AEMtx33Concat(&rot, &rot, &scale);
-		AEMtx33Concat(&pInst->transform, &trans, &rot);
+		sGameWon	= true;
+		sShipLives	= -1; // set this to negative so everything cant move
 	}
+
+	// one score event per player credited, in player order so a replay sends the same ones
+	std::sort(sScoredPlayers.begin(), sScoredPlayers.end());
+	sScoredPlayers.erase(std::unique(sScoredPlayers.begin(), sScoredPlayers.end()), sScoredPlayers.end());
+	for (uint32_t player : sScoredPlayers)
+	{
+		int32_t score;
+		if (ScoreboardFind(player, score))
+			sEvents.push_back({ GAME_EVENT_SCORE, player, score });
+	}
+	if (sShipLives < 0 && !overBefore)
+		sEvents.push_back({ GAME_EVENT_MATCH_OVER, 0, sGameWon ? 1 : 0 });
 }
 
 /******************************************************************************/
@@ -635,8 +736,6 @@ void GameStateAsteroidsUpdate(void)
 /******************************************************************************/
 void GameStateAsteroidsDraw(void)
 {
-	char strBuffer[1024];
-	
 	AEGfxSetRenderMode(AE_GFX_RM_COLOR);
 	AEGfxTextureSet(NULL, 0, 0);
 
@@ -647,47 +746,46 @@ void GameStateAsteroidsDraw(void)
 	AEGfxSetTransparency(1.0f);
 
 
-	// draw all object instances in the list
-	for (unsigned long i = 0; i < GAME_OBJ_INST_NUM_MAX; i++)
+	// the view stage only runs when something is drawn
+	if (sViewEnabled)
 	{
-		GameObjInst * pInst = sGameObjInstList + i;
+		// calculate the matrix for all objects
+		Helper_Build_View_Transforms();
 
-		// skip non-active object
-		if ((pInst->flag & FLAG_ACTIVE) == 0)
-			continue;
-		
-		// Set the current object instance's transform matrix using "AEGfxSetTransform"
-		AEGfxSetTransform(pInst->transform.m);
-		// Draw the shape used by the current object instance using "AEGfxMeshDraw"
-		AEGfxMeshDraw(pInst->pObject->pMesh, AE_GFX_MDM_TRIANGLES);
+		// draw all object instances in the list
+		for (unsigned long i = 0; i < gameObjInstStorageSize(); i++)
+		{
+			GameObjInst * pInst = gameObjInstStorageAt(i);
+
+			// skip non-active object
+			if ((pInst->flag & FLAG_ACTIVE) == 0)
+				continue;
+
+			// Set the current object instance's transform matrix using "AEGfxSetTransform"
+			AEGfxSetTransform(sViewTransforms[i].m);
+			// Draw the shape used by the current object instance using "AEGfxMeshDraw"
+			AEGfxMeshDraw(pInst->pObject->pMesh, AE_GFX_MDM_TRIANGLES);
+		}
 	}
 
 	//You can replace this condition/variable by your own data.
 	//The idea is to display any of these variables/strings whenever a change in their value happens
 	if(onValueChange)
 	{
-		sprintf_s(strBuffer, "Score: %d", sScore);
-		//AEGfxPrint(10, 10, (u32)-1, strBuffer);
-		printf("%s \n", strBuffer);
-
-		sprintf_s(strBuffer, "Ship Left: %d", sShipLives >= 0 ? sShipLives : 0);
-		//AEGfxPrint(600, 10, (u32)-1, strBuffer);
-		printf("%s \n", strBuffer);
+		// the console is written by the log thread, the frame does not wait for it
+		LogWrite(LOG_INFO, "score", { LogInt("score", (int64_t)sScore), LogInt("ships", sShipLives >= 0 ? sShipLives : 0) });
 
-		// display the game over message
-		if (sShipLives < 0)
+		// display the win or game over message, the win condition is checked by the tick
+		if (sGameWon)
 		{
-			//AEGfxPrint(280, 260, 0xFFFFFFFF, "       GAME OVER       ");
-			printf("       GAME OVER       \n");
+			LogWrite(LOG_INFO, "win", { LogText("message", "YOU ROCK") });
 		}
-		onValueChange = false; // once print set it to false
-		// win condition
-		if (sScore >= 5000)
+		else if (sShipLives < 0)
 		{
-			printf("       YOU ROCK      \n");
-			sShipLives = -1; // set this to negative so everything cant move
-			onValueChange = false; // once print set it to false
+			//AEGfxPrint(280, 260, 0xFFFFFFFF, "       GAME OVER       ");
+			LogWrite(LOG_INFO, "game_over", { LogText("message", "GAME OVER") });
 		}
+		onValueChange = false; // once print set it to false
 	}
 	
 }
@@ -700,12 +798,21 @@ void GameStateAsteroidsDraw(void)
 /******************************************************************************/
 void GameStateAsteroidsFree(void)
 {
+	// close the recording with the final state, so a replay can check it ends the same
+	ReplayRecordStop(GameStateAsteroidsChecksum());
+
 	// kill all object instances in the array using "gameObjInstDestroy"
-	for (unsigned long i = 0; i < GAME_OBJ_INST_NUM_MAX; i++)
+	for (unsigned long i = 0; i < gameObjInstStorageSize(); i++)
 	{
-		GameObjInst* pInst = sGameObjInstList + i;
+		GameObjInst* pInst = gameObjInstStorageAt(i);
 		gameObjInstDestroy(pInst);
 	}
+
+	// drop anything still queued
+	sDestroyQueue.clear();
+	sSpawnQueue.clear();
+
+	ScoreboardFree();
 }
 
 /******************************************************************************/
@@ -715,6 +822,18 @@ void GameStateAsteroidsFree(void)
 /******************************************************************************/
 void GameStateAsteroidsUnload(void)
 {
+	// release the memory of the object instance storage
+	gameObjInstStorageFree();
+
+	// stop the collision threads and release the grid
+	WorkerPoolFree();
+	BroadphaseFree();
+
+	// release the view transforms, the keyframe and the events
+	std::vector<AEMtx33>().swap(sViewTransforms);
+	std::vector<uint8_t>().swap(sKeyframe);
+	std::vector<GameEvent>().swap(sEvents);
+
 	// free all mesh data (shapes) of each object using "AEGfxTriFree"
 
 	for (unsigned long i = 0; i < GAME_OBJ_NUM_MAX; i++)
@@ -738,34 +857,27 @@ GameObjInst * gameObjInstCreate(unsigned long type,
 							   AEVec2 * pVel, 
 							   float dir)
 {
-	AEVec2 zero;
-	AEVec2Zero(&zero);
+	const AEVec2 zero = Vec2Make(0.0f, 0.0f);
 
 	AE_ASSERT_PARM(type < sGameObjNum);
 	
-	// loop through the object instance list to find a non-used object instance
-	for (unsigned long i = 0; i < GAME_OBJ_INST_NUM_MAX; i++)
-	{
-		GameObjInst * pInst = sGameObjInstList + i;
-
-		// check if current instance is not used
-		if (pInst->flag == 0)
-		{
-			// it is not used => use it to create the new instance
-			pInst->pObject	= sGameObjList + type;
-			pInst->flag		= FLAG_ACTIVE;
-			pInst->scale	= *scale;
-			pInst->posCurr	= pPos ? *pPos : zero;
-			pInst->velCurr	= pVel ? *pVel : zero;
-			pInst->dirCurr	= dir;
-			
-			// return the newly created instance
-			return pInst;
-		}
-	}
-
-	// cannot find empty slot => return 0
-	return 0;
+	// take a non-used object instance from the storage, it grows when every slot is used
+	GameObjInst * pInst = gameObjInstStorageAlloc();
+
+	// storage is full => return 0
+	if (pInst == 0)
+		return 0;
+
+	// use it to create the new instance
+	pInst->pObject	= sGameObjList + type;
+	pInst->scale	= *scale;
+	pInst->posCurr	= pPos ? *pPos : zero;
+	pInst->velCurr	= pVel ? *pVel : zero;
+	pInst->dirCurr	= dir;
+	pInst->owner	= GAME_PLAYER_NONE;
+
+	// return the newly created instance
+	return pInst;
 }
 
 /******************************************************************************/
@@ -775,17 +887,74 @@ GameObjInst * gameObjInstCreate(unsigned long type,
 /******************************************************************************/
 void gameObjInstDestroy(GameObjInst * pInst)
 {
-	// if instance is destroyed before, just return
-	if (pInst->flag == 0)
+	// give the slot back, this does nothing if the instance is destroyed before
+	gameObjInstStorageRelease(pInst);
+}
+
+/******************************************************************************/
+/*!
+	 gameObjInstQueueCreate() records an object to create. It is created by
+	 gameObjInstApplyQueues(), so it cannot show up in the pass that asked for it.
+*/
+/******************************************************************************/
+void gameObjInstQueueCreate(unsigned long type,
+							AEVec2 * scale,
+							AEVec2 * pPos,
+							AEVec2 * pVel,
+							float dir)
+{
+	const AEVec2 zero = Vec2Make(0.0f, 0.0f);
+
+	GameObjSpawn spawn;
+	spawn.type	= type;
+	spawn.scale	= *scale;
+	spawn.pos	= pPos ? *pPos : zero;
+	spawn.vel	= pVel ? *pVel : zero;
+	spawn.dir	= dir;
+	sSpawnQueue.push_back(spawn);
+}
+
+/******************************************************************************/
+/*!
+	 gameObjInstQueueDestroy() marks an object as about to be destroyed. It stays
+	 active, so the slot cannot be reused, until gameObjInstApplyQueues().
+*/
+/******************************************************************************/
+void gameObjInstQueueDestroy(GameObjInst * pInst)
+{
+	// already destroyed or already queued
+	if (pInst->flag == 0 || (pInst->flag & FLAG_DESTROY_PENDING))
 		return;
 
-	// zero out the flag
-	pInst->flag = 0;
+	pInst->flag |= FLAG_DESTROY_PENDING;
+	sDestroyQueue.push_back(gameObjInstGetHandle(pInst));
+}
+
+/******************************************************************************/
+/*!
+	 gameObjInstApplyQueues() is the sync point of the command buffers: every
+	 queued object is destroyed, then every queued object is created, in the
+	 order they were queued.
+*/
+/******************************************************************************/
+void gameObjInstApplyQueues()
+{
+	for (GameObjHandle handle : sDestroyQueue)
+	{
+		GameObjInst * pInst = gameObjInstStorageFind(handle);
+		if (pInst)
+			gameObjInstDestroy(pInst);
+	}
+	sDestroyQueue.clear();
+
+	for (GameObjSpawn& spawn : sSpawnQueue)
+		gameObjInstCreate(spawn.type, &spawn.scale, &spawn.pos, &spawn.vel, spawn.dir);
+	sSpawnQueue.clear();
 }
 
 /******************************************************************************/
 /*!
-    check for collision between Ship and Wall and apply physics response on the Ship
+    check for collision between every Ship and the Wall and apply physics response on the Ship
 		-- Apply collision response only on the "Ship" as we consider the "Wall" object is always stationary
 		-- We'll check collision only when the ship is moving towards the wall!
 	[DO NOT UPDATE THIS PARAGRAPH'S CODE]
@@ -793,56 +962,81 @@ void gameObjInstDestroy(GameObjInst * pInst)
 /******************************************************************************/
 void Helper_Wall_Collision()
 {
-	//calculate the vectors between the previous position of the ship and the boundary of wall
-	AEVec2 vec1;
-	vec1.x = spShip->posPrev.x - spWall->boundingBox.min.x;
-	vec1.y = spShip->posPrev.y - spWall->boundingBox.min.y;
-	AEVec2 vec2;
-	vec2.x = 0.0f;
-	vec2.y = -1.0f;
-	AEVec2 vec3;
-	vec3.x = spShip->posPrev.x - spWall->boundingBox.max.x;
-	vec3.y = spShip->posPrev.y - spWall->boundingBox.max.y;
-	AEVec2 vec4;
-	vec4.x = 1.0f;
-	vec4.y = 0.0f;
-	AEVec2 vec5;
-	vec5.x = spShip->posPrev.x - spWall->boundingBox.max.x;
-	vec5.y = spShip->posPrev.y - spWall->boundingBox.max.y;
-	AEVec2 vec6;
-	vec6.x = 0.0f;
-	vec6.y = 1.0f;
-	AEVec2 vec7;
-	vec7.x = spShip->posPrev.x - spWall->boundingBox.min.x;
-	vec7.y = spShip->posPrev.y - spWall->boundingBox.min.y;
-	AEVec2 vec8;
-	vec8.x = -1.0f;
-	vec8.y = 0.0f;
-	if (
-		(AEVec2DotProduct(&vec1, &vec2) >= 0.0f) && (AEVec2DotProduct(&spShip->velCurr, &vec2) <= 0.0f) ||
-		(AEVec2DotProduct(&vec3, &vec4) >= 0.0f) && (AEVec2DotProduct(&spShip->velCurr, &vec4) <= 0.0f) ||
-		(AEVec2DotProduct(&vec5, &vec6) >= 0.0f) && (AEVec2DotProduct(&spShip->velCurr, &vec6) <= 0.0f) ||
-		(AEVec2DotProduct(&vec7, &vec8) >= 0.0f) && (AEVec2DotProduct(&spShip->velCurr, &vec8) <= 0.0f)
-		)
-	{
-		float firstTimeOfCollision = 0.0f;
-		if (CollisionIntersection_RectRect(spShip->boundingBox,
-			spShip->velCurr,
-			spWall->boundingBox,
-			spWall->velCurr,
-			firstTimeOfCollision))
+	// resolve the handles, nothing to do if either object is gone
+	GameObjInst * spWall = gameObjInstStorageFind(sWallHandle);
+	if (spWall == 0)
+		return;
+
+	for (const GamePlayer& player : sPlayers)
+	{
+		GameObjInst * spShip = gameObjInstStorageFind(player.ship);
+		if (spShip == 0)
+			continue;
+
+		//calculate the vectors between the previous position of the ship and the boundary of wall
+		AEVec2 vec1 = Vec2Sub(spShip->posPrev, spWall->boundingBox.min);
+		AEVec2 vec2 = Vec2Make(0.0f, -1.0f);
+		AEVec2 vec3 = Vec2Sub(spShip->posPrev, spWall->boundingBox.max);
+		AEVec2 vec4 = Vec2Make(1.0f, 0.0f);
+		AEVec2 vec5 = Vec2Sub(spShip->posPrev, spWall->boundingBox.max);
+		AEVec2 vec6 = Vec2Make(0.0f, 1.0f);
+		AEVec2 vec7 = Vec2Sub(spShip->posPrev, spWall->boundingBox.min);
+		AEVec2 vec8 = Vec2Make(-1.0f, 0.0f);
+		if (
+			(Vec2Dot(vec1, vec2) >= 0.0f) && (Vec2Dot(spShip->velCurr, vec2) <= 0.0f) ||
+			(Vec2Dot(vec3, vec4) >= 0.0f) && (Vec2Dot(spShip->velCurr, vec4) <= 0.0f) ||
+			(Vec2Dot(vec5, vec6) >= 0.0f) && (Vec2Dot(spShip->velCurr, vec6) <= 0.0f) ||
+			(Vec2Dot(vec7, vec8) >= 0.0f) && (Vec2Dot(spShip->velCurr, vec8) <= 0.0f)
+			)
 		{
-			//re-calculating the new position based on the collision's intersection time
-			spShip->posCurr.x = spShip->velCurr.x * (float)firstTimeOfCollision + spShip->posPrev.x;
-			spShip->posCurr.y = spShip->velCurr.y * (float)firstTimeOfCollision + spShip->posPrev.y;
+			float firstTimeOfCollision = 0.0f;
+			if (CollisionIntersection_RectRect(spShip->boundingBox,
+				spShip->velCurr,
+				spWall->boundingBox,
+				spWall->velCurr,
+				firstTimeOfCollision))
+			{
+				//re-calculating the new position based on the collision's intersection time
+				spShip->posCurr.x = spShip->velCurr.x * (float)firstTimeOfCollision + spShip->posPrev.x;
+				spShip->posCurr.y = spShip->velCurr.y * (float)firstTimeOfCollision + spShip->posPrev.y;
 
-			//reset ship velocity
-			spShip->velCurr.x = 0.0f;
-			spShip->velCurr.y = 0.0f;
+				//reset ship velocity
+				spShip->velCurr.x = 0.0f;
+				spShip->velCurr.y = 0.0f;
+			}
 		}
 	}
 }
 
+/******************************************************************************/
+/*!
+	Helper_Build_View_Transforms() is the view stage: it computes the
+	transformation matrix of every active instance in one batch. The scale,
+	rotation, translation and world to window scale are fused and written
+	straight into the matrix, instead of building and concatenating one matrix
+	per step. Nothing in the simulation reads these matrices.
+*/
+/******************************************************************************/
+void Helper_Build_View_Transforms()
+{
+	sViewTransforms.resize(gameObjInstStorageSize());
+
+	for (unsigned long i = 0; i < gameObjInstStorageSize(); i++)
+	{
+		GameObjInst * pInst = gameObjInstStorageAt(i);
+
+		// skip non-active object
+		if ((pInst->flag & FLAG_ACTIVE) == 0)
+			continue;
+
+		// View * Trans * Rot * Scale, the view scale is folded in the rotation and the position
+		sViewTransforms[i] = Mtx33TRSCosSin(pInst->scale,
+											cosf(pInst->dirCurr) * sViewScale,
+											sinf(pInst->dirCurr) * sViewScale,
+											Vec2Scale(pInst->posCurr, sViewScale));
+	}
+}
+
 /******************************************************************************/
 /*!
 	 Random_value_Generator() will generate random value for vector scale, position and
@@ -854,20 +1048,20 @@ void Random_value_Generator(AEVec2& scale, AEVec2& pPos, AEVec2& pVel)
 	// randomly generate a scale within the bound
 	do
 	{
-		scale.x = (float)(rand() % (int)ASTEROID_MAX_SCALE_X);
-		scale.y = (float)(rand() % (int)ASTEROID_MAX_SCALE_Y);
+		scale.x = (float)(RandomNext(sRandom) % (uint32_t)ASTEROID_MAX_SCALE_X);
+		scale.y = (float)(RandomNext(sRandom) % (uint32_t)ASTEROID_MAX_SCALE_Y);
 	} while ((scale.x < ASTEROID_MIN_SCALE_X) || (scale.y < ASTEROID_MIN_SCALE_Y));
 	// randomly generate velocity bigger than 20 or smaller than 20, so it wont be too slow
 	do 
 	{
 		// velocity range will be -150 to 150
-		pVel.x = (float)((rand() % (int)301) - 150);
-		pVel.y = (float)((rand() % (int)301) - 150);
+		pVel.x = (float)((int)(RandomNext(sRandom) % 301) - 150);
+		pVel.y = (float)((int)(RandomNext(sRandom) % 301) - 150);
 	} while ((pVel.x >= -20 && pVel.x <= 20) || (pVel.y >= -20 && pVel.y <= 20));
 	
-	// randomly generate the position that is outside of the window
-	pPos.y = (float)((rand() % (int)(AEGfxGetWindowHeight())) - ((int)AEGfxGetWindowHeight()/2));
-	pPos.x = (float)((rand() % 2) * (int)(AEGfxGetWindowWidth()) - ((int)AEGfxGetWindowWidth() / 2));
+	// randomly generate the position on the left or right edge of the world
+	pPos.y = sWorldBounds.min.y + RandomFloat01(sRandom) * (sWorldBounds.max.y - sWorldBounds.min.y);
+	pPos.x = (RandomNext(sRandom) % 2) ? sWorldBounds.max.x : sWorldBounds.min.x;
 }
 
 
@@ -879,7 +1073,499 @@ void Random_value_Generator(AEVec2& scale, AEVec2& pPos, AEVec2& pVel)
 /******************************************************************************/
 void Random_number_asteroid_generator(int& number)
 {
-	time_t t;
-	srand((unsigned)time(&t));
-	number = (rand() % 2) + 1; // generate 1 or 2, as modulo 2 will give 0 or 1 , then +1 will get 1 or 2
-}
\ No newline at end of file
+	number = (int)(RandomNext(sRandom) % 2) + 1; // generate 1 or 2, as modulo 2 will give 0 or 1 , then +1 will get 1 or 2
+}
+
+/******************************************************************************/
+/*!
+	GameStateAsteroidsSetWorldSize() sets the size of the playfield, centered on
+	the origin. Objects wrap and bullets are culled against these bounds instead
+	of the window, and the debug view is scaled so the whole world stays visible.
+	It should be called before the state is initialized. A size below the debug
+	window is raised to it, the size applied is returned.
+*/
+/******************************************************************************/
+AEVec2 GameStateAsteroidsSetWorldSize(float width, float height)
+{
+	// never go smaller than the debug window
+	width	= width  > WORLD_DEFAULT_WIDTH  ? width  : WORLD_DEFAULT_WIDTH;
+	height	= height > WORLD_DEFAULT_HEIGHT ? height : WORLD_DEFAULT_HEIGHT;
+
+	sWorldBounds.min.x = -width  / 2.0f;
+	sWorldBounds.max.x =  width  / 2.0f;
+	sWorldBounds.min.y = -height / 2.0f;
+	sWorldBounds.max.y =  height / 2.0f;
+
+	// fit the whole world inside the debug window
+	float scaleX = WORLD_DEFAULT_WIDTH  / width;
+	float scaleY = WORLD_DEFAULT_HEIGHT / height;
+	sViewScale = scaleX < scaleY ? scaleX : scaleY;
+
+	return AEVec2{ width, height };
+}
+
+/******************************************************************************/
+/*!
+	GameStateAsteroidsSetViewEnabled() turns the view stage on or off. When it
+	is off no transformation matrix is computed and nothing is drawn, the
+	score is still printed to the console.
+*/
+/******************************************************************************/
+void GameStateAsteroidsSetViewEnabled(bool enabled)
+{
+	sViewEnabled = enabled;
+}
+
+/******************************************************************************/
+/*!
+	gameStateAsteroidsApplyCommand() moves the ship of a player according to
+	its buttons, the bullets it fires belong to that player.
+
+	Updating the velocity and position according to acceleration is 
+	done by using the following:
+	Pos1 = 1/2 * a*t*t + v0*t + Pos0
+
+	In our case we need to divide the previous equation into two parts in order 
+	to have control over the velocity and that is done by:
+
+	v1 = a*t + v0		//This is done when the UP or DOWN key is pressed 
+	Pos1 = v1*t + Pos0
+*/
+/******************************************************************************/
+void gameStateAsteroidsApplyCommand(GameObjInst * spShip, const InputCommand& command, float dt)
+{
+	// nothing moves once the game is over
+	if (sShipLives < 0)
+		return;
+
+	if (command.buttons & INPUT_FORWARD)
+	{
+		AEVec2 added = Vec2FromAngle(spShip->dirCurr);
+
+		// Find the velocity according to the acceleration
+		added = Vec2ScaleAdd(spShip->velCurr, added, SHIP_ACCEL_FORWARD * dt);
+		// Limit your speed over here
+		spShip->velCurr = Vec2Scale(added, 0.99f);
+	}
+
+	if (command.buttons & INPUT_BACKWARD)
+	{
+		AEVec2 added = Vec2Scale(Vec2FromAngle(spShip->dirCurr), -1.0f);
+
+		// Find the velocity according to the decceleration
+		added = Vec2ScaleAdd(spShip->velCurr, added, SHIP_ACCEL_BACKWARD * dt);
+		// Limit your speed over here
+		spShip->velCurr = Vec2Scale(added, 0.99f);
+	}
+
+	if (command.buttons & INPUT_LEFT)
+	{
+		spShip->dirCurr += SHIP_ROT_SPEED * dt;
+		spShip->dirCurr =  Wrap(spShip->dirCurr, -PI, PI);
+	}
+
+	if (command.buttons & INPUT_RIGHT)
+	{
+		spShip->dirCurr -= SHIP_ROT_SPEED * dt;
+		spShip->dirCurr =  Wrap(spShip->dirCurr, -PI, PI);
+	}
+
+	// Shoot a bullet if fire is triggered (Create a new object instance)
+	if (command.buttons & INPUT_FIRE)
+	{
+		// Get the bullet's direction according to the ship's direction and set the velocity
+		AEVec2 added_vel = Vec2Scale(Vec2FromAngle(spShip->dirCurr), BULLET_SPEED);
+		// Create an instance, based on BULLET_SCALE_X and BULLET_SCALE_Y
+		AEVec2 scale = Vec2Make(BULLET_SCALE_X, BULLET_SCALE_Y);
+		GameObjInst * spBullet = gameObjInstCreate(TYPE_BULLET, &scale, &spShip->posCurr, &added_vel, spShip->dirCurr);
+		if (spBullet)
+			spBullet->owner = command.player;
+	}
+}
+
+/******************************************************************************/
+/*!
+	GameStateAsteroidsSetSeed() fixes the seed of the random generator for the
+	next matches, by default every match is seeded from the clock. It should
+	be called before the state is initialized.
+*/
+/******************************************************************************/
+void GameStateAsteroidsSetSeed(uint32_t seed)
+{
+	sRandomSeed		= seed;
+	sRandomSeedSet	= true;
+}
+
+/******************************************************************************/
+/*!
+	GameStateAsteroidsSetRecordPath() records the next matches to path, an
+	empty path stops recording. A new match overwrites the file. It should be
+	called before the state is initialized.
+*/
+/******************************************************************************/
+void GameStateAsteroidsSetRecordPath(const char * path)
+{
+	sRecordPath = path ? path : "";
+}
+
+/******************************************************************************/
+/*!
+	GameStateAsteroidsPlayerJoin() adds a player to the match with a ship of
+	its own, its input commands are applied from the next tick. The local
+	player starts at the origin, the others at a random place drawn from the
+	generator of the match. GameStateAsteroidsPlayerLeave() removes the player
+	and its ship, the last player takes its place in the list. Both are
+	recorded and keep the scoreboard in step.
+*/
+/******************************************************************************/
+void GameStateAsteroidsPlayerJoin(uint32_t player)
+{
+	if (sPlayerIndex.count(player))
+		return;
+
+	AEVec2 scale	= Vec2Make(SHIP_SCALE_X, SHIP_SCALE_Y);
+	AEVec2 pos		= Vec2Make(0.0f, 0.0f);
+	if (player != GAME_LOCAL_PLAYER)
+	{
+		AEVec2 worldSize = Vec2Sub(sWorldBounds.max, sWorldBounds.min);
+		pos = Vec2Make(sWorldBounds.min.x + RandomFloat01(sRandom) * worldSize.x,
+					   sWorldBounds.min.y + RandomFloat01(sRandom) * worldSize.y);
+	}
+
+	// a full storage leaves the player without a ship, its commands are then dropped
+	GamePlayer entry = { player, GAME_OBJ_HANDLE_NONE };
+	GameObjInst * spShip = gameObjInstCreate(TYPE_SHIP, &scale, &pos, nullptr, 0.0f);
+	if (spShip)
+	{
+		spShip->owner	= player;
+		entry.ship		= gameObjInstGetHandle(spShip);
+	}
+
+	sPlayerIndex[player] = sPlayers.size();
+	sPlayers.push_back(entry);
+	ScoreboardJoin(player);
+	ReplayRecordJoin(player);
+}
+
+void GameStateAsteroidsPlayerLeave(uint32_t player)
+{
+	std::unordered_map<uint32_t, size_t>::iterator it = sPlayerIndex.find(player);
+	if (it == sPlayerIndex.end())
+		return;
+
+	size_t index = it->second;
+	GameObjInst * spShip = gameObjInstStorageFind(sPlayers[index].ship);
+	if (spShip)
+		gameObjInstDestroy(spShip);
+
+	sPlayerIndex.erase(it);
+	if (index + 1 < sPlayers.size())
+	{
+		sPlayers[index] = sPlayers.back();
+		sPlayerIndex[sPlayers[index].player] = index;
+	}
+	sPlayers.pop_back();
+
+	ScoreboardLeave(player);
+	ReplayRecordLeave(player);
+}
+
+/******************************************************************************/
+/*!
+	GameStateAsteroidsChecksum() hashes (FNV-1a) the score, the lives and the
+	slot, type, owner, position, velocity and direction of every active
+	instance. Two
+	runs that give the same value ended in the same state. The long values
+	are hashed as 32 bits, so Windows and Linux hash the same match alike.
+*/
+/******************************************************************************/
+uint32_t GameStateAsteroidsChecksum()
+{
+	uint32_t hash = 2166136261u;
+	auto mix = [&hash](const void * pData, size_t size)
+	{
+		const uint8_t * pBytes = (const uint8_t *)pData;
+		for (size_t b = 0; b < size; b++)
+			hash = (hash ^ pBytes[b]) * 16777619u;
+	};
+	auto mix32 = [&mix](uint32_t value)
+	{
+		mix(&value, sizeof(value));
+	};
+
+	mix32((uint32_t)sScore);
+	mix32((uint32_t)sShipLives);
+
+	for (unsigned long i = 0; i < gameObjInstStorageSize(); i++)
+	{
+		GameObjInst * pInst = gameObjInstStorageAt(i);
+
+		// skip non-active object
+		if ((pInst->flag & FLAG_ACTIVE) == 0)
+			continue;
+
+		mix32((uint32_t)i);
+		mix32((uint32_t)pInst->pObject->type);
+		mix32(pInst->owner);
+		mix(&pInst->posCurr, sizeof(pInst->posCurr));
+		mix(&pInst->velCurr, sizeof(pInst->velCurr));
+		mix(&pInst->dirCurr, sizeof(pInst->dirCurr));
+	}
+
+	return hash;
+}
+
+/******************************************************************************/
+/*!
+	GameStateAsteroidsSaveKeyframe() writes everything the next ticks depend
+	on: the generator, the score, the players with their ship and score, the
+	wall handle and the instance
+	storage slot by slot, free stack and generations included, so objects
+	created after a restore take the same slots as in the original run.
+	posPrev and boundingBox are not saved, the tick recomputes them first.
+*/
+/******************************************************************************/
+void GameStateAsteroidsSaveKeyframe(std::vector<uint8_t>& keyframe)
+{
+	keyframe.clear();
+
+	ReplayPutU64(keyframe, sRandom.state);
+	ReplayPutU32(keyframe, (uint32_t)sScore);
+	ReplayPutU32(keyframe, (uint32_t)sShipLives);
+	ReplayPutU8(keyframe, sGameWon ? 1 : 0);
+	ReplayPutU32(keyframe, sWallHandle);
+
+	ReplayPutU32(keyframe, (uint32_t)sPlayers.size());
+	for (const GamePlayer& player : sPlayers)
+	{
+		int32_t score = 0;
+		ScoreboardFind(player.player, score);
+		ReplayPutU32(keyframe, player.player);
+		ReplayPutU32(keyframe, player.ship);
+		ReplayPutU32(keyframe, (uint32_t)score);
+	}
+
+	const std::vector<unsigned long>& freeList = gameObjInstStorageFreeList();
+	ReplayPutU32(keyframe, (uint32_t)gGameObjInstChunks.size());
+	ReplayPutU32(keyframe, (uint32_t)freeList.size());
+	for (unsigned long index : freeList)
+		ReplayPutU32(keyframe, (uint32_t)index);
+
+	for (unsigned long i = 0; i < gameObjInstStorageSize(); i++)
+	{
+		GameObjInst * pInst = gameObjInstStorageAt(i);
+
+		ReplayPutU32(keyframe, (uint32_t)((pInst->generation << 8) | (pInst->flag & FLAG_ACTIVE)));
+		if ((pInst->flag & FLAG_ACTIVE) == 0)
+			continue;
+
+		ReplayPutU8(keyframe, (uint8_t)pInst->pObject->type);
+		ReplayPutU32(keyframe, pInst->owner);
+		ReplayPutF32(keyframe, pInst->scale.x);
+		ReplayPutF32(keyframe, pInst->scale.y);
+		ReplayPutF32(keyframe, pInst->posCurr.x);
+		ReplayPutF32(keyframe, pInst->posCurr.y);
+		ReplayPutF32(keyframe, pInst->velCurr.x);
+		ReplayPutF32(keyframe, pInst->velCurr.y);
+		ReplayPutF32(keyframe, pInst->dirCurr);
+	}
+}
+
+/******************************************************************************/
+/*!
+	GameStateAsteroidsLoadKeyframe() puts the state saved by
+	GameStateAsteroidsSaveKeyframe() back. The state must be loaded. Returns
+	false if the data is damaged, the state is then left empty.
+*/
+/******************************************************************************/
+bool GameStateAsteroidsLoadKeyframe(const uint8_t * pData, size_t size)
+{
+	const uint8_t * pEnd	= pData + size;
+	const uint8_t * pCursor	= pData;
+
+	sDestroyQueue.clear();
+	sSpawnQueue.clear();
+
+	sRandom.state	= ReplayGetU64(pCursor, pEnd);
+	sScore			= ReplayGetU32(pCursor, pEnd);
+	sShipLives		= (int32_t)ReplayGetU32(pCursor, pEnd);
+	sGameWon		= ReplayGetU8(pCursor, pEnd) != 0;
+	sWallHandle		= ReplayGetU32(pCursor, pEnd);
+
+	// the scoreboard follows from the players and their score
+	uint32_t playerCount = ReplayGetU32(pCursor, pEnd);
+	sPlayers.clear();
+	sPlayerIndex.clear();
+	ScoreboardInit();
+	for (uint32_t p = 0; p < playerCount && pCursor; p++)
+	{
+		GamePlayer player;
+		player.player	= ReplayGetU32(pCursor, pEnd);
+		player.ship		= ReplayGetU32(pCursor, pEnd);
+		int32_t score	= (int32_t)ReplayGetU32(pCursor, pEnd);
+
+		sPlayerIndex[player.player] = sPlayers.size();
+		sPlayers.push_back(player);
+		ScoreboardJoin(player.player);
+		ScoreboardSet(player.player, score);
+	}
+
+	uint32_t chunkCount	= ReplayGetU32(pCursor, pEnd);
+	uint32_t freeCount	= ReplayGetU32(pCursor, pEnd);
+	if (pCursor == 0 || (size_t)freeCount * 4 > (size_t)(pEnd - pCursor))
+	{
+		gameObjInstStorageInit();
+		return false;
+	}
+	std::vector<unsigned long> freeList(freeCount);
+	for (unsigned long& index : freeList)
+		index = ReplayGetU32(pCursor, pEnd);
+
+	if (!gameObjInstStorageRestore(chunkCount, freeList))
+	{
+		gameObjInstStorageInit();
+		return false;
+	}
+
+	for (unsigned long i = 0; i < gameObjInstStorageSize() && pCursor; i++)
+	{
+		GameObjInst * pInst = gameObjInstStorageAt(i);
+
+		uint32_t slot		= ReplayGetU32(pCursor, pEnd);
+		pInst->generation	= slot >> 8;
+		pInst->flag			= slot & FLAG_ACTIVE;
+		if ((pInst->flag & FLAG_ACTIVE) == 0)
+			continue;
+
+		uint8_t type		= ReplayGetU8(pCursor, pEnd);
+		pInst->pObject		= sGameObjList + (type < sGameObjNum ? type : 0);
+		pInst->owner		= ReplayGetU32(pCursor, pEnd);
+		pInst->scale.x		= ReplayGetF32(pCursor, pEnd);
+		pInst->scale.y		= ReplayGetF32(pCursor, pEnd);
+		pInst->posCurr.x	= ReplayGetF32(pCursor, pEnd);
+		pInst->posCurr.y	= ReplayGetF32(pCursor, pEnd);
+		pInst->velCurr.x	= ReplayGetF32(pCursor, pEnd);
+		pInst->velCurr.y	= ReplayGetF32(pCursor, pEnd);
+		pInst->dirCurr		= ReplayGetF32(pCursor, pEnd);
+		pInst->posPrev		= pInst->posCurr;
+	}
+
+	if (pCursor == 0)
+	{
+		gameObjInstStorageInit();
+		return false;
+	}
+
+	// print the score of the restored match
+	onValueChange = true;
+	return true;
+}
+
+/******************************************************************************/
+/*!
+	GameStateAsteroidsSetEndless() turns the game over and the win condition
+	off, so a benchmark or a load test can run a full world for as long as it
+	wants. It is saved in the replay header, so it should be called before
+	the state is initialized.
+*/
+/******************************************************************************/
+void GameStateAsteroidsSetEndless(bool endless)
+{
+	sEndless = endless;
+}
+
+/******************************************************************************/
+/*!
+	GameStateAsteroidsPopulate() creates random asteroids and bullets anywhere
+	in the world until it holds at least asteroidCount asteroids and
+	bulletCount bullets. Like the collision spawns, the values come from the
+	generator of the match. It is recorded, a server that fills its world
+	after the init can be replayed.
+*/
+/******************************************************************************/
+void GameStateAsteroidsPopulate(unsigned long asteroidCount, unsigned long bulletCount)
+{
+	unsigned long asteroids	= 0;
+	unsigned long bullets	= 0;
+	for (unsigned long i = 0; i < gameObjInstStorageSize(); i++)
+	{
+		GameObjInst * pInst = gameObjInstStorageAt(i);
+
+		// skip non-active object
+		if ((pInst->flag & FLAG_ACTIVE) == 0)
+			continue;
+
+		if (pInst->pObject->type == TYPE_ASTEROID)
+			++asteroids;
+		else if (pInst->pObject->type == TYPE_BULLET)
+			++bullets;
+	}
+
+	ReplayRecordPopulate((uint32_t)asteroidCount, (uint32_t)bulletCount);
+
+	AEVec2 worldSize = Vec2Sub(sWorldBounds.max, sWorldBounds.min);
+
+	for (; asteroids < asteroidCount; asteroids++)
+	{
+		AEVec2 scale, pos, vel;
+		Random_value_Generator(scale, pos, vel);
+		pos = Vec2Make(sWorldBounds.min.x + RandomFloat01(sRandom) * worldSize.x,
+					   sWorldBounds.min.y + RandomFloat01(sRandom) * worldSize.y);
+		if (gameObjInstCreate(TYPE_ASTEROID, &scale, &pos, &vel, 0.0f) == 0)
+			return;
+	}
+
+	for (; bullets < bulletCount; bullets++)
+	{
+		AEVec2 scale	= Vec2Make(BULLET_SCALE_X, BULLET_SCALE_Y);
+		AEVec2 pos		= Vec2Make(sWorldBounds.min.x + RandomFloat01(sRandom) * worldSize.x,
+								   sWorldBounds.min.y + RandomFloat01(sRandom) * worldSize.y);
+		float dir		= Wrap(RandomFloat01(sRandom) * 2.0f * PI, -PI, PI);
+		AEVec2 vel		= Vec2Scale(Vec2FromAngle(dir), BULLET_SPEED);
+		if (gameObjInstCreate(TYPE_BULLET, &scale, &pos, &vel, dir) == 0)
+			return;
+	}
+}
+
+/******************************************************************************/
+/*!
+	GameStateAsteroidsGetAsteroids() fills asteroids with the network data of
+	every active asteroid, in slot order. The id is the handle of the instance
+	and the owner is 0, the server owns the asteroids.
+*/
+/******************************************************************************/
+void GameStateAsteroidsGetAsteroids(std::vector<AsteroidData>& asteroids, float time)
+{
+	asteroids.clear();
+
+	for (unsigned long i = 0; i < gameObjInstStorageSize(); i++)
+	{
+		GameObjInst * pInst = gameObjInstStorageAt(i);
+
+		// skip non-active object
+		if ((pInst->flag & FLAG_ACTIVE) == 0 || pInst->pObject->type != TYPE_ASTEROID)
+			continue;
+
+		AsteroidData data;
+		data.owner		= 0;
+		data.id			= gameObjInstGetHandle(pInst);
+		data.position	= pInst->posCurr;
+		data.scale		= pInst->scale;
+		data.velocity	= pInst->velCurr;
+		data.direction	= Vec2FromAngle(pInst->dirCurr);
+		data.scoreCount	= (int)sScore;
+		data.time		= time;
+		asteroids.push_back(data);
+	}
+}
+
+/******************************************************************************/
+/*!
+	GameStateAsteroidsEvents() returns the events of the last tick, cleared
+	by the next one.
+*/
+/******************************************************************************/
+const std::vector<GameEvent>& GameStateAsteroidsEvents()
+{
+	return sEvents;
+}
@@ -0,0 +1,550 @@
+/******************************************************************************/
+/*!
+\file		LoadGen.cpp
+\brief		This file contains the definition of the load generator. The bots
+			are split between the threads, every thread polls the sockets of
+			its bots, answers the packets and sends what is due.
+ */
+/******************************************************************************/
+
+#include "LoadGen.h"
+#include "Socket.h"
+#include "NetProtocol.h"
+#include "NetChannel.h"
+#include "InputCommand.h"
+#include "Options.h"
+#include "Random.h"
+#include "Scoreboard.h"
+#include "SnapshotCodec.h"
+
+#include <algorithm>
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+
+// where a bot is in the handshake
+enum LOADGEN_BOT_STATE
+{
+	LOADGEN_BOT_WAITING = 0,	// its turn in the ramp has not come
+	LOADGEN_BOT_CONNECTING,		// CONNECT sent, no answer yet
+	LOADGEN_BOT_CONNECTED,		// ACCEPT received, streaming inputs
+	LOADGEN_BOT_REJECTED,		// REJECT received
+	LOADGEN_BOT_FAILED,			// no answer in LOADGEN_CONNECT_TIMEOUT, or the socket failed
+};
+
+// one simulated player
+struct LoadGenBot
+{
+	SocketHandle		socket;
+	LOADGEN_BOT_STATE	state;
+	RandomState			rng;
+	uint32_t			nonce;
+	uint32_t			player;
+
+	double				connectAt;			// time of the first CONNECT
+	double				nextConnect;		// time of the next CONNECT while connecting
+	double				connectedAt;		// time of the ACCEPT
+
+	uint32_t			inputSequence;		// number of the last input sent
+	double				nextInput;			// time of the next input
+	double				nextBehaviour;		// time the held buttons change
+	uint8_t				held;				// INPUT_FORWARD, INPUT_LEFT, INPUT_RIGHT kept down until nextBehaviour
+	double				sentAt[LOADGEN_INPUT_HISTORY];	// send time of the inputs, by sequence
+
+	uint32_t			lastAck;			// last input acknowledged
+	unsigned long		snapshots;			// snapshots received
+	uint32_t			firstSnapshot;		// sequence of the first and last snapshot received
+	uint32_t			lastSnapshot;
+	double				lastSnapshotAt;		// arrival time of lastSnapshot, echoed in the inputs
+	SNAPSHOT_CODEC		codec;				// of the asteroids, from the ACCEPT
+	unsigned long		asteroids;			// asteroids decoded
+	unsigned long		undecodable;		// snapshots whose asteroids did not decode
+	unsigned long		asteroidBytes;		// bytes of the asteroids of every snapshot
+	std::vector<float>	latencies;			// input to ack, in milliseconds
+
+	NetChannelReceiver	channel;			// the events of the snapshots
+	unsigned long		messages;			// messages handed out by the channel
+	unsigned long		misordered;			// handed out with an id that does not follow the last one, 0 for a sound channel
+
+	std::vector<ScoreboardEntry>	leaderboard;		// rebuilt from the deltas
+	uint32_t			leaderboardVersion;	// version held, acknowledged in every input
+	unsigned long		leaderboardDeltas;	// deltas applied
+	unsigned long		leaderboardBytes;	// bytes of every LEADERBOARD packet received
+};
+
+// ---------------------------------------------------------------------------
+// static variables
+
+static SocketAddress			sLoadGenServer;			// where the bots connect
+static unsigned int				sLoadGenInputRate;		// inputs per second of a bot
+static float					sLoadGenFireChance;		// chance that an input fires
+static double					sLoadGenSeconds;		// length of the run, ramp included
+static std::vector<LoadGenBot>	sLoadGenBots;
+
+static thread_local std::vector<NetMessage>	tLoadGenMessages;	// messages handed out by the last snapshot
+static thread_local std::vector<AsteroidData>	tLoadGenAsteroids;	// asteroids of the last snapshot
+
+/******************************************************************************/
+/*!
+	Seconds since start, from the steady clock.
+*/
+/******************************************************************************/
+static double loadGenSeconds(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+/******************************************************************************/
+/*!
+	Send the packet of the bot to the server.
+*/
+/******************************************************************************/
+static void loadGenSend(LoadGenBot& bot, const std::vector<uint8_t>& packet)
+{
+	SocketSendTo(bot.socket, packet.data(), packet.size(), sLoadGenServer);
+}
+
+/******************************************************************************/
+/*!
+	Pick what the bot holds down for the next half to two seconds: thrust most
+	of the time, and a turn one way or the other now and then.
+*/
+/******************************************************************************/
+static void loadGenBehave(LoadGenBot& bot, double now)
+{
+	bot.held = 0;
+	if (RandomFloat01(bot.rng) < 0.7f)
+		bot.held |= INPUT_FORWARD;
+
+	float turn = RandomFloat01(bot.rng);
+	if (turn < 0.3f)
+		bot.held |= INPUT_LEFT;
+	else if (turn < 0.6f)
+		bot.held |= INPUT_RIGHT;
+
+	bot.nextBehaviour = now + 0.5 + 1.5 * RandomFloat01(bot.rng);
+}
+
+/******************************************************************************/
+/*!
+	Handle one packet received by the bot.
+*/
+/******************************************************************************/
+static void loadGenReceive(LoadGenBot& bot, const uint8_t * pData, size_t size, double now)
+{
+	const uint8_t *	pCursor	= pData;
+	const uint8_t *	pEnd	= pData + size;
+	uint8_t			type	= NetGetHeader(pCursor, pEnd);
+
+	if (type == NET_PACKET_ACCEPT && bot.state == LOADGEN_BOT_CONNECTING)
+	{
+		uint32_t nonce	= NetGetU32(pCursor, pEnd);
+		uint32_t player	= NetGetU32(pCursor, pEnd);
+		NetGetU16(pCursor, pEnd);
+		NetGetU16(pCursor, pEnd);
+		uint8_t codec	= NetGetU8(pCursor, pEnd);
+		if (pCursor == 0 || nonce != bot.nonce || codec >= SNAPSHOT_CODEC_NUM)
+			return;
+
+		bot.state		= LOADGEN_BOT_CONNECTED;
+		bot.player		= player;
+		bot.codec		= (SNAPSHOT_CODEC)codec;
+		bot.connectedAt	= now;
+		bot.nextInput	= now;
+		loadGenBehave(bot, now);
+	}
+	else if (type == NET_PACKET_REJECT && bot.state == LOADGEN_BOT_CONNECTING)
+	{
+		uint32_t nonce = NetGetU32(pCursor, pEnd);
+		NetGetU8(pCursor, pEnd);
+		if (pCursor == 0 || nonce != bot.nonce)
+			return;
+
+		bot.state = LOADGEN_BOT_REJECTED;
+	}
+	else if (type == NET_PACKET_SNAPSHOT && bot.state == LOADGEN_BOT_CONNECTED)
+	{
+		uint32_t sequence	= NetGetU32(pCursor, pEnd);
+		NetGetU32(pCursor, pEnd);
+		uint32_t ack		= NetGetU32(pCursor, pEnd);
+		uint16_t count		= NetGetU16(pCursor, pEnd);
+		if (pCursor == 0)
+			return;
+
+		// the ids handed out follow each other from 0
+		tLoadGenMessages.clear();
+		if (!NetChannelRead(bot.channel, pCursor, pEnd, tLoadGenMessages))
+			return;
+		NetChannelReceivePacket(bot.channel, sequence);
+		for (const NetMessage& message : tLoadGenMessages)
+			bot.misordered += message.id == (uint16_t)bot.messages++ ? 0 : 1;
+
+		// the asteroids are the rest of the packet
+		tLoadGenAsteroids.resize(count);
+		bot.asteroidBytes += (unsigned long)(pEnd - pCursor);
+		if (SnapshotDecode(bot.codec, pCursor, (size_t)(pEnd - pCursor), count, tLoadGenAsteroids.data()))
+			bot.asteroids += count;
+		else
+			++bot.undecodable;
+
+		if (bot.snapshots++ == 0 || (int32_t)(sequence - bot.lastSnapshot) > 0)
+		{
+			if (bot.snapshots == 1)
+				bot.firstSnapshot = sequence;
+			bot.lastSnapshot	= sequence;
+			bot.lastSnapshotAt	= now;
+		}
+
+		// only a new ack of an input still in the history is a latency sample
+		if ((int32_t)(ack - bot.lastAck) > 0 && ack <= bot.inputSequence && bot.inputSequence - ack < LOADGEN_INPUT_HISTORY)
+			bot.latencies.push_back((float)((now - bot.sentAt[ack % LOADGEN_INPUT_HISTORY]) * 1000.0));
+		if ((int32_t)(ack - bot.lastAck) > 0)
+			bot.lastAck = ack;
+	}
+	else if (type == NET_PACKET_LEADERBOARD && bot.state == LOADGEN_BOT_CONNECTED)
+	{
+		bot.leaderboardBytes += (unsigned long)size;
+		if (ScoreboardApplyDelta(pCursor, pEnd, bot.leaderboard, bot.leaderboardVersion))
+			++bot.leaderboardDeltas;
+	}
+}
+
+/******************************************************************************/
+/*!
+	Send what is due for the bot, returns the time of its next send.
+*/
+/******************************************************************************/
+static double loadGenUpdate(LoadGenBot& bot, std::vector<uint8_t>& packet, double now)
+{
+	switch (bot.state)
+	{
+	case LOADGEN_BOT_WAITING:
+		if (now < bot.connectAt)
+			return bot.connectAt;
+		bot.state		= LOADGEN_BOT_CONNECTING;
+		bot.nextConnect	= now;
+		[[fallthrough]];
+
+	case LOADGEN_BOT_CONNECTING:
+		if (now - bot.connectAt >= LOADGEN_CONNECT_TIMEOUT)
+		{
+			bot.state = LOADGEN_BOT_FAILED;
+			return sLoadGenSeconds;
+		}
+		if (now >= bot.nextConnect)
+		{
+			NetPutHeader(packet, NET_PACKET_CONNECT);
+			NetPutU8(packet, NET_PROTOCOL_VERSION);
+			NetPutU32(packet, bot.nonce);
+			loadGenSend(bot, packet);
+			bot.nextConnect = now + LOADGEN_CONNECT_RESEND;
+		}
+		return bot.nextConnect;
+
+	case LOADGEN_BOT_CONNECTED:
+		if (now >= bot.nextBehaviour)
+			loadGenBehave(bot, now);
+		if (now >= bot.nextInput)
+		{
+			uint8_t buttons = bot.held;
+			if (RandomFloat01(bot.rng) < sLoadGenFireChance)
+				buttons |= INPUT_FIRE;
+
+			++bot.inputSequence;
+			bot.sentAt[bot.inputSequence % LOADGEN_INPUT_HISTORY] = now;
+
+			NetPutHeader(packet, NET_PACKET_INPUT);
+			NetPutU32(packet, bot.player);
+			NetPutU32(packet, bot.inputSequence);
+			NetPutU8(packet, buttons);
+			NetPutU32(packet, bot.leaderboardVersion);
+			NetPutU32(packet, bot.lastSnapshot);
+			NetPutU32(packet, bot.channel.ackBits);
+			NetPutU16(packet, bot.snapshots ? (uint16_t)(std::min(now - bot.lastSnapshotAt, 60.0) * 1000.0) : NET_INPUT_NO_SNAPSHOT);
+			loadGenSend(bot, packet);
+
+			// keep the cadence, a late thread does not send a burst to catch up
+			bot.nextInput += 1.0 / sLoadGenInputRate;
+			if (bot.nextInput < now)
+				bot.nextInput = now + 1.0 / sLoadGenInputRate;
+		}
+		return bot.nextInput;
+
+	default:
+		return sLoadGenSeconds;
+	}
+}
+
+/******************************************************************************/
+/*!
+	Run the bots [first, last) until the end of the run, then disconnect them.
+*/
+/******************************************************************************/
+static void loadGenThread(size_t first, size_t last, std::chrono::steady_clock::time_point start)
+{
+	std::vector<SocketHandle>	sockets;
+	std::vector<uint8_t>		readable(last - first);
+	std::vector<uint8_t>		packet;
+	uint8_t						buffer[NET_PACKET_MAX];
+
+	for (size_t i = first; i < last; i++)
+		sockets.push_back(sLoadGenBots[i].socket);
+
+	for (;;)
+	{
+		double now = loadGenSeconds(start);
+		if (now >= sLoadGenSeconds)
+			break;
+
+		double next = sLoadGenSeconds;
+		for (size_t i = first; i < last; i++)
+			next = std::min(next, loadGenUpdate(sLoadGenBots[i], packet, now));
+
+		int timeoutMs = next > now ? (int)((next - now) * 1000.0) : 0;
+		if (SocketPoll(sockets.data(), (unsigned int)sockets.size(), readable.data(), timeoutMs) <= 0)
+			continue;
+
+		now = loadGenSeconds(start);
+		for (size_t i = first; i < last; i++)
+		{
+			if (!readable[i - first])
+				continue;
+
+			LoadGenBot& bot = sLoadGenBots[i];
+			for (;;)
+			{
+				SocketAddress from;
+				int size = SocketRecvFrom(bot.socket, buffer, sizeof(buffer), from);
+				if (size <= 0)
+					break;
+				loadGenReceive(bot, buffer, (size_t)size, now);
+			}
+		}
+	}
+
+	for (size_t i = first; i < last; i++)
+	{
+		LoadGenBot& bot = sLoadGenBots[i];
+		if (bot.state != LOADGEN_BOT_CONNECTED)
+			continue;
+
+		NetPutHeader(packet, NET_PACKET_DISCONNECT);
+		NetPutU32(packet, bot.player);
+		loadGenSend(bot, packet);
+	}
+}
+
+/******************************************************************************/
+/*!
+	Value at fraction p of the sorted samples, 0 without samples.
+*/
+/******************************************************************************/
+static float loadGenPercentile(const std::vector<float>& sorted, double p)
+{
+	if (sorted.empty())
+		return 0.0f;
+	return sorted[(size_t)(p * (double)(sorted.size() - 1) + 0.5)];
+}
+
+/******************************************************************************/
+/*!
+	Snapshots the bot missed, from the sequence of the first and the last one.
+*/
+/******************************************************************************/
+static unsigned long loadGenLost(const LoadGenBot& bot)
+{
+	if (bot.snapshots == 0)
+		return 0;
+	unsigned long expected = (unsigned long)(bot.lastSnapshot - bot.firstSnapshot) + 1;
+	return expected > bot.snapshots ? expected - bot.snapshots : 0;
+}
+
+/******************************************************************************/
+/*!
+	LoadGenRun() reads the options, opens a socket per bot, runs the threads
+	and prints what the bots measured.
+*/
+/******************************************************************************/
+int LoadGenRun(const char * args)
+{
+	std::string		host		= "127.0.0.1";
+	unsigned long	port		= NET_DEFAULT_PORT;
+	unsigned long	botCount	= 100;
+	float			fireRate	= LOADGEN_FIRE_RATE;
+	double			ramp		= 1.0;
+	unsigned long	threadCount	= 1;
+	std::string		csvPath;
+
+	sLoadGenInputRate	= LOADGEN_INPUT_RATE;
+	sLoadGenSeconds		= 10.0;
+
+	std::string key, value;
+	while (OptionNext(args, key, value))
+	{
+		bool valid = !value.empty();
+		if (key == "server")
+			host = value;
+		else if (key == "port")
+			valid = valid && (port = strtoul(value.c_str(), 0, 10)) > 0 && port < 65536;
+		else if (key == "bots")
+			valid = valid && (botCount = strtoul(value.c_str(), 0, 10)) > 0;
+		else if (key == "rate")
+			valid = valid && (sLoadGenInputRate = (unsigned int)strtoul(value.c_str(), 0, 10)) > 0;
+		else if (key == "fire")
+			valid = valid && (fireRate = (float)atof(value.c_str())) >= 0.0f;
+		else if (key == "seconds")
+			valid = valid && (sLoadGenSeconds = atof(value.c_str())) > 0.0;
+		else if (key == "ramp")
+			valid = valid && (ramp = atof(value.c_str())) >= 0.0;
+		else if (key == "threads")
+			valid = valid && (threadCount = strtoul(value.c_str(), 0, 10)) > 0;
+		else if (key == "csv")
+			csvPath = value;
+		else
+			valid = false;
+
+		if (!valid)
+		{
+			fprintf(stderr, "loadgen: bad option \"%s=%s\"\n", key.c_str(), value.c_str());
+			return 1;
+		}
+	}
+	sLoadGenFireChance	= std::min(1.0f, fireRate / (float)sLoadGenInputRate);
+	threadCount			= std::min(threadCount, botCount);
+
+	if (!SocketStartup())
+	{
+		fprintf(stderr, "loadgen: cannot start the sockets\n");
+		return 1;
+	}
+	if (!SocketResolve(host.c_str(), (uint16_t)port, sLoadGenServer))
+	{
+		fprintf(stderr, "loadgen: cannot resolve \"%s\"\n", host.c_str());
+		SocketCleanup();
+		return 1;
+	}
+	if (!SocketReserve((unsigned int)botCount))
+		fprintf(stderr, "loadgen: cannot raise the descriptor limit, some bots may fail to open a socket\n");
+
+	// the connects are spread over the ramp so the server does not get them all in one tick
+	sLoadGenBots.assign(botCount, LoadGenBot());
+	for (unsigned long i = 0; i < botCount; i++)
+	{
+		LoadGenBot& bot = sLoadGenBots[i];
+		bot.socket		= SocketOpenUdp(0);
+		bot.state		= bot.socket == SOCKET_HANDLE_NONE ? LOADGEN_BOT_FAILED : LOADGEN_BOT_WAITING;
+		RandomSeed(bot.rng, (uint32_t)i + 1);
+		bot.nonce		= RandomNext(bot.rng);
+		bot.connectAt	= ramp * (double)i / (double)botCount;
+		NetChannelInit(bot.channel);
+	}
+
+	printf("Load generator: %lu bots on %s:%lu, %u inputs/s, %.1f shots/s, %.1f s, %lu threads\n",
+		botCount, host.c_str(), port, sLoadGenInputRate, fireRate, sLoadGenSeconds, threadCount);
+	fflush(stdout);
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	std::vector<std::thread> threads;
+	for (unsigned long t = 0; t < threadCount; t++)
+		threads.emplace_back(loadGenThread, botCount * t / threadCount, botCount * (t + 1) / threadCount, start);
+	for (std::thread& thread : threads)
+		thread.join();
+	double end = loadGenSeconds(start);
+
+	FILE * pCsv = 0;
+	if (!csvPath.empty())
+	{
+#ifdef _MSC_VER
+		fopen_s(&pCsv, csvPath.c_str(), "w");
+#else
+		pCsv = fopen(csvPath.c_str(), "w");
+#endif
+		if (pCsv == 0)
+			fprintf(stderr, "loadgen: cannot write \"%s\"\n", csvPath.c_str());
+		else
+			fprintf(pCsv, "bot,state,player,snapshots,snapshots_per_s,lost,latency_p50_ms,latency_p99_ms\n");
+	}
+
+	static const char * const stateNames[] = { "waiting", "connecting", "connected", "rejected", "failed" };
+
+	unsigned long		connected = 0, rejected = 0, failed = 0;
+	unsigned long		snapshots = 0, lost = 0;
+	unsigned long		deltas = 0, deltaBytes = 0;
+	unsigned long		messages = 0, misordered = 0, heldBack = 0, duplicates = 0;
+	unsigned long		asteroids = 0, undecodable = 0, asteroidBytes = 0;
+	uint32_t			latestVersion = 0;
+	double				rateSum = 0.0, connectedSeconds = 0.0;
+	std::vector<float>	latencies;
+	for (unsigned long i = 0; i < botCount; i++)
+	{
+		LoadGenBot& bot = sLoadGenBots[i];
+		std::sort(bot.latencies.begin(), bot.latencies.end());
+
+		double rate = 0.0;
+		if (bot.state == LOADGEN_BOT_CONNECTED)
+		{
+			++connected;
+			rate = end > bot.connectedAt ? (double)bot.snapshots / (end - bot.connectedAt) : 0.0;
+			connectedSeconds += end - bot.connectedAt;
+		}
+		else if (bot.state == LOADGEN_BOT_REJECTED)
+			++rejected;
+		else
+			++failed;
+
+		rateSum		+= rate;
+		snapshots	+= bot.snapshots;
+		lost		+= loadGenLost(bot);
+		deltas		+= bot.leaderboardDeltas;
+		deltaBytes	+= bot.leaderboardBytes;
+		messages	+= bot.messages;
+		misordered	+= bot.misordered;
+		heldBack	+= (unsigned long)bot.channel.heldBack;
+		duplicates	+= (unsigned long)bot.channel.duplicates;
+		asteroids	+= bot.asteroids;
+		undecodable	+= bot.undecodable;
+		asteroidBytes	+= bot.asteroidBytes;
+		if ((int32_t)(bot.leaderboardVersion - latestVersion) > 0)
+			latestVersion = bot.leaderboardVersion;
+		latencies.insert(latencies.end(), bot.latencies.begin(), bot.latencies.end());
+
+		if (pCsv)
+			fprintf(pCsv, "%lu,%s,%u,%lu,%.2f,%lu,%.3f,%.3f\n", i, stateNames[bot.state], bot.player,
+				bot.snapshots, rate, loadGenLost(bot),
+				loadGenPercentile(bot.latencies, 0.5), loadGenPercentile(bot.latencies, 0.99));
+
+		SocketClose(bot.socket);
+	}
+	if (pCsv)
+		fclose(pCsv);
+
+	// a bot is in sync when it holds the latest version any bot got
+	unsigned long synced = 0;
+	for (const LoadGenBot& bot : sLoadGenBots)
+		synced += bot.state == LOADGEN_BOT_CONNECTED && bot.leaderboardVersion == latestVersion ? 1 : 0;
+
+	std::sort(latencies.begin(), latencies.end());
+	printf("bots: %lu connected, %lu rejected, %lu failed\n", connected, rejected, failed);
+	printf("snapshots: %.2f/s per bot, %lu received, %.3f%% lost\n",
+		connected ? rateSum / (double)connected : 0.0, snapshots,
+		snapshots + lost ? 100.0 * (double)lost / (double)(snapshots + lost) : 0.0);
+	printf("input to ack: p50 %.3f ms, p99 %.3f ms, max %.3f ms over %zu inputs\n",
+		loadGenPercentile(latencies, 0.5), loadGenPercentile(latencies, 0.99),
+		latencies.empty() ? 0.0f : latencies.back(), latencies.size());
+	printf("leaderboard: %lu deltas, %.1f B/s per bot, %lu bots hold version %u\n",
+		deltas, connectedSeconds > 0.0 ? (double)deltaBytes / connectedSeconds : 0.0, synced, latestVersion);
+	printf("events: %lu delivered, %lu out of order, %lu held back, %lu duplicates\n",
+		messages, misordered, heldBack, duplicates);
+	printf("asteroids: %lu decoded, %lu undecodable snapshots, %.1f B per snapshot, %.1f B per asteroid\n",
+		asteroids, undecodable, snapshots ? (double)asteroidBytes / (double)snapshots : 0.0,
+		asteroids ? (double)asteroidBytes / (double)asteroids : 0.0);
+
+	std::vector<LoadGenBot>().swap(sLoadGenBots);
+	SocketCleanup();
+	return rejected + failed ? 1 : 0;
+}
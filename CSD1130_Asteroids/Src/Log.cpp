@@ -0,0 +1,330 @@
+/******************************************************************************/
+/*!
+\file		Log.cpp
+\brief		This file contains the definition of the asynchronous structured
+			log.
+
+			Every thread that logs gets a single producer single consumer ring
+			the first time it does. The thread only moves the head of its ring,
+			the background thread only moves the tail, so neither takes a lock
+			after the ring is registered. The rings are never freed: a thread
+			may still hold its ring after LogStop(), the next LogStart() uses
+			it again.
+ */
+/******************************************************************************/
+
+#include "Log.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+
+// one queued record
+struct LogRecord
+{
+	uint64_t			timeNs;			// since the clock origin
+	const char *		event;
+	uint8_t				level;
+	uint8_t				fieldCount;
+	LogField			fields[LOG_FIELD_MAX];
+};
+
+// ring of one thread, the head and the tail on their own cache lines
+struct LogRing
+{
+	alignas(64) std::atomic<uint32_t>	head;		// next record written, moved by the thread
+	alignas(64) std::atomic<uint32_t>	tail;		// next record read, moved by the background thread
+	alignas(64) std::atomic<uint64_t>	dropped;	// records that found the ring full, not reported yet
+	unsigned int						index;		// number of the thread in the lines
+	LogRecord							records[LOG_RING_SIZE];
+};
+
+// ---------------------------------------------------------------------------
+// static variables
+
+static std::mutex							sLogMutex;			// protects the ring list and the state below
+static std::condition_variable				sLogWake;			// wakes the background thread early to stop
+static std::vector<std::unique_ptr<LogRing>>	sLogRings;		// every ring, in the order the threads first logged
+static std::thread							sLogThread;
+static bool									sLogQuit;
+static std::atomic<bool>					sLogRunning;		// records are queued while set
+static FILE *								spLogFile;			// where the lines go
+static std::atomic<uint64_t>				sLogDroppedTotal;
+static const std::chrono::steady_clock::time_point	sLogOrigin = std::chrono::steady_clock::now();
+
+static thread_local LogRing *				tLogRing;			// ring of the calling thread
+
+static const char * const					sLogLevelNames[] = { "debug", "info", "warn", "error" };
+
+/******************************************************************************/
+/*!
+	Nanoseconds since the clock origin.
+*/
+/******************************************************************************/
+static uint64_t logNow()
+{
+	return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now() - sLogOrigin).count();
+}
+
+/******************************************************************************/
+/*!
+	Append one record as a line of "key=value" pairs. Text with a space or a
+	quote is quoted.
+*/
+/******************************************************************************/
+static void logFormat(std::string& out, const LogRecord& record, unsigned int thread)
+{
+	char buffer[64];
+	snprintf(buffer, sizeof(buffer), "t=%.6f level=%s thread=%u event=", (double)record.timeNs * 1e-9,
+		sLogLevelNames[record.level <= LOG_ERROR ? record.level : (uint8_t)LOG_ERROR], thread);
+	out += buffer;
+	out += record.event;
+
+	for (unsigned int f = 0; f < record.fieldCount; f++)
+	{
+		const LogField& field = record.fields[f];
+		out += ' ';
+		out += field.key;
+		out += '=';
+
+		if (field.type == LOG_FIELD_INT)
+		{
+			snprintf(buffer, sizeof(buffer), "%lld", (long long)field.value.i);
+			out += buffer;
+		}
+		else if (field.type == LOG_FIELD_FLOAT)
+		{
+			snprintf(buffer, sizeof(buffer), "%.6g", field.value.f);
+			out += buffer;
+		}
+		else
+		{
+			const char * text = field.value.s ? field.value.s : "";
+			bool quote = *text == 0 || strpbrk(text, " \"=") != 0;
+			if (quote)
+				out += '"';
+			for (; *text; text++)
+			{
+				if (*text == '"')
+					out += '\\';
+				out += *text;
+			}
+			if (quote)
+				out += '"';
+		}
+	}
+	out += '\n';
+}
+
+/******************************************************************************/
+/*!
+	Copy the records of every ring out and give the slots back, then write
+	them sorted by time in one batch, with a line for the drops.
+*/
+/******************************************************************************/
+static void logDrain(std::vector<std::pair<LogRecord, unsigned int>>& batch, std::string& out)
+{
+	batch.clear();
+	out.clear();
+
+	uint64_t dropped = 0;
+	{
+		std::lock_guard<std::mutex> lock(sLogMutex);
+		for (const std::unique_ptr<LogRing>& pRing : sLogRings)
+		{
+			uint32_t tail = pRing->tail.load(std::memory_order_relaxed);
+			uint32_t head = pRing->head.load(std::memory_order_acquire);
+			for (; tail != head; tail++)
+				batch.emplace_back(pRing->records[tail & (LOG_RING_SIZE - 1)], pRing->index);
+			pRing->tail.store(tail, std::memory_order_release);
+
+			dropped += pRing->dropped.exchange(0, std::memory_order_relaxed);
+		}
+
+		// counted under the lock, LogDropped() sees the drops in a ring or in the total
+		sLogDroppedTotal.fetch_add(dropped, std::memory_order_relaxed);
+	}
+
+	// each ring is in order, the threads are merged by time
+	std::stable_sort(batch.begin(), batch.end(), [](const std::pair<LogRecord, unsigned int>& a,
+													const std::pair<LogRecord, unsigned int>& b)
+	{
+		return a.first.timeNs < b.first.timeNs;
+	});
+
+	for (const std::pair<LogRecord, unsigned int>& entry : batch)
+		logFormat(out, entry.first, entry.second);
+
+	if (dropped)
+	{
+		LogRecord record = { logNow(), "log.dropped", LOG_WARN, 2, {} };
+		record.fields[0] = LogInt("count", (int64_t)dropped);
+		record.fields[1] = LogInt("total", (int64_t)sLogDroppedTotal.load(std::memory_order_relaxed));
+		logFormat(out, record, 0);
+	}
+
+	if (!out.empty())
+	{
+		fwrite(out.data(), 1, out.size(), spLogFile);
+		fflush(spLogFile);
+	}
+}
+
+/******************************************************************************/
+/*!
+	Body of the background thread: drain the rings every LOG_FLUSH_MS until
+	LogStop(), then one last time.
+*/
+/******************************************************************************/
+static void logMain()
+{
+	std::vector<std::pair<LogRecord, unsigned int>>	batch;
+	std::string										out;
+
+	for (;;)
+	{
+		bool quit = false;
+		{
+			std::unique_lock<std::mutex> lock(sLogMutex);
+			sLogWake.wait_for(lock, std::chrono::milliseconds(LOG_FLUSH_MS), [] { return sLogQuit; });
+			quit = sLogQuit;
+		}
+
+		logDrain(batch, out);
+		if (quit)
+			return;
+	}
+}
+
+/******************************************************************************/
+/*!
+	LogStart() opens the output and starts the background thread.
+*/
+/******************************************************************************/
+bool LogStart(const char * path)
+{
+	if (sLogRunning.load())
+		return true;
+
+	FILE * pFile = stdout;
+	if (path)
+	{
+#ifdef _MSC_VER
+		if (fopen_s(&pFile, path, "a") != 0)
+			pFile = 0;
+#else
+		pFile = fopen(path, "a");
+#endif
+		if (pFile == 0)
+			return false;
+	}
+
+	spLogFile	= pFile;
+	sLogQuit	= false;
+	sLogRunning.store(true);
+	sLogThread	= std::thread(logMain);
+	return true;
+}
+
+/******************************************************************************/
+/*!
+	LogStop() stops the queueing first, so the last drain sees every record
+	that made it into a ring.
+*/
+/******************************************************************************/
+void LogStop()
+{
+	if (!sLogRunning.exchange(false))
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(sLogMutex);
+		sLogQuit = true;
+	}
+	sLogWake.notify_one();
+	sLogThread.join();
+
+	if (sLogDroppedTotal.load())
+		fprintf(spLogFile, "log: %llu record(s) dropped\n", (unsigned long long)sLogDroppedTotal.load());
+
+	if (spLogFile != stdout)
+		fclose(spLogFile);
+	else
+		fflush(stdout);
+	spLogFile = 0;
+}
+
+/******************************************************************************/
+/*!
+	LogWrite() copies the record into the ring of the calling thread, or
+	counts it as dropped if the ring is full. The ring is created and
+	registered the first time the thread logs.
+*/
+/******************************************************************************/
+void LogWrite(LOG_LEVEL level, const char * event, std::initializer_list<LogField> fields)
+{
+	LogRecord record;
+	record.timeNs		= logNow();
+	record.event		= event;
+	record.level		= (uint8_t)level;
+	record.fieldCount	= (uint8_t)std::min((size_t)LOG_FIELD_MAX, fields.size());
+	std::copy(fields.begin(), fields.begin() + record.fieldCount, record.fields);
+
+	if (!sLogRunning.load(std::memory_order_acquire))
+	{
+		std::string out;
+		logFormat(out, record, 0);
+		fputs(out.c_str(), stdout);
+		return;
+	}
+
+	if (tLogRing == 0)
+	{
+		std::unique_ptr<LogRing> pRing(new LogRing());
+		pRing->head.store(0);
+		pRing->tail.store(0);
+		pRing->dropped.store(0);
+
+		std::lock_guard<std::mutex> lock(sLogMutex);
+		pRing->index = (unsigned int)sLogRings.size();
+		tLogRing = pRing.get();
+		sLogRings.push_back(std::move(pRing));
+	}
+
+	uint32_t head = tLogRing->head.load(std::memory_order_relaxed);
+	if (head - tLogRing->tail.load(std::memory_order_acquire) >= LOG_RING_SIZE)
+	{
+		tLogRing->dropped.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	tLogRing->records[head & (LOG_RING_SIZE - 1)] = record;
+	tLogRing->head.store(head + 1, std::memory_order_release);
+}
+
+/******************************************************************************/
+/*!
+	LogDropped() returns the records dropped so far, the ones not reported by
+	the background thread yet included.
+*/
+/******************************************************************************/
+uint64_t LogDropped()
+{
+	uint64_t dropped = sLogDroppedTotal.load();
+
+	std::lock_guard<std::mutex> lock(sLogMutex);
+	for (const std::unique_ptr<LogRing>& pRing : sLogRings)
+		dropped += pRing->dropped.load(std::memory_order_relaxed);
+	return dropped;
+}
@@ -18,7 +18,13 @@ prior written consent of DigiPen Institute of Technology is prohibited.
 
 #include <iostream>
 
-#include "main.h"
+#include "Main.h"
+#include "Benchmark.h"
+#include "LoadGen.h"
+#include "Log.h"
+#include "Metrics.h"
+#include "Replay.h"
+#include "Server.h"
 
 #include <memory>
 
@@ -44,6 +50,23 @@ char SERVER_PORT_BUFFER[MAX_PORT_LEN_STR];
 
 constexpr short PORT = 0;
 
+/******************************************************************************/
+/*!
+	Keep the console of a headless mode open until Enter is pressed, so its
+	output can be read. Nothing to wait for when interactive is false: the
+	input was redirected (a script runs the mode) or -headless comes before
+	the mode, nor when the input is not a console.
+*/
+/******************************************************************************/
+static void mainExitPause(bool interactive)
+{
+	DWORD mode = 0;
+	if (!interactive || !GetConsoleMode(GetStdHandle(STD_INPUT_HANDLE), &mode))
+		return;
+
+	std::cout << "Press Enter to exit..." << std::endl;
+	std::cin.get();
+}
 
 /******************************************************************************/
 /*!
@@ -57,6 +80,11 @@ constexpr short PORT = 0;
 /******************************************************************************/
 int WINAPI WinMain(HINSTANCE instanceH, HINSTANCE prevInstanceH, LPSTR command_line, int show)
 {
+	// A redirected input is seen before the console replaces it, e.g. "Asteroids.exe -bench suite < nul" from a script.
+	// A headless mode waits for Enter at the end only when run by hand, "-headless -bench suite" never waits
+	DWORD	stdinType	= GetFileType(GetStdHandle(STD_INPUT_HANDLE));
+	bool	interactive	= stdinType != FILE_TYPE_DISK && stdinType != FILE_TYPE_PIPE && strstr(command_line, "-headless") == nullptr;
+
 	// Create a console window
 	AllocConsole();
 	// Attach the console window to this application's process
@@ -72,7 +100,6 @@ int WINAPI WinMain(HINSTANCE instanceH, HINSTANCE prevInstanceH, LPSTR command_l
 
 
 	UNREFERENCED_PARAMETER(prevInstanceH);
-	UNREFERENCED_PARAMETER(command_line);
 
 	// Enable run-time memory check for debug builds.
 #if defined(DEBUG) | defined(_DEBUG)
@@ -82,6 +109,46 @@ int WINAPI WinMain(HINSTANCE instanceH, HINSTANCE prevInstanceH, LPSTR command_l
 	//int * pi = new int;
 	////delete pi;
 
+	// Headless benchmarks, e.g. "-bench capacity 100000"
+	const char* benchArg = strstr(command_line, "-bench");
+	if (benchArg != nullptr)
+	{
+		int result = BenchmarkRun(benchArg + strlen("-bench"));
+		mainExitPause(interactive);
+		FreeConsole();
+		return result;
+	}
+
+	// Headless replay of a recorded match, e.g. "-replay match.rpl" or "-replay match.rpl 162000" to seek first
+	const char* replayArg = strstr(command_line, "-replay");
+	if (replayArg != nullptr)
+	{
+		int result = ReplayRun(replayArg + strlen("-replay"));
+		mainExitPause(interactive);
+		FreeConsole();
+		return result;
+	}
+
+	// Headless UDP server, e.g. "-server port=7777 asteroids=500"
+	const char* serverArg = strstr(command_line, "-server");
+	if (serverArg != nullptr)
+	{
+		int result = ServerRun(serverArg + strlen("-server"));
+		mainExitPause(interactive);
+		FreeConsole();
+		return result;
+	}
+
+	// Bot swarm against a server, e.g. "-loadgen server=127.0.0.1 bots=1000 threads=4"
+	const char* loadGenArg = strstr(command_line, "-loadgen");
+	if (loadGenArg != nullptr)
+	{
+		int result = LoadGenRun(loadGenArg + strlen("-loadgen"));
+		mainExitPause(interactive);
+		FreeConsole();
+		return result;
+	}
+
 
 	// Initialize the system
 	AESysInit(instanceH, 0, 800, 600, 0, 60, false, NULL);
@@ -116,25 +183,76 @@ int WINAPI WinMain(HINSTANCE instanceH, HINSTANCE prevInstanceH, LPSTR command_l
 		return 1;
 	}
 
-	// Get the IP address
-	char* ip = inet_ntoa(*(struct in_addr*)*host->h_addr_list);
+	// Get the IP address, copied out of the static buffer of inet_ntoa: the log thread reads it until LogStop()
+	char ip[16];
+	strcpy_s(ip, sizeof(ip), inet_ntoa(*(struct in_addr*)*host->h_addr_list));
 
-	std::cout << "IP Address: " << ip << std::endl;
-	std::cout << "Port: " << SERVER_PORT_BUFFER << std::endl;
+	// the prompts are done, from here the console is written by the log thread
+	LogStart();
+	LogWrite(LOG_INFO, "address", { LogText("ip", ip), LogText("port", SERVER_PORT_BUFFER) });
 
+	// Large-world mode, e.g. "-world 8000x6000"
+	const char* worldArg = strstr(command_line, "-world");
+	if (worldArg != nullptr)
+	{
+		float worldWidth = 0.0f, worldHeight = 0.0f;
+		if (sscanf_s(worldArg, "-world %fx%f", &worldWidth, &worldHeight) == 2)
+		{
+			AEVec2 world = GameStateAsteroidsSetWorldSize(worldWidth, worldHeight);
+			LogWrite(LOG_INFO, "world", { LogFloat("width", world.x), LogFloat("height", world.y) });
+		}
+	}
 
+	// Headless mode, the simulation runs but no transform is computed and nothing is drawn
+	if (strstr(command_line, "-headless") != nullptr)
+	{
+		GameStateAsteroidsSetViewEnabled(false);
+		LogWrite(LOG_INFO, "headless", { LogText("view", "disabled") });
+	}
 
+	// Fixed random seed, e.g. "-seed 1234", to run the same match again
+	const char* seedArg = strstr(command_line, "-seed");
+	if (seedArg != nullptr)
+	{
+		unsigned int seed = 0;
+		if (sscanf_s(seedArg, "-seed %u", &seed) == 1)
+			GameStateAsteroidsSetSeed(seed);
+	}
 
+	// Input log recording, e.g. "-record match.rpl", played back with "-replay match.rpl"
+	const char* recordArg = strstr(command_line, "-record");
+	if (recordArg != nullptr)
+	{
+		char recordPath[MAX_PATH] = {};
+		if (sscanf_s(recordArg, "-record %259s", recordPath, (unsigned)sizeof(recordPath)) == 1)
+			GameStateAsteroidsSetRecordPath(recordPath);
+	}
 
 
 
 
+
+
+
+
+	// Metrics endpoint, e.g. "-metrics 9100" for http://127.0.0.1:9100/metrics
+	const char* metricsArg = strstr(command_line, "-metrics");
+	if (metricsArg != nullptr)
+	{
+		unsigned int metricsPort = METRICS_DEFAULT_PORT;
+		sscanf_s(metricsArg, "-metrics %u", &metricsPort);
+		if (MetricsServe((uint16_t)metricsPort))
+			LogWrite(LOG_INFO, "metrics", { LogInt("port", metricsPort) });
+		else
+			LogWrite(LOG_ERROR, "metrics.bind_failed", { LogInt("port", metricsPort) });
+	}
+
 	GameStateMgrInit(GS_ASTEROIDS);
 
-	std::cout << "Waiting for Player to connect..." << std::endl;
+	LogWrite(LOG_INFO, "waiting_for_player");
 	std::unique_lock<std::mutex> lock(serverState.world.PlayerCountMutex);
 	serverState.world.PlayerCount.wait(lock, [&] {return serverState.world.numPlayers > 0; });
-	std::cout << "Player connected!" << std::endl;
+	LogWrite(LOG_INFO, "player_connected");
 	while (gGameStateCurr != GS_QUIT)
 	{
 
@@ -180,6 +298,10 @@ int WINAPI WinMain(HINSTANCE instanceH, HINSTANCE prevInstanceH, LPSTR command_l
 		gGameStateCurr = gGameStateNext;
 	}
 
+	// write what is left in the log
+	MetricsStop();
+	LogStop();
+
 	// free the system
 	AESysExit();
 	FreeConsole();
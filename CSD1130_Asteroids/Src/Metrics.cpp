@@ -0,0 +1,413 @@
+/******************************************************************************/
+/*!
+\file		Metrics.cpp
+\brief		This file contains the definition of the metrics and of their HTTP
+			endpoint.
+
+			Every thread that updates a counter gets a shard the first time it
+			does, like the rings of the log. Only that thread writes it, so an
+			update is a relaxed load and a relaxed store of its own slot, the
+			scrape only reads. The shards are never freed: what a thread that
+			exited counted stays in the totals.
+ */
+/******************************************************************************/
+
+#include "Metrics.h"
+#include "Socket.h"
+#include "Log.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <stdio.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+
+// counters of one thread, on cache lines no other shard touches
+struct alignas(64) MetricsShard
+{
+	std::atomic<uint64_t>	counters[METRIC_COUNTER_NUM];
+	std::atomic<uint64_t>	tickBuckets[METRICS_TICK_BUCKET_NUM + 1];	// the last one is +Inf
+	std::atomic<uint64_t>	tickNs;										// sum of the tick times
+};
+
+// one gauge, the bits of a double on a cache line of its own
+struct alignas(64) MetricsGaugeSlot
+{
+	std::atomic<uint64_t>	bits;
+};
+
+// name and help of a metric
+struct MetricsInfo
+{
+	const char *	name;
+	const char *	help;
+};
+
+// ---------------------------------------------------------------------------
+// static variables
+
+static const MetricsInfo sMetricsCounterInfo[METRIC_COUNTER_NUM] =
+{
+	{ "asteroids_packets_in_total",			"Datagrams received by the server." },
+	{ "asteroids_packets_out_total",		"Datagrams sent by the server." },
+	{ "asteroids_bytes_in_total",			"Bytes received by the server." },
+	{ "asteroids_bytes_out_total",			"Bytes sent by the server." },
+	{ "asteroids_clients_joined_total",		"Sessions accepted." },
+	{ "asteroids_clients_left_total",		"Sessions closed, by disconnect, timeout or shutdown." },
+	{ "asteroids_clients_rejected_total",	"Connections refused." },
+	{ "asteroids_snapshots_total",			"Snapshot rounds sent to the sessions." },
+	{ "asteroids_recv_calls_total",			"System calls the transport made to receive, the empty ones included." },
+	{ "asteroids_send_calls_total",			"System calls the transport made to send." },
+	{ "asteroids_send_dropped_total",		"Datagrams the system refused to send." },
+	{ "asteroids_shard_dropped_total",		"Commands dropped by a socket shard whose queue to the simulation was full." },
+	{ "asteroids_send_segmented_total",		"Datagrams sent in segmented messages, cut by the system (UDP_SEGMENT)." },
+	{ "asteroids_messages_sent_total",		"Reliable messages written into snapshots, the resends included." },
+	{ "asteroids_messages_resent_total",	"Reliable messages sent again after their packet went unacknowledged." },
+	{ "asteroids_messages_refused_total",	"Reliable messages a session had no room for in its channel." },
+};
+
+static const MetricsInfo sMetricsGaugeInfo[METRIC_GAUGE_NUM] =
+{
+	{ "asteroids_clients",					"Sessions of the server." },
+	{ "asteroids_ships",					"Active ships after the last tick." },
+	{ "asteroids_asteroids",				"Active asteroids after the last tick." },
+	{ "asteroids_bullets",					"Active bullets after the last tick." },
+	{ "asteroids_recv_batch_max",			"Most datagrams received by one system call." },
+	{ "asteroids_send_batch_max",			"Most datagrams sent by one system call." },
+	{ "asteroids_packet_buffers",			"Buffers allocated by the packet pool." },
+	{ "asteroids_packets_in_use",			"Packet buffers held by a send queue or a writer." },
+	{ "asteroids_snapshot_rate_hz",			"Snapshots per second the sessions got over the last period, their mean." },
+};
+
+static std::mutex								sMetricsMutex;		// protects the shard list and the session table
+static std::vector<std::unique_ptr<MetricsShard>>	sMetricsShards;
+static MetricsGaugeSlot							sMetricsGauges[METRIC_GAUGE_NUM];
+static std::vector<MetricsClient>				sMetricsClients;	// last table published
+static thread_local MetricsShard *				tMetricsShard;		// shard of the calling thread
+
+static SocketHandle								sMetricsListener = SOCKET_HANDLE_NONE;
+static std::thread								sMetricsThread;
+static std::atomic<bool>						sMetricsQuit;
+
+/******************************************************************************/
+/*!
+	Shard of the calling thread, created and registered the first time.
+*/
+/******************************************************************************/
+static MetricsShard& metricsShard()
+{
+	if (tMetricsShard == 0)
+	{
+		std::unique_ptr<MetricsShard> pShard(new MetricsShard());
+		for (std::atomic<uint64_t>& counter : pShard->counters)
+			counter.store(0, std::memory_order_relaxed);
+		for (std::atomic<uint64_t>& bucket : pShard->tickBuckets)
+			bucket.store(0, std::memory_order_relaxed);
+		pShard->tickNs.store(0, std::memory_order_relaxed);
+
+		std::lock_guard<std::mutex> lock(sMetricsMutex);
+		tMetricsShard = pShard.get();
+		sMetricsShards.push_back(std::move(pShard));
+	}
+	return *tMetricsShard;
+}
+
+/******************************************************************************/
+/*!
+	Add to a slot only the calling thread writes: no locked instruction, the
+	store is atomic so the scrape never reads a torn value.
+*/
+/******************************************************************************/
+static void metricsBump(std::atomic<uint64_t>& slot, uint64_t value)
+{
+	slot.store(slot.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+/******************************************************************************/
+/*!
+	Append the HELP and TYPE lines of a metric.
+*/
+/******************************************************************************/
+static void metricsHeader(std::string& out, const char * name, const char * help, const char * type)
+{
+	out += "# HELP ";
+	out += name;
+	out += ' ';
+	out += help;
+	out += "\n# TYPE ";
+	out += name;
+	out += ' ';
+	out += type;
+	out += '\n';
+}
+
+/******************************************************************************/
+/*!
+	Append one sample line, label is "" or "key=\"value\"".
+*/
+/******************************************************************************/
+static void metricsSample(std::string& out, const char * name, const char * label, double value)
+{
+	char buffer[160];
+	snprintf(buffer, sizeof(buffer), *label ? "%s{%s} %.9g\n" : "%s%s %.9g\n", name, label, value);
+	out += buffer;
+}
+
+/******************************************************************************/
+/*!
+	Answer one connection: read the request line, send the metrics for
+	"GET /metrics" and 404 for anything else.
+*/
+/******************************************************************************/
+static void metricsAnswer(SocketHandle connection)
+{
+	char	request[2048];
+	size_t	size = 0;
+	while (size < sizeof(request) - 1)
+	{
+		int received = SocketRecv(connection, request + size, sizeof(request) - 1 - size);
+		if (received <= 0)
+			break;
+		size += (size_t)received;
+		request[size] = 0;
+		if (strstr(request, "\r\n\r\n") || strstr(request, "\n\n"))
+			break;
+	}
+	request[size] = 0;
+
+	std::string body;
+	const char * status = "404 Not Found";
+	const char * type	= "text/plain; charset=utf-8";
+	if (strncmp(request, "GET /metrics ", 13) == 0 || strncmp(request, "GET /metrics?", 13) == 0)
+	{
+		MetricsWrite(body);
+		status	= "200 OK";
+		type	= "text/plain; version=0.0.4; charset=utf-8";
+	}
+	else
+		body = "try /metrics\n";
+
+	char header[256];
+	snprintf(header, sizeof(header), "HTTP/1.0 %s\r\nContent-Type: %s\r\nContent-Length: %zu\r\nConnection: close\r\n\r\n",
+		status, type, body.size());
+
+	if (SocketSend(connection, header, strlen(header)))
+		SocketSend(connection, body.data(), body.size());
+}
+
+/******************************************************************************/
+/*!
+	Body of the endpoint thread: wait for connections and answer them one at
+	a time, a scrape every few seconds needs no more.
+*/
+/******************************************************************************/
+static void metricsMain()
+{
+	while (!sMetricsQuit.load())
+	{
+		uint8_t readable = 0;
+		if (SocketPoll(&sMetricsListener, 1, &readable, 100) <= 0)
+			continue;
+
+		SocketHandle connection = SocketAccept(sMetricsListener, 1000);
+		if (connection == SOCKET_HANDLE_NONE)
+			continue;
+
+		metricsAnswer(connection);
+		SocketClose(connection);
+	}
+}
+
+/******************************************************************************/
+/*!
+	MetricsAdd() adds to the counter in the shard of the calling thread.
+*/
+/******************************************************************************/
+void MetricsAdd(METRIC_COUNTER counter, uint64_t value)
+{
+	metricsBump(metricsShard().counters[counter], value);
+}
+
+/******************************************************************************/
+/*!
+	MetricsSet() stores the gauge, the last writer wins.
+*/
+/******************************************************************************/
+void MetricsSet(METRIC_GAUGE gauge, double value)
+{
+	uint64_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+	sMetricsGauges[gauge].bits.store(bits, std::memory_order_relaxed);
+}
+
+/******************************************************************************/
+/*!
+	MetricsObserveTick() counts the tick in the first bucket it fits in, the
+	scrape makes the buckets cumulative.
+*/
+/******************************************************************************/
+void MetricsObserveTick(double seconds)
+{
+	MetricsShard& shard = metricsShard();
+
+	unsigned int bucket = 0;
+	while (bucket < METRICS_TICK_BUCKET_NUM && seconds > METRICS_TICK_BUCKETS[bucket])
+		++bucket;
+
+	metricsBump(shard.tickBuckets[bucket], 1);
+	metricsBump(shard.tickNs, (uint64_t)(seconds * 1e9));
+}
+
+/******************************************************************************/
+/*!
+	MetricsSetClients() replaces the session table.
+*/
+/******************************************************************************/
+void MetricsSetClients(const MetricsClient * pClients, size_t count)
+{
+	std::lock_guard<std::mutex> lock(sMetricsMutex);
+	sMetricsClients.assign(pClients, pClients + count);
+}
+
+/******************************************************************************/
+/*!
+	MetricsWrite() adds the shards up and appends every metric. The counters
+	of a shard are read one by one while its thread runs, a scrape is not an
+	instant but every value in it is one the counter held.
+*/
+/******************************************************************************/
+void MetricsWrite(std::string& out)
+{
+	uint64_t counters[METRIC_COUNTER_NUM]			= {};
+	uint64_t tickBuckets[METRICS_TICK_BUCKET_NUM + 1] = {};
+	uint64_t tickNs									= 0;
+	std::vector<MetricsClient> clients;
+	{
+		std::lock_guard<std::mutex> lock(sMetricsMutex);
+		for (const std::unique_ptr<MetricsShard>& pShard : sMetricsShards)
+		{
+			for (unsigned int c = 0; c < METRIC_COUNTER_NUM; c++)
+				counters[c] += pShard->counters[c].load(std::memory_order_relaxed);
+			for (unsigned int b = 0; b <= METRICS_TICK_BUCKET_NUM; b++)
+				tickBuckets[b] += pShard->tickBuckets[b].load(std::memory_order_relaxed);
+			tickNs += pShard->tickNs.load(std::memory_order_relaxed);
+		}
+		clients = sMetricsClients;
+	}
+
+	for (unsigned int c = 0; c < METRIC_COUNTER_NUM; c++)
+	{
+		metricsHeader(out, sMetricsCounterInfo[c].name, sMetricsCounterInfo[c].help, "counter");
+		metricsSample(out, sMetricsCounterInfo[c].name, "", (double)counters[c]);
+	}
+
+	metricsHeader(out, "asteroids_log_dropped_total", "Log records dropped because a ring was full.", "counter");
+	metricsSample(out, "asteroids_log_dropped_total", "", (double)LogDropped());
+
+	for (unsigned int g = 0; g < METRIC_GAUGE_NUM; g++)
+	{
+		uint64_t	bits = sMetricsGauges[g].bits.load(std::memory_order_relaxed);
+		double		value;
+		memcpy(&value, &bits, sizeof(value));
+
+		metricsHeader(out, sMetricsGaugeInfo[g].name, sMetricsGaugeInfo[g].help, "gauge");
+		metricsSample(out, sMetricsGaugeInfo[g].name, "", value);
+	}
+
+	metricsHeader(out, "asteroids_tick_seconds", "Time spent in a tick of the simulation.", "histogram");
+	uint64_t cumulative = 0;
+	char label[64];
+	for (unsigned int b = 0; b <= METRICS_TICK_BUCKET_NUM; b++)
+	{
+		cumulative += tickBuckets[b];
+		if (b < METRICS_TICK_BUCKET_NUM)
+			snprintf(label, sizeof(label), "le=\"%g\"", METRICS_TICK_BUCKETS[b]);
+		else
+			snprintf(label, sizeof(label), "le=\"+Inf\"");
+		metricsSample(out, "asteroids_tick_seconds_bucket", label, (double)cumulative);
+	}
+	metricsSample(out, "asteroids_tick_seconds_sum", "", (double)tickNs * 1e-9);
+	metricsSample(out, "asteroids_tick_seconds_count", "", (double)cumulative);
+
+	metricsHeader(out, "asteroids_client_rtt_seconds", "Smoothed round trip time of a session.", "gauge");
+	for (const MetricsClient& client : clients)
+	{
+		snprintf(label, sizeof(label), "player=\"%u\"", client.player);
+		metricsSample(out, "asteroids_client_rtt_seconds", label, client.rttMs * 1e-3);
+	}
+
+	metricsHeader(out, "asteroids_client_input_loss_ratio", "Fraction of the inputs of a session lost over the last period.", "gauge");
+	for (const MetricsClient& client : clients)
+	{
+		snprintf(label, sizeof(label), "player=\"%u\"", client.player);
+		metricsSample(out, "asteroids_client_input_loss_ratio", label, client.loss);
+	}
+
+	metricsHeader(out, "asteroids_client_snapshot_rate_hz", "Snapshots per second a session got over the last period.", "gauge");
+	for (const MetricsClient& client : clients)
+	{
+		snprintf(label, sizeof(label), "player=\"%u\"", client.player);
+		metricsSample(out, "asteroids_client_snapshot_rate_hz", label, client.snapshotRate);
+	}
+
+	metricsHeader(out, "asteroids_client_snapshot_loss_ratio", "Smoothed fraction of the snapshots of a session lost.", "gauge");
+	for (const MetricsClient& client : clients)
+	{
+		snprintf(label, sizeof(label), "player=\"%u\"", client.player);
+		metricsSample(out, "asteroids_client_snapshot_loss_ratio", label, client.snapshotLoss);
+	}
+
+	metricsHeader(out, "asteroids_client_bandwidth_bytes", "Bytes per second delivered to a session, from its acknowledgements.", "gauge");
+	for (const MetricsClient& client : clients)
+	{
+		snprintf(label, sizeof(label), "player=\"%u\"", client.player);
+		metricsSample(out, "asteroids_client_bandwidth_bytes", label, client.bandwidth);
+	}
+
+	metricsHeader(out, "asteroids_client_packet_budget_bytes", "Bytes of a snapshot to a session at most.", "gauge");
+	for (const MetricsClient& client : clients)
+	{
+		snprintf(label, sizeof(label), "player=\"%u\"", client.player);
+		metricsSample(out, "asteroids_client_packet_budget_bytes", label, client.budget);
+	}
+}
+
+/******************************************************************************/
+/*!
+	MetricsServe() binds the endpoint and starts its thread.
+*/
+/******************************************************************************/
+bool MetricsServe(uint16_t port)
+{
+	if (sMetricsListener != SOCKET_HANDLE_NONE)
+		return true;
+
+	sMetricsListener = SocketListenTcp(port, true);
+	if (sMetricsListener == SOCKET_HANDLE_NONE)
+		return false;
+
+	sMetricsQuit.store(false);
+	sMetricsThread = std::thread(metricsMain);
+	return true;
+}
+
+/******************************************************************************/
+/*!
+	MetricsStop() stops the endpoint thread, it notices within 100 ms.
+*/
+/******************************************************************************/
+void MetricsStop()
+{
+	if (sMetricsListener == SOCKET_HANDLE_NONE)
+		return;
+
+	sMetricsQuit.store(true);
+	sMetricsThread.join();
+
+	SocketClose(sMetricsListener);
+	sMetricsListener = SOCKET_HANDLE_NONE;
+}
@@ -0,0 +1,257 @@
+/******************************************************************************/
+/*!
+\file		NetChannel.cpp
+\brief		This file contains the definition of the reliable ordered message
+			channel.
+
+			The ids are 16 bits and wrap, they are compared by their distance
+			to the oldest message of the sender or to the next message the
+			receiver expects. The sender never writes a message more than
+			NET_CHANNEL_WINDOW past its oldest, so a message the receiver gets
+			is either behind what it expects (a duplicate) or in its window.
+ */
+/******************************************************************************/
+
+#include "NetChannel.h"
+#include "NetProtocol.h"
+
+#include <string.h>
+
+/******************************************************************************/
+/*!
+	NetChannelInit() empties the sender.
+*/
+/******************************************************************************/
+void NetChannelInit(NetChannelSender& sender)
+{
+	memset(&sender, 0, sizeof(sender));
+}
+
+/******************************************************************************/
+/*!
+	NetChannelInit() empties the receiver, the first message expected is 0.
+*/
+/******************************************************************************/
+void NetChannelInit(NetChannelReceiver& receiver)
+{
+	memset(&receiver, 0, sizeof(receiver));
+}
+
+/******************************************************************************/
+/*!
+	NetChannelQueue() copies the message into the slot of its id.
+*/
+/******************************************************************************/
+bool NetChannelQueue(NetChannelSender& sender, uint8_t type, const void * pPayload, size_t size)
+{
+	if ((uint16_t)(sender.next - sender.oldest) >= NET_CHANNEL_QUEUE || size > NET_MESSAGE_PAYLOAD_MAX)
+	{
+		++sender.stats.refused;
+		return false;
+	}
+
+	unsigned int	slot	= sender.next & (NET_CHANNEL_QUEUE - 1);
+	NetMessage&		message	= sender.messages[slot];
+	message.id		= sender.next++;
+	message.type	= type;
+	message.size	= (uint8_t)size;
+	if (size)
+		memcpy(message.payload, pPayload, size);
+
+	sender.sentAt[slot]	= -1.0;
+	sender.acked[slot]	= false;
+	++sender.stats.queued;
+	return true;
+}
+
+/******************************************************************************/
+/*!
+	NetChannelWrite() writes the count first and sets it once the messages
+	are in. The slot of the packet forgets the packet that had it before, the
+	messages of that one are resent on their timeout if it was lost.
+*/
+/******************************************************************************/
+unsigned int NetChannelWrite(NetChannelSender& sender, uint32_t sequence, double now, double resendAfter, size_t budget,
+							 std::vector<uint8_t>& packet)
+{
+	size_t countAt = packet.size();
+	NetPutU8(packet, 0);
+	size_t used = 1;
+
+	unsigned int	slot	= sequence & (NET_CHANNEL_PACKETS - 1);
+	unsigned int	written	= 0;
+	sender.packetSequence[slot]	= sequence;
+	sender.packetCount[slot]	= 0;
+
+	for (uint16_t id = sender.oldest; id != sender.next && (uint16_t)(id - sender.oldest) < NET_CHANNEL_WINDOW &&
+		 written < NET_CHANNEL_PACKET_MESSAGES; id++)
+	{
+		unsigned int index = id & (NET_CHANNEL_QUEUE - 1);
+		if (sender.acked[index] || (sender.sentAt[index] >= 0.0 && now - sender.sentAt[index] < resendAfter))
+			continue;
+
+		const NetMessage& message = sender.messages[index];
+		if (used + NET_MESSAGE_HEADER_SIZE + message.size > budget)
+			break;
+
+		NetPutU16(packet, message.id);
+		NetPutU8(packet, message.type);
+		NetPutU8(packet, message.size);
+		packet.insert(packet.end(), message.payload, message.payload + message.size);
+		used += NET_MESSAGE_HEADER_SIZE + message.size;
+
+		if (sender.sentAt[index] >= 0.0)
+			++sender.stats.resent;
+		++sender.stats.sent;
+		sender.sentAt[index]				= now;
+		sender.packetIds[slot][written++]	= id;
+	}
+
+	packet[countAt]				= (uint8_t)written;
+	sender.packetCount[slot]	= (uint8_t)written;
+	return written;
+}
+
+/******************************************************************************/
+/*!
+	Mark the messages of one packet acknowledged, if the slot still has that
+	packet. A message whose slot was reused since is not the one of the id.
+*/
+/******************************************************************************/
+static void netChannelAckPacket(NetChannelSender& sender, uint32_t sequence)
+{
+	unsigned int slot = sequence & (NET_CHANNEL_PACKETS - 1);
+	if (sender.packetCount[slot] == 0 || sender.packetSequence[slot] != sequence)
+		return;
+
+	uint16_t pending = (uint16_t)(sender.next - sender.oldest);
+	for (unsigned int m = 0; m < sender.packetCount[slot]; m++)
+	{
+		uint16_t		id		= sender.packetIds[slot][m];
+		unsigned int	index	= id & (NET_CHANNEL_QUEUE - 1);
+		if ((uint16_t)(id - sender.oldest) < pending && sender.messages[index].id == id && !sender.acked[index])
+		{
+			sender.acked[index] = true;
+			++sender.stats.acked;
+		}
+	}
+	sender.packetCount[slot] = 0;
+}
+
+/******************************************************************************/
+/*!
+	NetChannelAck() acknowledges the packets, then moves the oldest past the
+	messages that are done.
+*/
+/******************************************************************************/
+void NetChannelAck(NetChannelSender& sender, uint32_t ack, uint32_t bits)
+{
+	netChannelAckPacket(sender, ack);
+	for (unsigned int i = 0; i < 32; i++)
+	{
+		if (bits & (1u << i))
+			netChannelAckPacket(sender, ack - 1 - i);
+	}
+
+	while (sender.oldest != sender.next && sender.acked[sender.oldest & (NET_CHANNEL_QUEUE - 1)])
+		++sender.oldest;
+}
+
+/******************************************************************************/
+/*!
+	NetChannelReceivePacket() shifts the bitfield when the packet is the new
+	last one, or sets its bit when it came late.
+*/
+/******************************************************************************/
+void NetChannelReceivePacket(NetChannelReceiver& receiver, uint32_t sequence)
+{
+	if (!receiver.anyPacket)
+	{
+		receiver.anyPacket		= true;
+		receiver.lastSequence	= sequence;
+		receiver.ackBits		= 0;
+		return;
+	}
+
+	int32_t distance = (int32_t)(sequence - receiver.lastSequence);
+	if (distance > 0)
+	{
+		receiver.ackBits		= distance < 32 ? receiver.ackBits << distance : 0;
+		receiver.ackBits		|= distance <= 32 ? 1u << (distance - 1) : 0;
+		receiver.lastSequence	= sequence;
+	}
+	else if (distance < 0 && distance >= -32)
+		receiver.ackBits |= 1u << (-distance - 1);
+}
+
+/******************************************************************************/
+/*!
+	Hand out the message, then the early ones that follow it.
+*/
+/******************************************************************************/
+static void netChannelDeliver(NetChannelReceiver& receiver, const NetMessage& message, std::vector<NetMessage>& delivered)
+{
+	delivered.push_back(message);
+	++receiver.expected;
+	++receiver.delivered;
+
+	for (;;)
+	{
+		unsigned int index = receiver.expected & (NET_CHANNEL_WINDOW - 1);
+		if (!receiver.present[index] || receiver.early[index].id != receiver.expected)
+			break;
+
+		receiver.present[index] = false;
+		delivered.push_back(receiver.early[index]);
+		++receiver.expected;
+		++receiver.delivered;
+	}
+}
+
+/******************************************************************************/
+/*!
+	NetChannelRead() reads every message of the section before it hands any
+	out, a section cut short delivers nothing.
+*/
+/******************************************************************************/
+bool NetChannelRead(NetChannelReceiver& receiver, const uint8_t *& pCursor, const uint8_t * pEnd,
+					std::vector<NetMessage>& delivered)
+{
+	NetMessage		messages[255];
+	unsigned int	count = NetGetU8(pCursor, pEnd);
+	for (unsigned int m = 0; m < count && pCursor; m++)
+	{
+		NetMessage& message = messages[m];
+		message.id		= NetGetU16(pCursor, pEnd);
+		message.type	= NetGetU8(pCursor, pEnd);
+		message.size	= NetGetU8(pCursor, pEnd);
+		if (pCursor == 0 || message.size > NET_MESSAGE_PAYLOAD_MAX || pEnd - pCursor < message.size)
+		{
+			pCursor = 0;
+			break;
+		}
+		memcpy(message.payload, pCursor, message.size);
+		pCursor += message.size;
+	}
+	if (pCursor == 0)
+		return false;
+
+	for (unsigned int m = 0; m < count; m++)
+	{
+		const NetMessage&	message		= messages[m];
+		uint16_t			distance	= (uint16_t)(message.id - receiver.expected);
+		unsigned int		index		= message.id & (NET_CHANNEL_WINDOW - 1);
+
+		if (distance == 0)
+			netChannelDeliver(receiver, message, delivered);
+		else if (distance >= 0x8000 || (receiver.present[index] && receiver.early[index].id == message.id))
+			++receiver.duplicates;
+		else if (distance < NET_CHANNEL_WINDOW)
+		{
+			receiver.early[index]	= message;
+			receiver.present[index]	= true;
+			++receiver.heldBack;
+		}
+	}
+	return true;
+}
@@ -0,0 +1,200 @@
+/******************************************************************************/
+/*!
+\file		NetCongestion.cpp
+\brief		This file contains the definition of the congestion control of a
+			session.
+
+			A packet is counted once, acknowledged or lost, when an
+			acknowledgement passes it. One that comes after it was counted
+			lost stays lost. The delivery rate only counts the bytes
+			acknowledged after the first acknowledgement of the period, the
+			ones before were in flight when the interval started.
+ */
+/******************************************************************************/
+
+#include "NetCongestion.h"
+
+#include <string.h>
+
+/******************************************************************************/
+/*!
+	Packets per second of a level.
+*/
+/******************************************************************************/
+static float netCongestionRate(unsigned int level, unsigned int roundRate, unsigned int parts)
+{
+	return (float)roundRate / (float)NET_CONGESTION_DIVISORS[level] * (float)parts;
+}
+
+/******************************************************************************/
+/*!
+	NetCongestionInit() forgets every packet, the first period starts now.
+*/
+/******************************************************************************/
+void NetCongestionInit(NetCongestion& congestion, size_t packetBytes, double now)
+{
+	memset(&congestion, 0, sizeof(congestion));
+	for (unsigned int i = 0; i < NET_CONGESTION_HISTORY; i++)
+		congestion.sentAt[i] = -1.0;
+
+	congestion.periodStart	= now;
+	congestion.firstAckAt	= -1.0;
+	congestion.lastAckAt	= -1.0;
+	congestion.budget		= packetBytes;
+	congestion.hold			= NET_CONGESTION_HOLD;
+	congestion.cleanSince	= now;
+}
+
+/******************************************************************************/
+/*!
+	NetCongestionSent() stamps the slot of the packet.
+*/
+/******************************************************************************/
+void NetCongestionSent(NetCongestion& congestion, uint32_t sequence, size_t bytes, double now)
+{
+	unsigned int slot = sequence & (NET_CONGESTION_HISTORY - 1);
+	congestion.sequence[slot]	= sequence;
+	congestion.sentAt[slot]		= now;
+	congestion.bytes[slot]		= (uint16_t)(bytes < 0xFFFF ? bytes : 0xFFFF);
+	congestion.done[slot]		= false;
+}
+
+/******************************************************************************/
+/*!
+	NetCongestionAck() counts the packets from the last acknowledgement to
+	this one, and takes a round trip sample from the echo. An echo that is
+	not newer than the last one changes nothing.
+*/
+/******************************************************************************/
+void NetCongestionAck(NetCongestion& congestion, uint32_t ack, uint32_t bits, float heldMs, double now)
+{
+	if (congestion.anyAck && (int32_t)(ack - congestion.lastAck) <= 0)
+		return;
+
+	unsigned int slot = ack & (NET_CONGESTION_HISTORY - 1);
+	if (congestion.sequence[slot] == ack && congestion.sentAt[slot] >= 0.0)
+	{
+		float sample = (float)((now - congestion.sentAt[slot]) * 1000.0) - heldMs;
+		sample = sample > 0.0f ? sample : 0.0f;
+		congestion.rttMs	= congestion.rttMs > 0.0f ? congestion.rttMs + (sample - congestion.rttMs) * 0.125f : sample;
+		congestion.minRttMs	= congestion.minRttMs > 0.0f && congestion.minRttMs < sample ? congestion.minRttMs : sample;
+	}
+
+	uint32_t first = congestion.anyAck ? congestion.lastAck + 1 : ack - 32;
+	if (ack - first >= NET_CONGESTION_HISTORY)
+		first = ack - (NET_CONGESTION_HISTORY - 1);
+
+	uint64_t acked = 0;
+	for (uint32_t sequence = first; sequence != ack + 1; sequence++)
+	{
+		unsigned int index = sequence & (NET_CONGESTION_HISTORY - 1);
+		if (congestion.sequence[index] != sequence || congestion.sentAt[index] < 0.0 || congestion.done[index])
+			continue;
+
+		uint32_t	behind	= ack - sequence;
+		bool		got		= behind == 0 || (behind <= 32 && (bits & (1u << (behind - 1))));
+		if (got)
+		{
+			acked += congestion.bytes[index];
+			++congestion.periodAcked;
+		}
+		else
+			++congestion.periodLost;
+		congestion.done[index] = true;
+	}
+
+	if (congestion.firstAckAt < 0.0)
+		congestion.firstAckAt = now;
+	else
+	{
+		congestion.periodBytes	+= acked;
+		congestion.lastAckAt	= now;
+	}
+
+	congestion.anyAck	= true;
+	congestion.lastAck	= ack;
+}
+
+/******************************************************************************/
+/*!
+	NetCongestionUpdate() waits for a period long enough to judge, moves the
+	target, then steps the level down at once or up by one after the hold.
+*/
+/******************************************************************************/
+bool NetCongestionUpdate(NetCongestion& congestion, double now, unsigned int roundRate, unsigned int parts,
+						 size_t packetBytes)
+{
+	float full = netCongestionRate(0, roundRate, parts) * (float)packetBytes;
+	if (congestion.target <= 0.0f)
+		congestion.target = full;
+
+	double		elapsed		= now - congestion.periodStart;
+	uint32_t	resolved	= congestion.periodAcked + congestion.periodLost;
+	if (elapsed < NET_CONGESTION_PERIOD || (resolved < NET_CONGESTION_SAMPLES && elapsed < NET_CONGESTION_PERIOD_MAX))
+		return false;
+
+	// the estimates of the period, no packet resolved is a blackout
+	float periodLoss		= resolved ? (float)congestion.periodLost / (float)resolved : 1.0f;
+	congestion.loss			+= (periodLoss - congestion.loss) * 0.5f;
+	congestion.bandwidth	= congestion.lastAckAt > congestion.firstAckAt ?
+		(float)((double)congestion.periodBytes / (congestion.lastAckAt - congestion.firstAckAt)) : 0.0f;
+
+	bool delayed	= congestion.minRttMs > 0.0f && congestion.rttMs > congestion.minRttMs * 1.25f + NET_CONGESTION_DELAY_MS;
+	bool congested	= congestion.loss > NET_CONGESTION_LOSS_HIGH || delayed || resolved == 0;
+
+	float floor		= netCongestionRate(0, roundRate, parts) * (float)NET_CONGESTION_BUDGET_MIN;
+	float ceiling	= netCongestionRate(NET_CONGESTION_LEVELS - 1, roundRate, parts) * (float)packetBytes * NET_CONGESTION_PROBE;
+	if (congested)
+	{
+		float delivered		= congestion.bandwidth < congestion.target ? congestion.bandwidth : congestion.target;
+		congestion.target	= delivered * NET_CONGESTION_BACKOFF;
+		congestion.cleanSince	= -1.0;
+	}
+	else
+	{
+		if (congestion.cleanSince < 0.0)
+			congestion.cleanSince = now;
+		if (congestion.loss < NET_CONGESTION_LOSS_LOW)
+			congestion.target = (congestion.bandwidth > congestion.target ? congestion.bandwidth : congestion.target) * NET_CONGESTION_PROBE;
+	}
+	congestion.target = congestion.target < floor ? floor : congestion.target > ceiling ? ceiling : congestion.target;
+
+	// the fastest level full packets fit in
+	unsigned int afford = 0;
+	for (unsigned int l = 1; l < NET_CONGESTION_LEVELS; l++)
+	{
+		if (congestion.target >= netCongestionRate(l, roundRate, parts) * (float)packetBytes)
+			afford = l;
+	}
+
+	unsigned int level = congestion.level;
+	if (afford < congestion.level)
+	{
+		congestion.level	= afford;
+		congestion.hold		= congestion.hold * 2.0 < NET_CONGESTION_HOLD_MAX ? congestion.hold * 2.0 : NET_CONGESTION_HOLD_MAX;
+	}
+	else if (afford > congestion.level && congestion.cleanSince >= 0.0 && now - congestion.cleanSince >= congestion.hold)
+	{
+		++congestion.level;
+		congestion.cleanSince = now;
+	}
+	else if (congestion.cleanSince >= 0.0 && now - congestion.cleanSince >= NET_CONGESTION_HOLD_MAX)
+	{
+		// a long clean streak forgives a step down
+		congestion.hold			= congestion.hold * 0.5 > NET_CONGESTION_HOLD ? congestion.hold * 0.5 : NET_CONGESTION_HOLD;
+		congestion.cleanSince	= now;
+	}
+
+	size_t fit = (size_t)(congestion.target / netCongestionRate(congestion.level, roundRate, parts));
+	fit = fit > NET_CONGESTION_BUDGET_MIN ? fit : NET_CONGESTION_BUDGET_MIN;
+	congestion.budget = fit < packetBytes ? fit : packetBytes;
+
+	// the next period starts at the last acknowledgement, its bytes were in flight
+	congestion.periodStart	= now;
+	congestion.firstAckAt	= congestion.lastAckAt;
+	congestion.lastAckAt	= -1.0;
+	congestion.periodAcked	= 0;
+	congestion.periodLost	= 0;
+	congestion.periodBytes	= 0;
+	return congestion.level != level;
+}
@@ -0,0 +1,263 @@
+/******************************************************************************/
+/*!
+\file		NetSim.cpp
+\brief		This file contains the definition of the network condition
+			simulator.
+
+			The line is a heap ordered by the time a datagram is due, then by
+			the order it was pushed in. A datagram in order is never due
+			before the one pushed in front of it to the same address, so the
+			jitter spreads the datagrams of a peer without mixing them up and
+			a slow peer does not hold the others back. A duplicate is a
+			second reference to the same packet.
+ */
+/******************************************************************************/
+
+#include "NetSim.h"
+
+#include <algorithm>
+#include <chrono>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Random.h"
+
+// ---------------------------------------------------------------------------
+
+// a datagram in the line
+struct NetSimEntry
+{
+	double				due;
+	uint64_t			order;				// pushes before it, breaks the ties
+	NetSimDatagram		datagram;
+};
+
+struct NetSim
+{
+	NetSimConditions			conditions;
+	RandomState					rng;
+	NetSimStats					stats;
+	std::vector<NetSimEntry>	line;			// heap, the next due in front
+	std::vector<NetSimDatagram>	delivered;		// the last pop, released by the next one
+	uint64_t					order;
+	std::unordered_map<uint64_t, double>	lastDue;	// per address, due time of the last datagram pushed in order
+};
+
+// ---------------------------------------------------------------------------
+// static variables
+
+static const std::chrono::steady_clock::time_point	sNetSimOrigin = std::chrono::steady_clock::now();
+
+/******************************************************************************/
+/*!
+	Heap order: the entry due last is the smallest, std::push_heap() keeps the
+	next due in front.
+*/
+/******************************************************************************/
+static bool netSimLater(const NetSimEntry& a, const NetSimEntry& b)
+{
+	return a.due != b.due ? a.due > b.due : a.order > b.order;
+}
+
+/******************************************************************************/
+/*!
+	Put one more reference to the packet into the line, due at latency plus
+	or minus the jitter from now, and never before the last one in order to
+	the same address.
+*/
+/******************************************************************************/
+static void netSimInsert(NetSim * pSim, PacketBuffer * pPacket, const SocketAddress& address, double now)
+{
+	const NetSimConditions& conditions = pSim->conditions;
+	double& lastDue = pSim->lastDue[((uint64_t)address.ip << 16) | address.port];
+
+	float	delayMs	= conditions.latencyMs + conditions.jitterMs * (2.0f * RandomFloat01(pSim->rng) - 1.0f);
+	double	due		= now + (double)(delayMs > 0.0f ? delayMs : 0.0f) * 0.001;
+
+	if (conditions.reorder > 0.0f && RandomFloat01(pSim->rng) < conditions.reorder)
+	{
+		// held back, the ones pushed after it pass it
+		due = std::max(due, lastDue) + (double)(NETSIM_REORDER_MS + conditions.jitterMs) * 0.001;
+		++pSim->stats.reordered;
+	}
+	else
+	{
+		due		= std::max(due, lastDue);
+		lastDue	= due;
+	}
+
+	NetSimEntry entry = { due, pSim->order++, { pPacket, address } };
+	pSim->line.push_back(entry);
+	std::push_heap(pSim->line.begin(), pSim->line.end(), netSimLater);
+}
+
+/******************************************************************************/
+/*!
+	NetSimCreate() seeds the generator of the line.
+*/
+/******************************************************************************/
+NetSim * NetSimCreate(const NetSimConditions& conditions, uint32_t seed)
+{
+	NetSim * pSim = new NetSim();
+	pSim->conditions	= conditions;
+	pSim->stats			= NetSimStats();
+	pSim->order			= 0;
+	RandomSeed(pSim->rng, seed);
+	return pSim;
+}
+
+/******************************************************************************/
+/*!
+	NetSimDestroy() gives every packet of the line back to the pool.
+*/
+/******************************************************************************/
+void NetSimDestroy(NetSim * pSim)
+{
+	if (pSim == 0)
+		return;
+
+	for (const NetSimEntry& entry : pSim->line)
+		PacketRelease(entry.datagram.pPacket);
+	for (const NetSimDatagram& datagram : pSim->delivered)
+		PacketRelease(datagram.pPacket);
+	delete pSim;
+}
+
+/******************************************************************************/
+/*!
+	NetSimPush() draws the loss first, then copies the datagram once for the
+	line and its duplicate.
+*/
+/******************************************************************************/
+void NetSimPush(NetSim * pSim, const void * pHead, size_t headSize, const void * pBody, size_t bodySize,
+				const SocketAddress& address, double now)
+{
+	++pSim->stats.pushed;
+
+	const NetSimConditions& conditions = pSim->conditions;
+	if ((conditions.loss > 0.0f && RandomFloat01(pSim->rng) < conditions.loss) || headSize + bodySize > PACKET_BUFFER_SIZE)
+	{
+		++pSim->stats.lost;
+		return;
+	}
+
+	PacketBuffer * pPacket = PacketAcquire();
+	memcpy(pPacket->data, pHead, headSize);
+	if (bodySize)
+		memcpy(pPacket->data + headSize, pBody, bodySize);
+	pPacket->size = (uint32_t)(headSize + bodySize);
+
+	netSimInsert(pSim, pPacket, address, now);
+	if (conditions.duplicate > 0.0f && RandomFloat01(pSim->rng) < conditions.duplicate)
+	{
+		PacketRetain(pPacket);
+		netSimInsert(pSim, pPacket, address, now);
+		++pSim->stats.duplicated;
+	}
+}
+
+/******************************************************************************/
+/*!
+	NetSimPop() releases the datagrams of the last pop and takes the ones due
+	off the heap. Once the line is empty every due time of an address is
+	past, they are forgotten so the table does not grow with the peers.
+*/
+/******************************************************************************/
+unsigned int NetSimPop(NetSim * pSim, double now, const NetSimDatagram *& pDatagrams)
+{
+	for (const NetSimDatagram& datagram : pSim->delivered)
+		PacketRelease(datagram.pPacket);
+	pSim->delivered.clear();
+
+	std::vector<NetSimEntry>& line = pSim->line;
+	while (!line.empty() && line.front().due <= now)
+	{
+		pSim->delivered.push_back(line.front().datagram);
+		std::pop_heap(line.begin(), line.end(), netSimLater);
+		line.pop_back();
+	}
+	pSim->stats.delivered += pSim->delivered.size();
+	if (line.empty())
+		pSim->lastDue.clear();
+
+	pDatagrams = pSim->delivered.data();
+	return (unsigned int)pSim->delivered.size();
+}
+
+/******************************************************************************/
+/*!
+	NetSimNextDue() reads the front of the heap.
+*/
+/******************************************************************************/
+double NetSimNextDue(const NetSim * pSim)
+{
+	return pSim->line.empty() ? -1.0 : pSim->line.front().due;
+}
+
+/******************************************************************************/
+/*!
+	NetSimGetStats() returns the counters of the line.
+*/
+/******************************************************************************/
+const NetSimStats& NetSimGetStats(const NetSim * pSim)
+{
+	return pSim->stats;
+}
+
+/******************************************************************************/
+/*!
+	NetSimNow() reads the steady clock from the first use of the module.
+*/
+/******************************************************************************/
+double NetSimNow()
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - sNetSimOrigin).count();
+}
+
+/******************************************************************************/
+/*!
+	NetSimParse() reads the "name:value" items separated by commas. A delay
+	is in ms, the others are fractions in [0, 1].
+*/
+/******************************************************************************/
+bool NetSimParse(const char * text, NetSimConditions& conditions)
+{
+	conditions = NetSimConditions();
+
+	std::string list = text;
+	for (size_t start = 0; start < list.size();)
+	{
+		size_t comma = list.find(',', start);
+		std::string item = list.substr(start, comma == std::string::npos ? std::string::npos : comma - start);
+
+		size_t colon = item.find(':');
+		if (colon == std::string::npos)
+			return false;
+		std::string	name	= item.substr(0, colon);
+		char *		pEnd	= 0;
+		float		value	= strtof(item.c_str() + colon + 1, &pEnd);
+		if (pEnd == item.c_str() + colon + 1 || *pEnd != 0 || value < 0.0f)
+			return false;
+
+		if (name == "latency")
+			conditions.latencyMs = value;
+		else if (name == "jitter")
+			conditions.jitterMs = value;
+		else if (name == "loss" && value <= 1.0f)
+			conditions.loss = value;
+		else if (name == "dup" && value <= 1.0f)
+			conditions.duplicate = value;
+		else if (name == "reorder" && value <= 1.0f)
+			conditions.reorder = value;
+		else
+			return false;
+
+		if (comma == std::string::npos)
+			break;
+		start = comma + 1;
+	}
+	return true;
+}
@@ -0,0 +1,168 @@
+/******************************************************************************/
+/*!
+\file		PacketPool.cpp
+\brief		This file contains the definition of the pool of packet buffers.
+
+			The free buffers are linked through pNext, in the shared list or
+			in the cache of a thread. A thread that finds its cache empty
+			takes half a cache from the shared list, a thread whose cache is
+			full gives half of it back, so a buffer acquired on one thread and
+			released on another only costs a lock every half cache. A thread
+			gives its whole cache back when it ends.
+ */
+/******************************************************************************/
+
+#include "PacketPool.h"
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+
+// free buffers of one thread
+struct PacketCache
+{
+	PacketBuffer *		buffers[PACKET_CACHE_BUFFERS];
+	unsigned int		count;
+
+	~PacketCache();
+};
+
+// ---------------------------------------------------------------------------
+// static variables
+
+static std::mutex									sPacketMutex;		// protects the shared list and the slabs
+static PacketBuffer *								spPacketFree;		// shared list of free buffers
+static std::vector<std::unique_ptr<PacketBuffer[]>>	sPacketSlabs;
+static std::atomic<uint64_t>						sPacketAcquired;
+static std::atomic<uint64_t>						sPacketReleased;
+
+static thread_local PacketCache						tPacketCache;
+
+/******************************************************************************/
+/*!
+	Move count buffers from the cache to the shared list, the last ones.
+	The caller holds the lock.
+*/
+/******************************************************************************/
+static void packetGiveBack(PacketCache& cache, unsigned int count)
+{
+	for (unsigned int i = 0; i < count; i++)
+	{
+		PacketBuffer * pPacket = cache.buffers[--cache.count];
+		pPacket->pNext	= spPacketFree;
+		spPacketFree	= pPacket;
+	}
+}
+
+/******************************************************************************/
+/*!
+	Fill half of the empty cache from the shared list, with a new slab if the
+	list is short.
+*/
+/******************************************************************************/
+static void packetRefill(PacketCache& cache)
+{
+	std::lock_guard<std::mutex> lock(sPacketMutex);
+
+	for (unsigned int i = 0; i < PACKET_CACHE_BUFFERS / 2; i++)
+	{
+		if (spPacketFree == 0)
+		{
+			sPacketSlabs.emplace_back(new PacketBuffer[PACKET_SLAB_BUFFERS]);
+			PacketBuffer * pSlab = sPacketSlabs.back().get();
+			for (unsigned int b = 0; b < PACKET_SLAB_BUFFERS; b++)
+			{
+				pSlab[b].pNext	= spPacketFree;
+				spPacketFree	= &pSlab[b];
+			}
+		}
+
+		cache.buffers[cache.count++]	= spPacketFree;
+		spPacketFree					= spPacketFree->pNext;
+	}
+}
+
+/******************************************************************************/
+/*!
+	The buffers of a thread that ends go back to the shared list.
+*/
+/******************************************************************************/
+PacketCache::~PacketCache()
+{
+	std::lock_guard<std::mutex> lock(sPacketMutex);
+	packetGiveBack(*this, count);
+}
+
+/******************************************************************************/
+/*!
+	PacketAcquire() takes the last buffer of the cache of the calling thread.
+*/
+/******************************************************************************/
+PacketBuffer * PacketAcquire()
+{
+	PacketCache& cache = tPacketCache;
+	if (cache.count == 0)
+		packetRefill(cache);
+
+	PacketBuffer * pPacket = cache.buffers[--cache.count];
+	pPacket->refs.store(1, std::memory_order_relaxed);
+	pPacket->size	= 0;
+	pPacket->pNext	= 0;
+	sPacketAcquired.fetch_add(1, std::memory_order_relaxed);
+	return pPacket;
+}
+
+/******************************************************************************/
+/*!
+	PacketRetain() adds a reference. The caller holds one already, the count
+	cannot reach 0 meanwhile.
+*/
+/******************************************************************************/
+void PacketRetain(PacketBuffer * pPacket)
+{
+	pPacket->refs.fetch_add(1, std::memory_order_relaxed);
+}
+
+/******************************************************************************/
+/*!
+	PacketRelease() drops a reference. The last one makes the writes of every
+	holder visible to the thread that reuses the buffer, and puts it in the
+	cache of the calling thread.
+*/
+/******************************************************************************/
+void PacketRelease(PacketBuffer * pPacket)
+{
+	if (pPacket == 0 || pPacket->refs.fetch_sub(1, std::memory_order_acq_rel) != 1)
+		return;
+
+	sPacketReleased.fetch_add(1, std::memory_order_relaxed);
+
+	PacketCache& cache = tPacketCache;
+	if (cache.count == PACKET_CACHE_BUFFERS)
+	{
+		std::lock_guard<std::mutex> lock(sPacketMutex);
+		packetGiveBack(cache, PACKET_CACHE_BUFFERS / 2);
+	}
+	cache.buffers[cache.count++] = pPacket;
+}
+
+/******************************************************************************/
+/*!
+	PacketPoolGetStats() reads the counters, the releases first so the buffers
+	in use are never counted below 0.
+*/
+/******************************************************************************/
+PacketPoolStats PacketPoolGetStats()
+{
+	PacketPoolStats stats;
+	uint64_t released	= sPacketReleased.load(std::memory_order_relaxed);
+	stats.acquired		= sPacketAcquired.load(std::memory_order_relaxed);
+	stats.inUse			= stats.acquired - released;
+
+	std::lock_guard<std::mutex> lock(sPacketMutex);
+	stats.slabs			= sPacketSlabs.size();
+	stats.buffers		= stats.slabs * PACKET_SLAB_BUFFERS;
+	return stats;
+}
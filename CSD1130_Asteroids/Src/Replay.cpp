@@ -0,0 +1,793 @@
+/******************************************************************************/
+/*!
+\file		Replay.cpp
+\brief		This file contains the definition of the match recorder, of the
+			memory mapped replay reader and of the headless replay runner.
+			Every value is written little endian.
+ */
+/******************************************************************************/
+
+#include "Main.h"
+#include "Replay.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <stdio.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// ---------------------------------------------------------------------------
+// static variables
+
+static FILE *							sRecordFile;				// file being recorded, 0 when not recording
+static std::vector<uint8_t>				sRecordBuffer;				// records of the current ticks, only touched by the tick
+static unsigned long					sRecordBufferTicks;			// ticks in sRecordBuffer
+static uint64_t							sRecordBufferOffset;		// offset in the file of the first byte of sRecordBuffer
+static uint32_t							sRecordTickCount;			// ticks recorded since the start
+static std::vector<ReplayKeyframe>		sRecordKeyframes;			// keyframes recorded since the start
+
+static std::thread						sRecordThread;				// writer thread
+static std::mutex						sRecordMutex;				// protects everything below
+static std::condition_variable			sRecordWake;				// signaled when a buffer is queued or the recording stops
+static std::vector<std::vector<uint8_t>>	sRecordQueue;			// buffers waiting to be written, in order
+static std::vector<std::vector<uint8_t>>	sRecordSpare;			// written buffers, kept to avoid allocating
+static bool								sRecordQuit;				// set to stop the writer thread once the queue is empty
+
+/******************************************************************************/
+/*!
+	Append a value to a record buffer.
+*/
+/******************************************************************************/
+void ReplayPutU8(std::vector<uint8_t>& buffer, uint8_t value)
+{
+	buffer.push_back(value);
+}
+
+void ReplayPutU32(std::vector<uint8_t>& buffer, uint32_t value)
+{
+	buffer.push_back((uint8_t)(value));
+	buffer.push_back((uint8_t)(value >> 8));
+	buffer.push_back((uint8_t)(value >> 16));
+	buffer.push_back((uint8_t)(value >> 24));
+}
+
+void ReplayPutU64(std::vector<uint8_t>& buffer, uint64_t value)
+{
+	ReplayPutU32(buffer, (uint32_t)value);
+	ReplayPutU32(buffer, (uint32_t)(value >> 32));
+}
+
+void ReplayPutF32(std::vector<uint8_t>& buffer, float value)
+{
+	uint32_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+	ReplayPutU32(buffer, bits);
+}
+
+/******************************************************************************/
+/*!
+	Read a value at the cursor and move the cursor past it. Reading past the
+	end of the data sets the cursor to 0 and returns 0.
+*/
+/******************************************************************************/
+uint8_t ReplayGetU8(const uint8_t *& pCursor, const uint8_t * pEnd)
+{
+	if (pCursor == 0 || pEnd - pCursor < 1)
+	{
+		pCursor = 0;
+		return 0;
+	}
+	return *pCursor++;
+}
+
+uint32_t ReplayGetU32(const uint8_t *& pCursor, const uint8_t * pEnd)
+{
+	if (pCursor == 0 || pEnd - pCursor < 4)
+	{
+		pCursor = 0;
+		return 0;
+	}
+	uint32_t value = (uint32_t)pCursor[0] | ((uint32_t)pCursor[1] << 8) |
+					 ((uint32_t)pCursor[2] << 16) | ((uint32_t)pCursor[3] << 24);
+	pCursor += 4;
+	return value;
+}
+
+uint64_t ReplayGetU64(const uint8_t *& pCursor, const uint8_t * pEnd)
+{
+	uint64_t low	= ReplayGetU32(pCursor, pEnd);
+	uint64_t high	= ReplayGetU32(pCursor, pEnd);
+	return low | (high << 32);
+}
+
+float ReplayGetF32(const uint8_t *& pCursor, const uint8_t * pEnd)
+{
+	uint32_t bits = ReplayGetU32(pCursor, pEnd);
+	float value;
+	memcpy(&value, &bits, sizeof(value));
+	return value;
+}
+
+/******************************************************************************/
+/*!
+	Body of the writer thread: write the queued buffers in order until the
+	recording stops and the queue is empty.
+*/
+/******************************************************************************/
+static void replayWriterMain()
+{
+	std::vector<std::vector<uint8_t>> writing;
+
+	for (;;)
+	{
+		{
+			std::unique_lock<std::mutex> lock(sRecordMutex);
+
+			// give the buffers written last time back to the tick
+			for (std::vector<uint8_t>& buffer : writing)
+			{
+				buffer.clear();
+				sRecordSpare.push_back(std::move(buffer));
+			}
+			writing.clear();
+
+			sRecordWake.wait(lock, [] { return sRecordQuit || !sRecordQueue.empty(); });
+			if (sRecordQueue.empty())
+				return;
+			writing.swap(sRecordQueue);
+		}
+
+		for (const std::vector<uint8_t>& buffer : writing)
+			fwrite(buffer.data(), 1, buffer.size(), sRecordFile);
+		fflush(sRecordFile);
+	}
+}
+
+/******************************************************************************/
+/*!
+	Hand the current buffer to the writer thread and continue in a spare one.
+	This is the only place the tick takes the lock, and only to move a vector.
+*/
+/******************************************************************************/
+static void replayFlush()
+{
+	if (sRecordBuffer.empty())
+		return;
+
+	sRecordBufferOffset += sRecordBuffer.size();
+
+	{
+		std::lock_guard<std::mutex> lock(sRecordMutex);
+		sRecordQueue.push_back(std::move(sRecordBuffer));
+		if (!sRecordSpare.empty())
+		{
+			sRecordBuffer = std::move(sRecordSpare.back());
+			sRecordSpare.pop_back();
+		}
+		else
+			sRecordBuffer = std::vector<uint8_t>();
+	}
+	sRecordWake.notify_one();
+
+	sRecordBuffer.reserve(REPLAY_FLUSH_BYTES);
+	sRecordBufferTicks = 0;
+}
+
+/******************************************************************************/
+/*!
+	ReplayRecordStart() creates the file, writes the header and starts the
+	writer thread. A recording already running is stopped first.
+*/
+/******************************************************************************/
+bool ReplayRecordStart(const char * path, uint32_t seed, float worldWidth, float worldHeight, bool endless)
+{
+	if (sRecordFile)
+		ReplayRecordStop(0);
+
+#ifdef _MSC_VER
+	if (fopen_s(&sRecordFile, path, "wb") != 0)
+		sRecordFile = 0;
+#else
+	sRecordFile = fopen(path, "wb");
+#endif
+	if (sRecordFile == 0)
+	{
+		printf("Replay: cannot create \"%s\"\n", path);
+		return false;
+	}
+
+	sRecordBuffer.clear();
+	sRecordBuffer.reserve(REPLAY_FLUSH_BYTES);
+	sRecordBufferTicks	= 0;
+	sRecordBufferOffset	= 0;
+	sRecordTickCount	= 0;
+	sRecordQuit			= false;
+	sRecordKeyframes.clear();
+
+	ReplayPutU32(sRecordBuffer, REPLAY_MAGIC);
+	ReplayPutU32(sRecordBuffer, REPLAY_VERSION);
+	ReplayPutU32(sRecordBuffer, seed);
+	ReplayPutF32(sRecordBuffer, worldWidth);
+	ReplayPutF32(sRecordBuffer, worldHeight);
+	ReplayPutU32(sRecordBuffer, REPLAY_KEYFRAME_TICKS);
+	ReplayPutU32(sRecordBuffer, endless ? REPLAY_FLAG_ENDLESS : 0);
+
+	sRecordThread = std::thread(replayWriterMain);
+	return true;
+}
+
+/******************************************************************************/
+/*!
+	ReplayRecordKeyframeDue() is true before tick 0 and every
+	REPLAY_KEYFRAME_TICKS ticks after, the seek of a reader relies on it.
+*/
+/******************************************************************************/
+bool ReplayRecordKeyframeDue()
+{
+	return sRecordFile != 0 && sRecordTickCount % REPLAY_KEYFRAME_TICKS == 0;
+}
+
+/******************************************************************************/
+/*!
+	ReplayRecordKeyframe() appends a keyframe record and remembers where it is
+	for the index.
+*/
+/******************************************************************************/
+void ReplayRecordKeyframe(const std::vector<uint8_t>& keyframe)
+{
+	if (sRecordFile == 0)
+		return;
+
+	ReplayKeyframe entry = { sRecordTickCount, sRecordBufferOffset + sRecordBuffer.size() };
+	sRecordKeyframes.push_back(entry);
+
+	ReplayPutU8(sRecordBuffer, REPLAY_RECORD_KEYFRAME);
+	ReplayPutU32(sRecordBuffer, sRecordTickCount);
+	ReplayPutU32(sRecordBuffer, (uint32_t)keyframe.size());
+	sRecordBuffer.insert(sRecordBuffer.end(), keyframe.begin(), keyframe.end());
+}
+
+/******************************************************************************/
+/*!
+	ReplayRecordTick() appends a tick record with every command, one per player
+	is expected.
+*/
+/******************************************************************************/
+void ReplayRecordTick(float dt, const InputCommand * pCommands, unsigned int commandCount)
+{
+	if (sRecordFile == 0)
+		return;
+
+	ReplayPutU8(sRecordBuffer, REPLAY_RECORD_TICK);
+	ReplayPutF32(sRecordBuffer, dt);
+	ReplayPutU32(sRecordBuffer, commandCount);
+	for (unsigned int i = 0; i < commandCount; i++)
+	{
+		ReplayPutU32(sRecordBuffer, pCommands[i].player);
+		ReplayPutU8(sRecordBuffer, pCommands[i].buttons);
+	}
+
+	++sRecordTickCount;
+	if (++sRecordBufferTicks >= REPLAY_FLUSH_TICKS || sRecordBuffer.size() >= REPLAY_FLUSH_BYTES)
+		replayFlush();
+}
+
+/******************************************************************************/
+/*!
+	ReplayRecordJoin() and ReplayRecordLeave() append a player event, it
+	applies before the next tick.
+*/
+/******************************************************************************/
+void ReplayRecordJoin(uint32_t player)
+{
+	if (sRecordFile == 0)
+		return;
+
+	ReplayPutU8(sRecordBuffer, REPLAY_RECORD_JOIN);
+	ReplayPutU32(sRecordBuffer, player);
+}
+
+void ReplayRecordLeave(uint32_t player)
+{
+	if (sRecordFile == 0)
+		return;
+
+	ReplayPutU8(sRecordBuffer, REPLAY_RECORD_LEAVE);
+	ReplayPutU32(sRecordBuffer, player);
+}
+
+/******************************************************************************/
+/*!
+	ReplayRecordPopulate() appends a top up of the world, it applies before
+	the next tick like a join.
+*/
+/******************************************************************************/
+void ReplayRecordPopulate(uint32_t asteroidCount, uint32_t bulletCount)
+{
+	if (sRecordFile == 0)
+		return;
+
+	ReplayPutU8(sRecordBuffer, REPLAY_RECORD_POPULATE);
+	ReplayPutU32(sRecordBuffer, asteroidCount);
+	ReplayPutU32(sRecordBuffer, bulletCount);
+}
+
+/******************************************************************************/
+/*!
+	ReplayRecordStop() appends the end record, the keyframe index and the
+	trailer, lets the writer thread write everything and closes the file.
+*/
+/******************************************************************************/
+void ReplayRecordStop(uint32_t checksum)
+{
+	if (sRecordFile == 0)
+		return;
+
+	ReplayPutU8(sRecordBuffer, REPLAY_RECORD_END);
+	ReplayPutU32(sRecordBuffer, sRecordTickCount);
+	ReplayPutU32(sRecordBuffer, checksum);
+
+	uint64_t indexOffset = sRecordBufferOffset + sRecordBuffer.size();
+	ReplayPutU8(sRecordBuffer, REPLAY_RECORD_INDEX);
+	ReplayPutU32(sRecordBuffer, (uint32_t)sRecordKeyframes.size());
+	for (const ReplayKeyframe& keyframe : sRecordKeyframes)
+	{
+		ReplayPutU32(sRecordBuffer, keyframe.tick);
+		ReplayPutU64(sRecordBuffer, keyframe.offset);
+	}
+	ReplayPutU64(sRecordBuffer, indexOffset);
+	ReplayPutU32(sRecordBuffer, REPLAY_INDEX_MAGIC);
+	replayFlush();
+
+	{
+		std::lock_guard<std::mutex> lock(sRecordMutex);
+		sRecordQuit = true;
+	}
+	sRecordWake.notify_one();
+	sRecordThread.join();
+
+	fclose(sRecordFile);
+	sRecordFile = 0;
+
+	std::vector<uint8_t>().swap(sRecordBuffer);
+	std::vector<std::vector<uint8_t>>().swap(sRecordSpare);
+	std::vector<ReplayKeyframe>().swap(sRecordKeyframes);
+}
+
+/******************************************************************************/
+/*!
+	Read the index pointed at by the trailer. Returns false if the file has no
+	valid trailer, a recording cut short by a crash for instance.
+*/
+/******************************************************************************/
+static bool replayReadIndex(ReplayFile& file)
+{
+	const uint8_t * pEnd = file.pData + file.size;
+	if (file.size < REPLAY_HEADER_SIZE + REPLAY_TRAILER_SIZE)
+		return false;
+
+	const uint8_t * pCursor = pEnd - REPLAY_TRAILER_SIZE;
+	uint64_t indexOffset	= ReplayGetU64(pCursor, pEnd);
+	uint32_t indexMagic		= ReplayGetU32(pCursor, pEnd);
+	if (indexMagic != REPLAY_INDEX_MAGIC || indexOffset < REPLAY_HEADER_SIZE || indexOffset >= file.size)
+		return false;
+
+	pCursor = file.pData + indexOffset;
+	if (ReplayGetU8(pCursor, pEnd) != REPLAY_RECORD_INDEX)
+		return false;
+
+	uint32_t count = ReplayGetU32(pCursor, pEnd);
+	if (pCursor == 0 || (uint64_t)count * 12 > (uint64_t)(pEnd - pCursor))
+		return false;
+
+	file.keyframes.resize(count);
+	for (ReplayKeyframe& keyframe : file.keyframes)
+	{
+		keyframe.tick	= ReplayGetU32(pCursor, pEnd);
+		keyframe.offset	= ReplayGetU64(pCursor, pEnd);
+	}
+
+	// the end record sits right before the index
+	const uint8_t * pEndRecord = file.pData + indexOffset - 9;
+	if (indexOffset >= REPLAY_HEADER_SIZE + 9 && ReplayGetU8(pEndRecord, pEnd) == REPLAY_RECORD_END)
+	{
+		file.tickCount	= ReplayGetU32(pEndRecord, pEnd);
+		file.checksum	= ReplayGetU32(pEndRecord, pEnd);
+		file.ended		= true;
+	}
+	return true;
+}
+
+/******************************************************************************/
+/*!
+	Walk every record to rebuild the index of a file without trailer. The
+	records are only skipped, nothing is simulated.
+*/
+/******************************************************************************/
+static void replayScanIndex(ReplayFile& file)
+{
+	const uint8_t * pEnd	= file.pData + file.size;
+	const uint8_t * pCursor	= file.pData + REPLAY_HEADER_SIZE;
+	uint32_t		ticks	= 0;
+
+	file.keyframes.clear();
+	while (pCursor && pCursor < pEnd)
+	{
+		const uint8_t * pRecord = pCursor;
+		switch (ReplayGetU8(pCursor, pEnd))
+		{
+		case REPLAY_RECORD_TICK:
+		{
+			ReplayGetF32(pCursor, pEnd);
+			uint32_t count = ReplayGetU32(pCursor, pEnd);
+			if (pCursor == 0 || (uint64_t)(pEnd - pCursor) < (uint64_t)count * 5)
+				return;
+			pCursor += (size_t)count * 5;
+			file.tickCount = ++ticks;
+			break;
+		}
+		case REPLAY_RECORD_JOIN:
+		case REPLAY_RECORD_LEAVE:
+			ReplayGetU32(pCursor, pEnd);
+			break;
+		case REPLAY_RECORD_POPULATE:
+			ReplayGetU32(pCursor, pEnd);
+			ReplayGetU32(pCursor, pEnd);
+			break;
+		case REPLAY_RECORD_KEYFRAME:
+		{
+			ReplayKeyframe keyframe;
+			keyframe.tick	= ReplayGetU32(pCursor, pEnd);
+			keyframe.offset	= (uint64_t)(pRecord - file.pData);
+			uint32_t size	= ReplayGetU32(pCursor, pEnd);
+			if (pCursor == 0 || (size_t)(pEnd - pCursor) < size)
+				return;
+			pCursor += size;
+			file.keyframes.push_back(keyframe);
+			break;
+		}
+		case REPLAY_RECORD_END:
+			file.tickCount	= ReplayGetU32(pCursor, pEnd);
+			file.checksum	= ReplayGetU32(pCursor, pEnd);
+			file.ended		= pCursor != 0;
+			return;
+		default:
+			return;
+		}
+	}
+}
+
+/******************************************************************************/
+/*!
+	ReplayOpen() maps the file read only, nothing is copied: the OS pages in
+	the parts a seek touches. The index comes from the trailer, or from a scan
+	of the records if the recording was cut short.
+*/
+/******************************************************************************/
+bool ReplayOpen(const char * path, ReplayFile& file)
+{
+	file = ReplayFile();
+
+#ifdef _WIN32
+	HANDLE hFile = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+	if (hFile == INVALID_HANDLE_VALUE)
+	{
+		printf("Replay: cannot open \"%s\"\n", path);
+		return false;
+	}
+	LARGE_INTEGER fileSize;
+	HANDLE hMapping = 0;
+	if (GetFileSizeEx(hFile, &fileSize) && fileSize.QuadPart >= (LONGLONG)REPLAY_HEADER_SIZE)
+		hMapping = CreateFileMappingA(hFile, 0, PAGE_READONLY, 0, 0, 0);
+	if (hMapping)
+		file.pData = (const uint8_t *)MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+	if (file.pData == 0)
+	{
+		if (hMapping)
+			CloseHandle(hMapping);
+		CloseHandle(hFile);
+		printf("Replay: cannot map \"%s\"\n", path);
+		return false;
+	}
+	file.size		= (size_t)fileSize.QuadPart;
+	file.hFile		= hFile;
+	file.hMapping	= hMapping;
+#else
+	int fd = open(path, O_RDONLY);
+	if (fd < 0)
+	{
+		printf("Replay: cannot open \"%s\"\n", path);
+		return false;
+	}
+	struct stat fileStat;
+	void * pMapped = MAP_FAILED;
+	if (fstat(fd, &fileStat) == 0 && fileStat.st_size >= (off_t)REPLAY_HEADER_SIZE)
+		pMapped = mmap(0, (size_t)fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (pMapped == MAP_FAILED)
+	{
+		printf("Replay: cannot map \"%s\"\n", path);
+		return false;
+	}
+	file.pData	= (const uint8_t *)pMapped;
+	file.size	= (size_t)fileStat.st_size;
+#endif
+
+	const uint8_t * pEnd	= file.pData + file.size;
+	const uint8_t * pCursor	= file.pData;
+	uint32_t magic		= ReplayGetU32(pCursor, pEnd);
+	uint32_t version	= ReplayGetU32(pCursor, pEnd);
+	file.seed			= ReplayGetU32(pCursor, pEnd);
+	file.worldWidth		= ReplayGetF32(pCursor, pEnd);
+	file.worldHeight	= ReplayGetF32(pCursor, pEnd);
+	file.keyframeTicks	= ReplayGetU32(pCursor, pEnd);
+	file.endless		= (ReplayGetU32(pCursor, pEnd) & REPLAY_FLAG_ENDLESS) != 0;
+	if (pCursor == 0 || magic != REPLAY_MAGIC || version != REPLAY_VERSION || file.keyframeTicks == 0)
+	{
+		printf("Replay: \"%s\" is not a version %u replay\n", path, REPLAY_VERSION);
+		ReplayClose(file);
+		return false;
+	}
+
+	if (!replayReadIndex(file))
+	{
+		printf("Replay: \"%s\" has no index (truncated recording), scanning it\n", path);
+		replayScanIndex(file);
+	}
+
+	file.pCursor	= file.pData + REPLAY_HEADER_SIZE;
+	file.tick		= 0;
+	return true;
+}
+
+/******************************************************************************/
+/*!
+	ReplayClose() unmaps the file.
+*/
+/******************************************************************************/
+void ReplayClose(ReplayFile& file)
+{
+	if (file.pData)
+	{
+#ifdef _WIN32
+		UnmapViewOfFile(file.pData);
+		CloseHandle((HANDLE)file.hMapping);
+		CloseHandle((HANDLE)file.hFile);
+#else
+		munmap((void *)file.pData, file.size);
+#endif
+	}
+	file = ReplayFile();
+}
+
+/******************************************************************************/
+/*!
+	ReplayBegin() sets the game state up like the recorded match started. The
+	caller chooses if the view stage runs, nothing is recorded.
+*/
+/******************************************************************************/
+void ReplayBegin(ReplayFile& file)
+{
+	GameStateAsteroidsSetRecordPath(nullptr);
+	GameStateAsteroidsSetWorldSize(file.worldWidth, file.worldHeight);
+	GameStateAsteroidsSetSeed(file.seed);
+	GameStateAsteroidsSetEndless(file.endless);
+	GameStateAsteroidsLoad();
+	GameStateAsteroidsInit();
+
+	file.pCursor	= file.pData + REPLAY_HEADER_SIZE;
+	file.tick		= 0;
+}
+
+/******************************************************************************/
+/*!
+	ReplayStep() feeds the records to the game state until tickCount ticks are
+	played or the end of the file is reached. Keyframes on the way are skipped,
+	the state they hold is the one the simulation already has.
+*/
+/******************************************************************************/
+uint32_t ReplayStep(ReplayFile& file, uint32_t tickCount)
+{
+	const uint8_t *				pEnd = file.pData + file.size;
+	std::vector<InputCommand>	commands;
+	uint32_t					played = 0;
+
+	while (played < tickCount && file.pCursor && file.pCursor < pEnd)
+	{
+		switch (ReplayGetU8(file.pCursor, pEnd))
+		{
+		case REPLAY_RECORD_TICK:
+		{
+			float dt		= ReplayGetF32(file.pCursor, pEnd);
+			uint32_t count	= ReplayGetU32(file.pCursor, pEnd);
+			if (file.pCursor == 0 || (uint64_t)(pEnd - file.pCursor) < (uint64_t)count * 5)
+			{
+				file.pCursor = 0;
+				break;
+			}
+			commands.resize(count);
+			for (uint32_t c = 0; c < count; c++)
+			{
+				commands[c].player	= ReplayGetU32(file.pCursor, pEnd);
+				commands[c].buttons	= ReplayGetU8(file.pCursor, pEnd);
+			}
+			if (file.pCursor == 0)
+				break;
+
+			GameStateAsteroidsTick(dt, commands.data(), count);
+			++file.tick;
+			++played;
+			break;
+		}
+		case REPLAY_RECORD_JOIN:
+			GameStateAsteroidsPlayerJoin(ReplayGetU32(file.pCursor, pEnd));
+			break;
+		case REPLAY_RECORD_LEAVE:
+			GameStateAsteroidsPlayerLeave(ReplayGetU32(file.pCursor, pEnd));
+			break;
+		case REPLAY_RECORD_POPULATE:
+		{
+			uint32_t asteroidCount	= ReplayGetU32(file.pCursor, pEnd);
+			uint32_t bulletCount	= ReplayGetU32(file.pCursor, pEnd);
+			if (file.pCursor)
+				GameStateAsteroidsPopulate(asteroidCount, bulletCount);
+			break;
+		}
+		case REPLAY_RECORD_KEYFRAME:
+		{
+			ReplayGetU32(file.pCursor, pEnd);
+			uint32_t size = ReplayGetU32(file.pCursor, pEnd);
+			if (file.pCursor && (size_t)(pEnd - file.pCursor) >= size)
+				file.pCursor += size;
+			else
+				file.pCursor = 0;
+			break;
+		}
+		default:
+			// end record or damaged data
+			file.pCursor = 0;
+			break;
+		}
+	}
+
+	return played;
+}
+
+/******************************************************************************/
+/*!
+	ReplaySeek() finds the keyframe of tick from the keyframe interval of the
+	header, restores it and plays the few ticks left. Without a usable
+	keyframe it restarts the match and plays from tick 0.
+*/
+/******************************************************************************/
+bool ReplaySeek(ReplayFile& file, uint32_t tick)
+{
+	if (tick > file.tickCount)
+		return false;
+
+	// keyframes are recorded at every multiple of keyframeTicks, so this is the one before tick
+	size_t k = tick / file.keyframeTicks;
+	if (k >= file.keyframes.size())
+		k = file.keyframes.size() - 1;
+
+	bool restored = false;
+	if (!file.keyframes.empty() && file.keyframes[k].tick <= tick && file.keyframes[k].offset < file.size)
+	{
+		const uint8_t * pEnd	= file.pData + file.size;
+		const uint8_t * pCursor	= file.pData + file.keyframes[k].offset;
+		uint8_t	 type			= ReplayGetU8(pCursor, pEnd);
+		uint32_t keyframeTick	= ReplayGetU32(pCursor, pEnd);
+		uint32_t size			= ReplayGetU32(pCursor, pEnd);
+		if (pCursor && type == REPLAY_RECORD_KEYFRAME && keyframeTick == file.keyframes[k].tick &&
+			(size_t)(pEnd - pCursor) >= size && GameStateAsteroidsLoadKeyframe(pCursor, size))
+		{
+			file.pCursor	= pCursor + size;
+			file.tick		= keyframeTick;
+			restored		= true;
+		}
+	}
+
+	if (!restored)
+	{
+		GameStateAsteroidsFree();
+		GameStateAsteroidsUnload();
+		ReplayBegin(file);
+	}
+
+	ReplayStep(file, tick - file.tick);
+	return file.tick == tick;
+}
+
+/******************************************************************************/
+/*!
+	ReplayRun() maps the file, sets the game state up headless and plays it
+	to the end as fast as possible, the frame time of each tick comes from the
+	file. With a tick after the file name, it seeks there first and reports
+	how long the seek took.
+*/
+/******************************************************************************/
+int ReplayRun(const char * args)
+{
+	char		path[260] = {};
+	uint32_t	seekTick = 0;
+
+#ifdef _MSC_VER
+	int fields = sscanf_s(args, " %259s %u", path, (unsigned)sizeof(path), &seekTick);
+#else
+	int fields = sscanf(args, " %259s %u", path, &seekTick);
+#endif
+	if (fields < 1)
+	{
+		printf("Usage: -replay <file> [tick]\n");
+		return 1;
+	}
+
+	ReplayFile file;
+	if (!ReplayOpen(path, file))
+		return 1;
+
+	printf("Replay: %s, seed %u, world %gx%g, %u ticks, %u keyframes\n",
+		path, file.seed, file.worldWidth, file.worldHeight, file.tickCount, (unsigned)file.keyframes.size());
+
+	GameStateAsteroidsSetViewEnabled(false);
+	ReplayBegin(file);
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	if (fields == 2)
+	{
+		if (!ReplaySeek(file, seekTick))
+		{
+			printf("Replay: cannot seek to tick %u\n", seekTick);
+			GameStateAsteroidsFree();
+			GameStateAsteroidsUnload();
+			ReplayClose(file);
+			return 1;
+		}
+		double seekMs = (double)std::chrono::duration_cast<std::chrono::microseconds>(
+			std::chrono::steady_clock::now() - start).count() / 1000.0;
+		printf("seek to tick %u: %.3f ms, checksum %08x\n", seekTick, seekMs, GameStateAsteroidsChecksum());
+		start = std::chrono::steady_clock::now();
+	}
+
+	uint32_t firstTick	= file.tick;
+	uint32_t ticks		= ReplayStep(file, 0xFFFFFFFFu);
+	double wall = (double)std::chrono::duration_cast<std::chrono::microseconds>(
+		std::chrono::steady_clock::now() - start).count() / 1000000.0;
+
+	uint32_t checksum = GameStateAsteroidsChecksum();
+
+	GameStateAsteroidsFree();
+	GameStateAsteroidsUnload();
+	GameStateAsteroidsSetEndless(false);
+
+	printf("ticks %u to %u, wall: %.3f s, %.0f ticks/s\n",
+		firstTick, file.tick, wall, wall > 0.0 ? (double)ticks / wall : 0.0);
+
+	bool ended = file.ended;
+	uint32_t expectedTicks = file.tickCount, expectedChecksum = file.checksum, replayedTicks = file.tick;
+	ReplayClose(file);
+
+	if (!ended)
+	{
+		printf("Replay: no end record (truncated recording), checksum %08x\n", checksum);
+		return 1;
+	}
+	if (replayedTicks != expectedTicks || checksum != expectedChecksum)
+	{
+		printf("Replay: MISMATCH, recorded %u ticks checksum %08x, replayed %u ticks checksum %08x\n",
+			expectedTicks, expectedChecksum, replayedTicks, checksum);
+		return 1;
+	}
+
+	printf("Replay: match, checksum %08x\n", checksum);
+	return 0;
+}
@@ -1,12 +1,533 @@
+/******************************************************************************/
+/*!
+\file		Scoreboard.cpp
+\brief		This file contains the definition of the scoreboard.
+
+			The table uses linear probing with a power of 2 capacity, kept at
+			most half full, and backward shift deletion so it never holds a
+			tombstone. The leaderboard is a min-heap of table slots: its root
+			is the worst of the best players, the one a rising score has to
+			beat. A score event is one probe in the table and at most one
+			sift of the heap, O(log K) for a leaderboard of K players.
+
+			A published leaderboard is kept in a ring of SCOREBOARD_HISTORY
+			versions. A delta lists the ranks whose player or score differ from
+			the base version, a rank past the new size is dropped by the size.
+ */
+/******************************************************************************/
+
 #include "Scoreboard.h"
+#include "NetProtocol.h"
+
+#include <algorithm>
+
+// ---------------------------------------------------------------------------
 
-// Player Structure
-// Identified by a player id
-// With their respective score
-struct Player {
-	int player_id;
-	int score = 0;
+// one slot of the table
+struct ScoreboardSlot
+{
+	uint32_t			player;
+	int32_t				score;
+	int32_t				heap;		// position in sScoreboardHeap, -1 when not on the leaderboard
+	uint32_t			used;		// 1 when the slot holds a player
 };
 
-// List of players
-std::map<int, Player> list_of_players;
\ No newline at end of file
+// ---------------------------------------------------------------------------
+// static variables
+
+static std::vector<ScoreboardSlot>	sScoreboardSlots;			// the table, size is a power of 2
+static std::vector<uint32_t>		sScoreboardHeap;			// slots of the leaderboard, min-heap on the rank
+static unsigned int					sScoreboardCount;			// players in the table
+static unsigned int					sScoreboardTopCount;		// size of the leaderboard when enough players joined
+static uint32_t						sScoreboardVersion;			// latest published version, 0 before the first
+static std::vector<ScoreboardEntry>	sScoreboardTop;				// leaderboard being compared with the latest version
+static std::vector<ScoreboardEntry>	sScoreboardHistory[SCOREBOARD_HISTORY];	// published leaderboards, by version
+
+/******************************************************************************/
+/*!
+	Home slot of a player, Fibonacci hashing so consecutive ids spread over
+	the table.
+*/
+/******************************************************************************/
+static size_t scoreboardHome(uint32_t player)
+{
+	return (size_t)(((uint64_t)player * 11400714819323198485ull) >> 32) & (sScoreboardSlots.size() - 1);
+}
+
+/******************************************************************************/
+/*!
+	Slot of a player, or -1 if it has not joined.
+*/
+/******************************************************************************/
+static long scoreboardFind(uint32_t player)
+{
+	size_t mask = sScoreboardSlots.size() - 1;
+	for (size_t i = scoreboardHome(player);; i = (i + 1) & mask)
+	{
+		const ScoreboardSlot& slot = sScoreboardSlots[i];
+		if (!slot.used)
+			return -1;
+		if (slot.player == player)
+			return (long)i;
+	}
+}
+
+/******************************************************************************/
+/*!
+	True if slot a ranks below slot b: a lower score, or the same score and a
+	higher player id.
+*/
+/******************************************************************************/
+static bool scoreboardWorse(uint32_t a, uint32_t b)
+{
+	const ScoreboardSlot& slotA = sScoreboardSlots[a];
+	const ScoreboardSlot& slotB = sScoreboardSlots[b];
+	return slotA.score < slotB.score || (slotA.score == slotB.score && slotA.player > slotB.player);
+}
+
+/******************************************************************************/
+/*!
+	Put slot at position i of the heap and record it in the slot.
+*/
+/******************************************************************************/
+static void scoreboardHeapPlace(size_t i, uint32_t slot)
+{
+	sScoreboardHeap[i] = slot;
+	sScoreboardSlots[slot].heap = (int32_t)i;
+}
+
+/******************************************************************************/
+/*!
+	Move the entry at position i of the heap towards the root while it ranks
+	below its parent, then towards the leaves while a child ranks below it.
+*/
+/******************************************************************************/
+static void scoreboardHeapFix(size_t i)
+{
+	uint32_t slot = sScoreboardHeap[i];
+
+	while (i > 0 && scoreboardWorse(slot, sScoreboardHeap[(i - 1) / 2]))
+	{
+		scoreboardHeapPlace(i, sScoreboardHeap[(i - 1) / 2]);
+		i = (i - 1) / 2;
+	}
+
+	for (;;)
+	{
+		size_t child = i * 2 + 1;
+		if (child >= sScoreboardHeap.size())
+			break;
+		if (child + 1 < sScoreboardHeap.size() && scoreboardWorse(sScoreboardHeap[child + 1], sScoreboardHeap[child]))
+			++child;
+		if (!scoreboardWorse(sScoreboardHeap[child], slot))
+			break;
+		scoreboardHeapPlace(i, sScoreboardHeap[child]);
+		i = child;
+	}
+
+	scoreboardHeapPlace(i, slot);
+}
+
+/******************************************************************************/
+/*!
+	Take the entry at position i out of the heap.
+*/
+/******************************************************************************/
+static void scoreboardHeapRemove(size_t i)
+{
+	sScoreboardSlots[sScoreboardHeap[i]].heap = -1;
+
+	uint32_t last = sScoreboardHeap.back();
+	sScoreboardHeap.pop_back();
+	if (i < sScoreboardHeap.size())
+	{
+		scoreboardHeapPlace(i, last);
+		scoreboardHeapFix(i);
+	}
+}
+
+/******************************************************************************/
+/*!
+	Give a player that is not on the leaderboard a chance to enter it: it
+	takes a free place, or the place of the root if it ranks above it.
+*/
+/******************************************************************************/
+static void scoreboardHeapOffer(uint32_t slot)
+{
+	if (sScoreboardHeap.size() < sScoreboardTopCount)
+	{
+		sScoreboardHeap.push_back(slot);
+		scoreboardHeapPlace(sScoreboardHeap.size() - 1, slot);
+		scoreboardHeapFix(sScoreboardHeap.size() - 1);
+		return;
+	}
+
+	if (sScoreboardHeap.empty() || !scoreboardWorse(sScoreboardHeap[0], slot))
+		return;
+
+	sScoreboardSlots[sScoreboardHeap[0]].heap = -1;
+	scoreboardHeapPlace(0, slot);
+	scoreboardHeapFix(0);
+}
+
+/******************************************************************************/
+/*!
+	A player left the leaderboard or dropped in it, the best player outside
+	may now rank above the root. Finding it is a walk over the table, it only
+	happens when a player leaves or loses points.
+*/
+/******************************************************************************/
+static void scoreboardHeapRefill()
+{
+	if (sScoreboardCount <= sScoreboardHeap.size())
+		return;
+
+	long best = -1;
+	for (size_t i = 0; i < sScoreboardSlots.size(); i++)
+	{
+		const ScoreboardSlot& slot = sScoreboardSlots[i];
+		if (slot.used && slot.heap < 0 && (best < 0 || scoreboardWorse((uint32_t)best, (uint32_t)i)))
+			best = (long)i;
+	}
+
+	if (best >= 0)
+		scoreboardHeapOffer((uint32_t)best);
+}
+
+/******************************************************************************/
+/*!
+	Put a slot in the table at the first free place from its home, returns
+	the slot it landed in. The table must have room.
+*/
+/******************************************************************************/
+static size_t scoreboardPlace(const ScoreboardSlot& slot)
+{
+	size_t mask = sScoreboardSlots.size() - 1;
+	size_t i = scoreboardHome(slot.player);
+	while (sScoreboardSlots[i].used)
+		i = (i + 1) & mask;
+
+	sScoreboardSlots[i] = slot;
+	if (slot.heap >= 0)
+		sScoreboardHeap[slot.heap] = (uint32_t)i;
+	return i;
+}
+
+/******************************************************************************/
+/*!
+	Double the table and place every player again, the leaderboard follows
+	its slots.
+*/
+/******************************************************************************/
+static void scoreboardGrow()
+{
+	std::vector<ScoreboardSlot> old(sScoreboardSlots.size() * 2, ScoreboardSlot());
+	old.swap(sScoreboardSlots);
+
+	for (const ScoreboardSlot& slot : old)
+	{
+		if (slot.used)
+			scoreboardPlace(slot);
+	}
+}
+
+/******************************************************************************/
+/*!
+	ScoreboardInit() drops every player and sizes the leaderboard.
+*/
+/******************************************************************************/
+void ScoreboardInit(unsigned int topCount)
+{
+	sScoreboardSlots.assign(SCOREBOARD_CAPACITY_MIN, ScoreboardSlot());
+	sScoreboardHeap.clear();
+	sScoreboardHeap.reserve(topCount);
+	sScoreboardCount	= 0;
+	sScoreboardTopCount	= topCount < SCOREBOARD_TOP_MAX ? topCount : SCOREBOARD_TOP_MAX;
+	sScoreboardVersion	= 0;
+	for (std::vector<ScoreboardEntry>& published : sScoreboardHistory)
+		published.clear();
+}
+
+/******************************************************************************/
+/*!
+	ScoreboardFree() releases the memory of the table and of the leaderboard.
+*/
+/******************************************************************************/
+void ScoreboardFree()
+{
+	std::vector<ScoreboardSlot>().swap(sScoreboardSlots);
+	std::vector<uint32_t>().swap(sScoreboardHeap);
+	std::vector<ScoreboardEntry>().swap(sScoreboardTop);
+	for (std::vector<ScoreboardEntry>& published : sScoreboardHistory)
+		std::vector<ScoreboardEntry>().swap(published);
+	sScoreboardCount	= 0;
+	sScoreboardVersion	= 0;
+}
+
+/******************************************************************************/
+/*!
+	ScoreboardJoin() adds a player with a score of 0. A new player enters the
+	leaderboard while it has free places, or when everybody on it is below 0.
+*/
+/******************************************************************************/
+void ScoreboardJoin(uint32_t player)
+{
+	if (sScoreboardSlots.empty())
+		ScoreboardInit();
+	if (scoreboardFind(player) >= 0)
+		return;
+
+	// at most half full keeps the probes short
+	if ((sScoreboardCount + 1) * 2 > sScoreboardSlots.size())
+		scoreboardGrow();
+
+	ScoreboardSlot slot = { player, 0, -1, 1 };
+	size_t i = scoreboardPlace(slot);
+	++sScoreboardCount;
+
+	scoreboardHeapOffer((uint32_t)i);
+}
+
+/******************************************************************************/
+/*!
+	ScoreboardLeave() removes a player. The slots after it in its probe run
+	that may sit in its place move back, so a lookup never stops early.
+*/
+/******************************************************************************/
+void ScoreboardLeave(uint32_t player)
+{
+	if (sScoreboardSlots.empty())
+		return;
+
+	long found = scoreboardFind(player);
+	if (found < 0)
+		return;
+
+	if (sScoreboardSlots[found].heap >= 0)
+		scoreboardHeapRemove((size_t)sScoreboardSlots[found].heap);
+
+	size_t mask = sScoreboardSlots.size() - 1;
+	size_t hole = (size_t)found;
+	for (size_t i = (hole + 1) & mask; sScoreboardSlots[i].used; i = (i + 1) & mask)
+	{
+		// a slot moves into the hole if its home is not between the hole and itself
+		size_t home = scoreboardHome(sScoreboardSlots[i].player);
+		if (((i - home) & mask) < ((i - hole) & mask))
+			continue;
+
+		sScoreboardSlots[hole] = sScoreboardSlots[i];
+		if (sScoreboardSlots[hole].heap >= 0)
+			sScoreboardHeap[sScoreboardSlots[hole].heap] = (uint32_t)hole;
+		hole = i;
+	}
+	sScoreboardSlots[hole] = ScoreboardSlot();
+	--sScoreboardCount;
+
+	scoreboardHeapRefill();
+}
+
+/******************************************************************************/
+/*!
+	ScoreboardAdd() is a score event. A player on the leaderboard moves in the
+	heap, one outside of it is offered the place of the root.
+*/
+/******************************************************************************/
+void ScoreboardAdd(uint32_t player, int32_t points)
+{
+	if (sScoreboardSlots.empty())
+		return;
+
+	long found = scoreboardFind(player);
+	if (found < 0)
+		return;
+
+	ScoreboardSet(player, sScoreboardSlots[found].score + points);
+}
+
+/******************************************************************************/
+/*!
+	ScoreboardSet() replaces the score of a player.
+*/
+/******************************************************************************/
+void ScoreboardSet(uint32_t player, int32_t score)
+{
+	if (sScoreboardSlots.empty())
+		return;
+
+	long found = scoreboardFind(player);
+	if (found < 0)
+		return;
+
+	ScoreboardSlot& slot = sScoreboardSlots[found];
+	bool dropped = score < slot.score;
+	slot.score = score;
+
+	if (slot.heap < 0)
+	{
+		scoreboardHeapOffer((uint32_t)found);
+		return;
+	}
+
+	scoreboardHeapFix((size_t)slot.heap);
+	if (dropped)
+		scoreboardHeapRefill();
+}
+
+/******************************************************************************/
+/*!
+	ScoreboardFind() reads the score of a player.
+*/
+/******************************************************************************/
+bool ScoreboardFind(uint32_t player, int32_t& score)
+{
+	if (sScoreboardSlots.empty())
+		return false;
+
+	long found = scoreboardFind(player);
+	if (found < 0)
+		return false;
+
+	score = sScoreboardSlots[found].score;
+	return true;
+}
+
+/******************************************************************************/
+/*!
+	ScoreboardPlayerCount() returns the number of players on the scoreboard.
+*/
+/******************************************************************************/
+unsigned int ScoreboardPlayerCount()
+{
+	return sScoreboardCount;
+}
+
+/******************************************************************************/
+/*!
+	ScoreboardTop() copies the leaderboard out of the heap, best first. Only
+	the K entries of the heap are sorted.
+*/
+/******************************************************************************/
+void ScoreboardTop(std::vector<ScoreboardEntry>& top)
+{
+	top.clear();
+	for (uint32_t slot : sScoreboardHeap)
+	{
+		ScoreboardEntry entry = { sScoreboardSlots[slot].player, sScoreboardSlots[slot].score };
+		top.push_back(entry);
+	}
+
+	std::sort(top.begin(), top.end(), [](const ScoreboardEntry& a, const ScoreboardEntry& b)
+	{
+		return a.score > b.score || (a.score == b.score && a.player < b.player);
+	});
+}
+
+/******************************************************************************/
+/*!
+	ScoreboardPublish() compares the leaderboard with the latest version and
+	keeps it as a new version if a rank changed. The server calls it once per
+	snapshot, the score events in between are merged into one version.
+*/
+/******************************************************************************/
+uint32_t ScoreboardPublish()
+{
+	ScoreboardTop(sScoreboardTop);
+
+	const std::vector<ScoreboardEntry>& latest = sScoreboardHistory[sScoreboardVersion % SCOREBOARD_HISTORY];
+	bool changed = sScoreboardVersion == 0 || latest.size() != sScoreboardTop.size();
+	for (size_t rank = 0; !changed && rank < latest.size(); rank++)
+		changed = latest[rank].player != sScoreboardTop[rank].player || latest[rank].score != sScoreboardTop[rank].score;
+
+	if (changed)
+	{
+		// version 0 means "nothing" to a client, it is skipped when the counter wraps
+		if (++sScoreboardVersion == 0)
+			++sScoreboardVersion;
+		sScoreboardHistory[sScoreboardVersion % SCOREBOARD_HISTORY] = sScoreboardTop;
+	}
+	return sScoreboardVersion;
+}
+
+/******************************************************************************/
+/*!
+	ScoreboardVersion() returns the latest published version.
+*/
+/******************************************************************************/
+uint32_t ScoreboardVersion()
+{
+	return sScoreboardVersion;
+}
+
+/******************************************************************************/
+/*!
+	ScoreboardWriteDelta() writes u32 base version, u32 version, u8 size, u8
+	change count, then u8 rank, u32 player, i32 score per change.
+*/
+/******************************************************************************/
+void ScoreboardWriteDelta(uint32_t baseVersion, std::vector<uint8_t>& packet)
+{
+	// a base is kept while fewer than SCOREBOARD_HISTORY versions came after it
+	if (baseVersion == 0 || sScoreboardVersion - baseVersion >= SCOREBOARD_HISTORY || baseVersion > sScoreboardVersion)
+		baseVersion = 0;
+
+	static const std::vector<ScoreboardEntry>	sEmpty;
+	const std::vector<ScoreboardEntry>&			base	= baseVersion ? sScoreboardHistory[baseVersion % SCOREBOARD_HISTORY] : sEmpty;
+	const std::vector<ScoreboardEntry>&			latest	= sScoreboardHistory[sScoreboardVersion % SCOREBOARD_HISTORY];
+
+	NetPutU32(packet, baseVersion);
+	NetPutU32(packet, sScoreboardVersion);
+	NetPutU8(packet, (uint8_t)latest.size());
+
+	size_t countAt = packet.size();
+	NetPutU8(packet, 0);
+
+	uint8_t changes = 0;
+	for (size_t rank = 0; rank < latest.size(); rank++)
+	{
+		if (rank < base.size() && base[rank].player == latest[rank].player && base[rank].score == latest[rank].score)
+			continue;
+
+		NetPutU8(packet, (uint8_t)rank);
+		NetPutU32(packet, latest[rank].player);
+		NetPutU32(packet, (uint32_t)latest[rank].score);
+		++changes;
+	}
+	packet[countAt] = changes;
+}
+
+/******************************************************************************/
+/*!
+	ScoreboardApplyDelta() reads what ScoreboardWriteDelta() wrote. A delta
+	based on another version than the one held is dropped, the next one the
+	server sends is based on the version the client acknowledges.
+*/
+/******************************************************************************/
+bool ScoreboardApplyDelta(const uint8_t * pData, const uint8_t * pEnd,
+						  std::vector<ScoreboardEntry>& board, uint32_t& version)
+{
+	const uint8_t * pCursor = pData;
+	uint32_t	baseVersion	= NetGetU32(pCursor, pEnd);
+	uint32_t	newVersion	= NetGetU32(pCursor, pEnd);
+	uint8_t		size		= NetGetU8(pCursor, pEnd);
+	uint8_t		changes		= NetGetU8(pCursor, pEnd);
+	if (pCursor == 0 || (baseVersion != 0 && baseVersion != version) || newVersion == version)
+		return false;
+	if ((size_t)(pEnd - pCursor) < (size_t)changes * 9)
+		return false;
+
+	if (baseVersion == 0)
+		board.clear();
+	board.resize(size);
+
+	for (uint8_t c = 0; c < changes; c++)
+	{
+		uint8_t		rank	= NetGetU8(pCursor, pEnd);
+		uint32_t	player	= NetGetU32(pCursor, pEnd);
+		int32_t		score	= (int32_t)NetGetU32(pCursor, pEnd);
+		if (rank < size)
+			board[rank] = { player, score };
+	}
+
+	version = newVersion;
+	return true;
+}
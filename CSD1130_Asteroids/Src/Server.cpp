@@ -0,0 +1,1153 @@
+/******************************************************************************/
+/*!
+\file		Server.cpp
+\brief		This file contains the definition of the headless UDP server. One
+			thread drains the socket, runs the ticks that are due and sends the
+			snapshots, then sleeps in TransportWait() until the next tick or
+			the next packet. What a snapshot round sends is queued in the
+			transport and flushed at once, in one system call with the batch
+			and uring backends.
+
+			With shards the socket of that thread is the first of an
+			SO_REUSEPORT group. The system hashes every sender to one socket
+			of the group, the thread of that socket receives and decodes its
+			packets and queues the commands in a ring the simulation thread
+			drains. A session is always heard by the same shard, its commands
+			stay in order. The simulation thread sends everything from its
+			own socket, on the same port.
+
+			A round of several parts queues the parts of a session one after
+			the other, all of the size of a full slice when they are raw: the
+			transport finds them as one run to one address and segments it.
+			Coded slices differ in size, a run ends at the first shorter one.
+
+			Every slice is coded once per round with the codec of the server,
+			for every session. A session whose budget is smaller than a coded
+			slice gets the slice coded again for fewer asteroids, kept for the
+			other sessions of the round with the same budget.
+ */
+/******************************************************************************/
+
+#include "Main.h"
+#include "Server.h"
+#include "Socket.h"
+#include "Transport.h"
+#include "PacketPool.h"
+#include "NetProtocol.h"
+#include "NetChannel.h"
+#include "NetCongestion.h"
+#include "SnapshotCodec.h"
+#include "Options.h"
+#include "Scoreboard.h"
+#include "Log.h"
+#include "Metrics.h"
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <memory>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+
+// session of a remote player
+struct ServerClient
+{
+	SocketAddress		address;			// where the packets come from and go to
+	uint32_t			nonce;				// nonce of the CONNECT, echoed in the ACCEPT
+	uint32_t			player;				// player id in the simulation
+	uint32_t			inputSequence;		// last input received
+	uint32_t			inputApplied;		// last input applied by a tick, the ack of the snapshots
+	uint8_t				buttons;			// buttons of the last input
+	uint8_t				triggered;			// INPUT_FIRE of every input since the last tick, so a shot is never lost
+	uint32_t			snapshotSequence;	// number of the next snapshot
+	uint32_t			snapshotRounds;		// rounds it got a snapshot in, the effective rate
+	uint32_t			snapshotRoundsSeen;	// rounds at the start of the metrics period
+	float				snapshotRate;		// rounds per second it got over the last period
+	bool				due;				// got a snapshot this round, the leaderboard goes with it
+	uint32_t			leaderboardAck;		// leaderboard version the client holds, the base of its deltas
+	double				lastHeard;			// time of the last packet
+	NetChannelSender *	pChannel;			// reliable events, owned by the session
+	NetCongestion *		pCongestion;		// round trip, snapshot loss, rate and packet budget, owned by the session
+
+	uint32_t			lossSequence;		// input sequence at the start of the metrics period
+	uint32_t			lossReceived;		// inputs received since
+	float				loss;				// input loss of the last period
+};
+
+// a packet of a client decoded, what the simulation thread applies
+struct ServerCommand
+{
+	SocketAddress		from;
+	double				time;				// when it was received
+	uint8_t				type;				// NET_PACKET_CONNECT, INPUT or DISCONNECT
+	uint8_t				version;			// CONNECT
+	uint8_t				buttons;			// INPUT
+	uint16_t			heldMs;				// INPUT
+	uint32_t			nonce;				// CONNECT
+	uint32_t			player;				// INPUT, DISCONNECT
+	uint32_t			sequence;			// INPUT
+	uint32_t			leaderboard;		// INPUT
+	uint32_t			snapshot;			// INPUT
+	uint32_t			snapshotBits;		// INPUT
+};
+
+// a socket of the SO_REUSEPORT group past the first, and its I/O thread. The thread
+// moves the head of the ring, the simulation thread the tail
+struct ServerShard
+{
+	alignas(64) std::atomic<uint32_t>	head;
+	alignas(64) std::atomic<uint32_t>	tail;
+	alignas(64) std::atomic<uint64_t>	packets;		// what the transport received, published by the thread
+	std::atomic<uint64_t>				bytes;
+	std::atomic<uint64_t>				calls;
+	std::atomic<uint64_t>				dropped;		// commands that found the ring full
+	alignas(64) Transport *				pTransport;
+	std::thread							thread;
+	uint64_t							packetsSeen;	// counters already given to the metrics, simulation thread
+	uint64_t							bytesSeen;
+	uint64_t							callsSeen;
+	uint64_t							droppedSeen;
+	ServerCommand						commands[SERVER_SHARD_QUEUE];
+};
+
+// ---------------------------------------------------------------------------
+// static variables
+
+static Transport *							spServerTransport;
+static TransportStats						sServerTransportSeen;		// counters of the transport already given to the metrics
+static std::vector<ServerClient>			sServerClients;				// every session
+static std::unordered_map<uint64_t, size_t>	sServerClientIndex;			// address key -> index in sServerClients
+static unsigned int							sServerClientMax;			// sessions accepted at once
+static unsigned int							sServerTickRate;			// ticks per second
+static unsigned int							sServerSnapshotRate;		// snapshot rounds per second, the fastest rate of a session
+static bool									sServerCongestion;			// the sessions get the rate and the budget of their link
+static size_t								sServerPacketBytes;			// snapshot with a full slice and message section
+static SNAPSHOT_CODEC						sServerCodec;				// how the asteroids of the snapshots are written
+static uint32_t								sServerNextPlayer;			// player id of the next session
+static unsigned int							sServerSnapshotParts;		// snapshots per session and round
+static std::vector<uint8_t>					sServerPacket;				// packet being written
+static std::vector<InputCommand>			sServerCommands;			// commands of the tick
+static std::vector<AsteroidData>			sServerAsteroids;			// asteroids of the snapshot
+static size_t								sServerAsteroidCursor;		// first asteroid of the next snapshot
+static std::vector<AsteroidData>			sServerSlices;				// asteroids of the slices of the round, part after part
+static std::vector<PacketBuffer *>			sServerTrimmed;				// slices coded for fewer asteroids, [part * (count + 1) + asteroids]
+static std::vector<PacketBuffer *>			sServerDeltas;				// leaderboard packets of this snapshot, one per base version
+static uint32_t								sServerRound;				// snapshot rounds sent
+static double								sServerNow;					// time of the current loop, the rounds are stamped with it
+static std::vector<MetricsClient>			sServerMetrics;				// per session table published to the metrics
+static double								sServerMetricsAt;			// time of the last publish
+static std::vector<std::unique_ptr<ServerShard>>	sServerShards;		// the sockets past the first
+static std::atomic<bool>					sServerShardQuit;			// stops the I/O threads
+static volatile std::sig_atomic_t			sServerStop;				// set by SIGINT/SIGTERM, the loop shuts down cleanly
+
+static unsigned long						sServerPacketsIn;			// statistics since the last print
+static unsigned long						sServerPacketsOut;
+static unsigned long						sServerBytesOut;
+static unsigned long						sServerRecvCalls;
+static unsigned long						sServerSendCalls;
+static unsigned long						sServerSegmented;
+
+/******************************************************************************/
+/*!
+	Handler of SIGINT and SIGTERM, the loop sees the flag and shuts down like
+	at the end of seconds=, so the log and the recording are closed.
+*/
+/******************************************************************************/
+static void serverOnSignal(int)
+{
+	sServerStop = 1;
+}
+
+/******************************************************************************/
+/*!
+	Seconds since start, from the steady clock.
+*/
+/******************************************************************************/
+static double serverSeconds(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+/******************************************************************************/
+/*!
+	Key of an address in sServerClientIndex.
+*/
+/******************************************************************************/
+static uint64_t serverAddressKey(const SocketAddress& address)
+{
+	return ((uint64_t)address.ip << 16) | address.port;
+}
+
+/******************************************************************************/
+/*!
+	Queue sServerPacket for address, it goes out at the next serverFlush().
+*/
+/******************************************************************************/
+static void serverSend(const SocketAddress& address)
+{
+	TransportQueue(spServerTransport, sServerPacket.data(), sServerPacket.size(), 0, 0, address);
+}
+
+/******************************************************************************/
+/*!
+	Give what the transport did since the last call to the statistics and to
+	the metrics. The datagrams per call are the batch sizes achieved.
+*/
+/******************************************************************************/
+static void serverTransportMetrics()
+{
+	const TransportStats&	stats	= TransportGetStats(spServerTransport);
+	TransportStats&			seen	= sServerTransportSeen;
+
+	sServerPacketsIn	+= (unsigned long)(stats.recvDatagrams - seen.recvDatagrams);
+	sServerPacketsOut	+= (unsigned long)(stats.sendDatagrams - seen.sendDatagrams);
+	sServerBytesOut		+= (unsigned long)(stats.sendBytes - seen.sendBytes);
+	sServerRecvCalls	+= (unsigned long)(stats.recvCalls - seen.recvCalls);
+	sServerSendCalls	+= (unsigned long)(stats.sendCalls - seen.sendCalls);
+	sServerSegmented	+= (unsigned long)(stats.sendSegmented - seen.sendSegmented);
+
+	MetricsAdd(METRIC_PACKETS_IN,	stats.recvDatagrams - seen.recvDatagrams);
+	MetricsAdd(METRIC_PACKETS_OUT,	stats.sendDatagrams - seen.sendDatagrams);
+	MetricsAdd(METRIC_BYTES_IN,		stats.recvBytes - seen.recvBytes);
+	MetricsAdd(METRIC_BYTES_OUT,	stats.sendBytes - seen.sendBytes);
+	MetricsAdd(METRIC_RECV_CALLS,	stats.recvCalls - seen.recvCalls);
+	MetricsAdd(METRIC_SEND_CALLS,	stats.sendCalls - seen.sendCalls);
+	MetricsAdd(METRIC_SEND_DROPPED,	stats.sendDropped - seen.sendDropped);
+	MetricsAdd(METRIC_SEND_SEGMENTED, stats.sendSegmented - seen.sendSegmented);
+	MetricsSet(METRIC_RECV_BATCH_MAX, (double)stats.recvBatchMax);
+	MetricsSet(METRIC_SEND_BATCH_MAX, (double)stats.sendBatchMax);
+
+	PacketPoolStats pool = PacketPoolGetStats();
+	MetricsSet(METRIC_PACKET_BUFFERS, (double)pool.buffers);
+	MetricsSet(METRIC_PACKETS_IN_USE, (double)pool.inUse);
+
+	seen = stats;
+
+	for (const std::unique_ptr<ServerShard>& pShard : sServerShards)
+	{
+		uint64_t packets	= pShard->packets.load(std::memory_order_relaxed);
+		uint64_t bytes		= pShard->bytes.load(std::memory_order_relaxed);
+		uint64_t calls		= pShard->calls.load(std::memory_order_relaxed);
+		uint64_t dropped	= pShard->dropped.load(std::memory_order_relaxed);
+
+		sServerPacketsIn	+= (unsigned long)(packets - pShard->packetsSeen);
+		sServerRecvCalls	+= (unsigned long)(calls - pShard->callsSeen);
+		MetricsAdd(METRIC_PACKETS_IN,	packets - pShard->packetsSeen);
+		MetricsAdd(METRIC_BYTES_IN,		bytes - pShard->bytesSeen);
+		MetricsAdd(METRIC_RECV_CALLS,	calls - pShard->callsSeen);
+		MetricsAdd(METRIC_SHARD_DROPPED, dropped - pShard->droppedSeen);
+
+		pShard->packetsSeen	= packets;
+		pShard->bytesSeen	= bytes;
+		pShard->callsSeen	= calls;
+		pShard->droppedSeen	= dropped;
+	}
+}
+
+/******************************************************************************/
+/*!
+	Send everything queued.
+*/
+/******************************************************************************/
+static void serverFlush()
+{
+	TransportFlush(spServerTransport);
+	serverTransportMetrics();
+}
+
+/******************************************************************************/
+/*!
+	Remove the session at index: the player leaves the match and the last
+	session takes its place. reason is a string literal for the log.
+*/
+/******************************************************************************/
+static void serverDropClient(size_t index, const char * reason)
+{
+	LogWrite(LOG_INFO, "client.leave", { LogInt("player", sServerClients[index].player), LogText("reason", reason) });
+	MetricsAdd(METRIC_CLIENTS_LEFT);
+	GameStateAsteroidsPlayerLeave(sServerClients[index].player);
+	sServerClientIndex.erase(serverAddressKey(sServerClients[index].address));
+	delete sServerClients[index].pChannel;
+	delete sServerClients[index].pCongestion;
+
+	if (index + 1 != sServerClients.size())
+	{
+		sServerClients[index] = sServerClients.back();
+		sServerClientIndex[serverAddressKey(sServerClients[index].address)] = index;
+	}
+	sServerClients.pop_back();
+}
+
+/******************************************************************************/
+/*!
+	Decode one packet of a client into command. Returns false for a packet
+	cut short or of a type the clients do not send. It touches nothing of the
+	server, the I/O threads call it.
+*/
+/******************************************************************************/
+static bool serverDecode(const uint8_t * pData, size_t size, const SocketAddress& from, double now, ServerCommand& command)
+{
+	const uint8_t *	pCursor	= pData;
+	const uint8_t *	pEnd	= pData + size;
+
+	command			= ServerCommand();
+	command.from	= from;
+	command.time	= now;
+	command.type	= NetGetHeader(pCursor, pEnd);
+
+	if (command.type == NET_PACKET_CONNECT)
+	{
+		command.version		= NetGetU8(pCursor, pEnd);
+		command.nonce		= NetGetU32(pCursor, pEnd);
+	}
+	else if (command.type == NET_PACKET_INPUT)
+	{
+		command.player		= NetGetU32(pCursor, pEnd);
+		command.sequence	= NetGetU32(pCursor, pEnd);
+		command.buttons		= NetGetU8(pCursor, pEnd);
+		command.leaderboard	= NetGetU32(pCursor, pEnd);
+		command.snapshot	= NetGetU32(pCursor, pEnd);
+		command.snapshotBits	= NetGetU32(pCursor, pEnd);
+		command.heldMs		= NetGetU16(pCursor, pEnd);
+	}
+	else if (command.type == NET_PACKET_DISCONNECT)
+		command.player		= NetGetU32(pCursor, pEnd);
+	else
+		return false;
+
+	return pCursor != 0;
+}
+
+/******************************************************************************/
+/*!
+	Apply one command. A CONNECT from a known address is a lost ACCEPT, it is
+	answered again. Anything else from an unknown address is ignored.
+*/
+/******************************************************************************/
+static void serverApply(const ServerCommand& command)
+{
+	const SocketAddress&	from	= command.from;
+	const double			now		= command.time;
+
+	std::unordered_map<uint64_t, size_t>::iterator found = sServerClientIndex.find(serverAddressKey(from));
+	ServerClient * pClient = found != sServerClientIndex.end() ? &sServerClients[found->second] : 0;
+
+	if (command.type == NET_PACKET_CONNECT)
+	{
+		uint8_t		version	= command.version;
+		uint32_t	nonce	= command.nonce;
+
+		if (pClient == 0)
+		{
+			uint8_t reason = version != NET_PROTOCOL_VERSION ? NET_REJECT_VERSION :
+							 (sServerClients.size() >= sServerClientMax ? NET_REJECT_FULL : 0);
+			if (reason)
+			{
+				LogWrite(LOG_WARN, "client.reject", { LogInt("ip", from.ip), LogInt("port", from.port), LogInt("reason", reason) });
+				MetricsAdd(METRIC_CLIENTS_REJECTED);
+				NetPutHeader(sServerPacket, NET_PACKET_REJECT);
+				NetPutU32(sServerPacket, nonce);
+				NetPutU8(sServerPacket, reason);
+				serverSend(from);
+				return;
+			}
+
+			ServerClient client = {};
+			client.address		= from;
+			client.nonce		= nonce;
+			client.player		= sServerNextPlayer++;
+			client.lastHeard	= now;
+			client.pChannel		= new NetChannelSender();
+			client.pCongestion	= new NetCongestion();
+			NetChannelInit(*client.pChannel);
+			NetCongestionInit(*client.pCongestion, sServerPacketBytes, now);
+			sServerClientIndex[serverAddressKey(from)] = sServerClients.size();
+			sServerClients.push_back(client);
+			pClient = &sServerClients.back();
+
+			GameStateAsteroidsPlayerJoin(client.player);
+			LogWrite(LOG_INFO, "client.join", { LogInt("player", client.player), LogInt("ip", from.ip), LogInt("port", from.port) });
+			MetricsAdd(METRIC_CLIENTS_JOINED);
+		}
+
+		NetPutHeader(sServerPacket, NET_PACKET_ACCEPT);
+		NetPutU32(sServerPacket, pClient->nonce);
+		NetPutU32(sServerPacket, pClient->player);
+		NetPutU16(sServerPacket, (uint16_t)sServerTickRate);
+		NetPutU16(sServerPacket, (uint16_t)sServerSnapshotRate);
+		NetPutU8(sServerPacket, (uint8_t)sServerCodec);
+		serverSend(from);
+		return;
+	}
+
+	if (pClient == 0)
+		return;
+
+	if (command.type == NET_PACKET_INPUT)
+	{
+		uint32_t	sequence	= command.sequence;
+		uint8_t		buttons		= command.buttons;
+		uint32_t	leaderboard	= command.leaderboard;
+		uint32_t	snapshot	= command.snapshot;
+		uint16_t	heldMs		= command.heldMs;
+		if (command.player != pClient->player)
+			return;
+
+		pClient->lastHeard = now;
+		++pClient->lossReceived;
+
+		// the echo of a snapshot sent: the messages it held are done, the round trip and the loss of the link
+		if (heldMs != NET_INPUT_NO_SNAPSHOT && (int32_t)(snapshot - pClient->snapshotSequence) < 0)
+		{
+			NetChannelAck(*pClient->pChannel, snapshot, command.snapshotBits);
+			NetCongestionAck(*pClient->pCongestion, snapshot, command.snapshotBits, (float)heldMs, now);
+		}
+
+		// inputs arriving out of order are older than the one kept
+		if ((int32_t)(sequence - pClient->inputSequence) <= 0)
+			return;
+
+		pClient->inputSequence	= sequence;
+		pClient->buttons		= buttons;
+		pClient->triggered		|= buttons & INPUT_FIRE;
+		pClient->leaderboardAck	= leaderboard;
+	}
+	else if (command.type == NET_PACKET_DISCONNECT)
+	{
+		if (command.player != pClient->player)
+			return;
+
+		serverDropClient(found->second, "disconnect");
+	}
+}
+
+/******************************************************************************/
+/*!
+	Body of the I/O thread of a shard: receive, decode and queue until
+	sServerShardQuit. A command that finds the ring full is dropped like a
+	lost packet, the client sends its input again next frame.
+*/
+/******************************************************************************/
+static void serverShardMain(ServerShard * pShard, std::chrono::steady_clock::time_point start)
+{
+	while (!sServerShardQuit.load(std::memory_order_relaxed))
+	{
+		if (!TransportWait(pShard->pTransport, SERVER_SHARD_WAIT_MS))
+			continue;
+
+		double		now		= serverSeconds(start);
+		uint32_t	head	= pShard->head.load(std::memory_order_relaxed);
+		for (;;)
+		{
+			const TransportDatagram * pDatagrams = 0;
+			unsigned int count = TransportReceive(pShard->pTransport, pDatagrams);
+
+			uint32_t tail = pShard->tail.load(std::memory_order_acquire);
+			for (unsigned int i = 0; i < count; i++)
+			{
+				ServerCommand command;
+				if (!serverDecode(pDatagrams[i].pData, pDatagrams[i].size, pDatagrams[i].from, now, command))
+					continue;
+
+				if (head - tail >= SERVER_SHARD_QUEUE)
+				{
+					pShard->dropped.fetch_add(1, std::memory_order_relaxed);
+					continue;
+				}
+				pShard->commands[head & (SERVER_SHARD_QUEUE - 1)] = command;
+				++head;
+			}
+			pShard->head.store(head, std::memory_order_release);
+
+			if (count < TRANSPORT_RECV_BATCH)
+				break;
+		}
+
+		const TransportStats& stats = TransportGetStats(pShard->pTransport);
+		pShard->packets.store(stats.recvDatagrams, std::memory_order_relaxed);
+		pShard->bytes.store(stats.recvBytes, std::memory_order_relaxed);
+		pShard->calls.store(stats.recvCalls, std::memory_order_relaxed);
+	}
+}
+
+/******************************************************************************/
+/*!
+	Apply the commands the I/O threads queued, shard after shard.
+*/
+/******************************************************************************/
+static void serverDrainShards()
+{
+	for (const std::unique_ptr<ServerShard>& pShard : sServerShards)
+	{
+		uint32_t tail = pShard->tail.load(std::memory_order_relaxed);
+		uint32_t head = pShard->head.load(std::memory_order_acquire);
+		for (; tail != head; tail++)
+			serverApply(pShard->commands[tail & (SERVER_SHARD_QUEUE - 1)]);
+		pShard->tail.store(tail, std::memory_order_release);
+	}
+}
+
+/******************************************************************************/
+/*!
+	Stop the I/O threads and close their sockets, with a line per shard of
+	what it received: the spread of the senders over the group.
+*/
+/******************************************************************************/
+static void serverStopShards()
+{
+	sServerShardQuit.store(true);
+	for (size_t s = 0; s < sServerShards.size(); s++)
+	{
+		ServerShard * pShard = sServerShards[s].get();
+		if (pShard->thread.joinable())
+		{
+			pShard->thread.join();
+
+			NetSimStats in, out;
+			TransportGetConditionStats(pShard->pTransport, in, out);
+			LogWrite(LOG_INFO, "server.shard", { LogInt("shard", (int64_t)s + 1), LogInt("packets", (int64_t)pShard->packets.load()),
+				LogInt("dropped", (int64_t)pShard->dropped.load()), LogInt("net_lost", (int64_t)in.lost) });
+		}
+		TransportClose(pShard->pTransport);
+	}
+	sServerShards.clear();
+}
+
+/******************************************************************************/
+/*!
+	Log the simulated conditions of one direction.
+*/
+/******************************************************************************/
+static void serverLogConditions(const char * direction, const NetSimConditions& conditions)
+{
+	LogWrite(LOG_INFO, "server.net", { LogText("direction", direction), LogFloat("latency_ms", conditions.latencyMs),
+		LogFloat("jitter_ms", conditions.jitterMs), LogFloat("loss", conditions.loss), LogFloat("dup", conditions.duplicate),
+		LogFloat("reorder", conditions.reorder) });
+}
+
+/******************************************************************************/
+/*!
+	Log what the simulated conditions of one direction did.
+*/
+/******************************************************************************/
+static void serverLogConditionStats(const char * direction, const NetSimStats& stats)
+{
+	LogWrite(LOG_INFO, "server.net.stats", { LogText("direction", direction), LogInt("pushed", (int64_t)stats.pushed),
+		LogInt("lost", (int64_t)stats.lost), LogInt("duplicated", (int64_t)stats.duplicated),
+		LogInt("reordered", (int64_t)stats.reordered), LogInt("delivered", (int64_t)stats.delivered) });
+}
+
+/******************************************************************************/
+/*!
+	Run one tick with the last input of every session.
+*/
+/******************************************************************************/
+static void serverTick(float dt)
+{
+	sServerCommands.resize(sServerClients.size());
+	for (size_t i = 0; i < sServerClients.size(); i++)
+	{
+		ServerClient& client = sServerClients[i];
+
+		sServerCommands[i].player	= client.player;
+		sServerCommands[i].buttons	= (uint8_t)((client.buttons & ~INPUT_FIRE) | client.triggered);
+		client.triggered			= 0;
+		client.inputApplied			= client.inputSequence;
+	}
+
+	GameStateAsteroidsTick(dt, sServerCommands.data(), (unsigned int)sServerCommands.size());
+}
+
+/******************************************************************************/
+/*!
+	Send the leaderboard delta to every session of the round that does not
+	hold the latest version, until it acknowledges it. Most sessions hold the
+	same version, a delta is written once per base and sent to all of them.
+	The deltas stay off the channel on purpose: a lost one is not sent
+	again, the next round sends the latest version from the base the
+	session acknowledged, where the channel would resend every version in
+	order, each cut into messages of NET_MESSAGE_PAYLOAD_MAX bytes.
+*/
+/******************************************************************************/
+static void serverLeaderboard()
+{
+	uint32_t version = ScoreboardPublish();
+
+	sServerDeltas.clear();
+	for (ServerClient& client : sServerClients)
+	{
+		if (!client.due || client.leaderboardAck == version)
+			continue;
+
+		PacketBuffer * pDelta = 0;
+		for (PacketBuffer * pPacket : sServerDeltas)
+		{
+			const uint8_t * pCursor = pPacket->data + NET_HEADER_SIZE;
+			if (NetGetU32(pCursor, pPacket->data + pPacket->size) == client.leaderboardAck)
+			{
+				pDelta = pPacket;
+				break;
+			}
+		}
+
+		if (pDelta == 0)
+		{
+			NetPutHeader(sServerPacket, NET_PACKET_LEADERBOARD);
+			ScoreboardWriteDelta(client.leaderboardAck, sServerPacket);
+			if (sServerPacket.size() > PACKET_BUFFER_SIZE)
+				continue;
+
+			pDelta = PacketAcquire();
+			memcpy(pDelta->data, sServerPacket.data(), sServerPacket.size());
+			pDelta->size = (uint32_t)sServerPacket.size();
+			sServerDeltas.push_back(pDelta);
+		}
+
+		TransportQueuePacket(spServerTransport, pDelta->data, NET_HEADER_SIZE, pDelta, NET_HEADER_SIZE,
+			pDelta->size - NET_HEADER_SIZE, client.address);
+	}
+
+	// the queue holds the deltas now
+	for (PacketBuffer * pPacket : sServerDeltas)
+		PacketRelease(pPacket);
+}
+
+/******************************************************************************/
+/*!
+	Queue the events of the tick on the channel of every session, they go
+	out with the next snapshot.
+*/
+/******************************************************************************/
+static void serverEvents()
+{
+	const std::vector<GameEvent>& events = GameStateAsteroidsEvents();
+	if (events.empty())
+		return;
+
+	uint64_t refused = 0;
+	for (const GameEvent& event : events)
+	{
+		uint8_t payload[NET_EVENT_SIZE];
+		for (unsigned int i = 0; i < 4; i++)
+		{
+			payload[i]		= (uint8_t)(event.id >> (24 - 8 * i));
+			payload[4 + i]	= (uint8_t)((uint32_t)event.value >> (24 - 8 * i));
+		}
+
+		for (ServerClient& client : sServerClients)
+			refused += NetChannelQueue(*client.pChannel, event.type, payload, sizeof(payload)) ? 0 : 1;
+	}
+	MetricsAdd(METRIC_MESSAGES_REFUSED, refused);
+}
+
+/******************************************************************************/
+/*!
+	The most asteroids of the slice of a part that fit in room bytes, pBody
+	is the packet that has them. A raw slice is cut, a coded one is coded
+	again from the estimate of its mean size down until it fits.
+*/
+/******************************************************************************/
+static size_t serverSliceFit(PacketBuffer * pSlice, unsigned int part, size_t count, size_t room, PacketBuffer *& pBody)
+{
+	pBody = pSlice;
+	if (pSlice->size <= room)
+		return count;
+	if (sServerCodec == SNAPSHOT_CODEC_RAW)
+		return room / DATA_SIZE;
+
+	for (size_t fit = (size_t)((uint64_t)room * count / pSlice->size); fit > 0; fit--)
+	{
+		PacketBuffer *& pTrimmed = sServerTrimmed[part * (count + 1) + fit];
+		if (pTrimmed == 0)
+		{
+			pTrimmed		= PacketAcquire();
+			pTrimmed->size	= (uint32_t)SnapshotEncode(sServerCodec, &sServerSlices[part * count], fit, pTrimmed->data,
+													   PACKET_BUFFER_SIZE);
+		}
+		if (pTrimmed->size != 0 && pTrimmed->size <= room)
+		{
+			pBody = pTrimmed;
+			return fit;
+		}
+	}
+	return 0;
+}
+
+/******************************************************************************/
+/*!
+	Send a snapshot to every session due in the round, or one per part. All
+	of them get the same slices of the asteroids, the next slices go in the
+	next round so the whole world is covered over a few snapshots. A session
+	whose link is slower than the round rate skips rounds, spread by player
+	so the rounds stay even, and one over its budget gets the front of the
+	slices.
+*/
+/******************************************************************************/
+static void serverSnapshot(uint32_t tick, float time)
+{
+	GameStateAsteroidsGetAsteroids(sServerAsteroids, time);
+
+	size_t count = sServerAsteroids.size() < NET_SNAPSHOT_ASTEROID_MAX ? sServerAsteroids.size() : NET_SNAPSHOT_ASTEROID_MAX;
+	if (sServerAsteroidCursor >= sServerAsteroids.size())
+		sServerAsteroidCursor = 0;
+
+	// the asteroids are the same for everybody, every slice is coded once in a packet of the pool
+	PacketBuffer *	pSlices[SERVER_SNAPSHOT_PARTS_MAX];
+	size_t			sliceSize	= 0;
+	sServerSlices.resize(sServerSnapshotParts * count);
+	sServerTrimmed.assign(sServerSnapshotParts * (count + 1), 0);
+	for (unsigned int p = 0; p < sServerSnapshotParts; p++)
+	{
+		for (size_t i = 0; i < count; i++)
+			sServerSlices[p * count + i] = sServerAsteroids[(sServerAsteroidCursor + i) % sServerAsteroids.size()];
+		sServerAsteroidCursor += count;
+
+		pSlices[p]			= PacketAcquire();
+		pSlices[p]->size	= (uint32_t)SnapshotEncode(sServerCodec, &sServerSlices[p * count], count, pSlices[p]->data,
+													   PACKET_BUFFER_SIZE);
+		sliceSize			= pSlices[p]->size > sliceSize ? pSlices[p]->size : sliceSize;
+	}
+
+	NetPutHeader(sServerPacket, NET_PACKET_SNAPSHOT);
+	NetPutU32(sServerPacket, 0);
+	NetPutU32(sServerPacket, tick);
+	NetPutU32(sServerPacket, 0);
+	NetPutU16(sServerPacket, (uint16_t)count);
+
+	uint32_t round = sServerRound++;
+	sServerPacketBytes = NET_SNAPSHOT_HEADER_SIZE + NET_SNAPSHOT_MESSAGE_BUDGET + sliceSize;
+	sServerPacketBytes = sServerPacketBytes < NET_PACKET_MAX ? sServerPacketBytes : NET_PACKET_MAX;
+	MetricsAdd(METRIC_SNAPSHOTS);
+
+	// every session gets a header of its own in front of the same asteroids, its parts back to back.
+	// The header ends with the reliable messages due, the first part takes them
+	uint64_t sent = 0, resent = 0;
+	for (ServerClient& client : sServerClients)
+	{
+		NetChannelSender&	channel		= *client.pChannel;
+		NetCongestion&		congestion	= *client.pCongestion;
+		if (sServerCongestion &&
+			NetCongestionUpdate(congestion, sServerNow, sServerSnapshotRate, sServerSnapshotParts, sServerPacketBytes))
+		{
+			LogWrite(LOG_INFO, "client.rate", { LogInt("player", client.player),
+				LogFloat("rate_hz", (double)sServerSnapshotRate / NET_CONGESTION_DIVISORS[congestion.level]),
+				LogInt("budget", (int64_t)congestion.budget), LogFloat("loss", congestion.loss),
+				LogFloat("rtt_ms", congestion.rttMs), LogFloat("bandwidth_kbps", congestion.bandwidth / 1024.0) });
+		}
+
+		unsigned int divisor = sServerCongestion ? NET_CONGESTION_DIVISORS[congestion.level] : 1;
+		client.due = (round + client.player) % divisor == 0;
+		if (!client.due)
+			continue;
+
+		double	resendAfter	= congestion.rttMs * 0.0015 > SERVER_RESEND_MIN ? congestion.rttMs * 0.0015 : SERVER_RESEND_MIN;
+		size_t	budget		= sServerCongestion ? congestion.budget : NET_PACKET_MAX;
+		uint64_t sentBefore		= channel.stats.sent;
+		uint64_t resentBefore	= channel.stats.resent;
+
+		NetSetU32(sServerPacket, NET_SNAPSHOT_ACK_AT, client.inputApplied);
+		for (unsigned int p = 0; p < sServerSnapshotParts; p++)
+		{
+			uint32_t sequence = client.snapshotSequence++;
+			NetSetU32(sServerPacket, NET_SNAPSHOT_SEQUENCE_AT, sequence);
+			sServerPacket.resize(NET_SNAPSHOT_HEADER_SIZE);
+			NetChannelWrite(channel, sequence, sServerNow, resendAfter, NET_SNAPSHOT_MESSAGE_BUDGET, sServerPacket);
+
+			// the asteroids that fit in the budget after the messages
+			PacketBuffer *	pBody;
+			size_t			room	= budget > sServerPacket.size() ? budget - sServerPacket.size() : 0;
+			size_t			body	= serverSliceFit(pSlices[p], p, count, room, pBody);
+			size_t			bytes	= pBody == pSlices[p] && body < count ? body * DATA_SIZE : pBody->size;
+			NetSetU16(sServerPacket, NET_SNAPSHOT_COUNT_AT, (uint16_t)body);
+			NetCongestionSent(congestion, sequence, sServerPacket.size() + bytes, sServerNow);
+			TransportQueuePacket(spServerTransport, sServerPacket.data(), sServerPacket.size(),
+				pBody, 0, bytes, client.address);
+		}
+		++client.snapshotRounds;
+
+		sent	+= channel.stats.sent - sentBefore;
+		resent	+= channel.stats.resent - resentBefore;
+	}
+	MetricsAdd(METRIC_MESSAGES_SENT, sent);
+	MetricsAdd(METRIC_MESSAGES_RESENT, resent);
+	for (unsigned int p = 0; p < sServerSnapshotParts; p++)
+		PacketRelease(pSlices[p]);
+	for (PacketBuffer * pTrimmed : sServerTrimmed)
+	{
+		if (pTrimmed)
+			PacketRelease(pTrimmed);
+	}
+
+	serverLeaderboard();
+	serverFlush();
+}
+
+/******************************************************************************/
+/*!
+	Close the loss period of every session and publish the per session table
+	to the metrics. The inputs are numbered one by one, the ones the sequence
+	skipped over were lost. The snapshot rate is the one achieved over the
+	period, not the one of the level.
+*/
+/******************************************************************************/
+static void serverPublishMetrics()
+{
+	double elapsed		= sServerNow - sServerMetricsAt;
+	double rateSum		= 0.0;
+	sServerMetricsAt	= sServerNow;
+
+	sServerMetrics.resize(sServerClients.size());
+	for (size_t i = 0; i < sServerClients.size(); i++)
+	{
+		ServerClient& client = sServerClients[i];
+
+		uint32_t expected = client.inputSequence - client.lossSequence;
+		if (expected > 0)
+			client.loss = client.lossReceived < expected ? 1.0f - (float)client.lossReceived / (float)expected : 0.0f;
+		client.lossSequence	= client.inputSequence;
+		client.lossReceived	= 0;
+
+		// the rounds it got, what the rate and the rounds it skipped left of the round rate
+		client.snapshotRate			= elapsed > 0.0 ? (float)((double)(client.snapshotRounds - client.snapshotRoundsSeen) / elapsed) : 0.0f;
+		client.snapshotRoundsSeen	= client.snapshotRounds;
+		rateSum						+= client.snapshotRate;
+
+		const NetCongestion& congestion = *client.pCongestion;
+		sServerMetrics[i].player		= client.player;
+		sServerMetrics[i].rttMs			= congestion.rttMs;
+		sServerMetrics[i].loss			= client.loss;
+		sServerMetrics[i].snapshotRate	= client.snapshotRate;
+		sServerMetrics[i].snapshotLoss	= congestion.loss;
+		sServerMetrics[i].bandwidth		= congestion.bandwidth;
+		sServerMetrics[i].budget		= (float)(sServerCongestion ? congestion.budget : NET_PACKET_MAX);
+	}
+
+	MetricsSetClients(sServerMetrics.data(), sServerMetrics.size());
+	MetricsSet(METRIC_CLIENTS, (double)sServerClients.size());
+	MetricsSet(METRIC_SNAPSHOT_RATE, sServerClients.empty() ? 0.0 : rateSum / (double)sServerClients.size());
+}
+
+/******************************************************************************/
+/*!
+	ServerRun() reads the options, sets a headless world up and serves it until
+	the time is up or the process is interrupted. The match never ends, the
+	players come and go and nobody could start a new one. With record= the
+	match is recorded from the init to the shutdown, populate and players
+	included, and replays with -replay.
+*/
+/******************************************************************************/
+int ServerRun(const char * args)
+{
+	unsigned long	port		= NET_DEFAULT_PORT;
+	unsigned long	asteroids	= 0;
+	double			seconds		= 0.0;
+	unsigned long	metricsPort	= 0;
+	unsigned long	shardCount	= 1;
+	bool			segmentation	= true;
+	NetSimConditions netIn		= {};
+	NetSimConditions netOut		= {};
+	bool			netInSet	= false;
+	bool			netOutSet	= false;
+	unsigned long	netSeed		= 1;
+	TRANSPORT_BACKEND backend	= TRANSPORT_BATCH;
+	std::string		logPath;
+	std::string		recordPath;
+
+	sServerClientMax	= SERVER_CLIENT_MAX;
+	sServerTickRate		= SERVER_TICK_RATE;
+	sServerSnapshotRate	= SERVER_SNAPSHOT_RATE;
+	sServerSnapshotParts	= 1;
+	sServerCongestion	= true;
+	sServerCodec		= SNAPSHOT_CODEC_RAW;
+
+	std::string key, value;
+	while (OptionNext(args, key, value))
+	{
+		bool valid = !value.empty();
+		if (key == "port")
+			valid = valid && (port = strtoul(value.c_str(), 0, 10)) > 0 && port < 65536;
+		else if (key == "tick")
+			valid = valid && (sServerTickRate = (unsigned int)strtoul(value.c_str(), 0, 10)) > 0;
+		else if (key == "snapshot")
+			valid = valid && (sServerSnapshotRate = (unsigned int)strtoul(value.c_str(), 0, 10)) > 0;
+		else if (key == "max")
+			valid = valid && (sServerClientMax = (unsigned int)strtoul(value.c_str(), 0, 10)) > 0;
+		else if (key == "asteroids")
+			asteroids = strtoul(value.c_str(), 0, 10);
+		else if (key == "seconds")
+			seconds = atof(value.c_str());
+		else if (key == "log")
+			logPath = value;
+		else if (key == "record")
+			recordPath = value;
+		else if (key == "io")
+			valid = TransportParseBackend(value.c_str(), backend);
+		else if (key == "metrics")
+			valid = valid && (metricsPort = strtoul(value.c_str(), 0, 10)) < 65536;
+		else if (key == "shards")
+			valid = valid && (shardCount = strtoul(value.c_str(), 0, 10)) > 0 && shardCount <= SERVER_SHARD_MAX;
+		else if (key == "parts")
+			valid = valid && (sServerSnapshotParts = (unsigned int)strtoul(value.c_str(), 0, 10)) > 0 &&
+					sServerSnapshotParts <= SERVER_SNAPSHOT_PARTS_MAX;
+		else if (key == "net")
+			valid = netInSet = netOutSet = NetSimParse(value.c_str(), netIn) && NetSimParse(value.c_str(), netOut);
+		else if (key == "netin")
+			valid = netInSet = NetSimParse(value.c_str(), netIn);
+		else if (key == "netout")
+			valid = netOutSet = NetSimParse(value.c_str(), netOut);
+		else if (key == "netseed")
+			netSeed = strtoul(value.c_str(), 0, 10);
+		else if (key == "gso")
+		{
+			valid			= value == "on" || value == "off";
+			segmentation	= value == "on";
+		}
+		else if (key == "cc")
+		{
+			valid				= value == "on" || value == "off";
+			sServerCongestion	= value == "on";
+		}
+		else if (key == "codec")
+			valid = SnapshotCodecParse(value.c_str(), sServerCodec);
+		else
+			valid = false;
+
+		if (!valid)
+		{
+			fprintf(stderr, "server: bad option \"%s=%s\"\n", key.c_str(), value.c_str());
+			return 1;
+		}
+	}
+	sServerSnapshotRate = sServerSnapshotRate < sServerTickRate ? sServerSnapshotRate : sServerTickRate;
+
+	if (!SocketStartup())
+	{
+		fprintf(stderr, "server: cannot start the sockets\n");
+		return 1;
+	}
+
+	spServerTransport = TransportOpen(backend, (uint16_t)port, shardCount > 1);
+	if (spServerTransport == 0)
+	{
+		fprintf(stderr, "server: cannot bind UDP port %lu\n", port);
+		SocketCleanup();
+		return 1;
+	}
+
+	// only this socket sends, the shards receive
+	segmentation = TransportSetSegmentation(spServerTransport, segmentation);
+	if (netInSet || netOutSet)
+		TransportSetConditions(spServerTransport, netInSet ? &netIn : 0, netOutSet ? &netOut : 0, (uint32_t)netSeed);
+
+	// every socket of the group is bound before a packet comes, the hash of a sender never changes
+	sServerShardQuit.store(false);
+	for (unsigned long s = 1; s < shardCount; s++)
+	{
+		std::unique_ptr<ServerShard> pShard(new ServerShard());
+		pShard->pTransport = TransportOpen(backend, (uint16_t)port, true);
+		if (pShard->pTransport == 0)
+		{
+			fprintf(stderr, "server: cannot open socket %lu of UDP port %lu with SO_REUSEPORT\n", s, port);
+			serverStopShards();
+			TransportClose(spServerTransport);
+			spServerTransport = 0;
+			SocketCleanup();
+			return 1;
+		}
+		if (netInSet)
+			TransportSetConditions(pShard->pTransport, &netIn, 0, (uint32_t)(netSeed + 2 * s));
+		sServerShards.push_back(std::move(pShard));
+	}
+
+	// from here the loop only queues log records, the log thread writes them
+	if (!LogStart(logPath.empty() ? 0 : logPath.c_str()))
+	{
+		fprintf(stderr, "server: cannot open the log \"%s\", logging to the console\n", logPath.c_str());
+		LogStart();
+	}
+
+	if (metricsPort && !MetricsServe((uint16_t)metricsPort))
+		fprintf(stderr, "server: cannot serve the metrics on port %lu\n", metricsPort);
+
+	GameStateAsteroidsSetViewEnabled(false);
+	GameStateAsteroidsSetEndless(true);
+	GameStateAsteroidsSetRecordPath(recordPath.c_str());
+	GameStateAsteroidsLoad();
+	GameStateAsteroidsInit();
+	GameStateAsteroidsPopulate(asteroids, 0);
+
+	sServerNextPlayer		= 1;	// 0 is the keyboard player
+	sServerAsteroidCursor	= 0;
+	sServerRound			= 0;
+	sServerMetricsAt		= 0.0;
+	sServerNow				= 0.0;
+	sServerPacketBytes		= NET_PACKET_MAX;
+	sServerPacketsIn = sServerPacketsOut = sServerBytesOut = sServerRecvCalls = sServerSendCalls = sServerSegmented = 0;
+	sServerTransportSeen	= TransportStats();
+
+	LogWrite(LOG_INFO, "server.start", { LogInt("port", (int64_t)port), LogInt("tick_rate", sServerTickRate),
+		LogInt("snapshot_rate", sServerSnapshotRate), LogInt("max", sServerClientMax), LogInt("asteroids", (int64_t)asteroids),
+		LogText("io", TransportBackendName(TransportBackend(spServerTransport))) });
+	if (sServerSnapshotParts > 1 || !segmentation)
+		LogWrite(LOG_INFO, "server.parts", { LogInt("parts", sServerSnapshotParts), LogText("gso", segmentation ? "on" : "off") });
+	if (!sServerCongestion)
+		LogWrite(LOG_INFO, "server.cc", { LogText("cc", "off"), LogInt("snapshot_rate", sServerSnapshotRate) });
+	if (sServerCodec != SNAPSHOT_CODEC_RAW)
+		LogWrite(LOG_INFO, "server.codec", { LogText("codec", SnapshotCodecName(sServerCodec)) });
+	if (netInSet)
+		serverLogConditions("in", netIn);
+	if (netOutSet)
+		serverLogConditions("out", netOut);
+	if (shardCount > 1)
+		LogWrite(LOG_INFO, "server.shards", { LogInt("sockets", (int64_t)shardCount), LogInt("io_threads", (int64_t)shardCount - 1) });
+
+	const float		dt				= 1.0f / (float)sServerTickRate;
+	const uint32_t	ticksPerSnap	= sServerTickRate / sServerSnapshotRate;
+	uint32_t		tick			= 0;
+	double			tickTime		= 0.0;		// time spent in the ticks since the last print
+	unsigned long	tickCount		= 0;		// ticks since the last print
+	double			nextStats		= SERVER_STATS_PERIOD;
+	double			nextMetrics		= SERVER_METRICS_PERIOD;
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (const std::unique_ptr<ServerShard>& pShard : sServerShards)
+		pShard->thread = std::thread(serverShardMain, pShard.get(), start);
+
+	sServerStop = 0;
+	void (*pPreviousInt)(int)	= std::signal(SIGINT, serverOnSignal);
+	void (*pPreviousTerm)(int)	= std::signal(SIGTERM, serverOnSignal);
+
+	for (;;)
+	{
+		double now = serverSeconds(start);
+		if ((seconds > 0.0 && now >= seconds) || sServerStop)
+			break;
+
+		// sleep until the next tick unless a packet comes first
+		double nextTick = (double)tick * dt;
+		int timeoutMs = nextTick > now ? (int)((nextTick - now) * 1000.0) : 0;
+		bool readable = TransportWait(spServerTransport, timeoutMs);
+
+		now = serverSeconds(start);
+		sServerNow = now;
+		while (readable)
+		{
+			const TransportDatagram * pDatagrams = 0;
+			unsigned int count = TransportReceive(spServerTransport, pDatagrams);
+			if (count == 0)
+				break;
+			for (unsigned int i = 0; i < count; i++)
+			{
+				ServerCommand command;
+				if (serverDecode(pDatagrams[i].pData, pDatagrams[i].size, pDatagrams[i].from, now, command))
+					serverApply(command);
+			}
+
+			// a short batch emptied the socket, no need for a call that finds nothing
+			if (count < TRANSPORT_RECV_BATCH)
+				break;
+		}
+		serverDrainShards();
+
+		// catch up with the ticks that are due, a server too slow for its tick rate falls behind for good
+		unsigned int catchUp = 0;
+		while ((double)tick * dt <= serverSeconds(start) && catchUp++ < SERVER_CATCH_UP_MAX)
+		{
+			std::chrono::steady_clock::time_point tickStart = std::chrono::steady_clock::now();
+			serverTick(dt);
+			serverEvents();
+			double tickSeconds = serverSeconds(tickStart);
+			tickTime += tickSeconds;
+			MetricsObserveTick(tickSeconds);
+			++tickCount;
+			++tick;
+
+			if (tick % ticksPerSnap == 0)
+			{
+				sServerNow = serverSeconds(start);
+				serverSnapshot(tick, (float)tick * dt);
+			}
+		}
+
+		// drop the sessions that went silent
+		for (size_t i = sServerClients.size(); i-- > 0;)
+		{
+			if (now - sServerClients[i].lastHeard > SERVER_CLIENT_TIMEOUT)
+				serverDropClient(i, "timeout");
+		}
+
+		// the answers to the handshakes, the snapshot rounds flushed on their own
+		serverFlush();
+
+		if (now >= nextMetrics)
+		{
+			serverPublishMetrics();
+			nextMetrics += SERVER_METRICS_PERIOD;
+		}
+
+		if (now >= nextStats)
+		{
+			LogWrite(LOG_INFO, "server.stats", { LogInt("clients", (int64_t)sServerClients.size()),
+				LogFloat("tick_ms", tickCount ? tickTime * 1000.0 / (double)tickCount : 0.0),
+				LogFloat("in_pps", sServerPacketsIn / SERVER_STATS_PERIOD), LogFloat("out_pps", sServerPacketsOut / SERVER_STATS_PERIOD),
+				LogFloat("out_kbps", sServerBytesOut / SERVER_STATS_PERIOD / 1024.0), LogInt("log_dropped", (int64_t)LogDropped()) });
+			LogWrite(LOG_INFO, "server.io", { LogText("backend", TransportBackendName(TransportBackend(spServerTransport))),
+				LogFloat("in_per_call", (double)sServerPacketsIn / (double)(sServerRecvCalls ? sServerRecvCalls : 1)),
+				LogFloat("out_per_call", (double)sServerPacketsOut / (double)(sServerSendCalls ? sServerSendCalls : 1)),
+				LogInt("send_dropped", (int64_t)TransportGetStats(spServerTransport).sendDropped),
+				LogFloat("segmented", (double)sServerSegmented / (double)(sServerPacketsOut ? sServerPacketsOut : 1)) });
+
+			sServerPacketsIn = sServerPacketsOut = sServerBytesOut = sServerRecvCalls = sServerSendCalls = sServerSegmented = 0;
+			tickTime	= 0.0;
+			tickCount	= 0;
+			nextStats	+= SERVER_STATS_PERIOD;
+		}
+	}
+
+	serverStopShards();
+	if (netInSet || netOutSet)
+	{
+		NetSimStats in, out;
+		TransportGetConditionStats(spServerTransport, in, out);
+		if (netInSet)
+			serverLogConditionStats("in", in);
+		if (netOutSet)
+			serverLogConditionStats("out", out);
+	}
+	PacketPoolStats pool = PacketPoolGetStats();
+	LogWrite(LOG_INFO, "server.pool", { LogInt("slabs", (int64_t)pool.slabs), LogInt("buffers", (int64_t)pool.buffers),
+		LogInt("acquired", (int64_t)pool.acquired), LogInt("in_use", (int64_t)pool.inUse) });
+	while (!sServerClients.empty())
+		serverDropClient(sServerClients.size() - 1, "shutdown");
+	serverPublishMetrics();
+	MetricsStop();
+
+	// closes the recording, the leaves of the players above are its last events
+	GameStateAsteroidsFree();
+	GameStateAsteroidsUnload();
+	GameStateAsteroidsSetEndless(false);
+	GameStateAsteroidsSetRecordPath(nullptr);
+	std::signal(SIGINT, pPreviousInt);
+	std::signal(SIGTERM, pPreviousTerm);
+
+	TransportClose(spServerTransport);
+	spServerTransport = 0;
+	SocketCleanup();
+	LogStop();
+
+	std::vector<ServerClient>().swap(sServerClients);
+	std::unordered_map<uint64_t, size_t>().swap(sServerClientIndex);
+	std::vector<uint8_t>().swap(sServerPacket);
+	std::vector<InputCommand>().swap(sServerCommands);
+	std::vector<AsteroidData>().swap(sServerAsteroids);
+	std::vector<PacketBuffer *>().swap(sServerDeltas);
+	std::vector<MetricsClient>().swap(sServerMetrics);
+	return 0;
+}
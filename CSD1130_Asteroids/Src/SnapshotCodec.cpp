@@ -0,0 +1,573 @@
+/******************************************************************************/
+/*!
+\file		SnapshotCodec.cpp
+\brief		This file contains the definition of the codecs of the asteroids of
+			a snapshot.
+
+			The range coder keeps 32 bits of range and carries into the bytes
+			already written through a cached byte, as the one of LZMA. Its
+			first byte is always 0 and is not written. The end rounds the low
+			bound up to the most zero bits the range allows and drops the
+			zero bytes at the end, the decoder reads zeros past the data.
+ */
+/******************************************************************************/
+
+#include "SnapshotCodec.h"
+
+#include <math.h>
+#include <string.h>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// ---------------------------------------------------------------------------
+
+// frequencies of the buckets of one field and their sum
+struct SnapshotModel
+{
+	uint32_t			freq[SNAPSHOT_BUCKET_NUM];
+	uint32_t			total;
+	bool				adapt;				// each symbol coded raises its frequency
+};
+
+struct SnapshotEncoder
+{
+	uint64_t			low;
+	uint32_t			range;
+	uint8_t				cache;				// last byte not written, a carry may still change it
+	uint64_t			cacheSize;			// the cached byte and the 0xFF bytes behind it
+	bool				first;				// the first byte, always 0, is skipped
+	uint8_t *			pOut;
+	size_t				size;
+	size_t				capacity;
+};
+
+struct SnapshotDecoder
+{
+	uint32_t			range;
+	uint32_t			code;
+	uint32_t			step;				// range / total of the symbol being decoded
+	const uint8_t *		pCursor;
+	const uint8_t *		pEnd;
+};
+
+// what the fields of an asteroid are the difference with
+struct SnapshotPrevious
+{
+	uint32_t			owner;
+	uint32_t			id;
+	uint32_t			angle;
+	uint32_t			score;
+	uint32_t			time;				// bits of the float
+};
+
+// ---------------------------------------------------------------------------
+// settings
+
+static const uint32_t	SNAPSHOT_RANGE_TOP		= 1u << 24;		// the range is kept above, one byte out when below
+static const uint32_t	SNAPSHOT_ADAPT_STEP		= 32;			// frequency added to a symbol coded by an adaptive model
+static const uint32_t	SNAPSHOT_ADAPT_LIMIT	= 1u << 16;		// total that halves the frequencies of an adaptive model
+static const size_t		SNAPSHOT_OVERRUN_MAX	= 6;			// bytes a decoder reads past the data: the zeros the flush dropped and the cache
+
+// bucket frequencies of SNAPSHOT_CODEC_STATIC, from "asteroids_bench codec seed=1130 train=on", the default seed measures it out of sample
+static const uint16_t	sSnapshotStaticFreq[SNAPSHOT_FIELD_NUM][SNAPSHOT_BUCKET_NUM] =
+{
+	{ 4096,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1 },	// owner
+	{ 952,1,103,55,13,8,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,604,956,908,431,57,1,1,1,1,1,1,1 },	// id
+	{ 1,1,1,1,1,2,3,8,16,28,60,127,322,1032,2491,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1 },	// position x
+	{ 1,1,1,1,2,4,8,20,37,77,161,342,811,1801,825,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1 },	// position y
+	{ 1,1,1,1,1,1,1,1,504,1310,2281,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1 },	// scale x
+	{ 1,1,1,1,1,1,1,1,527,1314,2254,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1 },	// scale y
+	{ 1,1,1,1,1,1,1,1,1,517,1161,1852,564,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1 },	// velocity x
+	{ 1,1,1,1,1,1,1,1,1,472,1138,1897,587,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1 },	// velocity y
+	{ 4096,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1 },	// direction
+	{ 3909,1,1,1,1,1,1,1,1,1,1,1,1,1,1,3,5,8,14,23,33,68,23,1,1,1,1,1,1,1,1,1,1 },	// score
+	{ 3909,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,6,179 },	// time
+};
+
+static const char * const	sSnapshotCodecNames[SNAPSHOT_CODEC_NUM] = { "raw", "quantized", "adaptive", "static" };
+
+/******************************************************************************/
+/*!
+	Bits of v up to its top one, 0 for 0.
+*/
+/******************************************************************************/
+static unsigned int snapshotBitLength(uint32_t v)
+{
+	if (v == 0)
+		return 0;
+#ifdef _MSC_VER
+	unsigned long top;
+	_BitScanReverse(&top, v);
+	return (unsigned int)top + 1;
+#else
+	return 32 - (unsigned int)__builtin_clz(v);
+#endif
+}
+
+/******************************************************************************/
+/*!
+	Signed to unsigned with the small magnitudes first: 0, -1, 1, -2, ...
+*/
+/******************************************************************************/
+static uint32_t snapshotZigzag(int32_t v)
+{
+	return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+
+static int32_t snapshotUnzigzag(uint32_t v)
+{
+	return (int32_t)(v >> 1) ^ -(int32_t)(v & 1);
+}
+
+/******************************************************************************/
+/*!
+	A float in SNAPSHOT_QUANTUM units, clamped to what 31 bits hold.
+*/
+/******************************************************************************/
+static int32_t snapshotQuantize(float value)
+{
+	float q = value / SNAPSHOT_QUANTUM;
+	q = q > 1.0e9f ? 1.0e9f : q < -1.0e9f ? -1.0e9f : q;
+	return (int32_t)lrintf(q);
+}
+
+/******************************************************************************/
+/*!
+	The model of a field for the codec, rebuilt for every slice.
+*/
+/******************************************************************************/
+static void snapshotModelInit(SnapshotModel& model, SNAPSHOT_CODEC codec, unsigned int field)
+{
+	model.total	= 0;
+	model.adapt	= codec == SNAPSHOT_CODEC_ADAPTIVE;
+	for (unsigned int s = 0; s < SNAPSHOT_BUCKET_NUM; s++)
+	{
+		model.freq[s]	= codec == SNAPSHOT_CODEC_STATIC ? sSnapshotStaticFreq[field][s] : 1;
+		model.total		+= model.freq[s];
+	}
+}
+
+/******************************************************************************/
+/*!
+	Count a symbol coded by an adaptive model.
+*/
+/******************************************************************************/
+static void snapshotModelUpdate(SnapshotModel& model, unsigned int symbol)
+{
+	if (!model.adapt)
+		return;
+
+	model.freq[symbol]	+= SNAPSHOT_ADAPT_STEP;
+	model.total			+= SNAPSHOT_ADAPT_STEP;
+	if (model.total > SNAPSHOT_ADAPT_LIMIT)
+	{
+		model.total = 0;
+		for (unsigned int s = 0; s < SNAPSHOT_BUCKET_NUM; s++)
+		{
+			model.freq[s]	= (model.freq[s] + 1) / 2;
+			model.total		+= model.freq[s];
+		}
+	}
+}
+
+/******************************************************************************/
+/*!
+	Write a byte, or only count it past the capacity.
+*/
+/******************************************************************************/
+static void snapshotPutByte(SnapshotEncoder& encoder, uint8_t byte)
+{
+	if (encoder.first)
+	{
+		encoder.first = false;
+		return;
+	}
+	if (encoder.size < encoder.capacity)
+		encoder.pOut[encoder.size] = byte;
+	++encoder.size;
+}
+
+/******************************************************************************/
+/*!
+	Move the top byte of low out, through the cache while a carry may still
+	reach it.
+*/
+/******************************************************************************/
+static void snapshotShiftLow(SnapshotEncoder& encoder)
+{
+	if ((uint32_t)encoder.low < 0xFF000000u || (encoder.low >> 32) != 0)
+	{
+		uint8_t carry	= (uint8_t)(encoder.low >> 32);
+		uint8_t byte	= encoder.cache;
+		do
+		{
+			snapshotPutByte(encoder, (uint8_t)(byte + carry));
+			byte = 0xFF;
+		} while (--encoder.cacheSize != 0);
+		encoder.cache = (uint8_t)(encoder.low >> 24);
+	}
+	++encoder.cacheSize;
+	encoder.low = (encoder.low & 0x00FFFFFFu) << 8;
+}
+
+/******************************************************************************/
+/*!
+	Narrow the range to [cum, cum + freq) of total.
+*/
+/******************************************************************************/
+static void snapshotEncodeRange(SnapshotEncoder& encoder, uint32_t cum, uint32_t freq, uint32_t total)
+{
+	uint32_t step = encoder.range / total;
+	encoder.low		+= (uint64_t)step * cum;
+	encoder.range	= step * freq;
+	while (encoder.range < SNAPSHOT_RANGE_TOP)
+	{
+		encoder.range <<= 8;
+		snapshotShiftLow(encoder);
+	}
+}
+
+/******************************************************************************/
+/*!
+	Bits as they are, at most 16: the total is a power of 2, the range is
+	shifted instead of divided.
+*/
+/******************************************************************************/
+static void snapshotEncodeBits(SnapshotEncoder& encoder, uint32_t bits, unsigned int count)
+{
+	encoder.range	>>= count;
+	encoder.low		+= (uint64_t)encoder.range * bits;
+	while (encoder.range < SNAPSHOT_RANGE_TOP)
+	{
+		encoder.range <<= 8;
+		snapshotShiftLow(encoder);
+	}
+}
+
+/******************************************************************************/
+/*!
+	A value: its bucket with the model, then the bits below its top one, 16
+	at a time.
+*/
+/******************************************************************************/
+static void snapshotEncodeValue(SnapshotEncoder& encoder, SnapshotModel& model, uint32_t value)
+{
+	unsigned int bucket = snapshotBitLength(value);
+
+	uint32_t cum = 0;
+	for (unsigned int s = 0; s < bucket; s++)
+		cum += model.freq[s];
+	snapshotEncodeRange(encoder, cum, model.freq[bucket], model.total);
+	snapshotModelUpdate(model, bucket);
+
+	for (int bits = (int)bucket - 1; bits > 0; bits -= 16)
+	{
+		unsigned int chunk = bits < 16 ? (unsigned int)bits : 16;
+		snapshotEncodeBits(encoder, (value >> (bits - chunk)) & ((1u << chunk) - 1), chunk);
+	}
+}
+
+/******************************************************************************/
+/*!
+	Pick the value of the range with the most zero bits below, write it out
+	and drop the zero bytes at the end.
+*/
+/******************************************************************************/
+static void snapshotEncodeFlush(SnapshotEncoder& encoder)
+{
+	for (unsigned int bits = 32; bits > 0; bits--)
+	{
+		uint64_t mask	= ((uint64_t)1 << bits) - 1;
+		uint64_t value	= (encoder.low + mask) & ~mask;
+		if (value < encoder.low + encoder.range)
+		{
+			encoder.low = value;
+			break;
+		}
+	}
+
+	size_t written = encoder.size;
+	for (int i = 0; i < 5; i++)
+		snapshotShiftLow(encoder);
+	while (encoder.size > written && encoder.size <= encoder.capacity && encoder.pOut[encoder.size - 1] == 0)
+		--encoder.size;
+}
+
+/******************************************************************************/
+/*!
+	Next byte of the data, 0 past its end.
+*/
+/******************************************************************************/
+static uint8_t snapshotGetByte(SnapshotDecoder& decoder)
+{
+	uint8_t byte = decoder.pCursor < decoder.pEnd ? *decoder.pCursor : 0;
+	++decoder.pCursor;
+	return byte;
+}
+
+/******************************************************************************/
+/*!
+	Where the code falls in [0, total), the symbol is looked up from it.
+*/
+/******************************************************************************/
+static uint32_t snapshotDecodeTarget(SnapshotDecoder& decoder, uint32_t total)
+{
+	decoder.step = decoder.range / total;
+	uint32_t target = decoder.code / decoder.step;
+	return target < total ? target : total - 1;
+}
+
+/******************************************************************************/
+/*!
+	Take the symbol [cum, cum + freq) of the target out of the code.
+*/
+/******************************************************************************/
+static void snapshotDecodeRange(SnapshotDecoder& decoder, uint32_t cum, uint32_t freq)
+{
+	decoder.code	-= decoder.step * cum;
+	decoder.range	= decoder.step * freq;
+	while (decoder.range < SNAPSHOT_RANGE_TOP)
+	{
+		decoder.code	= (decoder.code << 8) | snapshotGetByte(decoder);
+		decoder.range	<<= 8;
+	}
+}
+
+/******************************************************************************/
+/*!
+	The inverse of snapshotEncodeBits().
+*/
+/******************************************************************************/
+static uint32_t snapshotDecodeBits(SnapshotDecoder& decoder, unsigned int count)
+{
+	decoder.range >>= count;
+	uint32_t bits = decoder.code / decoder.range;
+	bits = bits < (1u << count) ? bits : (1u << count) - 1;
+	decoder.code -= decoder.range * bits;
+	while (decoder.range < SNAPSHOT_RANGE_TOP)
+	{
+		decoder.code	= (decoder.code << 8) | snapshotGetByte(decoder);
+		decoder.range	<<= 8;
+	}
+	return bits;
+}
+
+/******************************************************************************/
+/*!
+	The inverse of snapshotEncodeValue().
+*/
+/******************************************************************************/
+static uint32_t snapshotDecodeValue(SnapshotDecoder& decoder, SnapshotModel& model)
+{
+	uint32_t		target	= snapshotDecodeTarget(decoder, model.total);
+	uint32_t		cum		= 0;
+	unsigned int	bucket	= 0;
+	while (bucket + 1 < SNAPSHOT_BUCKET_NUM && cum + model.freq[bucket] <= target)
+		cum += model.freq[bucket++];
+	snapshotDecodeRange(decoder, cum, model.freq[bucket]);
+	snapshotModelUpdate(model, bucket);
+
+	if (bucket == 0)
+		return 0;
+
+	uint32_t value = 1;
+	for (int bits = (int)bucket - 1; bits > 0; bits -= 16)
+	{
+		unsigned int chunk = bits < 16 ? (unsigned int)bits : 16;
+		value = (value << chunk) | snapshotDecodeBits(decoder, chunk);
+	}
+	return value;
+}
+
+/******************************************************************************/
+/*!
+	The field values of an asteroid, the differences taken from previous,
+	which then moves to the asteroid.
+*/
+/******************************************************************************/
+static void snapshotValues(const AsteroidData& data, SnapshotPrevious& previous, uint32_t values[SNAPSHOT_FIELD_NUM])
+{
+	const float turn = 6.28318530718f;
+
+	uint32_t angle	= (uint32_t)lrintf(atan2f(data.direction.y, data.direction.x) / turn * (float)SNAPSHOT_ANGLE_STEPS) &
+					  (SNAPSHOT_ANGLE_STEPS - 1);
+	uint32_t turned	= (angle - previous.angle) & (SNAPSHOT_ANGLE_STEPS - 1);
+	uint32_t time;
+	memcpy(&time, &data.time, sizeof(time));
+
+	values[SNAPSHOT_FIELD_OWNER]		= snapshotZigzag((int32_t)(data.owner - previous.owner));
+	values[SNAPSHOT_FIELD_ID]			= snapshotZigzag((int32_t)(data.id - previous.id - 1));
+	values[SNAPSHOT_FIELD_POSITION_X]	= snapshotZigzag(snapshotQuantize(data.position.x));
+	values[SNAPSHOT_FIELD_POSITION_Y]	= snapshotZigzag(snapshotQuantize(data.position.y));
+	values[SNAPSHOT_FIELD_SCALE_X]		= snapshotZigzag(snapshotQuantize(data.scale.x));
+	values[SNAPSHOT_FIELD_SCALE_Y]		= snapshotZigzag(snapshotQuantize(data.scale.y));
+	values[SNAPSHOT_FIELD_VELOCITY_X]	= snapshotZigzag(snapshotQuantize(data.velocity.x));
+	values[SNAPSHOT_FIELD_VELOCITY_Y]	= snapshotZigzag(snapshotQuantize(data.velocity.y));
+	values[SNAPSHOT_FIELD_DIRECTION]	= snapshotZigzag(turned >= SNAPSHOT_ANGLE_STEPS / 2 ?
+										  (int32_t)turned - (int32_t)SNAPSHOT_ANGLE_STEPS : (int32_t)turned);
+	values[SNAPSHOT_FIELD_SCORE]		= snapshotZigzag((int32_t)((uint32_t)data.scoreCount - previous.score));
+	values[SNAPSHOT_FIELD_TIME]			= snapshotZigzag((int32_t)(time - previous.time));
+
+	previous.owner	= data.owner;
+	previous.id		= data.id;
+	previous.angle	= angle;
+	previous.score	= (uint32_t)data.scoreCount;
+	previous.time	= time;
+}
+
+/******************************************************************************/
+/*!
+	The inverse of snapshotValues().
+*/
+/******************************************************************************/
+static void snapshotAsteroid(const uint32_t values[SNAPSHOT_FIELD_NUM], SnapshotPrevious& previous, AsteroidData& data)
+{
+	const float turn = 6.28318530718f;
+
+	previous.owner	+= (uint32_t)snapshotUnzigzag(values[SNAPSHOT_FIELD_OWNER]);
+	previous.id		+= (uint32_t)snapshotUnzigzag(values[SNAPSHOT_FIELD_ID]) + 1;
+	previous.angle	= (previous.angle + (uint32_t)snapshotUnzigzag(values[SNAPSHOT_FIELD_DIRECTION])) & (SNAPSHOT_ANGLE_STEPS - 1);
+	previous.score	+= (uint32_t)snapshotUnzigzag(values[SNAPSHOT_FIELD_SCORE]);
+	previous.time	+= (uint32_t)snapshotUnzigzag(values[SNAPSHOT_FIELD_TIME]);
+
+	float angle = (float)previous.angle * turn / (float)SNAPSHOT_ANGLE_STEPS;
+	data.owner			= (uint8_t)previous.owner;
+	data.id				= previous.id;
+	data.position.x		= (float)snapshotUnzigzag(values[SNAPSHOT_FIELD_POSITION_X]) * SNAPSHOT_QUANTUM;
+	data.position.y		= (float)snapshotUnzigzag(values[SNAPSHOT_FIELD_POSITION_Y]) * SNAPSHOT_QUANTUM;
+	data.scale.x		= (float)snapshotUnzigzag(values[SNAPSHOT_FIELD_SCALE_X]) * SNAPSHOT_QUANTUM;
+	data.scale.y		= (float)snapshotUnzigzag(values[SNAPSHOT_FIELD_SCALE_Y]) * SNAPSHOT_QUANTUM;
+	data.velocity.x		= (float)snapshotUnzigzag(values[SNAPSHOT_FIELD_VELOCITY_X]) * SNAPSHOT_QUANTUM;
+	data.velocity.y		= (float)snapshotUnzigzag(values[SNAPSHOT_FIELD_VELOCITY_Y]) * SNAPSHOT_QUANTUM;
+	data.direction.x	= cosf(angle);
+	data.direction.y	= sinf(angle);
+	data.scoreCount		= (int)previous.score;
+	memcpy(&data.time, &previous.time, sizeof(data.time));
+}
+
+/******************************************************************************/
+/*!
+	SnapshotEncode() runs every value of every asteroid through the coder,
+	field after field.
+*/
+/******************************************************************************/
+size_t SnapshotEncode(SNAPSHOT_CODEC codec, const AsteroidData * pAsteroids, size_t count, uint8_t * pOut,
+					  size_t capacity)
+{
+	if (codec == SNAPSHOT_CODEC_RAW)
+	{
+		if (count * DATA_SIZE > capacity)
+			return 0;
+		for (size_t i = 0; i < count; i++)
+		{
+			AsteroidData data = pAsteroids[i];
+			WriteNetworkData(&data, (char *)pOut + i * DATA_SIZE);
+		}
+		return count * DATA_SIZE;
+	}
+
+	SnapshotModel models[SNAPSHOT_FIELD_NUM];
+	for (unsigned int f = 0; f < SNAPSHOT_FIELD_NUM; f++)
+		snapshotModelInit(models[f], codec, f);
+
+	SnapshotEncoder encoder = { 0, 0xFFFFFFFFu, 0, 1, true, pOut, 0, capacity };
+	SnapshotPrevious previous = {};
+	for (size_t i = 0; i < count; i++)
+	{
+		uint32_t values[SNAPSHOT_FIELD_NUM];
+		snapshotValues(pAsteroids[i], previous, values);
+		for (unsigned int f = 0; f < SNAPSHOT_FIELD_NUM; f++)
+			snapshotEncodeValue(encoder, models[f], values[f]);
+	}
+	snapshotEncodeFlush(encoder);
+
+	return encoder.size <= capacity ? encoder.size : 0;
+}
+
+/******************************************************************************/
+/*!
+	SnapshotDecode() builds the models of the encoder and reads the values
+	back.
+*/
+/******************************************************************************/
+bool SnapshotDecode(SNAPSHOT_CODEC codec, const uint8_t * pData, size_t size, size_t count, AsteroidData * pAsteroids)
+{
+	if (codec == SNAPSHOT_CODEC_RAW)
+	{
+		if (size != count * DATA_SIZE)
+			return false;
+		for (size_t i = 0; i < count; i++)
+			pAsteroids[i] = FromNetworkData((char *)pData + i * DATA_SIZE);
+		return true;
+	}
+	if (codec >= SNAPSHOT_CODEC_NUM)
+		return false;
+
+	SnapshotModel models[SNAPSHOT_FIELD_NUM];
+	for (unsigned int f = 0; f < SNAPSHOT_FIELD_NUM; f++)
+		snapshotModelInit(models[f], codec, f);
+
+	SnapshotDecoder decoder = { 0xFFFFFFFFu, 0, 0, pData, pData + size };
+	for (int i = 0; i < 4; i++)
+		decoder.code = (decoder.code << 8) | snapshotGetByte(decoder);
+
+	SnapshotPrevious previous = {};
+	for (size_t i = 0; i < count; i++)
+	{
+		uint32_t values[SNAPSHOT_FIELD_NUM];
+		for (unsigned int f = 0; f < SNAPSHOT_FIELD_NUM; f++)
+			values[f] = snapshotDecodeValue(decoder, models[f]);
+		snapshotAsteroid(values, previous, pAsteroids[i]);
+
+		if (decoder.pCursor > decoder.pEnd + SNAPSHOT_OVERRUN_MAX)
+			return false;
+	}
+	return true;
+}
+
+/******************************************************************************/
+/*!
+	SnapshotCount() takes the values the coders would write.
+*/
+/******************************************************************************/
+void SnapshotCount(const AsteroidData * pAsteroids, size_t count, uint64_t counts[SNAPSHOT_FIELD_NUM][SNAPSHOT_BUCKET_NUM])
+{
+	SnapshotPrevious previous = {};
+	for (size_t i = 0; i < count; i++)
+	{
+		uint32_t values[SNAPSHOT_FIELD_NUM];
+		snapshotValues(pAsteroids[i], previous, values);
+		for (unsigned int f = 0; f < SNAPSHOT_FIELD_NUM; f++)
+			++counts[f][snapshotBitLength(values[f])];
+	}
+}
+
+/******************************************************************************/
+/*!
+	SnapshotCodecParse() looks the name up.
+*/
+/******************************************************************************/
+bool SnapshotCodecParse(const char * name, SNAPSHOT_CODEC& codec)
+{
+	for (unsigned int c = 0; c < SNAPSHOT_CODEC_NUM; c++)
+	{
+		if (strcmp(name, sSnapshotCodecNames[c]) == 0)
+		{
+			codec = (SNAPSHOT_CODEC)c;
+			return true;
+		}
+	}
+	return false;
+}
+
+/******************************************************************************/
+/*!
+	SnapshotCodecName() is the name SnapshotCodecParse() reads.
+*/
+/******************************************************************************/
+const char * SnapshotCodecName(SNAPSHOT_CODEC codec)
+{
+	return codec < SNAPSHOT_CODEC_NUM ? sSnapshotCodecNames[codec] : "unknown";
+}
@@ -0,0 +1,406 @@
+/******************************************************************************/
+/*!
+\file		Socket.cpp
+\brief		This file contains the definition of the UDP and TCP sockets, on
+			WinSock under Windows and on BSD sockets elsewhere.
+ */
+/******************************************************************************/
+
+#include "Socket.h"
+
+#include <vector>
+
+#ifdef _WIN32
+#include <WinSock2.h>
+#include <WS2tcpip.h>
+#pragma comment(lib, "ws2_32.lib")
+typedef int				socklen_t;
+#define SOCKET_WOULD_BLOCK(error)	((error) == WSAEWOULDBLOCK || (error) == WSAECONNRESET)
+#define socketLastError()			WSAGetLastError()
+#define poll						WSAPoll
+#else
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+#define SOCKET_WOULD_BLOCK(error)	((error) == EAGAIN || (error) == EWOULDBLOCK || (error) == ECONNREFUSED)
+#define socketLastError()			errno
+#endif
+
+/******************************************************************************/
+/*!
+	Convert between SocketAddress and sockaddr_in.
+*/
+/******************************************************************************/
+static sockaddr_in socketToSockaddr(const SocketAddress& address)
+{
+	sockaddr_in result = {};
+	result.sin_family		= AF_INET;
+	result.sin_addr.s_addr	= htonl(address.ip);
+	result.sin_port			= htons(address.port);
+	return result;
+}
+
+static SocketAddress socketFromSockaddr(const sockaddr_in& address)
+{
+	SocketAddress result;
+	result.ip	= ntohl(address.sin_addr.s_addr);
+	result.port	= ntohs(address.sin_port);
+	return result;
+}
+
+/******************************************************************************/
+/*!
+	Turn the blocking mode of a socket on or off.
+*/
+/******************************************************************************/
+static void socketSetBlocking(SocketHandle socket, bool blocking)
+{
+#ifdef _WIN32
+	u_long nonBlocking = blocking ? 0 : 1;
+	ioctlsocket((SOCKET)socket, FIONBIO, &nonBlocking);
+#else
+	int flags = fcntl((int)socket, F_GETFL, 0);
+	fcntl((int)socket, F_SETFL, blocking ? flags & ~O_NONBLOCK : flags | O_NONBLOCK);
+#endif
+}
+
+/******************************************************************************/
+/*!
+	SocketStartup() initializes WinSock 2.2, it does nothing elsewhere.
+*/
+/******************************************************************************/
+bool SocketStartup()
+{
+#ifdef _WIN32
+	WSADATA wsData;
+	return WSAStartup(MAKEWORD(2, 2), &wsData) == 0;
+#else
+	return true;
+#endif
+}
+
+/******************************************************************************/
+/*!
+	SocketCleanup() releases WinSock, it does nothing elsewhere.
+*/
+/******************************************************************************/
+void SocketCleanup()
+{
+#ifdef _WIN32
+	WSACleanup();
+#endif
+}
+
+/******************************************************************************/
+/*!
+	SocketReserve() raises the soft limit of open descriptors so count sockets
+	fit next to the files of the process. WinSock has no such limit.
+*/
+/******************************************************************************/
+bool SocketReserve(unsigned int count)
+{
+#ifdef _WIN32
+	(void)count;
+	return true;
+#else
+	// stdin/stdout/stderr, the replay file and some slack
+	rlim_t wanted = (rlim_t)count + 64;
+
+	rlimit limit;
+	if (getrlimit(RLIMIT_NOFILE, &limit) != 0)
+		return false;
+	if (limit.rlim_cur >= wanted)
+		return true;
+	if (limit.rlim_max != RLIM_INFINITY && limit.rlim_max < wanted)
+		return false;
+
+	limit.rlim_cur = wanted;
+	return setrlimit(RLIMIT_NOFILE, &limit) == 0;
+#endif
+}
+
+/******************************************************************************/
+/*!
+	SocketResolve() reads a dotted address or looks a host name up, the first
+	IPv4 address is kept.
+*/
+/******************************************************************************/
+bool SocketResolve(const char * host, uint16_t port, SocketAddress& address)
+{
+	addrinfo hints = {};
+	hints.ai_family		= AF_INET;
+	hints.ai_socktype	= SOCK_DGRAM;
+
+	addrinfo * pResult = 0;
+	if (getaddrinfo(host, 0, &hints, &pResult) != 0 || pResult == 0)
+		return false;
+
+	address = socketFromSockaddr(*(const sockaddr_in *)pResult->ai_addr);
+	address.port = port;
+
+	freeaddrinfo(pResult);
+	return true;
+}
+
+/******************************************************************************/
+/*!
+	SocketOpenUdp() creates a non-blocking UDP socket bound to port. A shared
+	socket sets SO_REUSEPORT before the bind: every socket of the group must,
+	the first one included. WinSock has no such option, a shared socket
+	fails there.
+*/
+/******************************************************************************/
+SocketHandle SocketOpenUdp(uint16_t port, bool shared)
+{
+#ifdef _WIN32
+	SOCKET s = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	if (s == INVALID_SOCKET)
+		return SOCKET_HANDLE_NONE;
+
+	u_long nonBlocking = 1;
+	ioctlsocket(s, FIONBIO, &nonBlocking);
+#else
+	int s = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	if (s < 0)
+		return SOCKET_HANDLE_NONE;
+
+	fcntl(s, F_SETFL, fcntl(s, F_GETFL, 0) | O_NONBLOCK);
+#endif
+
+	if (shared)
+	{
+#ifdef SO_REUSEPORT
+		int on = 1;
+		setsockopt(s, SOL_SOCKET, SO_REUSEPORT, (const char *)&on, sizeof(on));
+#else
+		SocketClose((SocketHandle)s);
+		return SOCKET_HANDLE_NONE;
+#endif
+	}
+
+	SocketAddress any = { INADDR_ANY, port };
+	sockaddr_in bindAddress = socketToSockaddr(any);
+	if (bind(s, (const sockaddr *)&bindAddress, sizeof(bindAddress)) != 0)
+	{
+		SocketClose((SocketHandle)s);
+		return SOCKET_HANDLE_NONE;
+	}
+
+	return (SocketHandle)s;
+}
+
+/******************************************************************************/
+/*!
+	SocketClose() closes the socket, it does nothing for SOCKET_HANDLE_NONE.
+*/
+/******************************************************************************/
+void SocketClose(SocketHandle socket)
+{
+	if (socket == SOCKET_HANDLE_NONE)
+		return;
+#ifdef _WIN32
+	closesocket((SOCKET)socket);
+#else
+	close((int)socket);
+#endif
+}
+
+/******************************************************************************/
+/*!
+	SocketLocalPort() reads the port back, for sockets bound to port 0.
+*/
+/******************************************************************************/
+uint16_t SocketLocalPort(SocketHandle socket)
+{
+	sockaddr_in address = {};
+	socklen_t size = sizeof(address);
+	if (getsockname(socket, (sockaddr *)&address, &size) != 0)
+		return 0;
+	return ntohs(address.sin_port);
+}
+
+/******************************************************************************/
+/*!
+	SocketSetBufferSize() sets SO_RCVBUF and SO_SNDBUF. Linux caps them at
+	net.core.rmem_max and wmem_max without complaining.
+*/
+/******************************************************************************/
+bool SocketSetBufferSize(SocketHandle socket, int bytes)
+{
+	bool receive	= setsockopt(socket, SOL_SOCKET, SO_RCVBUF, (const char *)&bytes, sizeof(bytes)) == 0;
+	bool send		= setsockopt(socket, SOL_SOCKET, SO_SNDBUF, (const char *)&bytes, sizeof(bytes)) == 0;
+	return receive && send;
+}
+
+/******************************************************************************/
+/*!
+	SocketSendTo() sends one datagram. A full send buffer drops it, like the
+	network would.
+*/
+/******************************************************************************/
+bool SocketSendTo(SocketHandle socket, const void * pData, size_t size, const SocketAddress& to)
+{
+	sockaddr_in address = socketToSockaddr(to);
+	return sendto(socket, (const char *)pData, (int)size, 0, (const sockaddr *)&address, sizeof(address)) == (int)size;
+}
+
+/******************************************************************************/
+/*!
+	SocketRecvFrom() receives one datagram. An ICMP port unreachable from an
+	earlier send is not an error for a UDP server, it reads as no datagram.
+*/
+/******************************************************************************/
+int SocketRecvFrom(SocketHandle socket, void * pBuffer, size_t size, SocketAddress& from)
+{
+	sockaddr_in address = {};
+	socklen_t addressSize = sizeof(address);
+
+	int received = (int)recvfrom(socket, (char *)pBuffer, (int)size, 0, (sockaddr *)&address, &addressSize);
+	if (received < 0)
+		return SOCKET_WOULD_BLOCK(socketLastError()) ? 0 : -1;
+
+	from = socketFromSockaddr(address);
+	return received;
+}
+
+/******************************************************************************/
+/*!
+	SocketPoll() waits for datagrams on a set of sockets with poll(), or
+	WSAPoll() on Windows. The descriptor array is kept per thread.
+*/
+/******************************************************************************/
+int SocketPoll(const SocketHandle * pSockets, unsigned int count, uint8_t * pReadable, int timeoutMs)
+{
+#ifdef _WIN32
+	typedef WSAPOLLFD	PollEntry;
+#else
+	typedef pollfd		PollEntry;
+#endif
+	static thread_local std::vector<PollEntry> sPollEntries;
+
+	sPollEntries.resize(count);
+	for (unsigned int i = 0; i < count; i++)
+	{
+		sPollEntries[i].fd		= (decltype(sPollEntries[i].fd))pSockets[i];
+		sPollEntries[i].events	= POLLIN;
+		sPollEntries[i].revents	= 0;
+	}
+
+	int ready = poll(sPollEntries.data(), count, timeoutMs);
+	if (ready <= 0)
+	{
+		for (unsigned int i = 0; i < count; i++)
+			pReadable[i] = 0;
+		return 0;
+	}
+
+	for (unsigned int i = 0; i < count; i++)
+		pReadable[i] = (sPollEntries[i].revents & (POLLIN | POLLERR)) ? 1 : 0;
+	return ready;
+}
+
+/******************************************************************************/
+/*!
+	SocketListenTcp() creates a non-blocking TCP socket listening on port. The
+	address can be reused at once, so a restarted process gets its port back.
+*/
+/******************************************************************************/
+SocketHandle SocketListenTcp(uint16_t port, bool loopback)
+{
+#ifdef _WIN32
+	SOCKET s = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+	if (s == INVALID_SOCKET)
+		return SOCKET_HANDLE_NONE;
+#else
+	int s = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+	if (s < 0)
+		return SOCKET_HANDLE_NONE;
+#endif
+
+	int reuse = 1;
+	setsockopt(s, SOL_SOCKET, SO_REUSEADDR, (const char *)&reuse, sizeof(reuse));
+	socketSetBlocking((SocketHandle)s, false);
+
+	SocketAddress any = { loopback ? (uint32_t)INADDR_LOOPBACK : (uint32_t)INADDR_ANY, port };
+	sockaddr_in bindAddress = socketToSockaddr(any);
+	if (bind(s, (const sockaddr *)&bindAddress, sizeof(bindAddress)) != 0 || listen(s, 16) != 0)
+	{
+		SocketClose((SocketHandle)s);
+		return SOCKET_HANDLE_NONE;
+	}
+
+	return (SocketHandle)s;
+}
+
+/******************************************************************************/
+/*!
+	SocketAccept() takes a waiting connection and makes it blocking, with
+	timeoutMs on the receives and the sends so a silent peer cannot hold the
+	thread.
+*/
+/******************************************************************************/
+SocketHandle SocketAccept(SocketHandle listener, int timeoutMs)
+{
+#ifdef _WIN32
+	SOCKET s = accept((SOCKET)listener, 0, 0);
+	if (s == INVALID_SOCKET)
+		return SOCKET_HANDLE_NONE;
+
+	DWORD timeout = (DWORD)timeoutMs;
+#else
+	int s = accept((int)listener, 0, 0);
+	if (s < 0)
+		return SOCKET_HANDLE_NONE;
+
+	timeval timeout = {};
+	timeout.tv_sec	= timeoutMs / 1000;
+	timeout.tv_usec	= (timeoutMs % 1000) * 1000;
+#endif
+
+	socketSetBlocking((SocketHandle)s, true);
+	setsockopt(s, SOL_SOCKET, SO_RCVTIMEO, (const char *)&timeout, sizeof(timeout));
+	setsockopt(s, SOL_SOCKET, SO_SNDTIMEO, (const char *)&timeout, sizeof(timeout));
+	return (SocketHandle)s;
+}
+
+/******************************************************************************/
+/*!
+	SocketRecv() receives what the connection has, up to size bytes.
+*/
+/******************************************************************************/
+int SocketRecv(SocketHandle socket, void * pBuffer, size_t size)
+{
+	int received = (int)recv(socket, (char *)pBuffer, (int)size, 0);
+	return received < 0 ? -1 : received;
+}
+
+/******************************************************************************/
+/*!
+	SocketSend() sends until everything is out, a send can take only part of
+	the data.
+*/
+/******************************************************************************/
+bool SocketSend(SocketHandle socket, const void * pData, size_t size)
+{
+	const char * pCursor = (const char *)pData;
+	while (size > 0)
+	{
+#ifdef MSG_NOSIGNAL
+		int sent = (int)send(socket, pCursor, (int)size, MSG_NOSIGNAL);
+#else
+		int sent = (int)send(socket, pCursor, (int)size, 0);
+#endif
+		if (sent <= 0)
+			return false;
+		pCursor	+= sent;
+		size	-= (size_t)sent;
+	}
+	return true;
+}
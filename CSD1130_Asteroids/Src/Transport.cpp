@@ -0,0 +1,1239 @@
+/******************************************************************************/
+/*!
+\file		Transport.cpp
+\brief		This file contains the definition of the datagram transport of the
+			server.
+
+			The batch backend sets up the message headers of its receive
+			buffers once, a receive only resets their lengths. A queued
+			datagram is sent as two pieces, the head copied in the queue and
+			the body of the caller: the snapshot sent to every session is the
+			same body behind a header of its own, it is never copied.
+
+			The io_uring backends talk to the kernel through the rings it
+			shares, set up with the system calls themselves. One multishot
+			receive stays armed, every datagram completes into a buffer taken
+			from the provided buffer ring: the buffer is handed to the caller
+			and goes back to the ring on the next receive. The completions
+			that arrive while a flush waits for its sends are kept for the
+			next receive.
+
+			A segmented message is a run of queued datagrams to one address,
+			all of the size of the first but the last which may be shorter:
+			the kernel cuts the message at that size. Where it refuses one
+			the transport stops segmenting and sends the rest one datagram
+			per message.
+ */
+/******************************************************************************/
+
+#include "Transport.h"
+
+#include <string.h>
+#include <vector>
+
+#ifdef __linux__
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <netinet/udp.h>
+#include <sys/socket.h>
+#define TRANSPORT_HAS_MMSG
+#ifdef UDP_SEGMENT
+#define TRANSPORT_HAS_GSO
+#endif
+#endif
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#if defined(IORING_RECV_MULTISHOT) && defined(IORING_FEAT_EXT_ARG)
+#define TRANSPORT_HAS_URING
+#include <algorithm>
+#include <deque>
+#include <utility>
+#endif
+#endif
+#endif
+
+// ---------------------------------------------------------------------------
+
+// one datagram waiting for TransportFlush()
+struct TransportItem
+{
+	size_t				headOffset;			// in Transport::heads, which may move while the queue grows
+	size_t				headSize;
+	const uint8_t *		pBody;
+	size_t				bodySize;
+	PacketBuffer *		pPacket;			// holds the body if not 0, released after the flush
+	SocketAddress		to;
+};
+
+#ifdef TRANSPORT_HAS_URING
+
+const size_t		TRANSPORT_URING_BUFFER_SIZE	= sizeof(io_uring_recvmsg_out) + sizeof(sockaddr_in) + TRANSPORT_DATAGRAM_MAX;
+const uint64_t		TRANSPORT_URING_RECV		= 1;		// user data of the completions
+const uint64_t		TRANSPORT_URING_SEND		= 2;
+const unsigned int	TRANSPORT_URING_SPIN		= 20000;	// uring-sqpoll: looks at the completions before a flush waits in the kernel
+
+// a datagram completed by the multishot receive, not received by the caller yet
+struct TransportUringDatagram
+{
+	TransportDatagram	datagram;
+	uint16_t			buffer;
+};
+
+// an io_uring on the socket, the rings mapped from the kernel
+struct TransportUring
+{
+	int							fd;
+	bool						sqPoll;
+	void *						pRings;			// submission and completion rings, one mapping
+	size_t						ringsSize;
+	io_uring_sqe *				pSqes;
+	size_t						sqesSize;
+
+	unsigned int *				pSqHead;		// moved by the kernel
+	unsigned int *				pSqTail;		// moved here
+	unsigned int *				pSqFlags;
+	unsigned int *				pSqArray;
+	unsigned int				sqMask;
+	unsigned int				sqEntries;
+	unsigned int				sqTail;			// entries filled, published by transportUringSubmit()
+
+	unsigned int *				pCqHead;		// moved here
+	unsigned int *				pCqTail;		// moved by the kernel
+	unsigned int				cqMask;
+	io_uring_cqe *				pCqes;
+
+	io_uring_buf_ring *			pBufRing;		// provided buffers, group 0
+	size_t						bufRingSize;
+	std::vector<uint8_t>		buffers;		// TRANSPORT_URING_BUFFERS x TRANSPORT_URING_BUFFER_SIZE
+	uint16_t					bufTail;		// buffers given to the ring, published by transportUringPublish()
+
+	msghdr						recvMsg;		// layout of the multishot receive, the name then the payload
+	bool						recvArmed;
+	std::deque<TransportUringDatagram>	pending;
+	std::vector<uint16_t>		held;			// buffers of the last receive
+	unsigned int				sendsInFlight;
+	unsigned int				sent;			// sends completed by the current flush
+	std::vector<unsigned int>	refused;		// segmented messages of the chunk refused for the segmentation, sent again without
+};
+
+#endif // TRANSPORT_HAS_URING
+
+struct Transport
+{
+	SocketHandle					socket;
+	TRANSPORT_BACKEND				backend;
+	TransportStats					stats;
+
+	std::vector<uint8_t>			recvBuffers;	// TRANSPORT_RECV_BATCH x TRANSPORT_DATAGRAM_MAX
+	std::vector<TransportDatagram>	received;		// datagrams of the last receive
+	std::vector<uint8_t>			heads;			// heads of the queued datagrams
+	std::vector<TransportItem>		queue;
+	std::vector<uint8_t>			scratch;		// head and body put together, single backend
+
+#ifdef TRANSPORT_HAS_MMSG
+	std::vector<mmsghdr>			recvMsgs;		// point to the receive buffers once and for all
+	std::vector<iovec>				recvIovs;
+	std::vector<sockaddr_in>		recvNames;
+	std::vector<mmsghdr>			sendMsgs;		// filled for every chunk of the queue
+	std::vector<iovec>				sendIovs;		// two per datagram, head and body
+	std::vector<sockaddr_in>		sendNames;
+	std::vector<unsigned int>		sendRuns;		// datagrams of each message, more than 1 if segmented
+	std::vector<uint8_t>			sendControl;	// UDP_SEGMENT of each message
+	bool							segmentation;
+#endif
+#ifdef TRANSPORT_HAS_URING
+	TransportUring *				pUring;			// io_uring backends only
+#endif
+	NetSim *						pSimIn;			// conditions of TransportSetConditions(), 0 for none
+	NetSim *						pSimOut;
+};
+
+// ---------------------------------------------------------------------------
+// static variables
+
+static const char * const	sTransportBackendNames[TRANSPORT_BACKEND_NUM] = { "single", "batch", "uring", "uring-sqpoll" };
+
+/******************************************************************************/
+/*!
+	Empty the queue, the packets of the bodies lose its references.
+*/
+/******************************************************************************/
+static void transportClearQueue(Transport * pTransport)
+{
+	for (const TransportItem& item : pTransport->queue)
+		PacketRelease(item.pPacket);
+	pTransport->queue.clear();
+	pTransport->heads.clear();
+}
+
+/******************************************************************************/
+/*!
+	Put what the backend received into the line in and hand out what is due
+	instead. The data is in packets of the line until the next receive.
+*/
+/******************************************************************************/
+static void transportReceiveConditions(Transport * pTransport)
+{
+	double now = NetSimNow();
+	for (const TransportDatagram& datagram : pTransport->received)
+		NetSimPush(pTransport->pSimIn, datagram.pData, datagram.size, 0, 0, datagram.from, now);
+	pTransport->received.clear();
+
+	const NetSimDatagram *	pDatagrams	= 0;
+	unsigned int			count		= NetSimPop(pTransport->pSimIn, now, pDatagrams);
+	for (unsigned int i = 0; i < count; i++)
+	{
+		TransportDatagram datagram = { pDatagrams[i].pPacket->data, pDatagrams[i].pPacket->size, pDatagrams[i].address };
+		pTransport->received.push_back(datagram);
+	}
+}
+
+/******************************************************************************/
+/*!
+	Move the queue into the line out and queue what is due instead, the
+	packets of the line as bodies without a head.
+*/
+/******************************************************************************/
+static void transportSendConditions(Transport * pTransport)
+{
+	double now = NetSimNow();
+	for (const TransportItem& item : pTransport->queue)
+		NetSimPush(pTransport->pSimOut, pTransport->heads.data() + item.headOffset, item.headSize, item.pBody, item.bodySize,
+			item.to, now);
+	transportClearQueue(pTransport);
+
+	const NetSimDatagram *	pDatagrams	= 0;
+	unsigned int			count		= NetSimPop(pTransport->pSimOut, now, pDatagrams);
+	for (unsigned int i = 0; i < count; i++)
+		TransportQueuePacket(pTransport, 0, 0, pDatagrams[i].pPacket, 0, pDatagrams[i].pPacket->size, pDatagrams[i].address);
+}
+
+/******************************************************************************/
+/*!
+	Receive one datagram per call.
+*/
+/******************************************************************************/
+static void transportReceiveSingle(Transport * pTransport)
+{
+	for (unsigned int i = 0; i < TRANSPORT_RECV_BATCH; i++)
+	{
+		uint8_t * pBuffer = pTransport->recvBuffers.data() + i * TRANSPORT_DATAGRAM_MAX;
+
+		SocketAddress from;
+		int size = SocketRecvFrom(pTransport->socket, pBuffer, TRANSPORT_DATAGRAM_MAX, from);
+		++pTransport->stats.recvCalls;
+		if (size <= 0)
+			break;
+
+		TransportDatagram datagram = { pBuffer, (size_t)size, from };
+		pTransport->received.push_back(datagram);
+	}
+}
+
+/******************************************************************************/
+/*!
+	Send the queue one datagram per call, the head and the body put together
+	in the scratch buffer.
+*/
+/******************************************************************************/
+static void transportFlushSingle(Transport * pTransport, unsigned int& sent)
+{
+	for (const TransportItem& item : pTransport->queue)
+	{
+		const uint8_t * pHead = pTransport->heads.data() + item.headOffset;
+		pTransport->scratch.assign(pHead, pHead + item.headSize);
+		if (item.bodySize)
+			pTransport->scratch.insert(pTransport->scratch.end(), item.pBody, item.pBody + item.bodySize);
+
+		++pTransport->stats.sendCalls;
+		if (SocketSendTo(pTransport->socket, pTransport->scratch.data(), pTransport->scratch.size(), item.to))
+		{
+			++sent;
+			pTransport->stats.sendBytes += pTransport->scratch.size();
+		}
+		else
+			++pTransport->stats.sendDropped;
+	}
+	if (sent)
+		pTransport->stats.sendBatchMax = 1;
+}
+
+#ifdef TRANSPORT_HAS_MMSG
+
+/******************************************************************************/
+/*!
+	Point the receive headers at the receive buffers.
+*/
+/******************************************************************************/
+static void transportSetupBatch(Transport * pTransport)
+{
+	pTransport->recvMsgs.assign(TRANSPORT_RECV_BATCH, mmsghdr());
+	pTransport->recvIovs.resize(TRANSPORT_RECV_BATCH);
+	pTransport->recvNames.resize(TRANSPORT_RECV_BATCH);
+	for (unsigned int i = 0; i < TRANSPORT_RECV_BATCH; i++)
+	{
+		pTransport->recvIovs[i].iov_base			= pTransport->recvBuffers.data() + i * TRANSPORT_DATAGRAM_MAX;
+		pTransport->recvIovs[i].iov_len				= TRANSPORT_DATAGRAM_MAX;
+		pTransport->recvMsgs[i].msg_hdr.msg_name	= &pTransport->recvNames[i];
+		pTransport->recvMsgs[i].msg_hdr.msg_iov		= &pTransport->recvIovs[i];
+		pTransport->recvMsgs[i].msg_hdr.msg_iovlen	= 1;
+	}
+
+	pTransport->sendMsgs.assign(TRANSPORT_SEND_BATCH, mmsghdr());
+	pTransport->sendIovs.resize(TRANSPORT_SEND_BATCH * 2);
+	pTransport->sendNames.assign(TRANSPORT_SEND_BATCH, sockaddr_in());
+	pTransport->sendRuns.resize(TRANSPORT_SEND_BATCH);
+	pTransport->sendControl.assign(TRANSPORT_SEND_BATCH * CMSG_SPACE(sizeof(uint16_t)), 0);
+}
+
+/******************************************************************************/
+/*!
+	Whether the kernel knows UDP_SEGMENT, asked of the socket.
+*/
+/******************************************************************************/
+static bool transportProbeSegmentation(SocketHandle socket)
+{
+#ifdef TRANSPORT_HAS_GSO
+	int			size	= 0;
+	socklen_t	length	= sizeof(size);
+	return getsockopt((int)socket, SOL_UDP, UDP_SEGMENT, &size, &length) == 0;
+#else
+	(void)socket;
+	return false;
+#endif
+}
+
+/******************************************************************************/
+/*!
+	Receive up to TRANSPORT_RECV_BATCH datagrams in one recvmmsg(). A datagram
+	cut to the buffer size is dropped.
+*/
+/******************************************************************************/
+static void transportReceiveBatch(Transport * pTransport)
+{
+	for (mmsghdr& msg : pTransport->recvMsgs)
+	{
+		msg.msg_hdr.msg_namelen	= sizeof(sockaddr_in);
+		msg.msg_hdr.msg_flags	= 0;
+		msg.msg_len				= 0;
+	}
+
+	int count = recvmmsg((int)pTransport->socket, pTransport->recvMsgs.data(), TRANSPORT_RECV_BATCH, MSG_DONTWAIT, 0);
+	++pTransport->stats.recvCalls;
+	if (count <= 0)
+		return;
+
+	for (int i = 0; i < count; i++)
+	{
+		const mmsghdr& msg = pTransport->recvMsgs[i];
+		if (msg.msg_hdr.msg_flags & MSG_TRUNC)
+			continue;
+
+		TransportDatagram datagram;
+		datagram.pData		= (const uint8_t *)pTransport->recvIovs[i].iov_base;
+		datagram.size		= msg.msg_len;
+		datagram.from.ip	= ntohl(pTransport->recvNames[i].sin_addr.s_addr);
+		datagram.from.port	= ntohs(pTransport->recvNames[i].sin_port);
+		pTransport->received.push_back(datagram);
+	}
+}
+
+/******************************************************************************/
+/*!
+	Fill the send headers with the count datagrams of the queue from first,
+	the heads and the bodies as pieces. One datagram per message, or a run of
+	them per segmented message. Returns the messages, sendRuns tells the
+	datagrams of each.
+*/
+/******************************************************************************/
+static unsigned int transportFillSend(Transport * pTransport, size_t first, unsigned int count)
+{
+	const std::vector<TransportItem>& queue = pTransport->queue;
+
+	unsigned int messages	= 0;
+	unsigned int pieces		= 0;
+	for (unsigned int i = 0; i < count;)
+	{
+		const TransportItem&	item	= queue[first + i];
+		size_t					size	= item.headSize + item.bodySize;
+
+		// the run ends at another address, a longer datagram or the first shorter one
+		unsigned int	run		= 1;
+		size_t			total	= size;
+		while (pTransport->segmentation && i + run < count && run < TRANSPORT_GSO_SEGMENTS)
+		{
+			const TransportItem&	next		= queue[first + i + run];
+			size_t					nextSize	= next.headSize + next.bodySize;
+			if (next.to.ip != item.to.ip || next.to.port != item.to.port || nextSize > size || total + nextSize > TRANSPORT_GSO_BYTES)
+				break;
+			total += nextSize;
+			++run;
+			if (nextSize < size)
+				break;
+		}
+
+		mmsghdr&		msg		= pTransport->sendMsgs[messages];
+		iovec *			pIov	= pTransport->sendIovs.data() + pieces;
+		sockaddr_in&	name	= pTransport->sendNames[messages];
+
+		name.sin_family			= AF_INET;
+		name.sin_addr.s_addr	= htonl(item.to.ip);
+		name.sin_port			= htons(item.to.port);
+
+		msg.msg_hdr				= msghdr();
+		msg.msg_hdr.msg_name	= &name;
+		msg.msg_hdr.msg_namelen	= sizeof(name);
+		msg.msg_hdr.msg_iov		= pIov;
+
+		for (unsigned int r = 0; r < run; r++)
+		{
+			const TransportItem& piece = queue[first + i + r];
+			pTransport->sendIovs[pieces].iov_base	= pTransport->heads.data() + piece.headOffset;
+			pTransport->sendIovs[pieces].iov_len	= piece.headSize;
+			++pieces;
+			if (piece.bodySize)
+			{
+				pTransport->sendIovs[pieces].iov_base	= (void *)piece.pBody;
+				pTransport->sendIovs[pieces].iov_len	= piece.bodySize;
+				++pieces;
+			}
+		}
+		msg.msg_hdr.msg_iovlen	= pieces - (pIov - pTransport->sendIovs.data());	// pieces may reach the end of sendIovs, no [] past it
+
+#ifdef TRANSPORT_HAS_GSO
+		if (run > 1)
+		{
+			uint8_t * pControl = &pTransport->sendControl[messages * CMSG_SPACE(sizeof(uint16_t))];
+			msg.msg_hdr.msg_control		= pControl;
+			msg.msg_hdr.msg_controllen	= CMSG_SPACE(sizeof(uint16_t));
+
+			cmsghdr * pHeader = CMSG_FIRSTHDR(&msg.msg_hdr);
+			pHeader->cmsg_level	= SOL_UDP;
+			pHeader->cmsg_type	= UDP_SEGMENT;
+			pHeader->cmsg_len	= CMSG_LEN(sizeof(uint16_t));
+			uint16_t segment	= (uint16_t)size;
+			memcpy(CMSG_DATA(pHeader), &segment, sizeof(segment));
+		}
+#endif
+
+		pTransport->sendRuns[messages++] = run;
+		i += run;
+	}
+	return messages;
+}
+
+/******************************************************************************/
+/*!
+	Count what the system took of the messages from message, starting at the
+	datagram item of the queue: the datagrams, the bytes and the segments.
+	Returns the datagrams.
+*/
+/******************************************************************************/
+static unsigned int transportCountSent(Transport * pTransport, unsigned int message, unsigned int messages, size_t& item)
+{
+	unsigned int datagrams = 0;
+	for (unsigned int m = message; m < message + messages; m++)
+	{
+		unsigned int run = pTransport->sendRuns[m];
+		for (unsigned int r = 0; r < run; r++, item++)
+			pTransport->stats.sendBytes += pTransport->queue[item].headSize + pTransport->queue[item].bodySize;
+		if (run > 1)
+			pTransport->stats.sendSegmented += run;
+		datagrams += run;
+	}
+	return datagrams;
+}
+
+/******************************************************************************/
+/*!
+	Send the queue in chunks of TRANSPORT_SEND_BATCH datagrams, one sendmmsg()
+	each unless the system takes only part of a chunk. The message it refuses
+	is dropped and the rest of the chunk is sent again. A segmented message
+	refused for the segmentation itself turns it off, the chunk is filled
+	again from there without.
+*/
+/******************************************************************************/
+static void transportFlushBatch(Transport * pTransport, unsigned int& sent)
+{
+	std::vector<TransportItem>& queue = pTransport->queue;
+
+	for (size_t first = 0; first < queue.size();)
+	{
+		unsigned int count		= (unsigned int)(queue.size() - first < TRANSPORT_SEND_BATCH ? queue.size() - first : TRANSPORT_SEND_BATCH);
+		unsigned int messages	= transportFillSend(pTransport, first, count);
+
+		size_t item = first;
+		for (unsigned int done = 0; done < messages;)
+		{
+			int result = sendmmsg((int)pTransport->socket, &pTransport->sendMsgs[done], messages - done, MSG_DONTWAIT);
+			++pTransport->stats.sendCalls;
+			if (result < 0 && errno == EINTR)
+				continue;
+
+			if (result <= 0)
+			{
+				if (pTransport->sendRuns[done] > 1 && (errno == EIO || errno == EINVAL || errno == ENOPROTOOPT))
+				{
+					pTransport->segmentation = false;
+					break;
+				}
+				pTransport->stats.sendDropped += pTransport->sendRuns[done];
+				item += pTransport->sendRuns[done];
+				++done;
+				continue;
+			}
+
+			unsigned int datagrams = transportCountSent(pTransport, done, (unsigned int)result, item);
+			if (datagrams > pTransport->stats.sendBatchMax)
+				pTransport->stats.sendBatchMax = datagrams;
+			sent += datagrams;
+			done += (unsigned int)result;
+		}
+		first = item;
+	}
+}
+
+#endif // TRANSPORT_HAS_MMSG
+
+#ifdef TRANSPORT_HAS_URING
+
+/******************************************************************************/
+/*!
+	io_uring_enter(), again when a signal interrupts it. Returns the result of
+	the call.
+*/
+/******************************************************************************/
+static int transportUringEnter(TransportUring& uring, unsigned int submit, unsigned int wait, unsigned int flags,
+							   const void * pArg = 0, size_t argSize = 0)
+{
+	int result;
+	do
+		result = (int)syscall(__NR_io_uring_enter, uring.fd, submit, wait, flags, pArg, argSize);
+	while (result < 0 && errno == EINTR);
+	return result;
+}
+
+/******************************************************************************/
+/*!
+	Give the entries filled to the kernel and wait for wait completions.
+	With a polling thread the kernel takes the entries by itself, a call is
+	made only to wake the thread or to wait. Returns the system calls made.
+*/
+/******************************************************************************/
+static unsigned int transportUringSubmit(TransportUring& uring, unsigned int wait)
+{
+	unsigned int submit = uring.sqTail - *uring.pSqTail;
+	__atomic_store_n(uring.pSqTail, uring.sqTail, __ATOMIC_RELEASE);
+
+	unsigned int flags = wait ? IORING_ENTER_GETEVENTS : 0;
+	if (uring.sqPoll)
+	{
+		// the tail must be visible before the flag is read, or the thread may sleep on it
+		__atomic_thread_fence(__ATOMIC_SEQ_CST);
+		if (__atomic_load_n(uring.pSqFlags, __ATOMIC_RELAXED) & IORING_SQ_NEED_WAKEUP)
+			flags |= IORING_ENTER_SQ_WAKEUP;
+		submit = 0;
+	}
+	if (submit == 0 && flags == 0)
+		return 0;
+
+	transportUringEnter(uring, submit, wait, flags);
+	return 1;
+}
+
+/******************************************************************************/
+/*!
+	The next free submission entry, cleared. A full queue is submitted first,
+	the calls made are added to calls.
+*/
+/******************************************************************************/
+static io_uring_sqe * transportUringEntry(TransportUring& uring, uint64_t& calls)
+{
+	while (uring.sqTail - __atomic_load_n(uring.pSqHead, __ATOMIC_ACQUIRE) >= uring.sqEntries)
+	{
+		calls += transportUringSubmit(uring, 0);
+		if (uring.sqPoll)
+		{
+			transportUringEnter(uring, 0, 0, IORING_ENTER_SQ_WAIT);
+			++calls;
+		}
+	}
+
+	unsigned int index = uring.sqTail & uring.sqMask;
+	uring.pSqArray[index] = index;
+	++uring.sqTail;
+
+	io_uring_sqe * pSqe = &uring.pSqes[index];
+	memset(pSqe, 0, sizeof(*pSqe));
+	return pSqe;
+}
+
+/******************************************************************************/
+/*!
+	Put a buffer back in the provided buffer ring, the kernel sees it after
+	transportUringPublish().
+*/
+/******************************************************************************/
+static void transportUringRecycle(TransportUring& uring, uint16_t buffer)
+{
+	// the entries are indexed by hand: the bufs member of the header moves by 8 bytes in C++
+	io_uring_buf& entry = ((io_uring_buf *)uring.pBufRing)[uring.bufTail & (TRANSPORT_URING_BUFFERS - 1)];
+	entry.addr	= (uint64_t)(uintptr_t)(uring.buffers.data() + buffer * TRANSPORT_URING_BUFFER_SIZE);
+	entry.len	= (uint32_t)TRANSPORT_URING_BUFFER_SIZE;
+	entry.bid	= buffer;
+	++uring.bufTail;
+}
+
+static void transportUringPublish(TransportUring& uring)
+{
+	__atomic_store_n(&uring.pBufRing->tail, uring.bufTail, __ATOMIC_RELEASE);
+}
+
+/******************************************************************************/
+/*!
+	Arm the multishot receive: it completes once per datagram, each time into
+	a buffer of group 0, until the ring runs out of buffers.
+*/
+/******************************************************************************/
+static void transportUringArm(Transport * pTransport)
+{
+	TransportUring& uring = *pTransport->pUring;
+
+	io_uring_sqe * pSqe = transportUringEntry(uring, pTransport->stats.recvCalls);
+	pSqe->opcode	= IORING_OP_RECVMSG;
+	pSqe->fd		= (int)pTransport->socket;
+	pSqe->addr		= (uint64_t)(uintptr_t)&uring.recvMsg;
+	pSqe->len		= 1;
+	pSqe->ioprio	= IORING_RECV_MULTISHOT;
+	pSqe->flags		= IOSQE_BUFFER_SELECT;
+	pSqe->buf_group	= 0;
+	pSqe->user_data	= TRANSPORT_URING_RECV;
+
+	uring.recvArmed = true;
+	pTransport->stats.recvCalls += transportUringSubmit(uring, 0);
+}
+
+/******************************************************************************/
+/*!
+	Read the completion queue. A datagram goes to the pending ones, a send is
+	counted. A segmented send refused for the segmentation itself turns it
+	off and is kept for the flush to send again. A receive completion without
+	IORING_CQE_F_MORE ends the multishot receive, it is armed again by the
+	next receive.
+*/
+/******************************************************************************/
+static void transportUringReap(Transport * pTransport)
+{
+	TransportUring& uring = *pTransport->pUring;
+
+	unsigned int head = *uring.pCqHead;
+	unsigned int tail = __atomic_load_n(uring.pCqTail, __ATOMIC_ACQUIRE);
+	bool recycled = false;
+	for (; head != tail; head++)
+	{
+		const io_uring_cqe& cqe = uring.pCqes[head & uring.cqMask];
+
+		if ((uint32_t)cqe.user_data == TRANSPORT_URING_SEND)
+		{
+			// the message of the chunk is in the high half
+			unsigned int message	= (unsigned int)(cqe.user_data >> 32);
+			unsigned int run		= pTransport->sendRuns[message];
+			--uring.sendsInFlight;
+			if (cqe.res >= 0)
+			{
+				uring.sent += run;
+				pTransport->stats.sendBytes += (uint64_t)cqe.res;
+				if (run > 1)
+					pTransport->stats.sendSegmented += run;
+			}
+			else if (run > 1 && (cqe.res == -EIO || cqe.res == -EINVAL || cqe.res == -ENOPROTOOPT))
+			{
+				pTransport->segmentation = false;
+				uring.refused.push_back(message);
+			}
+			else
+				pTransport->stats.sendDropped += run;
+			continue;
+		}
+
+		if (!(cqe.flags & IORING_CQE_F_MORE))
+			uring.recvArmed = false;
+		if (!(cqe.flags & IORING_CQE_F_BUFFER))
+			continue;
+
+		uint16_t buffer = (uint16_t)(cqe.flags >> IORING_CQE_BUFFER_SHIFT);
+		const io_uring_recvmsg_out * pOut = (const io_uring_recvmsg_out *)(uring.buffers.data() + buffer * TRANSPORT_URING_BUFFER_SIZE);
+		if (cqe.res < 0 || (pOut->flags & MSG_TRUNC) || pOut->namelen < sizeof(sockaddr_in))
+		{
+			transportUringRecycle(uring, buffer);
+			recycled = true;
+			continue;
+		}
+
+		const sockaddr_in * pName = (const sockaddr_in *)(pOut + 1);
+
+		TransportUringDatagram pending;
+		pending.datagram.pData		= (const uint8_t *)(pName + 1);
+		pending.datagram.size		= pOut->payloadlen;
+		pending.datagram.from.ip	= ntohl(pName->sin_addr.s_addr);
+		pending.datagram.from.port	= ntohs(pName->sin_port);
+		pending.buffer				= buffer;
+		uring.pending.push_back(pending);
+	}
+	__atomic_store_n(uring.pCqHead, head, __ATOMIC_RELEASE);
+
+	if (recycled)
+		transportUringPublish(uring);
+}
+
+/******************************************************************************/
+/*!
+	Unmap the rings and close the ring descriptor, the kernel cancels what is
+	still armed.
+*/
+/******************************************************************************/
+static void transportUringClose(TransportUring * pUring)
+{
+	if (pUring->pBufRing)
+		munmap(pUring->pBufRing, pUring->bufRingSize);
+	if (pUring->pSqes)
+		munmap(pUring->pSqes, pUring->sqesSize);
+	if (pUring->pRings)
+		munmap(pUring->pRings, pUring->ringsSize);
+	if (pUring->fd >= 0)
+		close(pUring->fd);
+	delete pUring;
+}
+
+/******************************************************************************/
+/*!
+	Set up an io_uring, with a polling thread if sqPoll, register the
+	provided buffer ring and arm the receive. Returns false if the kernel
+	lacks a feature the backend needs, nothing is left behind.
+*/
+/******************************************************************************/
+static bool transportSetupUring(Transport * pTransport, bool sqPoll)
+{
+	io_uring_params params;
+	memset(&params, 0, sizeof(params));
+	params.flags			= IORING_SETUP_CQSIZE | (sqPoll ? IORING_SETUP_SQPOLL : 0);
+	params.cq_entries		= TRANSPORT_URING_COMPLETIONS;
+	params.sq_thread_idle	= TRANSPORT_URING_IDLE_MS;
+
+	TransportUring * pUring = new TransportUring();
+	pUring->sqPoll	= sqPoll;
+	pUring->fd		= (int)syscall(__NR_io_uring_setup, TRANSPORT_URING_ENTRIES, &params);
+	if (pUring->fd < 0 || !(params.features & IORING_FEAT_SINGLE_MMAP) || !(params.features & IORING_FEAT_NODROP) ||
+		!(params.features & IORING_FEAT_EXT_ARG))
+	{
+		transportUringClose(pUring);
+		return false;
+	}
+
+	size_t sqSize = params.sq_off.array + params.sq_entries * sizeof(unsigned int);
+	size_t cqSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+	pUring->ringsSize	= sqSize > cqSize ? sqSize : cqSize;
+	pUring->sqesSize	= params.sq_entries * sizeof(io_uring_sqe);
+	pUring->bufRingSize	= TRANSPORT_URING_BUFFERS * sizeof(io_uring_buf);
+
+	void * pRings	= mmap(0, pUring->ringsSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, pUring->fd, IORING_OFF_SQ_RING);
+	void * pSqes	= mmap(0, pUring->sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, pUring->fd, IORING_OFF_SQES);
+	void * pBufRing	= mmap(0, pUring->bufRingSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	pUring->pRings		= pRings != MAP_FAILED ? pRings : 0;
+	pUring->pSqes		= pSqes != MAP_FAILED ? (io_uring_sqe *)pSqes : 0;
+	pUring->pBufRing	= pBufRing != MAP_FAILED ? (io_uring_buf_ring *)pBufRing : 0;
+	if (pUring->pRings == 0 || pUring->pSqes == 0 || pUring->pBufRing == 0)
+	{
+		transportUringClose(pUring);
+		return false;
+	}
+
+	uint8_t * pBase = (uint8_t *)pUring->pRings;
+	pUring->pSqHead		= (unsigned int *)(pBase + params.sq_off.head);
+	pUring->pSqTail		= (unsigned int *)(pBase + params.sq_off.tail);
+	pUring->pSqFlags	= (unsigned int *)(pBase + params.sq_off.flags);
+	pUring->pSqArray	= (unsigned int *)(pBase + params.sq_off.array);
+	pUring->sqMask		= *(unsigned int *)(pBase + params.sq_off.ring_mask);
+	pUring->sqEntries	= params.sq_entries;
+	pUring->sqTail		= *pUring->pSqTail;
+	pUring->pCqHead		= (unsigned int *)(pBase + params.cq_off.head);
+	pUring->pCqTail		= (unsigned int *)(pBase + params.cq_off.tail);
+	pUring->cqMask		= *(unsigned int *)(pBase + params.cq_off.ring_mask);
+	pUring->pCqes		= (io_uring_cqe *)(pBase + params.cq_off.cqes);
+
+	io_uring_buf_reg registration;
+	memset(&registration, 0, sizeof(registration));
+	registration.ring_addr		= (uint64_t)(uintptr_t)pUring->pBufRing;
+	registration.ring_entries	= TRANSPORT_URING_BUFFERS;
+	registration.bgid			= 0;
+	if (syscall(__NR_io_uring_register, pUring->fd, IORING_REGISTER_PBUF_RING, &registration, 1) < 0)
+	{
+		transportUringClose(pUring);
+		return false;
+	}
+
+	pUring->buffers.resize(TRANSPORT_URING_BUFFERS * TRANSPORT_URING_BUFFER_SIZE);
+	for (unsigned int b = 0; b < TRANSPORT_URING_BUFFERS; b++)
+		transportUringRecycle(*pUring, (uint16_t)b);
+	transportUringPublish(*pUring);
+
+	pUring->recvMsg				= msghdr();
+	pUring->recvMsg.msg_namelen	= sizeof(sockaddr_in);
+
+	pTransport->pUring = pUring;
+	transportUringArm(pTransport);
+	return true;
+}
+
+/******************************************************************************/
+/*!
+	Give the buffers of the last receive back, arm the receive again if it
+	ended and buffers are free, then hand out the pending datagrams.
+*/
+/******************************************************************************/
+static void transportReceiveUring(Transport * pTransport)
+{
+	TransportUring& uring = *pTransport->pUring;
+
+	for (uint16_t buffer : uring.held)
+		transportUringRecycle(uring, buffer);
+	if (!uring.held.empty())
+		transportUringPublish(uring);
+	uring.held.clear();
+
+	transportUringReap(pTransport);
+	if (!uring.recvArmed && uring.pending.size() < TRANSPORT_URING_BUFFERS)
+		transportUringArm(pTransport);
+
+	while (!uring.pending.empty() && pTransport->received.size() < TRANSPORT_RECV_BATCH)
+	{
+		pTransport->received.push_back(uring.pending.front().datagram);
+		uring.held.push_back(uring.pending.front().buffer);
+		uring.pending.pop_front();
+	}
+}
+
+/******************************************************************************/
+/*!
+	Wait for a datagram in io_uring_enter(), the timeout passed as an extended
+	argument.
+*/
+/******************************************************************************/
+static bool transportWaitUring(Transport * pTransport, int timeoutMs)
+{
+	TransportUring& uring = *pTransport->pUring;
+
+	transportUringReap(pTransport);
+	if (!uring.pending.empty() || !uring.recvArmed)
+		return true;
+
+	__kernel_timespec timeout;
+	timeout.tv_sec	= timeoutMs / 1000;
+	timeout.tv_nsec	= (long long)(timeoutMs % 1000) * 1000000;
+
+	io_uring_getevents_arg arg;
+	memset(&arg, 0, sizeof(arg));
+	arg.ts = (uint64_t)(uintptr_t)&timeout;
+	transportUringEnter(uring, 0, 1, IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG, &arg, sizeof(arg));
+
+	transportUringReap(pTransport);
+	return !uring.pending.empty() || !uring.recvArmed;
+}
+
+/******************************************************************************/
+/*!
+	Queue one sendmsg per message filled by transportFillSend() and wait for
+	their completions. Without a polling thread the submission and the wait
+	are one call, with it the completions are looked at for a while before
+	the wait goes to the kernel.
+*/
+/******************************************************************************/
+static void transportUringSend(Transport * pTransport, unsigned int messages)
+{
+	TransportUring&	uring	= *pTransport->pUring;
+	TransportStats&	stats	= pTransport->stats;
+
+	for (unsigned int m = 0; m < messages; m++)
+	{
+		io_uring_sqe * pSqe = transportUringEntry(uring, stats.sendCalls);
+		pSqe->opcode	= IORING_OP_SENDMSG;
+		pSqe->fd		= (int)pTransport->socket;
+		pSqe->addr		= (uint64_t)(uintptr_t)&pTransport->sendMsgs[m].msg_hdr;
+		pSqe->len		= 1;
+		pSqe->user_data	= TRANSPORT_URING_SEND | ((uint64_t)m << 32);
+	}
+	uring.sendsInFlight += messages;
+
+	if (uring.sqPoll)
+	{
+		stats.sendCalls += transportUringSubmit(uring, 0);
+		for (unsigned int spin = 0; spin < TRANSPORT_URING_SPIN && uring.sendsInFlight; spin++)
+			transportUringReap(pTransport);
+	}
+	while (uring.sendsInFlight)
+	{
+		stats.sendCalls += transportUringSubmit(uring, uring.sendsInFlight);
+		transportUringReap(pTransport);
+	}
+}
+
+/******************************************************************************/
+/*!
+	Send the queue TRANSPORT_SEND_BATCH datagrams at a time and wait for the
+	completions: the bodies belong to the caller again when the flush
+	returns. A segmented message refused for the segmentation turns it off,
+	its datagrams are sent again one per message once the chunk is done, like
+	the batch flush fills the rest of its chunk again without.
+*/
+/******************************************************************************/
+static void transportFlushUring(Transport * pTransport, unsigned int& sent)
+{
+	TransportUring&				uring	= *pTransport->pUring;
+	std::vector<TransportItem>&	queue	= pTransport->queue;
+	TransportStats&				stats	= pTransport->stats;
+
+	uring.sent = 0;
+	for (size_t first = 0; first < queue.size(); first += TRANSPORT_SEND_BATCH)
+	{
+		unsigned int count		= (unsigned int)(queue.size() - first < TRANSPORT_SEND_BATCH ? queue.size() - first : TRANSPORT_SEND_BATCH);
+		unsigned int messages	= transportFillSend(pTransport, first, count);
+		uint64_t calls = stats.sendCalls;
+		transportUringSend(pTransport, messages);
+
+		if (!uring.refused.empty())
+		{
+			// where the refused messages start in the queue, before the headers are filled again
+			std::sort(uring.refused.begin(), uring.refused.end());
+			std::vector<std::pair<size_t, unsigned int>> runs;
+			size_t item = first;
+			for (unsigned int m = 0, r = 0; m < messages && r < uring.refused.size(); item += pTransport->sendRuns[m++])
+			{
+				if (uring.refused[r] == m)
+				{
+					runs.push_back(std::make_pair(item, pTransport->sendRuns[m]));
+					++r;
+				}
+			}
+			uring.refused.clear();
+
+			// the segmentation is off, every datagram is a message of its own
+			for (const std::pair<size_t, unsigned int>& run : runs)
+				transportUringSend(pTransport, transportFillSend(pTransport, run.first, run.second));
+		}
+
+		uint64_t perCall = count / (stats.sendCalls > calls ? stats.sendCalls - calls : 1);
+		if (perCall > stats.sendBatchMax)
+			stats.sendBatchMax = perCall;
+	}
+	sent = uring.sent;
+}
+
+#endif // TRANSPORT_HAS_URING
+
+/******************************************************************************/
+/*!
+	TransportOpen() opens the socket with large buffers, a burst of inputs
+	waits there until the loop comes back to it. uring-sqpoll falls back to
+	uring where the polling thread is refused, uring to batch where the
+	kernel has no io_uring or lacks the multishot receive.
+*/
+/******************************************************************************/
+Transport * TransportOpen(TRANSPORT_BACKEND backend, uint16_t port, bool shared)
+{
+	SocketHandle socket = SocketOpenUdp(port, shared);
+	if (socket == SOCKET_HANDLE_NONE)
+		return 0;
+	SocketSetBufferSize(socket, TRANSPORT_SOCKET_BUFFER);
+
+	Transport * pTransport = new Transport();
+	pTransport->socket	= socket;
+	pTransport->backend	= TRANSPORT_SINGLE;
+	pTransport->recvBuffers.resize(TRANSPORT_RECV_BATCH * TRANSPORT_DATAGRAM_MAX);
+	pTransport->received.reserve(TRANSPORT_RECV_BATCH);
+
+#ifdef TRANSPORT_HAS_MMSG
+	if (backend != TRANSPORT_SINGLE)
+	{
+		pTransport->backend			= TRANSPORT_BATCH;
+		pTransport->segmentation	= transportProbeSegmentation(socket);
+		transportSetupBatch(pTransport);
+	}
+#ifdef TRANSPORT_HAS_URING
+	if (backend == TRANSPORT_URING_SQPOLL && transportSetupUring(pTransport, true))
+		pTransport->backend = TRANSPORT_URING_SQPOLL;
+	else if ((backend == TRANSPORT_URING || backend == TRANSPORT_URING_SQPOLL) && transportSetupUring(pTransport, false))
+		pTransport->backend = TRANSPORT_URING;
+#endif
+#else
+	(void)backend;
+#endif
+
+	return pTransport;
+}
+
+/******************************************************************************/
+/*!
+	TransportClose() closes the socket, the queue is not sent. An io_uring
+	is closed first, so nothing of it points at the socket any more.
+*/
+/******************************************************************************/
+void TransportClose(Transport * pTransport)
+{
+	if (pTransport == 0)
+		return;
+
+#ifdef TRANSPORT_HAS_URING
+	if (pTransport->pUring)
+		transportUringClose(pTransport->pUring);
+#endif
+	transportClearQueue(pTransport);
+	NetSimDestroy(pTransport->pSimIn);
+	NetSimDestroy(pTransport->pSimOut);
+	SocketClose(pTransport->socket);
+	delete pTransport;
+}
+
+/******************************************************************************/
+/*!
+	TransportSocket() returns the socket.
+*/
+/******************************************************************************/
+SocketHandle TransportSocket(const Transport * pTransport)
+{
+	return pTransport->socket;
+}
+
+/******************************************************************************/
+/*!
+	TransportBackend() returns the backend in use.
+*/
+/******************************************************************************/
+TRANSPORT_BACKEND TransportBackend(const Transport * pTransport)
+{
+	return pTransport->backend;
+}
+
+/******************************************************************************/
+/*!
+	TransportSetSegmentation() turns the segmented messages on or off, the
+	kernel is asked again.
+*/
+/******************************************************************************/
+bool TransportSetSegmentation(Transport * pTransport, bool enabled)
+{
+#ifdef TRANSPORT_HAS_MMSG
+	pTransport->segmentation = enabled && pTransport->backend != TRANSPORT_SINGLE && transportProbeSegmentation(pTransport->socket);
+	return pTransport->segmentation;
+#else
+	(void)pTransport;
+	(void)enabled;
+	return false;
+#endif
+}
+
+/******************************************************************************/
+/*!
+	TransportSetConditions() replaces the lines.
+*/
+/******************************************************************************/
+void TransportSetConditions(Transport * pTransport, const NetSimConditions * pIn, const NetSimConditions * pOut, uint32_t seed)
+{
+	NetSimDestroy(pTransport->pSimIn);
+	NetSimDestroy(pTransport->pSimOut);
+	pTransport->pSimIn	= pIn ? NetSimCreate(*pIn, seed) : 0;
+	pTransport->pSimOut	= pOut ? NetSimCreate(*pOut, seed + 1) : 0;
+}
+
+/******************************************************************************/
+/*!
+	TransportGetConditionStats() reads the counters of the lines.
+*/
+/******************************************************************************/
+void TransportGetConditionStats(const Transport * pTransport, NetSimStats& in, NetSimStats& out)
+{
+	in	= pTransport->pSimIn ? NetSimGetStats(pTransport->pSimIn) : NetSimStats();
+	out	= pTransport->pSimOut ? NetSimGetStats(pTransport->pSimOut) : NetSimStats();
+}
+
+/******************************************************************************/
+/*!
+	TransportWait() polls the socket, or waits for a completion of the
+	io_uring: the multishot receive takes the datagrams off the socket, a
+	poll would not see them.
+*/
+/******************************************************************************/
+bool TransportWait(Transport * pTransport, int timeoutMs)
+{
+	// no longer than the next datagram of a line
+	double now = NetSimNow();
+	for (const NetSim * pSim : { pTransport->pSimIn, pTransport->pSimOut })
+	{
+		double next = pSim ? NetSimNextDue(pSim) : -1.0;
+		if (next < 0.0)
+			continue;
+		int dueMs = next > now ? (int)((next - now) * 1000.0) + 1 : 0;
+		timeoutMs = timeoutMs < 0 || dueMs < timeoutMs ? dueMs : timeoutMs;
+	}
+
+	bool readable = false;
+#ifdef TRANSPORT_HAS_URING
+	if (pTransport->pUring)
+		readable = transportWaitUring(pTransport, timeoutMs);
+	else
+#endif
+	{
+		uint8_t ready = 0;
+		SocketPoll(&pTransport->socket, 1, &ready, timeoutMs);
+		readable = ready != 0;
+	}
+
+	if (!readable && pTransport->pSimIn)
+	{
+		double next = NetSimNextDue(pTransport->pSimIn);
+		readable = next >= 0.0 && next <= NetSimNow();
+	}
+	return readable;
+}
+
+/******************************************************************************/
+/*!
+	TransportReceive() takes the datagrams waiting with the backend.
+*/
+/******************************************************************************/
+unsigned int TransportReceive(Transport * pTransport, const TransportDatagram *& pDatagrams)
+{
+	pTransport->received.clear();
+
+#ifdef TRANSPORT_HAS_URING
+	if (pTransport->pUring)
+		transportReceiveUring(pTransport);
+	else
+#endif
+#ifdef TRANSPORT_HAS_MMSG
+	if (pTransport->backend == TRANSPORT_BATCH)
+		transportReceiveBatch(pTransport);
+	else
+#endif
+		transportReceiveSingle(pTransport);
+
+	if (pTransport->pSimIn)
+		transportReceiveConditions(pTransport);
+
+	TransportStats& stats = pTransport->stats;
+	stats.recvDatagrams += pTransport->received.size();
+	for (const TransportDatagram& datagram : pTransport->received)
+		stats.recvBytes += datagram.size;
+	if (pTransport->received.size() > stats.recvBatchMax)
+		stats.recvBatchMax = pTransport->received.size();
+
+	pDatagrams = pTransport->received.data();
+	return (unsigned int)pTransport->received.size();
+}
+
+/******************************************************************************/
+/*!
+	TransportQueue() copies the head at the end of the heads and keeps the
+	offset, the heads grow while the queue does.
+*/
+/******************************************************************************/
+void TransportQueue(Transport * pTransport, const void * pHead, size_t headSize,
+					const void * pBody, size_t bodySize, const SocketAddress& to)
+{
+	TransportItem item;
+	item.headOffset	= pTransport->heads.size();
+	item.headSize	= headSize;
+	item.pBody		= (const uint8_t *)pBody;
+	item.bodySize	= pBody ? bodySize : 0;
+	item.pPacket	= 0;
+	item.to			= to;
+
+	pTransport->heads.insert(pTransport->heads.end(), (const uint8_t *)pHead, (const uint8_t *)pHead + headSize);
+	pTransport->queue.push_back(item);
+}
+
+/******************************************************************************/
+/*!
+	TransportQueuePacket() queues the body in the packet and takes a
+	reference, the flush gives it back.
+*/
+/******************************************************************************/
+void TransportQueuePacket(Transport * pTransport, const void * pHead, size_t headSize,
+						  PacketBuffer * pPacket, size_t offset, size_t size, const SocketAddress& to)
+{
+	TransportQueue(pTransport, pHead, headSize, pPacket->data + offset, size, to);
+	PacketRetain(pPacket);
+	pTransport->queue.back().pPacket = pPacket;
+}
+
+/******************************************************************************/
+/*!
+	TransportFlush() sends the queue with the backend and empties it.
+*/
+/******************************************************************************/
+unsigned int TransportFlush(Transport * pTransport)
+{
+	unsigned int sent = 0;
+
+	if (pTransport->pSimOut)
+		transportSendConditions(pTransport);
+
+#ifdef TRANSPORT_HAS_URING
+	if (pTransport->pUring)
+		transportFlushUring(pTransport, sent);
+	else
+#endif
+#ifdef TRANSPORT_HAS_MMSG
+	if (pTransport->backend == TRANSPORT_BATCH)
+		transportFlushBatch(pTransport, sent);
+	else
+#endif
+		transportFlushSingle(pTransport, sent);
+
+	pTransport->stats.sendDatagrams += sent;
+	transportClearQueue(pTransport);
+	return sent;
+}
+
+/******************************************************************************/
+/*!
+	TransportGetStats() returns the counters of the transport.
+*/
+/******************************************************************************/
+const TransportStats& TransportGetStats(const Transport * pTransport)
+{
+	return pTransport->stats;
+}
+
+/******************************************************************************/
+/*!
+	TransportParseBackend() reads the name of a backend.
+*/
+/******************************************************************************/
+bool TransportParseBackend(const char * name, TRANSPORT_BACKEND& backend)
+{
+	for (unsigned int b = 0; b < TRANSPORT_BACKEND_NUM; b++)
+	{
+		if (strcmp(name, sTransportBackendNames[b]) == 0)
+		{
+			backend = (TRANSPORT_BACKEND)b;
+			return true;
+		}
+	}
+	return false;
+}
+
+/******************************************************************************/
+/*!
+	TransportBackendName() returns the name of a backend.
+*/
+/******************************************************************************/
+const char * TransportBackendName(TRANSPORT_BACKEND backend)
+{
+	return backend < TRANSPORT_BACKEND_NUM ? sTransportBackendNames[backend] : "unknown";
+}
@@ -0,0 +1,160 @@
+/******************************************************************************/
+/*!
+\file		WorkerPool.cpp
+\brief		This file contains the definition of the worker thread pool. The
+			threads sleep on a condition variable between two runs and take the
+			jobs of a run from a shared atomic counter.
+ */
+/******************************************************************************/
+
+#include "WorkerPool.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// static variables
+
+static std::vector<std::thread>		sWorkers;					// worker threads, the calling thread is not in here
+static std::mutex					sWorkerMutex;				// protects everything below that is not atomic
+static std::condition_variable		sWorkerStart;				// signaled when a run starts or the pool stops
+static std::condition_variable		sWorkerDone;				// signaled when the last worker finishes a run
+static unsigned long				sWorkerRun;					// incremented at every run
+static unsigned int					sWorkerBusy;				// workers still inside the current run
+static bool							sWorkerQuit;				// set to stop the workers
+
+static const std::function<void(unsigned int, unsigned int)> *	spWorkerJob;	// job of the current run
+static unsigned int					sWorkerJobCount;			// number of jobs of the current run
+static std::atomic<unsigned int>	sWorkerJobNext;				// next job to take
+
+/******************************************************************************/
+/*!
+	Take jobs of the current run until there are none left.
+*/
+/******************************************************************************/
+static void WorkerPoolDrain(unsigned int threadIndex)
+{
+	for (;;)
+	{
+		unsigned int jobIndex = sWorkerJobNext.fetch_add(1);
+		if (jobIndex >= sWorkerJobCount)
+			return;
+
+		(*spWorkerJob)(jobIndex, threadIndex);
+	}
+}
+
+/******************************************************************************/
+/*!
+	Body of a worker thread: wait for a run, help with it, report back.
+	lastRun is the run counter when the thread was created, so a run that
+	starts before the thread gets scheduled is not missed.
+*/
+/******************************************************************************/
+static void WorkerPoolMain(unsigned int threadIndex, unsigned long lastRun)
+{
+	for (;;)
+	{
+		{
+			std::unique_lock<std::mutex> lock(sWorkerMutex);
+			sWorkerStart.wait(lock, [&] { return sWorkerQuit || sWorkerRun != lastRun; });
+			if (sWorkerQuit)
+				return;
+			lastRun = sWorkerRun;
+		}
+
+		WorkerPoolDrain(threadIndex);
+
+		std::lock_guard<std::mutex> lock(sWorkerMutex);
+		if (--sWorkerBusy == 0)
+			sWorkerDone.notify_one();
+	}
+}
+
+/******************************************************************************/
+/*!
+	WorkerPoolInit() starts threadCount - 1 worker threads, the calling thread
+	being the last one. threadCount 0 uses one thread per core.
+*/
+/******************************************************************************/
+void WorkerPoolInit(unsigned int threadCount)
+{
+	WorkerPoolFree();
+
+	if (threadCount == 0)
+		threadCount = std::thread::hardware_concurrency();
+	if (threadCount == 0)
+		threadCount = 1;
+
+	sWorkerQuit = false;
+	for (unsigned int i = 1; i < threadCount; i++)
+		sWorkers.emplace_back(WorkerPoolMain, i, sWorkerRun);
+}
+
+/******************************************************************************/
+/*!
+	WorkerPoolFree() stops and joins every worker thread.
+*/
+/******************************************************************************/
+void WorkerPoolFree()
+{
+	{
+		std::lock_guard<std::mutex> lock(sWorkerMutex);
+		sWorkerQuit = true;
+	}
+	sWorkerStart.notify_all();
+
+	for (std::thread& worker : sWorkers)
+		worker.join();
+	sWorkers.clear();
+}
+
+/******************************************************************************/
+/*!
+	WorkerPoolThreadCount() returns the number of threads taking jobs.
+*/
+/******************************************************************************/
+unsigned int WorkerPoolThreadCount()
+{
+	return (unsigned int)sWorkers.size() + 1;
+}
+
+/******************************************************************************/
+/*!
+	WorkerPoolRun() hands the jobs to the workers, takes jobs on the calling
+	thread too and returns once every job is finished. The order the jobs run
+	in is not defined, so a job should only write to data owned by its
+	jobIndex or its threadIndex.
+*/
+/******************************************************************************/
+void WorkerPoolRun(unsigned int jobCount, const std::function<void(unsigned int, unsigned int)>& job)
+{
+	if (jobCount == 0)
+		return;
+
+	spWorkerJob		= &job;
+	sWorkerJobCount	= jobCount;
+	sWorkerJobNext	= 0;
+
+	// not worth waking anybody for a single job
+	if (sWorkers.empty() || jobCount == 1)
+	{
+		WorkerPoolDrain(0);
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(sWorkerMutex);
+		sWorkerBusy = (unsigned int)sWorkers.size();
+		++sWorkerRun;
+	}
+	sWorkerStart.notify_all();
+
+	WorkerPoolDrain(0);
+
+	std::unique_lock<std::mutex> lock(sWorkerMutex);
+	sWorkerDone.wait(lock, [] { return sWorkerBusy == 0; });
+}